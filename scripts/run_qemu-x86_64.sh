@@ -1,3 +1,5 @@
 #!/bin/zsh
 #qemu-system-x86_64 -L . -m 64 -fda "/Users/hansung/work/ws/os/hos/hos.img" -hda "/Users/hansung/work/ws/os/hos/hdd.img" -boot a -localtime -M pc -serial tcp:127.0.0.1:7984,server,nowait -smp 2
 qemu-system-x86_64 -L . -m 64 -fda "/Users/hansung/work/ws/os/hos/hos.img" -hda "/Users/hansung/work/ws/os/hos/hdd.img" -boot a -M pc -serial tcp:127.0.0.1:7984,server,nowait -smp 2
+# NUMA: 2 nodes (a core and 64 MB per node), and distance 20 between nodes. (shell command: acpi, dmem)
+#qemu-system-x86_64 -L . -m 128 -fda "/Users/hansung/work/ws/os/hos/hos.img" -hda "/Users/hansung/work/ws/os/hos/hdd.img" -boot a -M pc -serial tcp:127.0.0.1:7984,server,nowait -smp 2 -numa node,nodeid=0,cpus=0,mem=64 -numa node,nodeid=1,cpus=1,mem=64 -numa dist,src=0,dst=1,val=20
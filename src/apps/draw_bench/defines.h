@@ -0,0 +1,11 @@
+#ifndef __DEFINES_H__
+#define __DEFINES_H__
+
+// title
+#define TITLE "Draw Benchmark"
+
+// benchmark count
+#define BENCH_PIXELCOUNT 20000 // drawPixel call count
+#define BENCH_LINECOUNT  5000  // drawLine call count
+
+#endif // __DEFINES_H__
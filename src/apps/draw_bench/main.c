@@ -0,0 +1,177 @@
+#include <hlib.h>
+#include "defines.h"
+
+static qword benchPixelPerCall(qword windowId, const Rect* area);
+static qword benchPixelBatched(qword windowId, const Rect* area, SyscallRing* ring);
+static qword benchLinePerCall(qword windowId, const Rect* area);
+static qword benchLineBatched(qword windowId, const Rect* area, SyscallRing* ring);
+static void drawResult(qword windowId, int y, const char* name, qword count, qword perCallTime, qword batchedTime);
+
+int main(const char* args) {
+	Rect screenArea;
+	Rect area;
+	int windowWidth, windowHeight;
+	qword windowId;
+	Event event;
+	SyscallRing* ring;
+	qword perCallTime, batchedTime;
+	int y;
+	char tempBuffer[100];
+
+	/* check graphic mode */
+	if (isGraphicMode() == false) {
+		printf("[draw bench error] not graphic mode\n");
+		return -1;
+	}
+
+	/* allocate syscall ring */
+	ring = (SyscallRing*)malloc(sizeof(SyscallRing));
+	if (ring == null) {
+		printf("[draw bench error] syscall ring allocation failure\n");
+		return -1;
+	}
+
+	initSyscallRing(ring);
+
+	/* create window */
+	getScreenArea(&screenArea);
+	windowWidth = 500;
+	windowHeight = 300;
+	windowId = createWindow((getRectWidth(&screenArea) - windowWidth) / 2, (getRectHeight(&screenArea) - windowHeight) / 2, windowWidth, windowHeight, WINDOW_FLAGS_DEFAULT, TITLE, WINDOW_COLOR_BACKGROUND, null, null, WINDOW_INVALIDID);
+	if (windowId == WINDOW_INVALIDID) {
+		free(ring);
+		return -1;
+	}
+
+	// drawing area of benchmark
+	setRect(&area, 10, WINDOW_TITLEBAR_HEIGHT + 10, windowWidth - 11, windowHeight - 101);
+
+	/* run benchmark */
+	y = windowHeight - 90;
+	sprintf(tempBuffer, "%d entries per ring, time in ms (per-call / batched)", SC_RINGMAXCOUNT);
+	drawText(windowId, 10, y, RGB(0, 0, 0), WINDOW_COLOR_BACKGROUND, tempBuffer, strlen(tempBuffer));
+
+	perCallTime = benchPixelPerCall(windowId, &area);
+	batchedTime = benchPixelBatched(windowId, &area, ring);
+	drawResult(windowId, y + 25, "drawPixel", BENCH_PIXELCOUNT, perCallTime, batchedTime);
+
+	perCallTime = benchLinePerCall(windowId, &area);
+	batchedTime = benchLineBatched(windowId, &area, ring);
+	drawResult(windowId, y + 50, "drawLine", BENCH_LINECOUNT, perCallTime, batchedTime);
+
+	showWindow(windowId, true);
+
+	/* event processing loop */
+	while (true) {
+		if (recvEventFromWindow(&event, windowId) == false) {
+			sleep(0);
+			continue;
+		}
+
+		if (event.type == EVENT_WINDOW_CLOSE) {
+			deleteWindow(windowId);
+			free(ring);
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+static qword benchPixelPerCall(qword windowId, const Rect* area) {
+	qword startTime;
+	int width, height;
+	int i;
+
+	width = getRectWidth(area);
+	height = getRectHeight(area);
+	drawRect(windowId, area->x1, area->y1, area->x2, area->y2, RGB(255, 255, 255), true);
+
+	// a syscall per a pixel.
+	startTime = getTickCount();
+	for (i = 0; i < BENCH_PIXELCOUNT; i++) {
+		drawPixel(windowId, area->x1 + (i % width), area->y1 + ((i / width) % height), RGB(255, 0, 0));
+	}
+
+	return getTickCount() - startTime;
+}
+
+static qword benchPixelBatched(qword windowId, const Rect* area, SyscallRing* ring) {
+	ParamTable* paramTable;
+	qword startTime;
+	int width, height;
+	int i;
+
+	width = getRectWidth(area);
+	height = getRectHeight(area);
+	drawRect(windowId, area->x1, area->y1, area->x2, area->y2, RGB(255, 255, 255), true);
+
+	// queue pixels to ring, and enter kernel once per a full ring.
+	startTime = getTickCount();
+	for (i = 0; i < BENCH_PIXELCOUNT; i++) {
+		paramTable = queueSyscall(ring, SYSCALL_DRAWPIXEL);
+		paramTable->values[0] = windowId;
+		paramTable->values[1] = (qword)(area->x1 + (i % width));
+		paramTable->values[2] = (qword)(area->y1 + ((i / width) % height));
+		paramTable->values[3] = (qword)RGB(0, 0, 255);
+	}
+
+	submitSyscallRing(ring);
+
+	return getTickCount() - startTime;
+}
+
+static qword benchLinePerCall(qword windowId, const Rect* area) {
+	qword startTime;
+	int width;
+	int i;
+
+	width = getRectWidth(area);
+	drawRect(windowId, area->x1, area->y1, area->x2, area->y2, RGB(255, 255, 255), true);
+
+	// a syscall per a line.
+	startTime = getTickCount();
+	for (i = 0; i < BENCH_LINECOUNT; i++) {
+		drawLine(windowId, area->x1 + (i % width), area->y1, area->x2 - (i % width), area->y2, RGB(255, 0, 0));
+	}
+
+	return getTickCount() - startTime;
+}
+
+static qword benchLineBatched(qword windowId, const Rect* area, SyscallRing* ring) {
+	ParamTable* paramTable;
+	qword startTime;
+	int width;
+	int i;
+
+	width = getRectWidth(area);
+	drawRect(windowId, area->x1, area->y1, area->x2, area->y2, RGB(255, 255, 255), true);
+
+	// queue lines to ring, and enter kernel once per a full ring.
+	startTime = getTickCount();
+	for (i = 0; i < BENCH_LINECOUNT; i++) {
+		paramTable = queueSyscall(ring, SYSCALL_DRAWLINE);
+		paramTable->values[0] = windowId;
+		paramTable->values[1] = (qword)(area->x1 + (i % width));
+		paramTable->values[2] = (qword)area->y1;
+		paramTable->values[3] = (qword)(area->x2 - (i % width));
+		paramTable->values[4] = (qword)area->y2;
+		paramTable->values[5] = (qword)RGB(0, 0, 255);
+	}
+
+	submitSyscallRing(ring);
+
+	return getTickCount() - startTime;
+}
+
+static void drawResult(qword windowId, int y, const char* name, qword count, qword perCallTime, qword batchedTime) {
+	char tempBuffer[100];
+
+	// tick count is millisecond-level, so 0 ms is regarded as 1 ms.
+	perCallTime = (perCallTime == 0) ? 1 : perCallTime;
+	batchedTime = (batchedTime == 0) ? 1 : batchedTime;
+
+	sprintf(tempBuffer, "- %s x %d: %d / %d ms (%d / %d calls/s)", name, (int)count, (int)perCallTime, (int)batchedTime,
+	        (int)(count * 1000 / perCallTime), (int)(count * 1000 / batchedTime));
+	drawText(windowId, 10, y, RGB(0, 0, 0), WINDOW_COLOR_BACKGROUND, tempBuffer, strlen(tempBuffer));
+}
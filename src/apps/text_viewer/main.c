@@ -46,6 +46,8 @@ int main(const char* args) {
 	windowId = createWindow(x, y, width, height, WINDOW_FLAGS_DEFAULT | WINDOW_FLAGS_RESIZABLE | WINDOW_FLAGS_BLOCKING, TITLE, WINDOW_COLOR_BACKGROUND, null, null, WINDOW_INVALIDID);
 	if (windowId == WINDOW_INVALIDID) {
 		printf("[text viewer error] window creation failure\n");
+		unmapFile(info.fileBuffer);
+		free(info.fileOffset);
 		return -1;
 	}
 
@@ -77,7 +79,7 @@ int main(const char* args) {
 		case EVENT_WINDOW_CLOSE:
 			deleteWindow(windowId);
 			// [NOTE] Not closing window, but killing task causes memory leak.
-			free(info.fileBuffer);
+			unmapFile(info.fileBuffer);
 			free(info.fileOffset);
 			return 0;
 
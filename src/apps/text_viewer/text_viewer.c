@@ -2,67 +2,26 @@
 
 bool readFile(const char* fileName, TextInfo* info) {
 	dword fileSize;
-	Dir* dir;
-	dirent* entry;
-	File* file;
 
-	/* get file size */
-	fileSize = 0;
-	dir = opendir("/");
-	while (true) {
-		entry = readdir(dir);
-		if (entry == null) {
-			break;
-		}
-
-		if (strcmp(entry->d_name, fileName) == 0) {
-			fileSize = entry->d_size;
-			break;
-		}
-	}
-
-	closedir(dir);
-
-	if (fileSize == 0) {
-		printf("[text viewer error] %s does not exist or is zero-sized.\n", fileName);
-		return false;
-	}
-
-	info->fileSize = fileSize;
 	strcpy(info->fileName, fileName);
 
-	/* allocate file offset and file buffer */
+	/* allocate file offset */
 	info->fileOffset = (dword*)malloc(sizeof(dword) * MAXLINECOUNT);
 	if (info->fileOffset == null) {
 		printf("[text viewer error] file offset allocation failure\n");
 		return false;
 	}
 
-	info->fileBuffer = (byte*)malloc(fileSize);
-	if (info->fileBuffer == null) {
-		printf("[text viewer error] file buffer allocation failure\n");
-		free(info->fileOffset);
-		return false;
-	}
-
-	/* read file */
-	file = fopen(fileName, "r");
-	if (file == null) {
-		printf("[text viewer error] %s opening failure\n", fileName);	
-		free(info->fileBuffer);
-		free(info->fileOffset);
-		return false;
-	}
-
-	if (fread(info->fileBuffer, 1, fileSize, file) != fileSize) {
-		printf("[text viewer error] %s reading failure\n", fileName);	
-		fclose(file);
-		free(info->fileBuffer);
+	/* map file: read file directly from the view without copying it to a private buffer */
+	fileSize = 0;
+	info->fileBuffer = (const byte*)mapFile(fileName, &fileSize);
+	if ((info->fileBuffer == null) || (fileSize == 0)) {
+		printf("[text viewer error] %s does not exist or is zero-sized.\n", fileName);
 		free(info->fileOffset);
 		return false;
 	}
 
-	fclose(file);
+	info->fileSize = fileSize;
 
 	return true;
 }
@@ -14,7 +14,7 @@
 #define COLOR_FILEINFO RGB(109, 213, 237)
 
 typedef struct __TextInfo {
-	byte* fileBuffer;  // file buffer
+	const byte* fileBuffer; // file buffer: read-only view of mapped file
 	dword fileSize;    // file size
 	int columns;       // column (character) count in a line
 	int rows;          // row (line) count in a page
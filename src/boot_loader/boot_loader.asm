@@ -3,9 +3,14 @@
 
 SECTION .text
 
+BOOT_LOADER_SECTOR_COUNT equ 2         ; sector count of boot-loader (stage 1, stage 2)
+BOUNCE_BUFFER_SEGMENT    equ 0x9000    ; bounce buffer (0x90000 ~ 0x97FFF, 32 KB) to read sectors under 1 MB
+MAX_READ_SECTOR_COUNT    equ 64        ; max sector count per a LBA read (32 KB)
+STAGING_ADDRESS          equ 0x1000000 ; staging address (16 MB) of hOS image except boot-loader
+
 jmp 0x07C0:START ; set <0x07C0> to CS segment register, and move to the address <0x7C00 + START>.
 
-TOTAL_SECTOR_COUNT: dw 0x02    ; physical address 0x7C05: the total sector count of hOS image except boot-loader (max 1152 sectors, max 0x90000 bytes)
+TOTAL_SECTOR_COUNT: dw 0x02    ; physical address 0x7C05: the total sector count of hOS image except boot-loader (max 65535 sectors, loaded to STAGING_ADDRESS)
 KERNEL32_SECTOR_COUNT: dw 0x02 ; physical address 0x7C07: the sector count of kernel32
 BSP_FLAG: db 0x01              ; physical address 0x7C09: BSP flag (0: AP, 1: BSP)
 GRAPHIC_MODE_FLAG: db 0x01     ; physical address 0x7C0A: graphic mode flag (0: text mode, 1: graphic mode)
@@ -50,57 +55,189 @@ RESET_DISK:
 	int 0x13                  ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
 	jc HANDLE_DISK_ERROR      ; exception handling
 	
-	mov ah, 0x08               ; function number (0x08: read disk parameters)
-	mov dl, byte [BOOT_DRIVE]  ; drive number
-	int 0x13                   ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
-	jc HANDLE_DISK_ERROR       ; exception handling
-	mov byte [LAST_HEAD], dh   ; last head number (DH 8 bits)
-	mov al, cl                 ; -
-	and al, 0x3f               ; -
-	mov byte [LAST_SECTOR], al ; last sector number (CL low 6 bits)
-	mov byte [LAST_TRACK], ch  ; last track number (CH 8 bits + CL high 2 bits)
-	
-	mov si, 0x1000             ; memory address for the read sectors (ES:BX, 0x10000)
-	mov es, si
-	mov bx, 0x0000
-	mov di, word [TOTAL_SECTOR_COUNT]
+	; load stage 2 (the second sector of boot-loader) right after stage 1 <0x7E00>.
+	mov ax, 0x07C0            ; memory address for the read sector (ES:BX, 0x7E00)
+	mov es, ax
+	mov bx, 0x0200
+	mov ax, 0x0201            ; function number (0x02: read sectors), read sector count (1)
+	mov cx, 0x0002            ; read track number (0), read sector number (2)
+	mov dh, 0x00              ; read head number (0)
+	mov dl, byte [BOOT_DRIVE] ; drive number
+	int 0x13                  ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
+	jc HANDLE_DISK_ERROR      ; exception handling
+	jmp STAGE2
+
+HANDLE_DISK_ERROR:
+	push DISK_ERROR_MESSAGE
+	push 1
+	push 20
+	call PRINT_MESSAGE
+	add sp, 6
+	jmp $
+
+PRINT_MESSAGE:
+	push bp
+	mov bp, sp
+	push es
+	push si
+	push di
+	push ax
+	push cx
+	push dx
+	
+	mov ax, 0xB800
+	mov es, ax
+	
+	mov ax, word [bp+6]
+	mov si, 160
+	mul si
+	mov di, ax
+	
+	mov ax, word [bp+4]
+	mov si, 2
+	mul si
+	add di, ax
+	
+	mov si, word [bp+8]
+
+.MESSAGE_LOOP:
+	mov cl, byte [si]
+	cmp cl, 0
+	je .MESSAGE_END
+	mov byte [es:di], cl
+	add si, 1
+	add di, 2
+	jmp .MESSAGE_LOOP
+
+.MESSAGE_END:
+	pop dx
+	pop cx
+	pop ax
+	pop di
+	pop si
+	pop es
+	pop bp
+	ret
+
+MESSAGE1:                         db 0 ; start boot-loader
+DISK_ERROR_MESSAGE:               db 'disk error', 0
+IMAGE_LOADING_MESSAGE:            db 0 ; load hOS image...
+LOADING_COMPLETE_MESSAGE:         db 0 ; pass
+CHANGE_GRAPHIC_MODE_FAIL_MESSAGE: db 'graphic mode switching failure', 0
+
+BOOT_DRIVE: db 0x00
+
+times 510 - ($ - $$) db 0x00
+db 0x55
+db 0xAA
+
+; ====================================================================================================
+; stage 2: It's loaded to <0x7E00> by stage 1, and loads hOS image.
+; ====================================================================================================
+STAGE2:
+	mov ah, 0x08                ; function number (0x08: read disk parameters)
+	mov dl, byte [BOOT_DRIVE]   ; drive number
+	int 0x13                    ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
+	jc HANDLE_DISK_ERROR        ; exception handling
+	and cx, 0x3F                ; -
+	mov word [SECTOR_COUNT], cx ; sector count per track (last sector number: CL low 6 bits)
+	movzx ax, dh                ; -
+	inc ax                      ; -
+	mov word [HEAD_COUNT], ax   ; head count (last head number (DH 8 bits) + 1)
+	
+	; check INT 13h extensions: If supported, read sectors by LBA (function 0x42). If not, read sectors by CHS (function 0x02).
+	mov ah, 0x41              ; function number (0x41: check extensions present)
+	mov bx, 0x55AA            ; signature
+	mov dl, byte [BOOT_DRIVE] ; drive number
+	int 0x13                  ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
+	jc .ENABLE_A20_GATE       ; not supported
+	cmp bx, 0xAA55            ; check signature if installed
+	jne .ENABLE_A20_GATE
+	and cl, 0x01              ; check disk address packet support (CX bit 0)
+	mov byte [LBA_MODE_FLAG], cl
+
+.ENABLE_A20_GATE:
+	; enable A20 gate to access memory over 1 MB.
+	mov ax, 0x2401 ; function number (0x2401: enable A20 gate)
+	int 0x15       ; cause software interrupt (0x15: BIOS Service -> System Service)
+	jnc .SET_BOUNCE_BUFFER
+	in al, 0x92    ; read 1 byte from system control port (0x92) and save it to AL.
+	or al, 0x02    ; set A20 gate bit (bit 1) to 1.
+	and al, 0xFE   ; set system reset bit (bit 0) to 0.
+	out 0x92, al   ; save it to system control port (0x92).
+
+.SET_BOUNCE_BUFFER:
+	mov ax, BOUNCE_BUFFER_SEGMENT ; memory address for the read sectors (ES:BX, 0x90000)
+	mov es, ax
+	
+	; [NOTE] hOS image is loaded to the staging address (16 MB) through the bounce buffer (0x90000),
+	;        because BIOS can read sectors only under 1 MB. Then, kernel32 is copied to <0x10000> in unreal mode.
+	xor bx, bx
+	mov bp, word [TOTAL_SECTOR_COUNT] ; remaining sector count
 
 READ_DATA:
-	cmp di, 0
-	je READ_END
-	sub di, 1
-	
-	mov ah, 0x02                 ; function number (0x02: read sectors)
-	mov al, 0x01                 ; read sector count
-	mov ch, byte [TRACK_NUMBER]  ; read track number
-	mov cl, byte [SECTOR_NUMBER] ; read sector number
-	mov dh, byte [HEAD_NUMBER]   ; read head number
-	mov dl, byte [BOOT_DRIVE]    ; drive number
-	int 0x13                     ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
-	jc HANDLE_DISK_ERROR         ; exception handling
-	
-	add si, 0x0020
-	mov es, si
-	
-	mov al, byte [SECTOR_NUMBER]
-	add al, 1
-	mov byte [SECTOR_NUMBER], al
-	cmp al, byte [LAST_SECTOR]
-	jbe READ_DATA
-	
-	add byte [HEAD_NUMBER], 1
-	mov byte [SECTOR_NUMBER], 0x01
-	mov al, byte [LAST_HEAD]
-	cmp byte [HEAD_NUMBER], al
-	ja .ADD_TRACK
-	jmp READ_DATA
-
-.ADD_TRACK:
-	mov byte [HEAD_NUMBER], 0x00
-	add byte [TRACK_NUMBER], 1
-	jmp READ_DATA
+	mov cx, 1
+	cmp byte [LBA_MODE_FLAG], 0x00
+	je .READ_DATA_BY_CHS
+	
+	; read sectors by LBA: as many sectors as the bounce buffer can take per a call.
+	mov cl, MAX_READ_SECTOR_COUNT
+	cmp bp, cx
+	jae .READ_DATA_BY_LBA
+	mov cx, bp
+
+.READ_DATA_BY_LBA:
+	mov word [DAP_SECTOR_COUNT], cx
+	mov ah, 0x42 ; function number (0x42: extended read sectors)
+	mov si, DAP  ; disk address packet (DS:SI)
+	jmp .READ_SECTORS
+
+.READ_DATA_BY_CHS:
+	; read a sector by CHS: convert 32-bit LBA to CHS.
+	mov word [DAP_SECTOR_COUNT], cx
+	mov eax, dword [DAP_LBA]
+	xor edx, edx
+	movzx esi, word [SECTOR_COUNT]
+	div esi                    ; EAX = LBA / sector count per track, EDX = LBA % sector count per track
+	mov cl, dl                 ; -
+	inc cl                     ; sector number = EDX + 1
+	xor edx, edx
+	movzx esi, word [HEAD_COUNT]
+	div esi                    ; EAX = track number, EDX = head number
+	cmp eax, 1023              ; CHS can address only 1024 tracks.
+	ja HANDLE_DISK_ERROR
+	mov ch, al                 ; track number (low 8 bits)
+	shl ah, 6                  ; -
+	or cl, ah                  ; track number (high 2 bits) to CL bit 6~7
+	mov dh, dl                 ; head number
+	mov ax, 0x0201             ; function number (0x02: read sectors), read sector count (1)
+
+.READ_SECTORS:
+	mov dl, byte [BOOT_DRIVE] ; drive number
+	int 0x13                  ; cause software interrupt (0x13: BIOS Service -> Disk I/O Service)
+	jc HANDLE_DISK_ERROR      ; exception handling
+	
+	; copy the read sectors from the bounce buffer to the staging area.
+	movzx ecx, word [DAP_SECTOR_COUNT]
+	add dword [DAP_LBA], ecx
+	sub bp, cx
+	shl ecx, 7 ; sector count * 128 = dword count
+	mov esi, BOUNCE_BUFFER_SEGMENT * 16
+	mov edi, dword [STAGING_OFFSET]
+	call COPY_MEMORY
+	mov dword [STAGING_OFFSET], edi
+	
+	cmp bp, 0
+	jne READ_DATA
 
 READ_END:
+	; copy kernel32 from the staging area to <0x10000>.
+	movzx ecx, word [KERNEL32_SECTOR_COUNT]
+	shl ecx, 7 ; sector count * 128 = dword count
+	mov esi, STAGING_ADDRESS
+	mov edi, 0x10000
+	call COPY_MEMORY
+	
 	push LOADING_COMPLETE_MESSAGE
 	push 1
 	push 20
@@ -152,7 +289,7 @@ READ_END:
 	; function 0x4F01: get VBE mode info block.
 	mov ax, 0x4F01 ; function number
 	mov cx, 0x117  ; mode number
-	mov bx, 0x07E0 ; VBE mode info block segment address: VBE mode info block physical address -> [ES:DI] -> [0x07E0:0x00] -> 0x7E00
+	mov bx, 0x0800 ; VBE mode info block segment address: VBE mode info block physical address -> [ES:DI] -> [0x0800:0x00] -> 0x8000
 	mov es, bx
 	mov di, 0x00   ; VBE mode info block offset
 	int 0x10       ; cause software interrupt (0x10: BIOS Service -> Video Control Service)
@@ -183,73 +320,73 @@ VBE_ERROR:
 JUMP_TO_PROTECTED_MODE:
 	jmp 0x1000:0x0000 ; set <0x1000> to CS segment register, and move to the address <0x10000>.
 
-HANDLE_DISK_ERROR:
-	push DISK_ERROR_MESSAGE
-	push 1
-	push 20
-	call PRINT_MESSAGE
-	add sp, 6
-	jmp $
-
-PRINT_MESSAGE:
-	push bp
-	mov bp, sp
+; - param  : ESI (source address), EDI (destination address), ECX (dword count)
+; - return : ESI, EDI (next addresses of source and destination)
+COPY_MEMORY:
+	push ds
 	push es
-	push si
-	push di
-	push ax
-	push cx
-	push dx
-	
-	mov ax, 0xB800
-	mov es, ax
-	
-	mov ax, word [bp+6]
-	mov si, 160
-	mul si
-	mov di, ax
+	push eax
+	push bx
 	
-	mov ax, word [bp+4]
-	mov si, 2
-	mul si
-	add di, ax
+	; enter unreal mode: Segment limit (4 GB) loaded in protected mode is kept after returning to real mode,
+	;                    so 32-bit offsets can access memory over 1 MB in real mode.
+	; [NOTE] It's entered again before each copy, because BIOS services called between copies might reload segment limits.
+	;        Interrupts are disabled until the copy ends for the same reason.
+	cli
+	lgdt [UNREAL_GDTR]
+	mov eax, cr0
+	or al, 0x01  ; PE=1
+	mov cr0, eax
+	mov bx, 0x08 ; data segment descriptor (4 GB)
+	mov ds, bx
+	mov es, bx
+	and al, 0xFE ; PE=0
+	mov cr0, eax
+	xor bx, bx
+	mov ds, bx
+	mov es, bx
+	cld
+	a32 rep movsd ; copy by 32-bit offsets in unreal mode.
+	sti
 	
-	mov si, word [bp+8]
-
-.MESSAGE_LOOP:
-	mov cl, byte [si]
-	cmp cl, 0
-	je .MESSAGE_END
-	mov byte [es:di], cl
-	add si, 1
-	add di, 2
-	jmp .MESSAGE_LOOP
-
-.MESSAGE_END:
-	pop dx
-	pop cx
-	pop ax
-	pop di
-	pop si
+	pop bx
+	pop eax
 	pop es
-	pop bp
+	pop ds
 	ret
 
-MESSAGE1:                         db 0 ; start boot-loader
-DISK_ERROR_MESSAGE:               db 'disk error', 0
-IMAGE_LOADING_MESSAGE:            db 0 ; load hOS image...
-LOADING_COMPLETE_MESSAGE:         db 0 ; pass
-CHANGE_GRAPHIC_MODE_FAIL_MESSAGE: db 'graphic mode switching failure', 0
+SECTOR_COUNT:   dw 0x00            ; sector count per track
+HEAD_COUNT:     dw 0x00            ; head count
+LBA_MODE_FLAG:  db 0x00            ; LBA mode flag (0: CHS mode, 1: LBA mode)
+STAGING_OFFSET: dd STAGING_ADDRESS ; staging address to copy the next read sectors
 
-SECTOR_NUMBER: db 0x02
-HEAD_NUMBER:   db 0x00
-TRACK_NUMBER:  db 0x00
+; disk address packet (16 bytes) of function 0x42
+DAP:              db 0x10, 0x00                     ; packet size, reserved
+DAP_SECTOR_COUNT: dw 0x00                           ; sector count to read
+DAP_BUFFER:       dw 0x0000, BOUNCE_BUFFER_SEGMENT  ; buffer offset, buffer segment
+DAP_LBA:          dd BOOT_LOADER_SECTOR_COUNT, 0x00 ; start LBA: the next sector of boot-loader
 
-BOOT_DRIVE:  db 0x00
-LAST_SECTOR: db 0x00
-LAST_HEAD:   db 0x00
-LAST_TRACK:  db 0x00
+UNREAL_GDTR:
+	dw UNREAL_GDT_END - UNREAL_GDT - 1 ; GDT Size (2 bytes)
+	dd UNREAL_GDT + 0x7C00             ; GDT BaseAddress (4 bytes)
 
-times 510 - ($ - $$) db 0x00
-db 0x55
-db 0xAA
+UNREAL_GDT:
+	UNREAL_NULL_DESCRIPTOR: ; null segment descriptor (8 bytes)
+		dw 0x0000
+		dw 0x0000
+		db 0x00
+		db 0x00
+		db 0x00
+		db 0x00
+	
+	UNREAL_DATA_DESCRIPTOR: ; unreal mode data segment descriptor (8 bytes)
+		dw 0xFFFF    ; Limit=0xFFFF
+		dw 0x0000    ; BaseAddress=0x0000
+		db 0x00      ; BaseAddress=0x00
+		db 0x92      ; P=1, DPL=00, S=1, Type=0x2:DataSegment (Read/Write)
+		db 0xCF      ; G=1, D/B=1, L=0, AVL=0, Limit=0xF
+		db 0x00      ; BaseAddress=0x00
+	
+UNREAL_GDT_END:
+
+times (512 * BOOT_LOADER_SECTOR_COUNT) - ($ - $$) db 0x00
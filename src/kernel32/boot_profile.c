@@ -0,0 +1,33 @@
+#include "types.h"
+#include "mode_switch.h"
+#include "../kernel64/core/boot_profile.h"
+
+// [NOTE] kernel32 implements only initialization and recording of boot profile,
+//        and kernel64 implements the rest of boot profile functions.
+
+void k_initBootProfile(void) {
+	BootProfile* profile = (BootProfile*)BOOTPROFILE_ADDRESS;
+	
+	profile->signature = BOOTPROFILE_SIGNATURE;
+	profile->phaseCount = 0;
+}
+
+void k_addBootPhase(const char* name) {
+	BootProfile* profile = (BootProfile*)BOOTPROFILE_ADDRESS;
+	BootPhase* phase;
+	int i;
+	
+	if (profile->phaseCount >= BOOTPROFILE_MAXPHASECOUNT) {
+		return;
+	}
+	
+	phase = &profile->phases[profile->phaseCount];
+	k_readTsc(&phase->highTsc, &phase->lowTsc);
+	
+	for (i = 0; (i < BOOTPROFILE_MAXNAMELENGTH - 1) && (name[i] != '\0'); i++) {
+		phase->name[i] = name[i];
+	}
+	
+	phase->name[i] = '\0';
+	profile->phaseCount++;
+}
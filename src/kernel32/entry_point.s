@@ -14,19 +14,8 @@ START:
 	cmp byte [es:0x7C09], 0x00 ; If BSP flag == [0:AP], move to AP start point.
 	je .AP_STARTPOINT
 	
-	; enable A20 gate
-	mov ax, 0x2401        ; function number (0x2401: enable A20 gate)
-	int 0x15              ; cause software interrupt (0x15: BIOS Service -> System Service)
-	jc .A20_GATE_ERROR    ; error handling
-	jmp .A20_GATE_SUCCESS ; success handling
+	; [NOTE] A20 gate has been already enabled by boot-loader to load hOS image over 1 MB.
 
-.A20_GATE_ERROR:
-	in al, 0x92  ; read 1 byte from system control port (0x92) and save it to AL.
-	or al, 0x02  ; set A20 gate bit (bit 1) to 1.
-	and al, 0xFE ; set system reset bit (bit 0) to 0.
-	out 0x92, al ; save it to system control port (0x92).
-
-.A20_GATE_SUCCESS:
 .AP_STARTPOINT:
 	; switch to kernel32
 	cli                 ; close interrupt.
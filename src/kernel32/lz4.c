@@ -0,0 +1,86 @@
+#include "lz4.h"
+
+/**
+  < LZ4 Block Format >
+  - A block is composed of sequences, and a sequence is [token][literal length+][literals][offset][match length+].
+  - token (1 byte): high 4 bits are literal length, and low 4 bits are match length - 4.
+                    If a length is 15, the following bytes are added to it until a byte is not 255.
+  - offset (2 bytes, little endian): backward distance of match from the current position (1 ~ 65535).
+  - The last sequence has only literals.
+*/
+
+// return decompressed size, or 0 if source is corrupted.
+dword k_decompressLz4(const byte* src, dword srcSize, byte* dest, dword destSize) {
+	dword srcIndex = 0;
+	dword destIndex = 0;
+	dword literalLen;
+	dword matchLen;
+	dword offset;
+	byte token;
+	byte len;
+	dword i;
+	
+	while (srcIndex < srcSize) {
+		token = src[srcIndex++];
+		
+		// copy literals.
+		literalLen = token >> 4;
+		if (literalLen == 15) {
+			do {
+				if (srcIndex >= srcSize) {
+					return 0;
+				}
+				
+				len = src[srcIndex++];
+				literalLen += len;
+			} while (len == 255);
+		}
+		
+		if (((srcIndex + literalLen) > srcSize) || ((destIndex + literalLen) > destSize)) {
+			return 0;
+		}
+		
+		for (i = 0; i < literalLen; i++) {
+			dest[destIndex++] = src[srcIndex++];
+		}
+		
+		// The last sequence has only literals.
+		if (srcIndex >= srcSize) {
+			break;
+		}
+		
+		// copy match: Match can overlap the current position, so copy it byte by byte.
+		if ((srcIndex + 2) > srcSize) {
+			return 0;
+		}
+		
+		offset = src[srcIndex] | (src[srcIndex + 1] << 8);
+		srcIndex += 2;
+		if ((offset == 0) || (offset > destIndex)) {
+			return 0;
+		}
+		
+		matchLen = (token & 0x0F) + LZ4_MINMATCH;
+		if ((token & 0x0F) == 15) {
+			do {
+				if (srcIndex >= srcSize) {
+					return 0;
+				}
+				
+				len = src[srcIndex++];
+				matchLen += len;
+			} while (len == 255);
+		}
+		
+		if ((destIndex + matchLen) > destSize) {
+			return 0;
+		}
+		
+		for (i = 0; i < matchLen; i++) {
+			dest[destIndex] = dest[destIndex - offset];
+			destIndex++;
+		}
+	}
+	
+	return destIndex;
+}
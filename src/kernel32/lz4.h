@@ -0,0 +1,25 @@
+#ifndef __LZ4_H__
+#define __LZ4_H__
+
+#include "types.h"
+
+// LZ4-compressed kernel64 header: image-maker writes it in front of kernel64 compressed with '-c' option.
+#define LZ4_KERNEL64SIGNATURE 0x4B345A4C // "LZ4K"
+
+// LZ4 block format-related macros
+#define LZ4_MINMATCH 4 // min match length
+
+#pragma pack(push, 1)
+
+typedef struct k_Lz4Header {
+	dword signature;      // signature (LZ4_KERNEL64SIGNATURE)
+	dword compressedSize; // compressed data size (except header)
+	dword originalSize;   // original data size
+	dword reserved;       // reserved
+} Lz4Header;
+
+#pragma pack(pop)
+
+dword k_decompressLz4(const byte* src, dword srcSize, byte* dest, dword destSize);
+
+#endif // __LZ4_H__
@@ -1,7 +1,12 @@
 #include "types.h"
 #include "page.h"
+#include "lz4.h"
+#include "../kernel64/core/boot_profile.h"
 #include "mode_switch.h"
 
+// hOS image staging address (0x1000000, 16 MB): STAGING_ADDRESS is defined in boot_loader.asm.
+#define STAGINGADDRESS 0x1000000
+
 // BSP flag
 #define BSPFLAG     *(byte*)0x7C09 // BSP flag (0: AP, 1: BSP): BSP_FLAG is defined in boot_loader.asm.
 #define BSPFLAG_AP  0x00           // AP
@@ -10,7 +15,7 @@
 static void k_printStrXy(int x, int y, const char* str);
 static bool k_isMemEnough(void);
 static bool k_initKernel64Area(void);
-static void k_copyKernel64To2MB(void);
+static bool k_copyKernel64To2MB(void);
 
 void k_main(void) {
 	int y = 1; // y of cursor, blank line 0.
@@ -19,12 +24,19 @@ void k_main(void) {
 	
 	// compare BSP flag.
 	if (BSPFLAG == BSPFLAG_AP) {
+		// initialize PAT same as BSP.
+		k_initPat();
+
 		// switch to kernel64.
 		k_switchToKernel64();
 		
 		while (true);
 	}
 	
+	// initialize boot profile, and record BIOS, boot-loader and mode switch phase (from power-on, TSC 0).
+	k_initBootProfile();
+	k_addBootPhase("power-on to kernel32");
+	
 	// print the first message of kernel32 at line 1.
 	k_printStrXy(0, y++, "*** hOS Initialization ***");
 	
@@ -50,6 +62,8 @@ void k_main(void) {
 		while (true);
 	}
 	
+	k_addBootPhase("check memory size");
+	
 	// initialize the memory area of kernel64.
 	k_printStrXy(0, y, "- initialize IA-32e mode kernel area.........");
 	if (k_initKernel64Area() == true) {
@@ -60,10 +74,22 @@ void k_main(void) {
 		while (true);
 	}
 	
+	k_addBootPhase("initialize kernel64 area");
+	
 	// initialize the page tables of kernel64.
 	k_printStrXy(0, y, "- initialize IA-32e mode page tables.........");
 	k_initPageTables();
 	k_printStrXy(45, y++, "pass");
+	k_addBootPhase("initialize page tables");
+
+	// initialize PAT to map video memory as write combining.
+	k_printStrXy(0, y, "- initialize page attribute table............");
+	if (k_initPat() == true) {
+		k_printStrXy(45, y++, "pass");
+
+	} else {
+		k_printStrXy(45, y++, "skip");
+	}
 	
 	// read processor vendor name.
 	k_readCpuid(0x00000000, &eax, &ebx, &ecx, &edx);
@@ -84,11 +110,17 @@ void k_main(void) {
 		while (true);
 	}
 	
-	// print the last message of kernel32 at line 11.
+	// print the last message of kernel32 at line 12.
 	// copy kernel64 to the address <0x200000 (2 MB)>.
 	k_printStrXy(0, y, "- copy IA-32e mode kernel to 2 MB address....");
-	k_copyKernel64To2MB();
+	if (k_copyKernel64To2MB() == false) {
+		k_printStrXy(45, y++, "fail");
+		k_printStrXy(0, y++, "[kernel32 error] kernel64 image is corrupted.");
+		while (true);
+	}
+	
 	k_printStrXy(45, y++, "pass");
+	k_addBootPhase("copy kernel64");
 	
 	// switch to kernel64
 	k_switchToKernel64();
@@ -109,14 +141,18 @@ static void k_printStrXy(int x, int y, const char* str) {
 
 static bool k_isMemEnough(void) {
 	dword* currentAddr = (dword*)0x100000; // 1 MB
+	dword prevValue;
 	
 	while ((dword)currentAddr < 0x4000000) { // 64 MB
+		// [NOTE] hOS image is in the staging area, so restore the previous value after checking.
+		prevValue = *currentAddr;
 		*currentAddr = 0x12345678;
 		
 		if (*currentAddr != 0x12345678) {
 			return false;
 		}
 		
+		*currentAddr = prevValue;
 		currentAddr += (0x100000 / 4); // increase by 1 MB.
 	}
 	
@@ -139,20 +175,39 @@ static bool k_initKernel64Area(void) {
 	return true;
 }
 
-static void k_copyKernel64To2MB(void) {
+static bool k_copyKernel64To2MB(void) {
 	word totalSectorCount, kernel32SectorCount;
 	dword* srcAddr, * destAddr;
+	Lz4Header* header;
 	int i;
 	
 	totalSectorCount = *((word*)0x7C05);
 	kernel32SectorCount = *((word*)0x7C07);
 	
-	srcAddr = (dword*)(0x10000 + (kernel32SectorCount * 512));
+	srcAddr = (dword*)(STAGINGADDRESS + (kernel32SectorCount * 512));
 	destAddr = (dword*)0x200000;
 	
-	for (int i = 0; i < (((totalSectorCount - kernel32SectorCount) * 512) / 4); i++) {
+	// if kernel64 image has been compressed by image maker, decompress it to 2 MB.
+	header = (Lz4Header*)srcAddr;
+	if (header->signature == LZ4_KERNEL64SIGNATURE) {
+		// kernel64 area is from 2 MB to 6 MB.
+		if ((header->originalSize > (0x600000 - 0x200000)) ||
+		    (header->compressedSize > (((totalSectorCount - kernel32SectorCount) * 512) - sizeof(Lz4Header)))) {
+			return false;
+		}
+		
+		if (k_decompressLz4((byte*)srcAddr + sizeof(Lz4Header), header->compressedSize, (byte*)destAddr, header->originalSize) != header->originalSize) {
+			return false;
+		}
+		
+		return true;
+	}
+	
+	for (i = 0; i < (((totalSectorCount - kernel32SectorCount) * 512) / 4); i++) {
 		*destAddr = *srcAddr;
 		destAddr++;
 		srcAddr++;
 	}
+	
+	return true;
 }
@@ -1,6 +1,6 @@
 [BITS 32]
 
-global k_readCpuid, k_switchToKernel64
+global k_readCpuid, k_switchToKernel64, k_writeMsr, k_readTsc
 
 SECTION .text
 
@@ -40,6 +40,48 @@ k_readCpuid:
 	pop ebp
 	ret
 
+; - param  : dword addr, dword high32bits, dword low32bits
+; - return : void
+k_writeMsr:
+	push ebp
+	mov ebp, esp
+	push eax
+	push ecx
+	push edx
+	
+	mov ecx, dword [ebp + 8]  ; addr
+	mov edx, dword [ebp + 12] ; high32bits
+	mov eax, dword [ebp + 16] ; low32bits
+	wrmsr
+	
+	pop edx
+	pop ecx
+	pop eax
+	pop ebp
+	ret
+
+; - param  : dword* high32bits, dword* low32bits
+; - return : void
+k_readTsc:
+	push ebp
+	mov ebp, esp
+	push eax
+	push edx
+	push esi
+	
+	rdtsc ; read TSC to EDX:EAX.
+	
+	mov esi, dword [ebp + 8]  ; high32bits
+	mov dword [esi], edx
+	mov esi, dword [ebp + 12] ; low32bits
+	mov dword [esi], eax
+	
+	pop esi
+	pop edx
+	pop eax
+	pop ebp
+	ret
+
 ; - param  : void
 ; - return : void
 k_switchToKernel64:
@@ -65,11 +107,12 @@ k_switchToKernel64:
 	or eax, 0x0101
 	wrmsr
 	
-	; CR0 control register: PG(bit 31)=1, CD(bit 30)=0, NW(bit 29)=0, TS(bit 3)=1, EM(bit 2)=0, MP(bit 1)=1
+	; CR0 control register: PG(bit 31)=1, CD(bit 30)=0, NW(bit 29)=0, WP(bit 16)=1, TS(bit 3)=1, EM(bit 2)=0, MP(bit 1)=1
 	; - enable paging, cache, FPU
 	; - NW(bit 29)=0: [NOTE] NW must be set to 1 to use the write back policy.
+	; - WP(bit 16)=1: kernel (Ring 0) can't write read-only pages either, in order to catch copy-on-write pages in system call.
 	mov eax, cr0
-	or eax, 0xE000000E
+	or eax, 0xE001000E
 	xor eax, 0x60000004
 	mov cr0, eax
 	
@@ -5,5 +5,7 @@
 
 void k_readCpuid(dword eax_, dword* eax, dword* ebx, dword* ecx, dword* edx);
 void k_switchToKernel64(void);
+void k_writeMsr(dword addr, dword high32bits, dword low32bits);
+void k_readTsc(dword* high32bits, dword* low32bits);
 
 #endif // __MODESWITCH_H__
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "page.h"
+#include "mode_switch.h"
 
 /**
   < Intel 80x86 Memory Address >
@@ -19,6 +20,12 @@
   -> page directory pointer table
   -> page directory
   -> page (2 MB) in physical memory 
+
+  < hOS Video Memory Caching >
+  Video memory (linear frame buffer) in graphic mode is mapped as write combining (WC),
+  which buffers and merges writes to sequential addresses, instead of default uncacheable (UC) by BIOS MTRRs.
+  - PAT entry 4 (PA4) is changed from WB to WC on every core (BSP, AP), and video memory pages select PA4 by PAT flag.
+  - MTRRs are not changed, because PAT WC takes precedence over MTRR UC or WB.
 */
 
 void k_initPageTables(void) {
@@ -26,6 +33,9 @@ void k_initPageTables(void) {
 	PdptEntry* pdptEntry;
 	PdEntry* pdEntry;
 	dword mappingAddr;
+	VbeModeInfoBlock* vbeMode;
+	dword videoMemStartIndex;
+	dword videoMemEndIndex;
 	int i;
 	
 	// create PML4 table (4 KB): 1 table, 1 entry.
@@ -62,6 +72,40 @@ void k_initPageTables(void) {
 		
 		mappingAddr += PAGE_DEFAULTSIZE;
 	}
+
+	// map video memory as write combining in graphic mode.
+	if ((VBE_GRAPHICMODEFLAG == VBE_GRAPHICMODEFLAG_GRAPHICMODE) && (k_isPatSupported() == true)) {
+		vbeMode = (VbeModeInfoBlock*)VBE_MODEINFOBLOCKADDRESS;
+		videoMemStartIndex = vbeMode->physicalBaseAddr / PAGE_DEFAULTSIZE;
+		videoMemEndIndex = (vbeMode->physicalBaseAddr + (vbeMode->xResolution * vbeMode->yResolution * (vbeMode->bitsPerPixel / 8)) - 1) / PAGE_DEFAULTSIZE;
+
+		for (i = videoMemStartIndex; i <= videoMemEndIndex; i++) {
+			pdEntry[i].attrAndLowerBaseAddr |= PAGE_FLAGS_WC;
+		}
+	}
+}
+
+bool k_initPat(void) {
+	if (k_isPatSupported() == false) {
+		return false;
+	}
+
+	// [NOTE] PAT must be same on all cores, so this function is called by BSP and APs before enabling paging.
+	k_writeMsr(PAGE_MSR_PAT, PAGE_PAT_UPPER, PAGE_PAT_LOWER);
+
+	return true;
+}
+
+static bool k_isPatSupported(void) {
+	dword eax, ebx, ecx, edx;
+
+	// check PAT support (CPUID.01h:EDX.PAT[bit 16]).
+	k_readCpuid(0x00000001, &eax, &ebx, &ecx, &edx);
+	if (edx & (1 << 16)) {
+		return true;
+	}
+
+	return false;
 }
 
 void k_setPageTableEntry(PtEntry* entry, dword upperBaseAddr, dword lowerBaseAddr, dword lowerFlags, dword upperFlags) {
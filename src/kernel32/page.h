@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "../kernel64/core/task.h"
+#include "../kernel64/core/vbe.h"
 
 // page table entry fields
 #define PAGE_FLAGS_P   0x00000001 // present: 1: valid, 0: invalid
@@ -19,6 +20,20 @@
 
 // useful macros
 #define PAGE_FLAGS_DEFAULT (PAGE_FLAGS_P | PAGE_FLAGS_RW)
+#define PAGE_FLAGS_WC      PAGE_FLAGS_PAT // write combining: PAT=1, PCD=0, PWT=0 selects PAT entry 4 (PA4) of 2 MB page.
+
+// PAT (page attribute table) memory types
+#define PAGE_PATTYPE_UC      0x00 // uncacheable
+#define PAGE_PATTYPE_WC      0x01 // write combining
+#define PAGE_PATTYPE_WT      0x04 // write through
+#define PAGE_PATTYPE_WP      0x05 // write protected
+#define PAGE_PATTYPE_WB      0x06 // write back
+#define PAGE_PATTYPE_UCMINUS 0x07 // uncached (UC-)
+
+// IA32_PAT MSR (address 0x277, size 64 bits): PA0~PA3 (lower 32 bits) are power-on defaults, and PA4 (upper 32 bits) is changed from WB to WC.
+#define PAGE_MSR_PAT   0x277
+#define PAGE_PAT_LOWER ((PAGE_PATTYPE_UC << 24) | (PAGE_PATTYPE_UCMINUS << 16) | (PAGE_PATTYPE_WT << 8) | PAGE_PATTYPE_WB) // PA3~PA0
+#define PAGE_PAT_UPPER ((PAGE_PATTYPE_UC << 24) | (PAGE_PATTYPE_UCMINUS << 16) | (PAGE_PATTYPE_WT << 8) | PAGE_PATTYPE_WC) // PA7~PA4
 
 // etc macros
 #define PAGE_TABLESIZE     0x1000   // 4 KB
@@ -38,6 +53,8 @@ typedef struct k_PageTableEntry {
 #pragma pack(pop)
 
 void k_initPageTables(void);
+bool k_initPat(void);
+static bool k_isPatSupported(void);
 void k_setPageTableEntry(PtEntry* entry, dword upperBaseAddr, dword lowerBaseAddr, dword lowerFlags, dword upperFlags);
 
 #endif // __PAGE_H__
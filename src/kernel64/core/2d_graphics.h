@@ -17,6 +17,13 @@ typedef word Color;
 #define GETG(rgb)    ((((rgb) & 0x07E0) >> 5) << 2)
 #define GETB(rgb)    (((rgb) & 0x001F) << 3)
 
+// draw command type of display list
+#define DRAWCOMMAND_PIXEL  0
+#define DRAWCOMMAND_LINE   1
+#define DRAWCOMMAND_RECT   2
+#define DRAWCOMMAND_CIRCLE 3
+#define DRAWCOMMAND_TEXT   4
+
 #pragma pack(push, 1)
 
 typedef struct k_Point {
@@ -37,6 +44,29 @@ typedef struct k_Circle {
 	int radius; // radius
 } Circle;
 
+// draw command of display list
+typedef struct k_DrawCommand {
+	byte type;             // draw command type
+	bool fill;             // fill flag (rectangle, circle)
+	Color color;           // color (text color for text)
+	Color backgroundColor; // background color (text)
+	int x1;                // x1: point (pixel, text), start point (line, rectangle), center (circle)
+	int y1;                // y1
+	int x2;                // x2: end point (line, rectangle), radius (circle)
+	int y2;                // y2
+	const char* str;       // string (text): It's not copied, so it must be valid while display list is used.
+	int len;               // string length (text)
+	Rect bound;            // bounding area of command (window coordinates)
+} DrawCommand;
+
+// display list: a command buffer of primitives, which is recorded once and drawn many times.
+typedef struct k_DisplayList {
+	DrawCommand* commands; // draw command buffer (provided by owner)
+	int maxCount;          // max draw command count of command buffer
+	int count;             // recorded draw command count
+	Rect bound;            // bounding area of all commands (window coordinates)
+} DisplayList;
+
 #pragma pack(pop)
 
 /* Color Functions */
@@ -0,0 +1,430 @@
+#include "acpi.h"
+#include "console.h"
+#include "../utils/util.h"
+
+static AcpiManager g_acpiManager = {0, };
+
+bool k_analyzeAcpiTables(void) {
+	Rsdp* rsdp;
+	AcpiHeader* table;
+	int i, j;
+
+	k_memset(&g_acpiManager, 0, sizeof(AcpiManager));
+
+	if (k_findRsdp(&rsdp) == false) {
+		g_acpiManager.nodeCount = 1;
+		g_acpiManager.distances[0][0] = ACPI_DISTANCE_LOCAL;
+		return false;
+	}
+
+	g_acpiManager.found = true;
+	g_acpiManager.revision = rsdp->revision;
+
+	// analyze MADT.
+	table = k_findAcpiTable(rsdp, ACPI_SIGNATURE_MADT);
+	if (table != null) {
+		k_analyzeMadt((MadtHeader*)table);
+	}
+
+	// analyze SRAT.
+	table = k_findAcpiTable(rsdp, ACPI_SIGNATURE_SRAT);
+	if (table != null) {
+		k_analyzeSrat((SratHeader*)table);
+	}
+
+	// If SRAT doesn't exist or has no enabled entry, all processors and memory belong to node 0.
+	if (g_acpiManager.nodeCount == 0) {
+		g_acpiManager.nodeCount = 1;
+		g_acpiManager.domains[0] = 0;
+	}
+
+	// set default distances.
+	for (i = 0; i < g_acpiManager.nodeCount; i++) {
+		for (j = 0; j < g_acpiManager.nodeCount; j++) {
+			g_acpiManager.distances[i][j] = (i == j) ? ACPI_DISTANCE_LOCAL : ACPI_DISTANCE_REMOTE;
+		}
+	}
+
+	// analyze SLIT: It's meaningful only if SRAT exists.
+	if (g_acpiManager.sratFound == true) {
+		table = k_findAcpiTable(rsdp, ACPI_SIGNATURE_SLIT);
+		if (table != null) {
+			k_analyzeSlit((SlitHeader*)table);
+		}
+	}
+
+	return true;
+}
+
+AcpiManager* k_getAcpiManager(void) {
+	return &g_acpiManager;
+}
+
+void k_printAcpiTables(void) {
+	AcpiMemRange* memRange;
+	int i, j;
+
+	k_printf("*** ACPI Table Info ***\n");
+	if (g_acpiManager.found == false) {
+		k_printf("RSDP not found\n");
+		return;
+	}
+
+	k_printf("- ACPI revision            : %d\n", g_acpiManager.revision);
+
+	/* print MADT */
+	k_printf("- MADT                     : %s\n", (g_acpiManager.madtFound == true) ? "found" : "not found");
+	if (g_acpiManager.madtFound == true) {
+		k_printf("  - local APIC address     : 0x%q\n", g_acpiManager.localApicAddr);
+		k_printf("  - processor count        : %d\n", g_acpiManager.processorCount);
+		k_printf("  - local APIC IDs         :");
+		for (i = 0; i < g_acpiManager.processorCount; i++) {
+			k_printf(" %d", g_acpiManager.apicIds[i]);
+		}
+
+		k_printf("\n");
+
+		for (i = 0; i < g_acpiManager.ioApicCount; i++) {
+			k_printf("  - IO APIC (%d)            : address 0x%x, GSI base %d\n", g_acpiManager.ioApics[i].ioApicId, g_acpiManager.ioApics[i].ioApicAddr, g_acpiManager.ioApics[i].gsiBase);
+		}
+
+		for (i = 0; i < g_acpiManager.isOverrideCount; i++) {
+			k_printf("  - IRQ override           : IRQ %d -> GSI %d, flags 0x%x\n", g_acpiManager.isOverrides[i].srcIrq, g_acpiManager.isOverrides[i].gsi, g_acpiManager.isOverrides[i].flags);
+		}
+	}
+
+	/* print SRAT, SLIT */
+	k_printf("- SRAT                     : %s\n", (g_acpiManager.sratFound == true) ? "found" : "not found");
+	k_printf("- SLIT                     : %s\n", (g_acpiManager.slitFound == true) ? "found" : "not found");
+	k_printf("- NUMA node count          : %d\n", g_acpiManager.nodeCount);
+	for (i = 0; i < g_acpiManager.nodeCount; i++) {
+		k_printf("  - node %d (domain %d)      : cores", i, g_acpiManager.domains[i]);
+		for (j = 0; j < g_acpiManager.processorCount; j++) {
+			if (k_getNodeByApicId(g_acpiManager.apicIds[j]) == i) {
+				k_printf(" %d", g_acpiManager.apicIds[j]);
+			}
+		}
+
+		k_printf(", distances");
+		for (j = 0; j < g_acpiManager.nodeCount; j++) {
+			k_printf(" %d", g_acpiManager.distances[i][j]);
+		}
+
+		k_printf("\n");
+	}
+
+	for (i = 0; i < g_acpiManager.memRangeCount; i++) {
+		memRange = &(g_acpiManager.memRanges[i]);
+		k_printf("  - memory range           : 0x%q~0x%q, node %d\n", memRange->startAddr, memRange->endAddr, memRange->node);
+	}
+}
+
+static bool k_findRsdp(Rsdp** rsdp) {
+	qword ebdaAddr;
+	qword addr;
+
+	/* 1. search RSDP: search it in the starting 1KB-sized range of extended BIOS data area */
+	ebdaAddr = ACPI_SEARCH1_EBDA_ADDRESS;
+	if (ebdaAddr != 0) {
+		for (addr = ebdaAddr; addr < (ebdaAddr + 1024); addr += 16) {
+			if ((k_memcmp((void*)addr, ACPI_SIGNATURE_RSDP, 8) == 0) && (k_checkAcpiChecksum((void*)addr, 20) == true)) {
+				*rsdp = (Rsdp*)addr;
+				return true;
+			}
+		}
+	}
+
+	/* 2. search RSDP: search it in BIOS ROM area */
+	for (addr = ACPI_SEARCH2_BIOSROM_STARTADDRESS; addr < ACPI_SEARCH2_BIOSROM_ENDADDRESS; addr += 16) {
+		if ((k_memcmp((void*)addr, ACPI_SIGNATURE_RSDP, 8) == 0) && (k_checkAcpiChecksum((void*)addr, 20) == true)) {
+			*rsdp = (Rsdp*)addr;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static AcpiHeader* k_findAcpiTable(const Rsdp* rsdp, const char* signature) {
+	AcpiHeader* rootTable;
+	AcpiHeader* table;
+	int entryCount;
+	int entrySize;
+	qword entryAddr;
+	int i;
+
+	// use XSDT if it exists (ACPI 2.0+), otherwise use RSDT.
+	if ((rsdp->revision >= 2) && (rsdp->xsdtAddr != 0)) {
+		rootTable = (AcpiHeader*)rsdp->xsdtAddr;
+		entrySize = sizeof(qword);
+
+	} else {
+		rootTable = (AcpiHeader*)((qword)rsdp->rsdtAddr);
+		entrySize = sizeof(dword);
+	}
+
+	if (k_checkAcpiChecksum(rootTable, rootTable->len) == false) {
+		return null;
+	}
+
+	entryCount = (rootTable->len - sizeof(AcpiHeader)) / entrySize;
+	for (i = 0; i < entryCount; i++) {
+		entryAddr = (qword)rootTable + sizeof(AcpiHeader) + (i * entrySize);
+		if (entrySize == sizeof(qword)) {
+			table = (AcpiHeader*)(*(qword*)entryAddr);
+
+		} else {
+			table = (AcpiHeader*)((qword)(*(dword*)entryAddr));
+		}
+
+		if ((table != null) && (k_memcmp(table->signature, signature, 4) == 0) && (k_checkAcpiChecksum(table, table->len) == true)) {
+			return table;
+		}
+	}
+
+	return null;
+}
+
+static bool k_checkAcpiChecksum(const void* table, dword len) {
+	byte sum;
+	dword i;
+
+	// the sum of all bytes (including checksum field) must be 0.
+	sum = 0;
+	for (i = 0; i < len; i++) {
+		sum += ((byte*)table)[i];
+	}
+
+	return (sum == 0);
+}
+
+static void k_analyzeMadt(const MadtHeader* madt) {
+	qword entryAddr;
+	qword endAddr;
+	MadtLocalApic* localApic;
+	byte type;
+	byte len;
+
+	g_acpiManager.madtFound = true;
+	g_acpiManager.localApicAddr = madt->localApicAddr;
+
+	entryAddr = (qword)madt + sizeof(MadtHeader);
+	endAddr = (qword)madt + madt->header.len;
+	while ((entryAddr + 2) <= endAddr) {
+		type = *(byte*)entryAddr;
+		len = *(byte*)(entryAddr + 1);
+		if ((len < 2) || ((entryAddr + len) > endAddr)) {
+			break;
+		}
+
+		switch (type) {
+		case ACPI_MADT_LOCALAPIC:
+			localApic = (MadtLocalApic*)entryAddr;
+			if ((localApic->flags & ACPI_MADT_LOCALAPIC_ENABLED) && (g_acpiManager.processorCount < MAXPROCESSORCOUNT)) {
+				g_acpiManager.apicIds[g_acpiManager.processorCount] = localApic->apicId;
+				g_acpiManager.processorCount++;
+			}
+
+			break;
+
+		case ACPI_MADT_IOAPIC:
+			if (g_acpiManager.ioApicCount < ACPI_MAXIOAPICCOUNT) {
+				k_memcpy(&(g_acpiManager.ioApics[g_acpiManager.ioApicCount]), (void*)entryAddr, sizeof(MadtIoApic));
+				g_acpiManager.ioApicCount++;
+			}
+
+			break;
+
+		case ACPI_MADT_ISOVERRIDE:
+			if (g_acpiManager.isOverrideCount < ACPI_MAXISOVERRIDECOUNT) {
+				k_memcpy(&(g_acpiManager.isOverrides[g_acpiManager.isOverrideCount]), (void*)entryAddr, sizeof(MadtIsOverride));
+				g_acpiManager.isOverrideCount++;
+			}
+
+			break;
+
+		default:
+			break;
+		}
+
+		entryAddr += len;
+	}
+}
+
+static void k_analyzeSrat(const SratHeader* srat) {
+	qword entryAddr;
+	qword endAddr;
+	SratProcessor* processor;
+	SratMemory* memory;
+	SratX2Apic* x2Apic;
+	AcpiMemRange* memRange;
+	dword domain;
+	byte type;
+	byte len;
+
+	g_acpiManager.sratFound = true;
+
+	entryAddr = (qword)srat + sizeof(SratHeader);
+	endAddr = (qword)srat + srat->header.len;
+	while ((entryAddr + 2) <= endAddr) {
+		type = *(byte*)entryAddr;
+		len = *(byte*)(entryAddr + 1);
+		if ((len < 2) || ((entryAddr + len) > endAddr)) {
+			break;
+		}
+
+		switch (type) {
+		case ACPI_SRAT_PROCESSOR:
+			processor = (SratProcessor*)entryAddr;
+			if ((processor->flags & ACPI_SRAT_FLAGS_ENABLED) == 0) {
+				break;
+			}
+
+			domain = processor->domainLow | (processor->domainHigh[0] << 8) | (processor->domainHigh[1] << 16) | (processor->domainHigh[2] << 24);
+			if (processor->apicId < MAXPROCESSORCOUNT) {
+				g_acpiManager.apicIdToNode[processor->apicId] = k_getNodeByDomain(domain);
+			}
+
+			break;
+
+		case ACPI_SRAT_MEMORY:
+			memory = (SratMemory*)entryAddr;
+			if (((memory->flags & ACPI_SRAT_FLAGS_ENABLED) == 0) || (memory->size == 0) || (g_acpiManager.memRangeCount >= ACPI_MAXMEMRANGECOUNT)) {
+				break;
+			}
+
+			memRange = &(g_acpiManager.memRanges[g_acpiManager.memRangeCount]);
+			memRange->startAddr = memory->baseAddr;
+			memRange->endAddr = memory->baseAddr + memory->size;
+			memRange->node = k_getNodeByDomain(memory->domain);
+			g_acpiManager.memRangeCount++;
+			break;
+
+		case ACPI_SRAT_X2APIC:
+			// [NOTE] hOS uses xAPIC mode, so only x2APIC IDs which fit in a local APIC ID are used.
+			x2Apic = (SratX2Apic*)entryAddr;
+			if ((x2Apic->flags & ACPI_SRAT_FLAGS_ENABLED) && (x2Apic->x2ApicId < MAXPROCESSORCOUNT)) {
+				g_acpiManager.apicIdToNode[x2Apic->x2ApicId] = k_getNodeByDomain(x2Apic->domain);
+			}
+
+			break;
+
+		default:
+			break;
+		}
+
+		entryAddr += len;
+	}
+}
+
+static void k_analyzeSlit(const SlitHeader* slit) {
+	const byte* matrix;
+	qword localityCount;
+	dword fromDomain, toDomain;
+	int i, j;
+
+	localityCount = slit->localityCount;
+	if ((sizeof(SlitHeader) + (localityCount * localityCount)) > slit->header.len) {
+		return;
+	}
+
+	g_acpiManager.slitFound = true;
+
+	// distance matrix is indexed by proximity domain, so convert it to NUMA node.
+	matrix = (const byte*)((qword)slit + sizeof(SlitHeader));
+	for (i = 0; i < g_acpiManager.nodeCount; i++) {
+		for (j = 0; j < g_acpiManager.nodeCount; j++) {
+			fromDomain = g_acpiManager.domains[i];
+			toDomain = g_acpiManager.domains[j];
+			if ((fromDomain < localityCount) && (toDomain < localityCount)) {
+				g_acpiManager.distances[i][j] = matrix[(fromDomain * localityCount) + toDomain];
+			}
+		}
+	}
+}
+
+static byte k_getNodeByDomain(dword domain) {
+	int i;
+
+	for (i = 0; i < g_acpiManager.nodeCount; i++) {
+		if (g_acpiManager.domains[i] == domain) {
+			return i;
+		}
+	}
+
+	// If there are too many proximity domains, the rest belong to node 0.
+	if (g_acpiManager.nodeCount >= ACPI_MAXNODECOUNT) {
+		return 0;
+	}
+
+	g_acpiManager.domains[g_acpiManager.nodeCount] = domain;
+	g_acpiManager.nodeCount++;
+
+	return g_acpiManager.nodeCount - 1;
+}
+
+int k_getNodeCount(void) {
+	return g_acpiManager.nodeCount;
+}
+
+byte k_getNodeByApicId(byte apicId) {
+	if (apicId >= MAXPROCESSORCOUNT) {
+		return 0;
+	}
+
+	return g_acpiManager.apicIdToNode[apicId];
+}
+
+byte k_getNodeByAddr(qword addr) {
+	int i;
+
+	for (i = 0; i < g_acpiManager.memRangeCount; i++) {
+		if ((addr >= g_acpiManager.memRanges[i].startAddr) && (addr < g_acpiManager.memRanges[i].endAddr)) {
+			return g_acpiManager.memRanges[i].node;
+		}
+	}
+
+	return 0;
+}
+
+byte k_getCurrentNode(void) {
+	return k_getNodeByApicId(k_getApicId());
+}
+
+byte k_getNodeDistance(byte fromNode, byte toNode) {
+	if ((fromNode >= g_acpiManager.nodeCount) || (toNode >= g_acpiManager.nodeCount)) {
+		return ACPI_DISTANCE_REMOTE;
+	}
+
+	return g_acpiManager.distances[fromNode][toNode];
+}
+
+int k_getNodesByDistance(byte node, byte* nodes) {
+	int count;
+	byte temp;
+	int i, j;
+
+	if (node >= g_acpiManager.nodeCount) {
+		node = 0;
+	}
+
+	// node itself is the first, and the others are sorted by distance from it (insertion sort).
+	nodes[0] = node;
+	count = 1;
+	for (i = 0; i < g_acpiManager.nodeCount; i++) {
+		if (i == node) {
+			continue;
+		}
+
+		nodes[count] = i;
+		for (j = count; (j > 1) && (g_acpiManager.distances[node][nodes[j - 1]] > g_acpiManager.distances[node][nodes[j]]); j--) {
+			temp = nodes[j - 1];
+			nodes[j - 1] = nodes[j];
+			nodes[j] = temp;
+		}
+
+		count++;
+	}
+
+	return count;
+}
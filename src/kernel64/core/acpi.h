@@ -0,0 +1,235 @@
+#ifndef __CORE_ACPI_H__
+#define __CORE_ACPI_H__
+
+#include "types.h"
+#include "multiprocessor.h"
+
+/**
+  < ACPI Tables >
+  - RSDP (Root System Description Pointer) is searched in the first 1 KB of EBDA and BIOS ROM area (0xE0000 ~ 0xFFFFF).
+  - RSDP points to RSDT (32-bit entries) or XSDT (64-bit entries, ACPI 2.0+), which points to the other tables.
+    - MADT (APIC) : local APICs, IO APICs and ISA interrupt source overrides
+    - SRAT (SRAT) : proximity domains of processors (local APIC IDs) and memory ranges
+    - SLIT (SLIT) : relative distances between proximity domains (10 means local.)
+  - Tables are analyzed once before dynamic memory is initialized, and their contents are copied to ACPI manager.
+    [NOTE] Tables can be in the top of RAM, which is handed out by frame memory later, so pointers to them are not kept.
+
+  < NUMA Node >
+  - Proximity domains of SRAT are renumbered to NUMA node IDs (0 ~ ACPI_MAXNODECOUNT-1) in the order of appearance.
+  - If SRAT doesn't exist, all processors and memory belong to node 0.
+  - Processors and memory ranges not described in SRAT belong to node 0.
+  - If SLIT doesn't exist, distance is ACPI_DISTANCE_LOCAL in the same node, and ACPI_DISTANCE_REMOTE between nodes.
+*/
+
+// table signature
+#define ACPI_SIGNATURE_RSDP "RSD PTR "
+#define ACPI_SIGNATURE_RSDT "RSDT"
+#define ACPI_SIGNATURE_XSDT "XSDT"
+#define ACPI_SIGNATURE_MADT "APIC"
+#define ACPI_SIGNATURE_SRAT "SRAT"
+#define ACPI_SIGNATURE_SLIT "SLIT"
+
+// RSDP searching
+#define ACPI_SEARCH1_EBDA_ADDRESS         ((*(word*)0x040E) * 16) // extended BIOS data area address
+#define ACPI_SEARCH2_BIOSROM_STARTADDRESS 0x0E0000                // BIOS ROM area start address
+#define ACPI_SEARCH2_BIOSROM_ENDADDRESS   0x100000                // BIOS ROM area end address
+
+// MADT entry type
+#define ACPI_MADT_LOCALAPIC  0 // processor local APIC
+#define ACPI_MADT_IOAPIC     1 // IO APIC
+#define ACPI_MADT_ISOVERRIDE 2 // interrupt source override
+
+// MADT local APIC flags
+#define ACPI_MADT_LOCALAPIC_ENABLED 0x01
+
+// SRAT entry type
+#define ACPI_SRAT_PROCESSOR 0 // processor local APIC affinity
+#define ACPI_SRAT_MEMORY    1 // memory affinity
+#define ACPI_SRAT_X2APIC    2 // processor local x2APIC affinity
+
+// SRAT affinity flags
+#define ACPI_SRAT_FLAGS_ENABLED 0x01
+
+// max counts
+#define ACPI_MAXNODECOUNT       8  // max NUMA node count
+#define ACPI_MAXMEMRANGECOUNT   16 // max memory range count of SRAT
+#define ACPI_MAXIOAPICCOUNT     8  // max IO APIC count of MADT
+#define ACPI_MAXISOVERRIDECOUNT 16 // max interrupt source override count of MADT
+
+// distance
+#define ACPI_DISTANCE_LOCAL  10
+#define ACPI_DISTANCE_REMOTE 20
+
+// invalid NUMA node
+#define ACPI_INVALIDNODE 0xFF
+
+#pragma pack(push, 1)
+
+// RSDP (36 bytes: 20 bytes in ACPI 1.0)
+typedef struct k_Rsdp {
+	char signature[8];   // signature (RSD PTR )
+	byte checksum;       // checksum of the first 20 bytes
+	char oemId[6];       // OEM ID
+	byte revision;       // revision (0: ACPI 1.0, 2: ACPI 2.0+)
+	dword rsdtAddr;      // RSDT address
+	dword len;           // RSDP length (ACPI 2.0+)
+	qword xsdtAddr;      // XSDT address (ACPI 2.0+)
+	byte extChecksum;    // checksum of the whole RSDP (ACPI 2.0+)
+	byte reserved[3];    // reserved area
+} Rsdp;
+
+// system description table header (36 bytes)
+typedef struct k_AcpiHeader {
+	char signature[4];     // signature
+	dword len;             // table length including header
+	byte revision;         // revision
+	byte checksum;         // checksum of the whole table
+	char oemId[6];         // OEM ID
+	char oemTableId[8];    // OEM table ID
+	dword oemRevision;     // OEM revision
+	dword creatorId;       // creator ID
+	dword creatorRevision; // creator revision
+} AcpiHeader;
+
+// MADT header (44 bytes)
+typedef struct k_MadtHeader {
+	AcpiHeader header;   // table header
+	dword localApicAddr; // memory map IO address of local APIC
+	dword flags;         // flags (bit 0: PC-AT compatible dual PIC)
+} MadtHeader;
+
+// MADT entry - processor local APIC (8 bytes)
+typedef struct k_MadtLocalApic {
+	byte type;           // entry type (0)
+	byte len;            // entry length (8)
+	byte processorId;    // ACPI processor ID
+	byte apicId;         // local APIC ID
+	dword flags;         // flags (bit 0: enabled)
+} MadtLocalApic;
+
+// MADT entry - IO APIC (12 bytes)
+typedef struct k_MadtIoApic {
+	byte type;           // entry type (1)
+	byte len;            // entry length (12)
+	byte ioApicId;       // IO APIC ID
+	byte reserved;       // reserved area
+	dword ioApicAddr;    // memory map IO address of IO APIC
+	dword gsiBase;       // global system interrupt base
+} MadtIoApic;
+
+// MADT entry - interrupt source override (10 bytes)
+typedef struct k_MadtIsOverride {
+	byte type;           // entry type (2)
+	byte len;            // entry length (10)
+	byte bus;            // bus (0: ISA)
+	byte srcIrq;         // source IRQ
+	dword gsi;           // global system interrupt
+	word flags;          // MPS INTI flags (polarity, trigger mode)
+} MadtIsOverride;
+
+// SRAT header (48 bytes)
+typedef struct k_SratHeader {
+	AcpiHeader header;   // table header
+	dword reserved1;     // reserved area (must be 1)
+	qword reserved2;     // reserved area
+} SratHeader;
+
+// SRAT entry - processor local APIC affinity (16 bytes)
+typedef struct k_SratProcessor {
+	byte type;           // entry type (0)
+	byte len;            // entry length (16)
+	byte domainLow;      // proximity domain (bit 0~7)
+	byte apicId;         // local APIC ID
+	dword flags;         // flags (bit 0: enabled)
+	byte sapicEid;       // local SAPIC EID
+	byte domainHigh[3];  // proximity domain (bit 8~31)
+	dword clockDomain;   // clock domain
+} SratProcessor;
+
+// SRAT entry - memory affinity (40 bytes)
+typedef struct k_SratMemory {
+	byte type;           // entry type (1)
+	byte len;            // entry length (40)
+	dword domain;        // proximity domain
+	word reserved1;      // reserved area
+	qword baseAddr;      // base address
+	qword size;          // length
+	dword reserved2;     // reserved area
+	dword flags;         // flags (bit 0: enabled, bit 1: hot-pluggable, bit 2: non-volatile)
+	qword reserved3;     // reserved area
+} SratMemory;
+
+// SRAT entry - processor local x2APIC affinity (24 bytes)
+typedef struct k_SratX2Apic {
+	byte type;           // entry type (2)
+	byte len;            // entry length (24)
+	word reserved1;      // reserved area
+	dword domain;        // proximity domain
+	dword x2ApicId;      // local x2APIC ID
+	dword flags;         // flags (bit 0: enabled)
+	dword clockDomain;   // clock domain
+	dword reserved2;     // reserved area
+} SratX2Apic;
+
+// SLIT header (44 bytes): distance matrix (localityCount * localityCount bytes) follows it.
+typedef struct k_SlitHeader {
+	AcpiHeader header;   // table header
+	qword localityCount; // system locality (proximity domain) count
+} SlitHeader;
+
+// memory range of NUMA node
+typedef struct k_AcpiMemRange {
+	qword startAddr;     // start address
+	qword endAddr;       // end address
+	byte node;           // NUMA node ID
+} AcpiMemRange;
+
+// ACPI manager
+typedef struct k_AcpiManager {
+	bool found;                                           // RSDP found flag
+	byte revision;                                        // ACPI revision of RSDP
+
+	// MADT
+	bool madtFound;                                       // MADT found flag
+	qword localApicAddr;                                  // memory map IO address of local APIC
+	int processorCount;                                   // enabled processor count
+	byte apicIds[MAXPROCESSORCOUNT];                      // local APIC IDs of enabled processors
+	int ioApicCount;                                      // IO APIC count
+	MadtIoApic ioApics[ACPI_MAXIOAPICCOUNT];              // IO APICs
+	int isOverrideCount;                                  // interrupt source override count
+	MadtIsOverride isOverrides[ACPI_MAXISOVERRIDECOUNT];  // interrupt source overrides
+
+	// SRAT, SLIT
+	bool sratFound;                                       // SRAT found flag
+	bool slitFound;                                       // SLIT found flag
+	int nodeCount;                                        // NUMA node count (at least 1)
+	dword domains[ACPI_MAXNODECOUNT];                     // proximity domains of NUMA nodes
+	byte apicIdToNode[MAXPROCESSORCOUNT];                 // NUMA nodes of local APIC IDs
+	int memRangeCount;                                    // memory range count
+	AcpiMemRange memRanges[ACPI_MAXMEMRANGECOUNT];        // memory ranges of NUMA nodes
+	byte distances[ACPI_MAXNODECOUNT][ACPI_MAXNODECOUNT]; // distances between NUMA nodes
+} AcpiManager;
+
+#pragma pack(pop)
+
+/* ACPI Table Functions */
+bool k_analyzeAcpiTables(void);
+AcpiManager* k_getAcpiManager(void);
+void k_printAcpiTables(void);
+static bool k_findRsdp(Rsdp** rsdp);
+static AcpiHeader* k_findAcpiTable(const Rsdp* rsdp, const char* signature);
+static bool k_checkAcpiChecksum(const void* table, dword len);
+static void k_analyzeMadt(const MadtHeader* madt);
+static void k_analyzeSrat(const SratHeader* srat);
+static void k_analyzeSlit(const SlitHeader* slit);
+static byte k_getNodeByDomain(dword domain); // get NUMA node of proximity domain, and add new node if it's not found.
+
+/* NUMA Functions */
+int k_getNodeCount(void);
+byte k_getNodeByApicId(byte apicId);
+byte k_getNodeByAddr(qword addr);
+byte k_getCurrentNode(void); // get NUMA node of current core.
+byte k_getNodeDistance(byte fromNode, byte toNode);
+int k_getNodesByDistance(byte node, byte* nodes); // get all nodes sorted by distance from node (node itself is the first).
+
+#endif // __CORE_ACPI_H__
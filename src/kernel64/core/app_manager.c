@@ -4,36 +4,26 @@
 #include "dynamic_mem.h"
 #include "../utils/util.h"
 #include "../gui_tasks/app_panel.h"
+#include "virtual_mem.h"
 
 qword k_executeApp(const char* fileName, const char* args, byte affinity) {
 	dword fileSize;
-	Dir* dir;
-	dirent* entry;
+	dirent entry;
 	byte* fileBuffer;
 	File* file;
 	qword appMemAddr;
 	qword appMemSize;
 	qword entryPointAddr;
+	qword stackPointer;
+	AddressSpace* addressSpace;
 	Task* task;
 
 	/* get file size */
 	fileSize = 0;
-	dir = opendir("/");
-	
-	while (true) {
-		entry = readdir(dir);
-		if (entry == null) {
-			break;
-		}
-
-		if (k_equalStr(entry->d_name, fileName) == true) {
-			fileSize = entry->d_size;
-			break;
-		}
+	if ((stat(fileName, &entry) == 0) && (entry.d_attr == FS_ATTRIBUTE_FILE)) {
+		fileSize = entry.d_size;
 	}
 
-	closedir(dir);
-
 	if (fileSize == 0) {
 		k_printf("app manager error: %s does not exist or is zero-sized.\n", fileName);
 		return TASK_INVALIDID;
@@ -62,33 +52,62 @@ qword k_executeApp(const char* fileName, const char* args, byte affinity) {
 
 	fclose(file);
 
+	/* create address space */
+	addressSpace = k_createAddressSpace();
+	if (addressSpace == null) {
+		k_printf("app manager error: address space creation failure\n");
+		k_freeMem(fileBuffer);
+		return TASK_INVALIDID;
+	}
+
 	/* load and relocate sections */
-	if (k_loadSections(fileBuffer, &appMemAddr, &appMemSize, &entryPointAddr) == false) {
+	if (k_loadSections(fileBuffer, fileSize, addressSpace, &appMemAddr, &appMemSize, &entryPointAddr) == false) {
 		k_printf("app manager error: sections loading or relocation failure\n");
+		k_deleteAddressSpace(addressSpace);
 		k_freeMem(fileBuffer);
 		return TASK_INVALIDID;
 	}
 
-	k_freeMem(fileBuffer);
+	// file buffer becomes app image of address space, because pages are filled from it lazily.
+	addressSpace->image = fileBuffer;
+
+	/* add stack region, and push argument string to stack */
+	if (k_addVirtualRegion(addressSpace, VMEM_USERSTACKSTARTADDRESS, VMEM_USERSTACKSIZE, null, 0) == false) {
+		k_printf("app manager error: stack region adding failure\n");
+		k_deleteAddressSpace(addressSpace);
+		return TASK_INVALIDID;
+	}
+
+	stackPointer = k_pushArgsToStack(addressSpace, args);
+	if (stackPointer == 0) {
+		k_printf("app manager error: argument string pushing failure\n");
+		k_deleteAddressSpace(addressSpace);
+		return TASK_INVALIDID;
+	}
 
 	#if __DEBUG__
 	k_printf("app manager debug: execute '%s' with args: '%s'\n", fileName, args);
 	#endif // __DEBUG__
 
-	/* create task and add argument string to task */
-	task = k_createTask(TASK_FLAGS_PROCESS | TASK_FLAGS_USER, (void*)appMemAddr, appMemSize, entryPointAddr, 0, affinity);
+	/* create task in address space: argument string address is passed as the first argument (RDI). */
+	task = k_createTaskInAddressSpace(TASK_FLAGS_PROCESS | TASK_FLAGS_USER, addressSpace, (void*)appMemAddr, appMemSize, entryPointAddr, stackPointer, stackPointer, affinity);
 	if (task == null) {
 		k_printf("app manager error: task creation failure\n");
-		k_freeMem((void*)appMemAddr);
+		k_deleteAddressSpace(addressSpace);
 		return TASK_INVALIDID;
 	}
 
-	k_addArgsToTask(task, args);
-
 	return task->link.id;
 }
 
-static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* appMemSize, qword* entryPointAddr) {
+/**
+  < Section Loading with Demand Paging >
+  - Sections are placed at user space start address <0x8000000000 (512 GB)> of address space.
+  - Relocation is applied to sections in file buffer, not to memory,
+    and each section is added to address space as a virtual region which is filled from file buffer when touched first.
+  - So, loading only costs relocation, and BSS costs nothing until used.
+*/
+static bool k_loadSections(byte* fileBuffer, qword fileSize, AddressSpace* addressSpace, qword* appMemAddr, qword* appMemSize, qword* entryPointAddr) {
 	Elf64_Ehdr* eh;           // ELF header
 	Elf64_Shdr* sh;           // section header
 	//Elf64_Shdr* shstr_sh;     // section name table section header
@@ -96,7 +115,7 @@ static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* app
 	Elf64_Xword last_sh_size; // last section size
 	int i;
 	qword memSize; // application memory size
-	byte* memAddr; // application memory address
+	qword memAddr; // application memory address (user virtual address)
 
 	/* analyze ELF header */
 	eh = (Elf64_Ehdr*)fileBuffer;
@@ -139,9 +158,9 @@ static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* app
 
 	memSize = (last_sh_addr + last_sh_size + 0x1000 - 1) & 0xFFFFFFFFFFFFF000; // aligned with 0x1000 (4 KB)
 	
-	memAddr = (byte*)k_allocMem(memSize);
-	if (memAddr == null) {
-		k_printf("app manager error: application memory allocation failure\n");
+	memAddr = VMEM_USERSPACESTARTADDRESS;
+	if (memSize > (VMEM_USERSTACKSTARTADDRESS - memAddr)) {
+		k_printf("app manager error: application is too big\n");
 		return false;
 	}
 
@@ -161,11 +180,23 @@ static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* app
 
 		sh[i].sh_addr += (Elf64_Addr)memAddr;
 
+		// add section as a virtual region: BSS is zero-filled, and the others are filled from file buffer.
 		if (sh[i].sh_type == SHT_NOBITS) {
-			k_memset((void*)sh[i].sh_addr, 0, sh[i].sh_size);
+			if (k_addVirtualRegion(addressSpace, sh[i].sh_addr, sh[i].sh_size, null, 0) == false) {
+				k_printf("app manager error: section %d region adding failure\n", i);
+				return false;
+			}
 
 		} else {
-			k_memcpy((void*)sh[i].sh_addr, fileBuffer + sh[i].sh_offset, sh[i].sh_size);
+			if ((sh[i].sh_offset > fileSize) || (sh[i].sh_size > (fileSize - sh[i].sh_offset))) {
+				k_printf("app manager error: section %d is out of file\n", i);
+				return false;
+			}
+
+			if (k_addVirtualRegion(addressSpace, sh[i].sh_addr, sh[i].sh_size, fileBuffer + sh[i].sh_offset, sh[i].sh_size) == false) {
+				k_printf("app manager error: section %d region adding failure\n", i);
+				return false;
+			}
 		}
 
 		//k_printf("app manager info: section %d loading: from file 0x%q to memory 0x%q, size 0x%q\n", i, sh[i].sh_offset, sh[i].sh_addr, sh[i].sh_size);
@@ -176,21 +207,20 @@ static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* app
 	/* relocate sections */
 	if (k_relocateSections(fileBuffer) == false) {
 		k_printf("app manager error: sections relocation failure\n");
-		k_freeMem(memAddr);	
 		return false;
 	}
 
 	//k_printf("app manager info: sections relocation success\n");
 
 	/* copy results */
-	*appMemAddr = (qword)memAddr;
+	*appMemAddr = memAddr;
 	*appMemSize = memSize;
-	*entryPointAddr = (qword)memAddr + eh->e_entry;
+	*entryPointAddr = memAddr + eh->e_entry;
 
 	return true;
 }
 
-static bool k_relocateSections(const byte* fileBuffer) {
+static bool k_relocateSections(byte* fileBuffer) {
 	Elf64_Ehdr* eh;        // ELF header
 	Elf64_Shdr* sh;        // section header
 	int i;                 // relocation section header index
@@ -206,6 +236,7 @@ static bool k_relocateSections(const byte* fileBuffer) {
 	Elf64_Sym* sym;        // symbol table entry
 	Elf64_Rel* rel;        // relocation entry
 	Elf64_Rela* rela;      // relocation-addend entry
+	byte* torel;           // to-relocate section in file buffer
 	
 	eh = (Elf64_Ehdr*)fileBuffer;
 	sh = (Elf64_Shdr*)(fileBuffer + eh->e_shoff);
@@ -219,6 +250,13 @@ static bool k_relocateSections(const byte* fileBuffer) {
 		sym_shndx = sh[i].sh_link;
 		torel_shndx = sh[i].sh_info;
 
+		// relocate only loaded sections, because relocation is applied to file buffer which pages are filled from.
+		if (((sh[torel_shndx].sh_flags & SHF_ALLOC) != SHF_ALLOC) || (sh[torel_shndx].sh_type == SHT_NOBITS)) {
+			continue;
+		}
+
+		torel = fileBuffer + sh[torel_shndx].sh_offset;
+
 		// get first symbol table entry.
 		sym = (Elf64_Sym*)(fileBuffer + sh[sym_shndx].sh_offset);
 
@@ -325,22 +363,34 @@ static bool k_relocateSections(const byte* fileBuffer) {
 				return false;
 			}
 
-			/* apply relocation value and size to to-relocate section */
+			if ((r_offset > sh[torel_shndx].sh_size) || (r_size > (sh[torel_shndx].sh_size - r_offset))) {
+				k_printf("app manager error: relocation offset is out of section: 0x%q\n", r_offset);
+				return false;
+			}
+
+			// user space is above 4 GB, so 32 bits-sized absolute address can't be relocated. (Build apps with -mcmodel=large.)
+			if (((REL_TYPE(r_info) == R_X86_64_32) && (((qword)r_value >> 32) != 0)) ||
+				((REL_TYPE(r_info) == R_X86_64_32S) && ((r_value < -0x80000000LL) || (r_value > 0x7FFFFFFFLL)))) {
+				k_printf("app manager error: 32 bits relocation overflow: type %d\n", REL_TYPE(r_info));
+				return false;
+			}
+
+			/* apply relocation value and size to to-relocate section in file buffer */
 			switch (r_size) {
 			case 8:
-				*(Elf64_Sxword*)(sh[torel_shndx].sh_addr + r_offset) += r_value;
+				*(Elf64_Sxword*)(torel + r_offset) += r_value;
 				break;
 
 			case 4:
-				*(int*)(sh[torel_shndx].sh_addr + r_offset) += (int)r_value;
+				*(int*)(torel + r_offset) += (int)r_value;
 				break;
 
 			case 2:
-				*(short*)(sh[torel_shndx].sh_addr + r_offset) += (short)r_value;
+				*(short*)(torel + r_offset) += (short)r_value;
 				break;
 
 			case 1:
-				*(char*)(sh[torel_shndx].sh_addr + r_offset) += (char)r_value;
+				*(char*)(torel + r_offset) += (char)r_value;
 				break;
 
 			default:
@@ -353,10 +403,11 @@ static bool k_relocateSections(const byte* fileBuffer) {
 	return true;
 }
 
-static void k_addArgsToTask(Task* task, const char* args) {
+static qword k_pushArgsToStack(AddressSpace* addressSpace, const char* args) {
 	int len;
 	int alignedLen;
 	qword rsp; // new RSP address
+	char null_ = '\0';
 
 	if (args == null) {
 		len = 0;
@@ -368,15 +419,20 @@ static void k_addArgsToTask(Task* task, const char* args) {
 		}
 	}
 
-	alignedLen = (len + 7) & 0xFFFFFFF8; // aligned with stack size (8 bytes).
+	alignedLen = (len + 1 + 7) & 0xFFFFFFF8; // aligned with stack size (8 bytes), including null character.
+
+	// push argument string under the return address area (8 bytes) of stack end.
+	// stack is not mapped in current address space, so copy it through address space.
+	rsp = VMEM_USERSPACEENDADDRESS - 8 - (qword)alignedLen;
+	if ((len > 0) && (k_copyToAddressSpace(addressSpace, rsp, args, len) == false)) {
+		return 0;
+	}
 
-	rsp = task->context.registers[TASK_INDEX_RSP] - (qword)alignedLen;
-	k_memcpy((void*)rsp, args, len);
-	*((byte*)rsp + len) = '\0';
+	if (k_copyToAddressSpace(addressSpace, rsp + len, &null_, 1) == false) {
+		return 0;
+	}
 
-	task->context.registers[TASK_INDEX_RSP] = rsp;
-	task->context.registers[TASK_INDEX_RBP] = rsp;
-	task->context.registers[TASK_INDEX_RDI] = rsp; // RDI (first argument)
+	return rsp;
 }
 
 bool k_installApp(const char* fileName) {	
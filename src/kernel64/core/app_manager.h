@@ -4,14 +4,15 @@
 #include "types.h"
 #include "../utils/elf64.h"
 #include "task.h"
+#include "virtual_mem.h"
 
 // max argument string length
 #define APPMGR_MAXARGSLENGTH 1023
 
 qword k_executeApp(const char* fileName, const char* args, byte affinity);
-static bool k_loadSections(const byte* fileBuffer, qword* appMemAddr, qword* appMemSize, qword* entryPointAddr);
-static bool k_relocateSections(const byte* fileBuffer);
-static void k_addArgsToTask(Task* task, const char* args);
+static bool k_loadSections(byte* fileBuffer, qword fileSize, AddressSpace* addressSpace, qword* appMemAddr, qword* appMemSize, qword* entryPointAddr);
+static bool k_relocateSections(byte* fileBuffer);
+static qword k_pushArgsToStack(AddressSpace* addressSpace, const char* args); // push argument string to stack, and return new RSP (0 if failure).
 bool k_installApp(const char* fileName);
 bool k_uninstallApp(const char* fileName);
 
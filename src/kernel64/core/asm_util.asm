@@ -2,7 +2,7 @@
 
 SECTION .text
 
-global k_inPortByte, k_outPortByte, k_inPortWord, k_outPortWord
+global k_inPortByte, k_outPortByte, k_inPortWord, k_outPortWord, k_inPortDword, k_outPortDword
 global k_loadGdt, k_loadTss, k_loadIdt
 global k_enableInterrupt, k_disableInterrupt, k_readRflags
 global k_readTsc
@@ -10,8 +10,11 @@ global k_switchContext
 global k_halt, k_pause
 global k_testAndSet
 global k_initFpu, k_saveFpuContext, k_loadFpuContext, k_setTs, k_clearTs
+global k_xsave, k_xsaveopt, k_xrstor, k_writeXcr0
 global k_enableGlobalLocalApic
 global k_readMsr, k_writeMsr
+global k_readCr2, k_readCr3, k_writeCr3, k_invalidatePage
+global k_readCr4, k_writeCr4, k_readCpuid
 
 ; ====================================================================================================
 ; < Calling Convention - from C to assembly, IA-32e mode >
@@ -95,6 +98,34 @@ k_outPortWord:
 	pop rdx
 	ret
 
+; - param  : word port (RDI)
+; - return : dword data (RAX)
+k_inPortDword:
+	push rdx
+	
+	mov rdx, rdi ; port
+	mov rax, 0   ; data (initialization)
+	; read data (4 bytes) from a port number saved in DX, save it to EAX (EAX will be used as a return value.)
+	in eax, dx
+	
+	pop rdx
+	ret
+
+; - param  : word port (RDI), dword data (RSI)
+; - return : void
+k_outPortDword:
+	push rdx
+	push rax
+	
+	mov rdx, rdi ; port
+	mov rax, rsi ; data
+    ; write data (4 bytes) saved in EAX to a port number saved in DX.
+	out dx, eax
+	
+	pop rax
+	pop rdx
+	ret
+
 ; - param  : qword gdtrAddr (RDI)
 ; - return : void
 k_loadGdt:
@@ -202,7 +233,7 @@ k_readTsc:
 	pop rbp
 %endmacro
 
-; - param  : Context* currentContext (RDI), Context* nextContext (RSI)
+; - param  : Context* currentContext (RDI), Context* nextContext (RSI), qword nextCr3 (RDX)
 ; - return : void
 k_switchContext:
 	push rbp
@@ -250,6 +281,17 @@ k_switchContext:
 .loadContext:
 	mov rsp, rsi
 	
+	; switch address space (CR3) of a next task after RSP has moved to Context structure (nextContext),
+	; because the stack of a current task might be in user space which is not mapped in the next address space.
+	; If nextCr3 == 0 or nextCr3 == current CR3, don't switch it in order not to flush TLB.
+	cmp rdx, 0
+	je .loadRegisters
+	mov rax, cr3
+	cmp rax, rdx
+	je .loadRegisters
+	mov cr3, rdx
+	
+.loadRegisters:
 	; restore 19 registers from Context structure (nextContext).
 	KLOADCONTEXT
 	
@@ -313,6 +355,74 @@ k_loadFpuContext:
 	fxrstor [rdi] ; restore FPU register (512 bytes) from fpuContext.
 	ret
 
+; - param  : void* fpuContext (RDI), qword mask (RSI)
+; - return : void
+k_xsave:
+	push rax
+	push rdx
+
+	; set state-component bitmap (mask) to EDX:EAX.
+	mov rax, rsi
+	mov rdx, rsi
+	shr rdx, 32
+
+	xsave [rdi] ; save state components selected by mask to fpuContext (XSAVE area, 64 bytes-aligned).
+
+	pop rdx
+	pop rax
+	ret
+
+; - param  : void* fpuContext (RDI), qword mask (RSI)
+; - return : void
+k_xsaveopt:
+	push rax
+	push rdx
+
+	mov rax, rsi
+	mov rdx, rsi
+	shr rdx, 32
+
+	xsaveopt [rdi] ; save only state components modified since the last XRSTOR from fpuContext.
+
+	pop rdx
+	pop rax
+	ret
+
+; - param  : void* fpuContext (RDI), qword mask (RSI)
+; - return : void
+k_xrstor:
+	push rax
+	push rdx
+
+	mov rax, rsi
+	mov rdx, rsi
+	shr rdx, 32
+
+	xrstor [rdi] ; restore state components selected by mask from fpuContext.
+
+	pop rdx
+	pop rax
+	ret
+
+; - param  : qword value (RDI)
+; - return : void
+k_writeXcr0:
+	push rax
+	push rcx
+	push rdx
+
+	; XCR0 (XFEATURE_ENABLED_MASK): state components enabled for XSAVE
+	mov rcx, 0
+	mov rax, rdi
+	mov rdx, rdi
+	shr rdx, 32
+	xsetbv
+
+	pop rdx
+	pop rcx
+	pop rax
+	ret
+
 ; - param  : void
 ; - return : void
 k_setTs:
@@ -396,3 +506,69 @@ k_writeMsr:
 	pop rdx
 	pop rcx
 	ret
+
+; - param  : void
+; - return : qword pageFaultAddr (RAX)
+k_readCr2:
+	mov rax, cr2
+	ret
+
+; - param  : void
+; - return : qword pml4Addr (RAX)
+k_readCr3:
+	mov rax, cr3
+	ret
+
+; - param  : qword pml4Addr (RDI)
+; - return : void
+k_writeCr3:
+	mov cr3, rdi
+	ret
+
+; - param  : qword virtualAddr (RDI)
+; - return : void
+k_invalidatePage:
+	invlpg [rdi] ; invalidate TLB entry of the page which contains virtualAddr.
+	ret
+
+; - param  : void
+; - return : qword cr4 (RAX)
+k_readCr4:
+	mov rax, cr4
+	ret
+
+; - param  : qword cr4 (RDI)
+; - return : void
+k_writeCr4:
+	mov cr4, rdi
+	ret
+
+; - param  : dword eax_ (RDI), dword ecx_ (RSI), dword* eax (RDX), dword* ebx (RCX), dword* ecx (R8), dword* edx (R9)
+; - return : void
+k_readCpuid:
+	push rax
+	push rbx
+	push rcx
+	push rdx
+	push r10
+	push r11
+
+	mov r10, rdx ; back up eax (RDX) to R10.
+	mov r11, rcx ; back up ebx (RCX) to R11.
+
+	mov eax, edi
+	mov ecx, esi
+	cpuid
+
+	mov dword [r10], eax
+	mov dword [r11], ebx
+	mov dword [r8], ecx
+	mov dword [r9], edx
+
+	pop r11
+	pop r10
+	pop rdx
+	pop rcx
+	pop rbx
+	pop rax
+	ret
@@ -8,6 +8,8 @@ byte k_inPortByte(word port);
 void k_outPortByte(word port, byte data);
 word k_inPortWord(word port);
 void k_outPortWord(word port, word data);
+dword k_inPortDword(word port);
+void k_outPortDword(word port, dword data);
 void k_loadGdt(qword gdtrAddr);
 void k_loadTss(word tssOffset);
 void k_loadIdt(qword idtrAddr);
@@ -15,7 +17,7 @@ void k_enableInterrupt(void);
 void k_disableInterrupt(void);
 qword k_readRflags(void);
 qword k_readTsc(void);
-void k_switchContext(Context* currentContext, Context* nextContext);
+void k_switchContext(Context* currentContext, Context* nextContext, qword nextCr3);
 void k_halt(void);
 void k_pause(void);
 bool k_testAndSet(volatile byte* dest, byte cmp, byte src);
@@ -24,8 +26,19 @@ void k_saveFpuContext(void* fpuContext);
 void k_loadFpuContext(void* fpuContext);
 void k_setTs(void);
 void k_clearTs(void);
+void k_xsave(void* fpuContext, qword mask);
+void k_xsaveopt(void* fpuContext, qword mask);
+void k_xrstor(void* fpuContext, qword mask);
+void k_writeXcr0(qword value);
 void k_enableGlobalLocalApic(void);
 void k_readMsr(qword addr, qword* high32bits, qword* low32bits);
 void k_writeMsr(qword addr, qword high32bits, qword low32bits);
+qword k_readCr2(void);
+qword k_readCr3(void);
+void k_writeCr3(qword pml4Addr);
+void k_invalidatePage(qword virtualAddr);
+qword k_readCr4(void);
+void k_writeCr4(qword cr4);
+void k_readCpuid(dword eax_, dword ecx_, dword* eax, dword* ebx, dword* ecx, dword* edx);
 
 #endif // __CORE_ASMUTIL_H__
@@ -0,0 +1,115 @@
+#include "boot_profile.h"
+#include "asm_util.h"
+#include "pit.h"
+#include "console.h"
+#include "serial_port.h"
+#include "../utils/util.h"
+
+static qword g_tscPerMs = 0;
+
+// [NOTE] k_initBootProfile is called by kernel32 only, so kernel64 doesn't implement it.
+
+void k_addBootPhase(const char* name) {
+	BootProfile* profile = (BootProfile*)BOOTPROFILE_ADDRESS;
+	BootPhase* phase;
+	qword tsc;
+	int len;
+	
+	// If kernel32 hasn't initialized boot profile, or it's full, ignore phase.
+	if ((profile->signature != BOOTPROFILE_SIGNATURE) || (profile->phaseCount >= BOOTPROFILE_MAXPHASECOUNT)) {
+		return;
+	}
+	
+	tsc = k_readTsc();
+	phase = &profile->phases[profile->phaseCount];
+	phase->lowTsc = (dword)tsc;
+	phase->highTsc = (dword)(tsc >> 32);
+	
+	len = k_strlen(name);
+	if (len > BOOTPROFILE_MAXNAMELENGTH - 1) {
+		len = BOOTPROFILE_MAXNAMELENGTH - 1;
+	}
+	
+	k_memcpy(phase->name, name, len);
+	phase->name[len] = '\0';
+	profile->phaseCount++;
+}
+
+void k_printBootProfile(void) {
+	BootProfile* profile = (BootProfile*)BOOTPROFILE_ADDRESS;
+	qword tscPerMs;
+	qword prevTsc = 0;
+	qword tsc;
+	int i;
+	
+	if (profile->signature != BOOTPROFILE_SIGNATURE) {
+		k_printf("boot profile error: no boot profile\n");
+		return;
+	}
+	
+	tscPerMs = k_getTscPerMs();
+	
+	k_printf("boot profile: %d phases, %l TSC/ms\n", profile->phaseCount, tscPerMs);
+	for (i = 0; i < profile->phaseCount; i++) {
+		tsc = k_getPhaseTsc(&profile->phases[i]);
+		k_printf("  %d) %s: %l us (at %l ms)\n", i, profile->phases[i].name, (tsc - prevTsc) * 1000 / tscPerMs, tsc / tscPerMs);
+		prevTsc = tsc;
+	}
+}
+
+void k_sendBootProfileToSerial(void) {
+	BootProfile* profile = (BootProfile*)BOOTPROFILE_ADDRESS;
+	char buffer[100];
+	qword tscPerMs;
+	qword prevTsc = 0;
+	qword tsc;
+	int len;
+	int i;
+	
+	if (profile->signature != BOOTPROFILE_SIGNATURE) {
+		return;
+	}
+	
+	tscPerMs = k_getTscPerMs();
+	
+	// send boot profile as CSV lines: index,name,duration (us),end time (ms)
+	len = k_sprintf(buffer, "boot profile,%d phases,%l TSC/ms\r\n", profile->phaseCount, tscPerMs);
+	k_sendSerialData((byte*)buffer, len);
+	
+	for (i = 0; i < profile->phaseCount; i++) {
+		tsc = k_getPhaseTsc(&profile->phases[i]);
+		len = k_sprintf(buffer, "%d,%s,%l,%l\r\n", i, profile->phases[i].name, (tsc - prevTsc) * 1000 / tscPerMs, tsc / tscPerMs);
+		k_sendSerialData((byte*)buffer, len);
+		prevTsc = tsc;
+	}
+}
+
+static qword k_getPhaseTsc(const BootPhase* phase) {
+	return ((qword)phase->highTsc << 32) | (qword)phase->lowTsc;
+}
+
+static qword k_getTscPerMs(void) {
+	qword startTickCount;
+	qword startTsc;
+	
+	// calibrate TSC using tick count (1 ms-level) of PIT once.
+	if (g_tscPerMs == 0) {
+		startTickCount = k_getTickCount();
+		while (k_getTickCount() == startTickCount) {
+			;
+		}
+		
+		startTickCount = k_getTickCount();
+		startTsc = k_readTsc();
+		while (k_getTickCount() - startTickCount < BOOTPROFILE_CALIBRATIONMS) {
+			;
+		}
+		
+		g_tscPerMs = (k_readTsc() - startTsc) / BOOTPROFILE_CALIBRATIONMS;
+		if (g_tscPerMs == 0) {
+			g_tscPerMs = 1;
+		}
+	}
+	
+	return g_tscPerMs;
+}
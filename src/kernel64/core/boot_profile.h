@@ -0,0 +1,45 @@
+#ifndef __CORE_BOOTPROFILE_H__
+#define __CORE_BOOTPROFILE_H__
+
+#include "types.h"
+
+/**
+  < Boot Profile >
+  - Boot profile is a table of TSC-stamped boot phases, which is filled from kernel32 to the first GUI frame.
+  - The table is located at the fixed address <0x5000>, because kernel32 and kernel64 share it.
+  - A phase records TSC at the end of the phase, so the duration of a phase is (its TSC - TSC of the previous phase).
+  - kernel32 is 32 bits, so TSC is saved as two dwords, in order that both kernels have the same table layout.
+*/
+
+// boot profile
+#define BOOTPROFILE_ADDRESS       0x5000     // boot profile address: It's free conventional memory under boot-loader address <0x7C00>.
+#define BOOTPROFILE_SIGNATURE     0x544F4F42 // boot profile signature: "BOOT" (little endian)
+#define BOOTPROFILE_MAXPHASECOUNT 48         // max phase count
+#define BOOTPROFILE_MAXNAMELENGTH 40         // max phase name length (including null character)
+#define BOOTPROFILE_CALIBRATIONMS 100        // TSC calibration time (ms)
+
+#pragma pack(push, 1)
+
+typedef struct k_BootPhase {
+	char name[BOOTPROFILE_MAXNAMELENGTH]; // phase name
+	dword lowTsc;                         // low 32 bits of TSC at the end of phase
+	dword highTsc;                        // high 32 bits of TSC at the end of phase
+} BootPhase;
+
+typedef struct k_BootProfile {
+	dword signature;                               // signature: It's set by kernel32, and means that the table is valid.
+	dword phaseCount;                              // phase count
+	BootPhase phases[BOOTPROFILE_MAXPHASECOUNT];   // phases
+} BootProfile;
+
+#pragma pack(pop)
+
+/* Boot Profile Functions */
+void k_initBootProfile(void);
+void k_addBootPhase(const char* name);
+void k_printBootProfile(void);
+void k_sendBootProfileToSerial(void);
+static qword k_getPhaseTsc(const BootPhase* phase);
+static qword k_getTscPerMs(void);
+
+#endif // __CORE_BOOTPROFILE_H__
@@ -2,6 +2,7 @@
 #define __CORE_CACHE_H__
 
 #include "types.h"
+#include "hdd.h"
 
 #define CACHE_MAXCLUSTERLINKTABLEAREACOUNT 16         // max cache buffer count of cluster link table area
 #define CACHE_MAXDATAAREACOUNT             32         // max cache buffer count of data area
@@ -19,6 +20,7 @@ typedef struct k_CacheBuffer {
 	dword accessTime; // access time: the time which accesses to cache buffer.
 	bool changed;     // changed flag: It indicates whether data changed or not.
 	byte* buffer;     // data buffer: the address of cache buffer.
+	HddRequest* request; // request: asynchronous read-ahead/write-back request which is in progress. (null if no request)
 } CacheBuffer;
 
 typedef struct k_CacheManager {
@@ -104,7 +104,8 @@ void k_initIdt(void) {
 	  < IDT >
 	  - vector 0 ~ 31    : exception handlers
 	  - vector 32 ~ 47   : interrupt handlers (interrupt from ISA bus)
-	  - vector 48 ~ 99   : interrupt hanlders (etc interrupt)
+	  - vector 48        : interrupt handler (TLB shootdown IPI)
+	  - vector 49 ~ 99   : interrupt hanlders (etc interrupt)
 	  - vector 100 ~ 255 : hOS do not use
 	*/
 	
@@ -134,7 +135,7 @@ void k_initIdt(void) {
 		k_setIdtEntry(&(entry[i]), k_isrEtcException,           GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	}
 	
-	// Interrupt Handling ISR (17): #32 ~ #47, #48 ~ #99
+	// Interrupt Handling ISR (18): #32 ~ #47, #48, #49 ~ #99
 	k_setIdtEntry(&(entry[32]), k_isrTimer,                     GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	k_setIdtEntry(&(entry[33]), k_isrKeyboard,                  GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	k_setIdtEntry(&(entry[34]), k_isrSlavePic,                  GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
@@ -151,7 +152,8 @@ void k_initIdt(void) {
 	k_setIdtEntry(&(entry[45]), k_isrCoprocessor,               GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	k_setIdtEntry(&(entry[46]), k_isrHdd1,                      GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	k_setIdtEntry(&(entry[47]), k_isrHdd2,                      GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
-	for (i = 48; i < IDT_MAXENTRYCOUNT; i++) {
+	k_setIdtEntry(&(entry[48]), k_isrTlbShootdown,              GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
+	for (i = 49; i < IDT_MAXENTRYCOUNT; i++) {
 		k_setIdtEntry(&(entry[i]), k_isrEtcInterrupt,           GDT_OFFSET_KERNELCODESEGMENT, IDT_FLAGS_IST1, IDT_FLAGS_KERNEL, IDT_TYPE_INTERRUPT);
 	}
 }
@@ -2,6 +2,7 @@
 #include "../utils/util.h"
 #include "sync.h"
 #include "console.h"
+#include "frame_mem.h"
 
 static DynamicMemManager g_dynamicMemManager;
 
@@ -81,20 +82,36 @@ void k_initDynamicMem(void) {
 	
 	// initialize spinlock.
 	k_initSpinlock(&(g_dynamicMemManager.spinlock));
+	
+	// initialize frame memory with the rest of RAM.
+	k_initFrameMem(g_dynamicMemManager.endAddr, k_calcRamEndAddress());
 }
 
 static qword k_calcDynamicMemSize(void) {
+	qword usableSize;
+	qword heapSize;
+	
+	usableSize = k_calcRamEndAddress() - DMEM_STARTADDRESS;
+	
+	// use a part of usable RAM as dynamic memory, and leave the rest to frame memory.
+	heapSize = ((usableSize / DMEM_HEAPRATIO) + 0x1FFFFF) & 0xFFFFFFFFFFE00000; // aligned with 2 MB
+	heapSize = MAX(heapSize, DMEM_MINHEAPSIZE);
+	
+	return MIN(heapSize, usableSize);
+}
+
+static qword k_calcRamEndAddress(void) {
 	qword ramSize;
 	
 	ramSize = (k_getTotalRamSize() * 1024 * 1024);
 	
-	// use dynamic memory area up to the maximum 3GB,
+	// use RAM up to the maximum 3GB,
 	// because graphic video memory and processor-using registers exist in the above of 3GB.
 	if (ramSize > ((qword)3 * 1024 * 1024 * 1024)) {
 		ramSize = ((qword)3 * 1024 * 1024 * 1024);
 	}
 	
-	return ramSize - DMEM_STARTADDRESS;
+	return ramSize;
 }
 
 static int k_calcMetaBlockCount(qword dynamicRamSize) {
@@ -127,6 +144,15 @@ void* k_allocMem(qword size) {
 	long offset;         // bitmap offset of allocated block
 	int sizeArrayOffset; // byte-level offset of allocated block
 	int blockListIndex;  // block list index matching block size
+	void* hugeFrames;    // huge frames for large allocation
+	
+	// serve large allocation with contiguous huge frames, and fall back to buddy block if frame memory is not enough.
+	if (size >= DMEM_LARGESIZE) {
+		hugeFrames = k_allocHugeFrames(size);
+		if (hugeFrames != null) {
+			return hugeFrames;
+		}
+	}
 	
 	// search buddy block size which is the closest one to the allocating memory size.
 	alignedSize = k_getBuddyBlockSize(size);
@@ -321,6 +347,11 @@ bool k_freeMem(void* addr) {
 		return false;
 	}
 	
+	// free huge frames of large allocation.
+	if (k_isFrameMem(addr) == true) {
+		return k_freeHugeFrames(addr);
+	}
+	
 	// calculate relative address and byte-level offset
 	relativeAddr = ((qword)addr) - g_dynamicMemManager.startAddr;
 	sizeArrayOffset = relativeAddr / DMEM_MINSIZE;
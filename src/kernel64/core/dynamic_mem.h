@@ -54,6 +54,14 @@
 // smallest block size (1 KB)
 #define DMEM_MINSIZE 1024
 
+// dynamic memory (buddy heap) size: The rest of RAM above it is frame memory.
+// - dynamic memory size = usable RAM size above dynamic memory start address / 4 (at least 16 MB), aligned with 2 MB.
+#define DMEM_HEAPRATIO   4
+#define DMEM_MINHEAPSIZE (16 * 1024 * 1024) // 16 MB
+
+// large allocation size (1 MB): Allocations larger than or equal to it are served with huge frames of frame memory first.
+#define DMEM_LARGESIZE (1024 * 1024)
+
 // bitmap flag
 #define DMEM_EXIST 0x01 // block EXIST: block can be allocated.
 #define DMEM_EMPTY 0x00 // block EMPTY: block can't be allocated, because it's already allocated or combined.
@@ -86,6 +94,7 @@ bool k_freeMem(void* addr);
 void k_getDynamicMemInfo(qword* startAddr, qword* totalSize, qword* metaSize, qword* usedSize);
 DynamicMemManager* k_getDynamicMemManager(void);
 static qword k_calcDynamicMemSize(void);
+static qword k_calcRamEndAddress(void);
 static int k_calcMetaBlockCount(qword dynamicRamSize);
 static int k_allocBuddyBlock(qword alignedSize);
 static qword k_getBuddyBlockSize(qword size);
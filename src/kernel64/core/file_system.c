@@ -3,22 +3,39 @@
 #include "../utils/util.h"
 #include "rdd.h"
 #include "console.h"
+#include "frame_mem.h"
+#include "virtual_mem.h"
+#include "task.h"
+#include "local_apic.h"
 
 static FileSystemManager g_fileSystemManager;
-static byte g_tempBuffer[FS_CLUSTERSIZE];
+static byte g_tempBuffer[FS_CLUSTERSIZE];     // temporary buffer for directory clusters (protected by mutex)
+static byte g_clusterLinkBuffer[512];         // cluster link table sector buffer (protected by allocation mutex)
 
 static ReadHddInfo g_readHddInfo = null;
 static ReadHddSector g_readHddSector = null;
 static WriteHddSector g_writeHddSector = null;
+static GetHddSectorPointer g_getHddSectorPointer = null; // only for RAM disk (null for hard disk)
+static FlushHddCache g_flushHddCache = null;             // only for hard disk (null for RAM disk)
 
 bool k_initFileSystem(void) {
 	bool cacheEnabled = false;
+	byte* handlePoolAddr;
+	int* usedIndexes;
+	int* usedPositions;
+	int i;
 	
 	// initialize file system manager.
 	k_memset(&g_fileSystemManager, 0, sizeof(g_fileSystemManager));
 	
-	// initialize mutex.
+	// initialize mutexes.
 	k_initMutex(&(g_fileSystemManager.mutex));
+	k_initMutex(&(g_fileSystemManager.allocMutex));
+	k_initMutex(&(g_fileSystemManager.cacheMutex));
+	k_initMutex(&(g_fileSystemManager.journal.mutex));
+	for (i = 0; i < FS_FILELOCKCOUNT; i++) {
+		k_initMutex(&(g_fileSystemManager.fileLocks[i]));
+	}
 	
 	// initialize hard disk.
 	if (k_initHdd() == true) {
@@ -26,16 +43,19 @@ bool k_initFileSystem(void) {
 		g_readHddInfo = k_readHddInfo;
 		g_readHddSector = k_readHddSector;
 		g_writeHddSector = k_writeHddSector;
+		g_flushHddCache = k_flushHddCache;
 		
 		// set true to cache enable flag.
 		cacheEnabled = true;
 		
 	// initialize ram disk if initialization of hard disk fails.
-	} else if (k_initRdd(RDD_TOTALSECTORCOUNT) == true) {
+	// RAM disk size is set by free dynamic memory, and its memory is allocated on demand.
+	} else if (k_initRdd(k_calcRddTotalSectorCount()) == true) {
 		// set function pointer related with ram disk control.
 		g_readHddInfo = k_readRddInfo;
 		g_readHddSector = k_readRddSector;
 		g_writeHddSector = k_writeRddSector;
+		g_getHddSectorPointer = k_getRddSectorPointer;
 		
 		// create file system every when booting, because ram disk is volatile.
 		if (k_formatHdd() == false) {
@@ -51,15 +71,28 @@ bool k_initFileSystem(void) {
 		return false;
 	}
 	
-	// allocate memory of handle pool.
-	g_fileSystemManager.handlePool = (File*)k_allocMem(sizeof(File) * FS_HANDLE_MAXCOUNT);
-	if (g_fileSystemManager.handlePool == null) {
+	// allocate memory of handle pool: handles, used index array, used position array, open handle hash table.
+	handlePoolAddr = (byte*)k_allocMem((sizeof(File) * FS_HANDLE_MAXCOUNT) + (sizeof(int) * FS_HANDLE_MAXCOUNT * 2) + (sizeof(int) * FS_OPENHASHCOUNT));
+	if (handlePoolAddr == null) {
 		g_fileSystemManager.mounted = false;
 		return false;
 	}
 	
 	// initialize handle pool.
-	k_memset(g_fileSystemManager.handlePool, 0, sizeof(File) * FS_HANDLE_MAXCOUNT);
+	k_memset(handlePoolAddr, 0, sizeof(File) * FS_HANDLE_MAXCOUNT);
+	usedIndexes = (int*)(handlePoolAddr + (sizeof(File) * FS_HANDLE_MAXCOUNT));
+	usedPositions = usedIndexes + FS_HANDLE_MAXCOUNT;
+	k_initPool(&(g_fileSystemManager.handlePool), handlePoolAddr, sizeof(File), FS_HANDLE_MAXCOUNT, offsetof(File, next), usedIndexes, usedPositions);
+	
+	// initialize all open handle hash buckets as empty.
+	g_fileSystemManager.openHashTable = usedPositions + FS_HANDLE_MAXCOUNT;
+	for (i = 0; i < FS_OPENHASHCOUNT; i++) {
+		g_fileSystemManager.openHashTable[i] = POOL_INVALIDINDEX;
+	}
+	
+	// initialize file mapping pool.
+	k_initPool(&(g_fileSystemManager.mappingPool), g_fileSystemManager.mappings, sizeof(FileMapping), FS_MAPPING_MAXCOUNT, offsetof(FileMapping, next), 
+	           g_fileSystemManager.mappingUsedIndexes, g_fileSystemManager.mappingUsedPositions);
 	
 	// If cache enable flag == true, initialize cache.
 	if (cacheEnabled == true) {
@@ -77,6 +110,7 @@ bool k_formatHdd(void) {
 	dword maxClusterCount;        // max cluster count (total cluster count of hard disk)
 	dword clusterCount;           // real cluster count (cluster count of general data area)
 	dword clusterLinkSectorCount; // sector count of cluster link table area
+	dword reservedSectorCount;    // sector count of reserved area
 	dword i;
 	
 	k_lock(&(g_fileSystemManager.mutex));
@@ -92,7 +126,8 @@ bool k_formatHdd(void) {
 		return false;
 	}
 	
-	totalSectorCount = hddInfo->totalSectors;
+	// [NOTE] LBA address of hFS is 32 bits, so the sectors above 2TB aren't used.
+	totalSectorCount = MIN(k_getHddTotalSectorCount(hddInfo), 0xFFFFFFFF);
 	
 	// total cluster count = total sector count of hard disk / sector count per a cluster (8)
 	maxClusterCount = totalSectorCount / FS_SECTORSPERCLUSTER;
@@ -101,13 +136,18 @@ bool k_formatHdd(void) {
 	// aligned with 128 (sector-level, rounding up), because 128 cluster links (4B) can be created in a sector (512B).
 	clusterLinkSectorCount = (maxClusterCount + 127) / 128;
 	
-	// sector count of general data area = total sector count of hard disk - sector count of MBR area (1) - sector count of reserved area (0) - sector count of cluster link table area
+	// reserved area consists of journal and padding which aligns the start of general data area with cluster-level (8 sectors),
+	// so that a cluster never crosses the page of RAM disk (or the physical sector of 4KB-sector hard disk).
+	reservedSectorCount = FS_JOURNALSECTORCOUNT + ((FS_SECTORSPERCLUSTER - ((1 + FS_JOURNALSECTORCOUNT + clusterLinkSectorCount) % FS_SECTORSPERCLUSTER)) % FS_SECTORSPERCLUSTER);
+	
+	// sector count of general data area = total sector count of hard disk - sector count of MBR area (1) - sector count of reserved area - sector count of cluster link table area
 	// real cluster count = sector count of general data area / sector count per a cluster (8)
-	remainSectorCount = totalSectorCount - 1 - clusterLinkSectorCount;
+	remainSectorCount = totalSectorCount - 1 - reservedSectorCount - clusterLinkSectorCount;
 	clusterCount = remainSectorCount / FS_SECTORSPERCLUSTER;
 	
-	// Finally, calculate sector count of cluster link table area with real cluster count again.
+	// Finally, calculate sector count of cluster link table area and reserved area with real cluster count again.
 	clusterLinkSectorCount = (clusterCount + 127) / 128;
+	reservedSectorCount = FS_JOURNALSECTORCOUNT + ((FS_SECTORSPERCLUSTER - ((1 + FS_JOURNALSECTORCOUNT + clusterLinkSectorCount) % FS_SECTORSPERCLUSTER)) % FS_SECTORSPERCLUSTER);
 	
 	//----------------------------------------------------------------------------------------------------
 	// initialize MBR area
@@ -123,7 +163,7 @@ bool k_formatHdd(void) {
 	mbr = (Mbr*)g_tempBuffer;
 	k_memset(mbr->partition, 0, sizeof(mbr->partition));
 	mbr->signature = FS_SIGNATURE;
-	mbr->reservedSectorCount = 0;
+	mbr->reservedSectorCount = reservedSectorCount;
 	mbr->clusterLinkSectorCount = clusterLinkSectorCount;
 	mbr->totalClusterCount = clusterCount;
 	
@@ -148,19 +188,30 @@ bool k_formatHdd(void) {
 			((dword*)(g_tempBuffer))[0] = FS_FREECLUSTER;
 		}
 		
-		// write by 1 sector from LBA 1.
-		if (g_writeHddSector(true, true, i + 1, 1, g_tempBuffer) == false) {
+		// write by 1 sector from the start of cluster link table area.
+		if (g_writeHddSector(true, true, 1 + reservedSectorCount + i, 1, g_tempBuffer) == false) {
 			k_unlock(&(g_fileSystemManager.mutex));
 			return false;
 		}
 	}
 	
+	//----------------------------------------------------------------------------------------------------
+	// initialize journal (empty log) at the start of reserved area.
+	//----------------------------------------------------------------------------------------------------
+	if (k_formatJournal(1) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
+	
 	//----------------------------------------------------------------------------------------------------
 	// flush all cache buffers.
 	//----------------------------------------------------------------------------------------------------
 	if (g_fileSystemManager.cacheEnabled == true) {
+		k_lock(&(g_fileSystemManager.cacheMutex));
+		k_waitAllCacheBufferIo();
 		k_discardAllCacheBuffer(CACHE_CLUSTERLINKTABLEAREA);
 		k_discardAllCacheBuffer(CACHE_DATAAREA);
+		k_unlock(&(g_fileSystemManager.cacheMutex));
 	}
 	
 	k_unlock(&(g_fileSystemManager.mutex));
@@ -169,6 +220,7 @@ bool k_formatHdd(void) {
 
 bool k_mountHdd(void) {
 	Mbr* mbr;
+	bool upgrade;
 	
 	k_lock(&(g_fileSystemManager.mutex));
 	
@@ -178,9 +230,15 @@ bool k_mountHdd(void) {
 		return false;
 	}
 	
-	// check file system signature.
+	// check file system signature. If it's version 1, upgrade it after reading metadata.
 	mbr = (Mbr*)g_tempBuffer;
-	if (mbr->signature != FS_SIGNATURE) {
+	if (mbr->signature == FS_SIGNATURE) {
+		upgrade = false;
+		
+	} else if (mbr->signature == FS_SIGNATURE_V1) {
+		upgrade = true;
+		
+	} else {
 		k_unlock(&(g_fileSystemManager.mutex));
 		return false;
 	}
@@ -194,11 +252,420 @@ bool k_mountHdd(void) {
 	g_fileSystemManager.clusterLinkAreaSize = mbr->clusterLinkSectorCount;
 	g_fileSystemManager.dataAreaStartAddr = 1 + mbr->reservedSectorCount + mbr->clusterLinkSectorCount;
 	g_fileSystemManager.totalClusterCount = mbr->totalClusterCount;
+	g_fileSystemManager.lastAllocedClusterIndex = 0;
+	
+	// replay committed transactions in journal before reading metadata.
+	if (k_mountJournal() == false) {
+		g_fileSystemManager.mounted = false;
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
+	
+	// build free cluster bitmap from cluster link table.
+	if (k_buildFreeClusterBitmap() == false) {
+		g_fileSystemManager.mounted = false;
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
+	
+	// upgrade version 1 to version 2, or finish the upgrade interrupted while replacing root directory.
+	if (k_upgradeFileSystem(upgrade) == false) {
+		g_fileSystemManager.mounted = false;
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
+	
+	// build dentry cache from all directories.
+	if (k_buildDentryCache() == false) {
+		g_fileSystemManager.mounted = false;
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
 	
 	k_unlock(&(g_fileSystemManager.mutex));
 	return true;
 }
 
+static bool k_upgradeFileSystem(bool convert) {
+	byte* buffer;               // 2 cluster-sized buffer: version 1 directory cluster + version 2 directory cluster
+	UpgradeList queue;          // directory queue: pairs of (version 1 start cluster index, version 2 start cluster index)
+	UpgradeList oldClusters;    // version 1 directory clusters, which are freed after root directory is replaced
+	UpgradeList newClusters;    // version 2 directory clusters, which are freed if conversion fails
+	dword rootLink;
+	dword newRootClusterIndex;
+	dword allocedCount;
+	dword i;
+	bool result = true;
+	
+	queue.items = null;
+	oldClusters.items = null;
+	newClusters.items = null;
+	
+	//----------------------------------------------------------------------------------------------------
+	// If upgrade was interrupted while replacing root directory, finish it regardless of signature.
+	// [NOTE] Mark is valid only if cluster index can't have the mark bit, which is always true for version 1 (LBA 32 bits).
+	//----------------------------------------------------------------------------------------------------
+	if (k_getClusterLinkData(FS_ROOTCLUSTER, &rootLink) == false) {
+		return false;
+	}
+	
+	if ((g_fileSystemManager.totalClusterCount <= FS_UPGRADEMARK) && (rootLink != FS_LASTCLUSTER) && (rootLink & FS_UPGRADEMARK)) {
+		return k_replaceUpgradedRootDir(rootLink & ~FS_UPGRADEMARK);
+	}
+	
+	if (convert == false) {
+		return true;
+	}
+	
+	buffer = (byte*)k_allocMem(FS_CLUSTERSIZE * 2);
+	if ((buffer == null) || (k_initUpgradeList(&queue) == false) || (k_initUpgradeList(&oldClusters) == false) || (k_initUpgradeList(&newClusters) == false)) {
+		if (buffer != null) {
+			k_freeMem(buffer);
+		}
+		
+		k_freeUpgradeList(&queue);
+		k_freeUpgradeList(&oldClusters);
+		k_freeUpgradeList(&newClusters);
+		return false;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// convert all directories from root directory in breadth-first order into new clusters (out of place),
+	// so that version 1 directories stay intact until root directory is replaced.
+	// A subdirectory found while converting a directory gets its new start cluster, and is added to directory queue.
+	//----------------------------------------------------------------------------------------------------
+	newRootClusterIndex = k_allocClusterExtent(FS_ROOTCLUSTER + 1, 1, &allocedCount);
+	if ((newRootClusterIndex == FS_LASTCLUSTER) || (k_addUpgradeList(&newClusters, newRootClusterIndex) == false) ||
+	    (k_addUpgradeList(&queue, FS_ROOTCLUSTER) == false) || (k_addUpgradeList(&queue, newRootClusterIndex) == false)) {
+		result = false;
+	}
+	
+	for (i = 0; (result == true) && (i < queue.count); i += 2) {
+		result = k_upgradeDir(queue.items[i], queue.items[i + 1], buffer, &queue, &oldClusters, &newClusters);
+	}
+	
+	k_freeMem(buffer);
+	k_freeUpgradeList(&queue);
+	
+	//----------------------------------------------------------------------------------------------------
+	// flush all converted directories, and mark root cluster link with the start cluster of converted root directory.
+	// Marking root cluster link is the commit point of upgrade: Before it, version 1 remains and upgrade runs again at next mount.
+	// After it, next mount finishes replacing root directory.
+	//----------------------------------------------------------------------------------------------------
+	if ((result == false) || (k_flushFileSystemCache() == false) ||
+	    (k_setClusterLinkData(FS_ROOTCLUSTER, FS_UPGRADEMARK | newRootClusterIndex) == false) || (k_flushFileSystemCache() == false)) {
+		// free clusters allocated for conversion. If it fails, they just leak.
+		for (i = 0; i < newClusters.count; i++) {
+			k_setClusterLinkData(newClusters.items[i], FS_FREECLUSTER);
+		}
+		
+		k_freeUpgradeList(&oldClusters);
+		k_freeUpgradeList(&newClusters);
+		return false;
+	}
+	
+	k_freeUpgradeList(&newClusters);
+	
+	if (k_replaceUpgradedRootDir(newRootClusterIndex) == false) {
+		k_freeUpgradeList(&oldClusters);
+		return false;
+	}
+	
+	// free version 1 directory clusters. (If power fails before it, they just leak.)
+	for (i = 0; i < oldClusters.count; i++) {
+		if (k_setClusterLinkData(oldClusters.items[i], FS_FREECLUSTER) == false) {
+			result = false;
+			break;
+		}
+	}
+	
+	k_freeUpgradeList(&oldClusters);
+	
+	if ((result == false) || (k_flushFileSystemCache() == false)) {
+		return false;
+	}
+	
+	return true;
+}
+
+static bool k_replaceUpgradedRootDir(dword newRootClusterIndex) {
+	byte* buffer;
+	dword nextClusterIndex;
+	Mbr* mbr;
+	
+	buffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
+	if (buffer == null) {
+		return false;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// copy the first cluster of converted root directory to root cluster, and change signature to version 2.
+	// Each step is repeated safely at next mount until root cluster link is unmarked,
+	// because converted root directory isn't freed until then.
+	//----------------------------------------------------------------------------------------------------
+	if ((k_getClusterLinkData(newRootClusterIndex, &nextClusterIndex) == false) ||
+	    (k_readDirCluster(newRootClusterIndex, buffer) == false) || (k_writeDirCluster(FS_ROOTCLUSTER, buffer) == false) ||
+	    (k_flushFileSystemCache() == false)) {
+		k_freeMem(buffer);
+		return false;
+	}
+	
+	k_freeMem(buffer);
+	
+	if (g_readHddSector(true, true, 0, 1, g_tempBuffer) == false) {
+		return false;
+	}
+	
+	mbr = (Mbr*)g_tempBuffer;
+	if (mbr->signature != FS_SIGNATURE) {
+		mbr->signature = FS_SIGNATURE;
+		if (g_writeHddSector(true, true, 0, 1, g_tempBuffer) == false) {
+			return false;
+		}
+	}
+	
+	// link root cluster to the rest of converted root directory, and free the first cluster of it.
+	if ((k_setClusterLinkData(FS_ROOTCLUSTER, nextClusterIndex) == false) || (k_flushFileSystemCache() == false) ||
+	    (k_setClusterLinkData(newRootClusterIndex, FS_FREECLUSTER) == false) || (k_flushFileSystemCache() == false)) {
+		return false;
+	}
+	
+	return true;
+}
+
+static bool k_upgradeDir(dword oldDirClusterIndex, dword newDirClusterIndex, byte* buffer, UpgradeList* queue, UpgradeList* oldClusters, UpgradeList* newClusters) {
+	DirEntryV1* oldEntry;     // version 1 directory entries (128 entries in a cluster)
+	DirEntry* newEntry;       // version 2 directory entries (64 entries in a cluster)
+	dword clusterIndex;       // version 1 directory cluster index
+	dword nextClusterIndex;   // next directory cluster index (in version 1 cluster chain)
+	dword newClusterIndex;    // version 2 directory cluster index for lower half entries
+	dword upperClusterIndex;  // version 2 directory cluster index for upper half entries
+	dword lastClusterIndex;   // the last version 2 directory cluster index converted so far
+	dword childClusterIndex;  // version 2 start cluster index of subdirectory
+	dword allocedCount;       // allocated cluster count
+	bool upperUsed;           // upper half entries used flag
+	int i;
+	
+	oldEntry = (DirEntryV1*)buffer;
+	newEntry = (DirEntry*)(buffer + FS_CLUSTERSIZE);
+	
+	clusterIndex = oldDirClusterIndex;
+	newClusterIndex = newDirClusterIndex;
+	while (clusterIndex != FS_LASTCLUSTER) {
+		if ((k_getClusterLinkData(clusterIndex, &nextClusterIndex) == false) || (k_readDirCluster(clusterIndex, (byte*)oldEntry) == false)) {
+			return false;
+		}
+		
+		// root cluster is overwritten by converted root directory, so it isn't freed.
+		if ((clusterIndex != FS_ROOTCLUSTER) && (k_addUpgradeList(oldClusters, clusterIndex) == false)) {
+			return false;
+		}
+		
+		//----------------------------------------------------------------------------------------------------
+		// allocate new start clusters of subdirectories, add them to directory queue, and check if upper half entries are used.
+		// Subdirectory entries point to new start clusters after conversion.
+		//----------------------------------------------------------------------------------------------------
+		upperUsed = false;
+		for (i = 0; i < (FS_CLUSTERSIZE / sizeof(DirEntryV1)); i++) {
+			if ((oldEntry[i].startClusterIndex == 0x00) || (oldEntry[i].startClusterIndex >= g_fileSystemManager.totalClusterCount)) {
+				continue;
+			}
+			
+			if (i >= FS_MAXDIRECTORYENTRYCOUNT) {
+				upperUsed = true;
+			}
+			
+			if (oldEntry[i].attribute != FS_ATTRIBUTE_DIRECTORY) {
+				continue;
+			}
+			
+			childClusterIndex = k_allocClusterExtent(newClusterIndex + 1, 1, &allocedCount);
+			if ((childClusterIndex == FS_LASTCLUSTER) || (k_addUpgradeList(newClusters, childClusterIndex) == false) ||
+			    (k_addUpgradeList(queue, oldEntry[i].startClusterIndex) == false) || (k_addUpgradeList(queue, childClusterIndex) == false)) {
+				return false;
+			}
+			
+			oldEntry[i].startClusterIndex = childClusterIndex;
+		}
+		
+		//----------------------------------------------------------------------------------------------------
+		// convert a version 1 directory cluster into 2 version 2 directory clusters.
+		// lower half entries go to new cluster, and upper half entries go to another new cluster linked next to it.
+		// If upper half entries aren't used, upper cluster isn't allocated.
+		//----------------------------------------------------------------------------------------------------
+		lastClusterIndex = newClusterIndex;
+		if (upperUsed == true) {
+			upperClusterIndex = k_allocClusterExtent(newClusterIndex + 1, 1, &allocedCount);
+			if ((upperClusterIndex == FS_LASTCLUSTER) || (k_addUpgradeList(newClusters, upperClusterIndex) == false)) {
+				return false;
+			}
+			
+			k_convertDirEntries(oldEntry + FS_MAXDIRECTORYENTRYCOUNT, newEntry, FS_MAXDIRECTORYENTRYCOUNT);
+			if ((k_writeDirCluster(upperClusterIndex, (byte*)newEntry) == false) ||
+			    (k_setClusterLinkData(newClusterIndex, upperClusterIndex) == false)) {
+				return false;
+			}
+			
+			lastClusterIndex = upperClusterIndex;
+		}
+		
+		k_convertDirEntries(oldEntry, newEntry, FS_MAXDIRECTORYENTRYCOUNT);
+		if (k_writeDirCluster(newClusterIndex, (byte*)newEntry) == false) {
+			return false;
+		}
+		
+		// If version 1 directory has next cluster, allocate next new cluster and link it.
+		if (nextClusterIndex != FS_LASTCLUSTER) {
+			newClusterIndex = k_allocClusterExtent(lastClusterIndex + 1, 1, &allocedCount);
+			if ((newClusterIndex == FS_LASTCLUSTER) || (k_addUpgradeList(newClusters, newClusterIndex) == false) ||
+			    (k_setClusterLinkData(lastClusterIndex, newClusterIndex) == false)) {
+				return false;
+			}
+		}
+		
+		clusterIndex = nextClusterIndex;
+	}
+	
+	return true;
+}
+
+static bool k_initUpgradeList(UpgradeList* list) {
+	list->maxCount = FS_MINUPGRADELISTCOUNT;
+	list->count = 0;
+	list->items = (dword*)k_allocMem(sizeof(dword) * list->maxCount);
+	if (list->items == null) {
+		return false;
+	}
+	
+	return true;
+}
+
+static void k_freeUpgradeList(UpgradeList* list) {
+	if (list->items != null) {
+		k_freeMem(list->items);
+		list->items = null;
+	}
+}
+
+static bool k_addUpgradeList(UpgradeList* list, dword item) {
+	dword* newItems;
+	
+	// If list is full, double it.
+	if (list->count >= list->maxCount) {
+		newItems = (dword*)k_allocMem(sizeof(dword) * list->maxCount * 2);
+		if (newItems == null) {
+			return false;
+		}
+		
+		k_memcpy(newItems, list->items, sizeof(dword) * list->count);
+		k_freeMem(list->items);
+		list->items = newItems;
+		list->maxCount *= 2;
+	}
+	
+	list->items[list->count++] = item;
+	
+	return true;
+}
+
+static void k_convertDirEntries(const DirEntryV1* src, DirEntry* dest, int count) {
+	int i;
+	
+	k_memset(dest, 0, sizeof(DirEntry) * count);
+	
+	for (i = 0; i < count; i++) {
+		if (src[i].startClusterIndex == 0x00) {
+			continue;
+		}
+		
+		k_memcpy(dest[i].fileName, src[i].fileName, FS_MAXFILENAMELENGTH);
+		dest[i].attribute = src[i].attribute;
+		dest[i].fileSize = src[i].fileSize;
+		dest[i].startClusterIndex = src[i].startClusterIndex;
+	}
+}
+
+static bool k_buildFreeClusterBitmap(void) {
+	dword bitmapSize;
+	dword linkCountInSector;
+	dword clusterIndex;
+	dword i, j;
+	bool result = true;
+	
+	k_lock(&(g_fileSystemManager.allocMutex));
+	
+	// free the bitmap of previous mount.
+	if (g_fileSystemManager.freeClusterBitmap != null) {
+		k_freeMem(g_fileSystemManager.freeClusterBitmap);
+		g_fileSystemManager.freeClusterBitmap = null;
+	}
+	
+	// allocate bitmap (1 bit per cluster), and initialize all clusters as allocated.
+	bitmapSize = (g_fileSystemManager.totalClusterCount + 7) / 8;
+	g_fileSystemManager.freeClusterBitmap = (byte*)k_allocMem(bitmapSize);
+	if (g_fileSystemManager.freeClusterBitmap == null) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
+		return false;
+	}
+	
+	k_memset(g_fileSystemManager.freeClusterBitmap, 0, bitmapSize);
+	g_fileSystemManager.freeClusterCount = 0;
+	
+	// read all sectors of cluster link table once, and set free clusters to bitmap.
+	for (i = 0; i < g_fileSystemManager.clusterLinkAreaSize; i++) {
+		if (k_readClusterLinkTable(i, g_clusterLinkBuffer) == false) {
+			result = false;
+			break;
+		}
+		
+		linkCountInSector = MIN(g_fileSystemManager.totalClusterCount - (i * 128), 128);
+		for (j = 0; j < linkCountInSector; j++) {
+			if (((dword*)g_clusterLinkBuffer)[j] == FS_FREECLUSTER) {
+				clusterIndex = (i * 128) + j;
+				g_fileSystemManager.freeClusterBitmap[clusterIndex / 8] |= (1 << (clusterIndex % 8));
+				g_fileSystemManager.freeClusterCount++;
+			}
+		}
+	}
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	return result;
+}
+
+static void k_setFreeClusterBitmap(dword clusterIndex, bool free) {
+	byte* bitmap;
+	byte mask;
+	
+	if ((g_fileSystemManager.freeClusterBitmap == null) || (clusterIndex >= g_fileSystemManager.totalClusterCount)) {
+		return;
+	}
+	
+	bitmap = &(g_fileSystemManager.freeClusterBitmap[clusterIndex / 8]);
+	mask = 1 << (clusterIndex % 8);
+	
+	// update bit and free cluster count only if the state changes.
+	if ((free == true) && ((*bitmap & mask) == 0)) {
+		*bitmap |= mask;
+		g_fileSystemManager.freeClusterCount++;
+		
+	} else if ((free == false) && ((*bitmap & mask) != 0)) {
+		*bitmap &= ~mask;
+		g_fileSystemManager.freeClusterCount--;
+	}
+}
+
+static bool k_isFreeCluster(dword clusterIndex) {
+	if ((g_fileSystemManager.freeClusterBitmap == null) || (clusterIndex >= g_fileSystemManager.totalClusterCount)) {
+		return false;
+	}
+	
+	if ((g_fileSystemManager.freeClusterBitmap[clusterIndex / 8] & (1 << (clusterIndex % 8))) != 0) {
+		return true;
+	}
+	
+	return false;
+}
+
 bool k_getHddInfo(HddInfo* info) {
 	bool result;
 	
@@ -229,6 +696,10 @@ static CacheBuffer* k_allocCacheBufferWithFlush(int cacheTableIndex) {
 			return null;
 		}
 		
+		// wait for request in progress (read-ahead) of old cache buffer, in order not to let its late completion overwrite new data.
+		// [NOTE] If read-ahead fails, old cache buffer has been set to be free, so it isn't applied to hard disk below.
+		k_waitCacheBufferIo(cacheTableIndex, cacheBuffer);
+		
 		// If cache buffer changes, apply it to hard disk.
 		if (cacheBuffer->changed == true) {
 			switch(cacheTableIndex){
@@ -259,16 +730,26 @@ static CacheBuffer* k_allocCacheBufferWithFlush(int cacheTableIndex) {
 }
 
 static bool k_readClusterLinkTable(dword offset, byte* buffer) {
+	bool result;
+	
+	// If running transaction of journal has the sector, read it.
+	if (k_readJournalBlock(FS_JOURNALBLOCK_CLUSTERLINK, offset, buffer) == true) {
+		return true;
+	}
+	
 	if (g_fileSystemManager.cacheEnabled == false) {
-		k_readClusterLinkTableWithoutCache(offset, buffer);
-		
-	} else {
-		k_readClusterLinkTableWithCache(offset, buffer);
+		return k_readClusterLinkTableWithoutCache(offset, buffer);
 	}
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	result = k_readClusterLinkTableWithCache(offset, buffer);
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
 }
 
 static bool k_readClusterLinkTableWithoutCache(dword offset, byte* buffer) {
-	return g_readHddSector(true, true, g_fileSystemManager.clusterLinkAreaStartAddr + offset, 1, buffer);
+	return g_readHddSector(true, true, (qword)g_fileSystemManager.clusterLinkAreaStartAddr + offset, 1, buffer);
 }
 
 static bool k_readClusterLinkTableWithCache(dword offset, byte* buffer) {
@@ -277,8 +758,8 @@ static bool k_readClusterLinkTableWithCache(dword offset, byte* buffer) {
 	// search cache buffer matching offset
 	cacheBuffer = k_findCacheBuffer(CACHE_CLUSTERLINKTABLEAREA, offset);
 	
-	// If cache buffer exists, read it.
-	if (cacheBuffer != null) {
+	// If cache buffer exists, read it. (If its request is in progress, wait for it.)
+	if ((cacheBuffer != null) && (k_waitCacheBufferIo(CACHE_CLUSTERLINKTABLEAREA, cacheBuffer) == true)) {
 		k_memcpy(buffer, cacheBuffer->buffer, 512);
 		return true;
 	}
@@ -303,16 +784,26 @@ static bool k_readClusterLinkTableWithCache(dword offset, byte* buffer) {
 }
 
 static bool k_writeClusterLinkTable(dword offset, byte* buffer) {
+	bool result;
+	
+	// If journal is enabled, write the sector to running transaction. It's written to home location at commit.
+	if (g_fileSystemManager.journal.enabled == true) {
+		return k_addJournalBlock(FS_JOURNALBLOCK_CLUSTERLINK, offset, buffer);
+	}
+	
 	if (g_fileSystemManager.cacheEnabled == false) {
-		k_writeClusterLinkTableWithoutCache(offset, buffer);
-		
-	} else {
-		k_writeClusterLinkTableWithCache(offset, buffer);
+		return k_writeClusterLinkTableWithoutCache(offset, buffer);
 	}
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	result = k_writeClusterLinkTableWithCache(offset, buffer);
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
 }
 
 static bool k_writeClusterLinkTableWithoutCache(dword offset, byte* buffer) {
-	return g_writeHddSector(true, true, g_fileSystemManager.clusterLinkAreaStartAddr + offset, 1, buffer);
+	return g_writeHddSector(true, true, (qword)g_fileSystemManager.clusterLinkAreaStartAddr + offset, 1, buffer);
 }
 
 static bool k_writeClusterLinkTableWithCache(dword offset, byte* buffer) {
@@ -321,8 +812,10 @@ static bool k_writeClusterLinkTableWithCache(dword offset, byte* buffer) {
 	// search cache buffer matching offset.
 	cacheBuffer = k_findCacheBuffer(CACHE_CLUSTERLINKTABLEAREA, offset);
 	
-	// If cache buffer exists, write to it.
+	// If cache buffer exists, write to it. (If its request is in progress, wait for it.)
 	if (cacheBuffer != null) {
+		k_waitCacheBufferIo(CACHE_CLUSTERLINKTABLEAREA, cacheBuffer);
+		cacheBuffer->tag = offset; // The whole buffer is overwritten, so it's valid even if the request has failed.
 		k_memcpy(cacheBuffer->buffer, buffer, 512);
 		cacheBuffer->changed = true;
 		return true;
@@ -343,16 +836,21 @@ static bool k_writeClusterLinkTableWithCache(dword offset, byte* buffer) {
 }
 
 static bool k_readCluster(dword offset, byte* buffer) {
+	bool result;
+	
 	if (g_fileSystemManager.cacheEnabled == false) {
-		k_readClusterWithoutCache(offset, buffer);
-		
-	} else {
-		k_readClusterWithCache(offset, buffer);
+		return k_readClusterWithoutCache(offset, buffer);
 	}
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	result = k_readClusterWithCache(offset, buffer);
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
 }
 
 static bool k_readClusterWithoutCache(dword offset, byte* buffer) {
-	return g_readHddSector(true, true, g_fileSystemManager.dataAreaStartAddr + (offset * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, buffer);
+	return g_readHddSector(true, true, g_fileSystemManager.dataAreaStartAddr + ((qword)offset * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, buffer);
 }
 
 static bool k_readClusterWithCache(dword offset, byte* buffer) {
@@ -361,8 +859,8 @@ static bool k_readClusterWithCache(dword offset, byte* buffer) {
 	// search cache buffer matching offset.
 	cacheBuffer = k_findCacheBuffer(CACHE_DATAAREA, offset);
 	
-	// If cache buffer exists, read from it.
-	if (cacheBuffer != null) {
+	// If cache buffer exists, read from it. (If its read-ahead request is in progress, wait for it.)
+	if ((cacheBuffer != null) && (k_waitCacheBufferIo(CACHE_DATAAREA, cacheBuffer) == true)) {
 		k_memcpy(buffer, cacheBuffer->buffer, FS_CLUSTERSIZE);
 		return true;
 	}
@@ -387,16 +885,32 @@ static bool k_readClusterWithCache(dword offset, byte* buffer) {
 }
 
 static bool k_writeCluster(dword offset, byte* buffer) {
+	bool result;
+	
 	if (g_fileSystemManager.cacheEnabled == false) {
-		k_writeClusterWithoutCache(offset, buffer);
-		
-	} else {
-		k_writeClusterWithCache(offset, buffer);
+		return k_writeClusterWithoutCache(offset, buffer);
 	}
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	result = k_writeClusterWithCache(offset, buffer);
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
 }
 
 static bool k_writeClusterWithoutCache(dword offset, byte* buffer) {
-	return g_writeHddSector(true, true, g_fileSystemManager.dataAreaStartAddr + (offset * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, buffer);
+	return g_writeHddSector(true, true, g_fileSystemManager.dataAreaStartAddr + ((qword)offset * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, buffer);
+}
+
+static byte* k_getClusterPointer(dword offset, bool write) {
+	// If disk can't hand out a pointer (hard disk), return null. Then, the caller copies cluster through temporary buffer.
+	if (g_getHddSectorPointer == null) {
+		return null;
+	}
+	
+	// return a pointer to the cluster in the page of RAM disk (zero-copy).
+	// [NOTE] the pointer for reading must not be written, because it might be the shared zero buffer.
+	return g_getHddSectorPointer(g_fileSystemManager.dataAreaStartAddr + ((qword)offset * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, write);
 }
 
 static bool k_writeClusterWithCache(dword offset, byte* buffer) {
@@ -405,8 +919,10 @@ static bool k_writeClusterWithCache(dword offset, byte* buffer) {
 	// search cache buffer matching offset.
 	cacheBuffer = k_findCacheBuffer(CACHE_DATAAREA, offset);
 	
-	// If cache buffer exists, write to it.
+	// If cache buffer exists, write to it. (If its request is in progress, wait for it.)
 	if (cacheBuffer != null) {
+		k_waitCacheBufferIo(CACHE_DATAAREA, cacheBuffer);
+		cacheBuffer->tag = offset; // The whole buffer is overwritten, so it's valid even if the request has failed.
 		k_memcpy(cacheBuffer->buffer, buffer, FS_CLUSTERSIZE);
 		cacheBuffer->changed = true;
 		return true;
@@ -426,50 +942,89 @@ static bool k_writeClusterWithCache(dword offset, byte* buffer) {
 	return true;
 }
 
+// [NOTE] The caller must lock allocation mutex until it sets the found cluster to allocated cluster,
+//        otherwise another task can find the same cluster.
 static dword k_findFreeCluster(void) {
-	dword linkCountInSector;
-	dword lastSectorOffset, currentSectorOffset;
+	dword bitmapSize;
+	dword byteOffset;
+	dword clusterIndex;
 	dword i, j;
 	
-	if (g_fileSystemManager.mounted == false) {
+	if ((g_fileSystemManager.mounted == false) || (g_fileSystemManager.freeClusterCount == 0)) {
 		return FS_LASTCLUSTER;
 	}
 	
-	lastSectorOffset = g_fileSystemManager.lastAllocedClusterLinkSectorOffset;
+	bitmapSize = (g_fileSystemManager.totalClusterCount + 7) / 8;
 	
-	// search free cluster looping from the last allocated position.
-	for (i = 0; i < g_fileSystemManager.clusterLinkAreaSize; i++) {
+	// search free cluster in bitmap looping from the last allocated position.
+	// skip the bytes which have no free cluster (0x00) at once.
+	for (i = 0; i <= bitmapSize; i++) {
+		byteOffset = ((g_fileSystemManager.lastAllocedClusterIndex / 8) + i) % bitmapSize;
+		if (g_fileSystemManager.freeClusterBitmap[byteOffset] == 0x00) {
+			continue;
+		}
 		
-		// If it's the last sector of cluster link table, 128 cluster links might not exist.
-		if ((lastSectorOffset + i) == (g_fileSystemManager.clusterLinkAreaSize - 1)) {
-			linkCountInSector = g_fileSystemManager.totalClusterCount % 128;
-			
-		} else {
-			linkCountInSector = 128;
+		for (j = 0; j < 8; j++) {
+			clusterIndex = (byteOffset * 8) + j;
+			if (k_isFreeCluster(clusterIndex) == true) {
+				g_fileSystemManager.lastAllocedClusterIndex = clusterIndex;
+				return clusterIndex; // return free cluster index.
+			}
 		}
+	}
+	
+	return FS_LASTCLUSTER;
+}
+
+static dword k_allocClusterExtent(dword preferredClusterIndex, dword count, dword* allocedCount) {
+	dword startClusterIndex;
+	dword i;
+	
+	*allocedCount = 0;
+	
+	k_lock(&(g_fileSystemManager.allocMutex));
+	
+	// If preferred cluster (next to the last cluster of file) is free, extend file sequentially.
+	// If not, search free cluster from the last allocated position.
+	if (k_isFreeCluster(preferredClusterIndex) == true) {
+		startClusterIndex = preferredClusterIndex;
 		
-		// read current sector.
-		currentSectorOffset = (lastSectorOffset + i) % g_fileSystemManager.clusterLinkAreaSize;
-		if (k_readClusterLinkTable(currentSectorOffset, g_tempBuffer) == false) {
+	} else {
+		startClusterIndex = k_findFreeCluster();
+		if (startClusterIndex == FS_LASTCLUSTER) {
+			k_unlock(&(g_fileSystemManager.allocMutex));
 			return FS_LASTCLUSTER;
 		}
-		
-		// search free cluster inside current sector.
-		for (j = 0; j < linkCountInSector; j++) {
-			if (((dword*)g_tempBuffer)[j] == FS_FREECLUSTER) {
-				break;
-			}
+	}
+	
+	// collect contiguous free clusters (extent) up to requested count.
+	count = MIN(count, FS_MAXEXTENTCLUSTERCOUNT);
+	for (i = 0; i < count; i++) {
+		if (k_isFreeCluster(startClusterIndex + i) == false) {
+			break;
 		}
-		
-		// If free cluster is searched successfully, return cluster index.
-		if (j != linkCountInSector) {
-			g_fileSystemManager.lastAllocedClusterLinkSectorOffset = currentSectorOffset;
+	}
+	
+	// link the clusters of extent in order, and set the last one to last cluster.
+	// If linking fails, free the clusters linked so far.
+	*allocedCount = i;
+	for (i = 0; i < *allocedCount; i++) {
+		if (k_setClusterLinkData(startClusterIndex + i, (i == (*allocedCount - 1)) ? FS_LASTCLUSTER : (startClusterIndex + i + 1)) == false) {
+			while (i > 0) {
+				i--;
+				k_setClusterLinkData(startClusterIndex + i, FS_FREECLUSTER);
+			}
 			
-			return (currentSectorOffset * 128) + j; // return free cluster index.
+			*allocedCount = 0;
+			k_unlock(&(g_fileSystemManager.allocMutex));
+			return FS_LASTCLUSTER;
 		}
 	}
 	
-	return FS_LASTCLUSTER;
+	g_fileSystemManager.lastAllocedClusterIndex = startClusterIndex + *allocedCount - 1;
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	return startClusterIndex;
 }
 
 static bool k_setClusterLinkData(dword clusterIndex, dword data) {
@@ -486,19 +1041,34 @@ static bool k_setClusterLinkData(dword clusterIndex, dword data) {
 		return false;
 	}
 	
+	k_lock(&(g_fileSystemManager.allocMutex));
+	
 	// read the sector.
-	if (k_readClusterLinkTable(sectorOffset, g_tempBuffer) == false) {
+	if (k_readClusterLinkTable(sectorOffset, g_clusterLinkBuffer) == false) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
 		return false;
 	}
 	
 	// set data to the cluster link.
-	((dword*)g_tempBuffer)[clusterIndex % 128] = data;
+	((dword*)g_clusterLinkBuffer)[clusterIndex % 128] = data;
 	
 	// write the sector.
-	if (k_writeClusterLinkTable(sectorOffset, g_tempBuffer) == false) {
+	if (k_writeClusterLinkTable(sectorOffset, g_clusterLinkBuffer) == false) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
+		return false;
+	}
+	
+	// update free cluster bitmap.
+	k_setFreeClusterBitmap(clusterIndex, (data == FS_FREECLUSTER) ? true : false);
+	
+	// If cluster is freed, discard it from journal (if it was directory cluster),
+	// so that the old directory cluster doesn't overwrite the cluster reused as file data at commit or replay.
+	if ((data == FS_FREECLUSTER) && (k_discardJournalBlock(FS_JOURNALBLOCK_DIRECTORY, clusterIndex) == false)) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
 		return false;
 	}
 	
+	k_unlock(&(g_fileSystemManager.allocMutex));
 	return true;
 }
 
@@ -515,239 +1085,949 @@ static bool k_getClusterLinkData(dword clusterIndex, dword* data) {
 		return false;
 	}
 	
+	k_lock(&(g_fileSystemManager.allocMutex));
+	
 	// read the sector.
-	if (k_readClusterLinkTable(sectorOffset, g_tempBuffer) == false) {
+	if (k_readClusterLinkTable(sectorOffset, g_clusterLinkBuffer) == false) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
 		return false;
 	}
 	
 	// get data from the cluster link.
-	*data = ((dword*)g_tempBuffer)[clusterIndex % 128];
+	*data = ((dword*)g_clusterLinkBuffer)[clusterIndex % 128];
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
 	return true;
 }
 
-static int k_findFreeDirEntry(void) {
+static dword k_findFreeDirEntry(dword dirClusterIndex, int* index) {
 	DirEntry* entry;
+	dword clusterIndex;
+	dword nextClusterIndex;
+	dword newClusterIndex;
 	int i;
 	
 	if (g_fileSystemManager.mounted == false) {
-		return -1;
+		return FS_LASTCLUSTER;
 	}
 	
-	// read root directory (cluster 0, 1 cluster-sized)
-	if (k_readCluster(0, g_tempBuffer) == false) {
-		return -1;
+	// search free directory entry (start cluster index=0x00) following the cluster chain of directory.
+	clusterIndex = dirClusterIndex;
+	while (true) {
+		if (k_readDirCluster(clusterIndex, g_tempBuffer) == false) {
+			return FS_LASTCLUSTER;
+		}
+		
+		entry = (DirEntry*)g_tempBuffer;
+		for (i = 0; i < FS_MAXDIRECTORYENTRYCOUNT; i++) {
+			if (entry[i].startClusterIndex == 0x00) {
+				*index = i;
+				return clusterIndex; // return directory cluster index which has free directory entry.
+			}
+		}
+		
+		if (k_getClusterLinkData(clusterIndex, &nextClusterIndex) == false) {
+			return FS_LASTCLUSTER;
+		}
+		
+		if (nextClusterIndex == FS_LASTCLUSTER) {
+			break;
+		}
+		
+		clusterIndex = nextClusterIndex;
 	}
 	
-	// search free directory entry (start cluster index=0x00) in root directory.
-	entry = (DirEntry*)g_tempBuffer;
-	for (i = 0; i < FS_MAXDIRECTORYENTRYCOUNT; i++) {
-		if (entry[i].startClusterIndex == 0x00) {
-			return i; // return free directory entry index.
-		}
+	// If all directory entries are used, link a new cluster to the last cluster of directory.
+	k_lock(&(g_fileSystemManager.allocMutex));
+	newClusterIndex = k_findFreeCluster();
+	if ((newClusterIndex == FS_LASTCLUSTER) || (k_setClusterLinkData(newClusterIndex, FS_LASTCLUSTER) == false)) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
+		return FS_LASTCLUSTER;
+	}
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	
+	if (k_setClusterLinkData(clusterIndex, newClusterIndex) == false) {
+		k_setClusterLinkData(newClusterIndex, FS_FREECLUSTER);
+		return FS_LASTCLUSTER;
 	}
 	
-	return -1;
+	// initialize new directory cluster as 0 (all directory entries are free).
+	k_memset(g_tempBuffer, 0, FS_CLUSTERSIZE);
+	if (k_writeDirCluster(newClusterIndex, g_tempBuffer) == false) {
+		return FS_LASTCLUSTER;
+	}
+	
+	*index = 0;
+	return newClusterIndex;
 }
 
-static bool k_setDirEntryData(int index, DirEntry* entry) {
-	DirEntry* rootEntry;
+static bool k_setDirEntryData(dword clusterIndex, int index, DirEntry* entry) {
+	DirEntry* dirEntry;
 	
 	if ((g_fileSystemManager.mounted == false) || (index < 0) || (index >= FS_MAXDIRECTORYENTRYCOUNT)) {
 		return false;
 	}
 	
-	// read root directory (cluster 0, 1 cluster-sized)
-	if (k_readCluster(0, g_tempBuffer) == false) {
+	// read directory cluster.
+	if (k_readDirCluster(clusterIndex, g_tempBuffer) == false) {
 		return false;
 	}
 	
-	// set to the directory entry of root directory.
-	rootEntry = (DirEntry*)g_tempBuffer;
-	k_memcpy(rootEntry + index, entry, sizeof(DirEntry));
+	// set to the directory entry of directory cluster.
+	dirEntry = (DirEntry*)g_tempBuffer;
+	k_memcpy(dirEntry + index, entry, sizeof(DirEntry));
 	
-	// write root directory (cluster 0, 1 cluster-sized)
-	if (k_writeCluster(0, g_tempBuffer) == false) {
+	// write directory cluster.
+	if (k_writeDirCluster(clusterIndex, g_tempBuffer) == false) {
 		return false;
 	}
 	
 	return true;
 }
 
-static bool k_getDirEntryData(int index, DirEntry* entry) {
-	DirEntry* rootEntry;
+static int k_findDirEntry(const char* path, DirEntry* entry) {
+	dword parentClusterIndex;
+	char fileName[FS_MAXFILENAMELENGTH];
+	int dentryIndex;
 	
-	if ((g_fileSystemManager.mounted == false) || (index < 0) || (index >= FS_MAXDIRECTORYENTRYCOUNT)) {
-		return false;
+	if (g_fileSystemManager.mounted == false) {
+		return -1;
 	}
 	
-	// read root directory (cluster 0, 1 cluster-sized)
-	if (k_readCluster(0, g_tempBuffer) == false) {
-		return false;
+	// resolve parent directory of path, and search dentry matching file name in dentry cache (no disk access).
+	if ((k_parsePath(path, &parentClusterIndex, fileName) == false) || (fileName[0] == '\0')) {
+		return -1;
 	}
 	
-	// get the directory entry of root directory.
-	rootEntry = (DirEntry*)g_tempBuffer;
-	k_memcpy(entry, rootEntry + index, sizeof(DirEntry));
+	dentryIndex = k_lookupDentry(parentClusterIndex, fileName);
+	if (dentryIndex == FS_INVALIDDENTRY) {
+		return -1;
+	}
 	
-	return true;
+	k_memcpy(entry, &(g_fileSystemManager.dentryPool[dentryIndex].entry), sizeof(DirEntry));
+	return dentryIndex; // return dentry index matching path.
 }
 
-static int k_findDirEntry(const char* fileName, DirEntry* entry) {
-	DirEntry* rootEntry;
-	int i;
+// parse path, and return the start cluster index of parent directory and the last name of path.
+// leading, trailing, consecutive path separators are ignored (ex: /apps//games/ = apps/games).
+// If path is root directory (/), file name is empty string and parent cluster index is root directory.
+static bool k_parsePath(const char* path, dword* parentClusterIndex, char* fileName) {
+	const char* name;
 	int len;
+	int dentryIndex;
+	Dentry* dentry;
 	
-	if (g_fileSystemManager.mounted == false) {
-		return -1;
+	if ((path == null) || (k_strlen(path) > (FS_MAXPATHLENGTH - 1))) {
+		return false;
 	}
 	
-	// read root directory (cluster 0, 1 cluster-sized)
-	if (k_readCluster(0, g_tempBuffer) == false) {
-		return -1;
+	*parentClusterIndex = FS_ROOTCLUSTER;
+	fileName[0] = '\0';
+	
+	while (*path == FS_PATHSEPARATOR) {
+		path++;
+	}
+	
+	while (*path != '\0') {
+		// get a name until next path separator.
+		name = path;
+		while ((*path != FS_PATHSEPARATOR) && (*path != '\0')) {
+			path++;
+		}
+		
+		len = path - name;
+		if (len > (FS_MAXFILENAMELENGTH - 1)) {
+			return false;
+		}
+		
+		k_memcpy(fileName, name, len);
+		fileName[len] = '\0';
+		
+		while (*path == FS_PATHSEPARATOR) {
+			path++;
+		}
+		
+		// If it's the last name, return it.
+		if (*path == '\0') {
+			break;
+		}
+		
+		// If it's not the last name, it must be a directory.
+		dentryIndex = k_lookupDentry(*parentClusterIndex, fileName);
+		if (dentryIndex == FS_INVALIDDENTRY) {
+			return false;
+		}
+		
+		dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+		if (dentry->entry.attribute != FS_ATTRIBUTE_DIRECTORY) {
+			return false;
+		}
+		
+		*parentClusterIndex = dentry->entry.startClusterIndex;
 	}
 	
-	len = k_strlen(fileName);
+	return true;
+}
+
+static bool k_isDirEmpty(dword dirClusterIndex) {
+	DirEntry* entry;
+	dword clusterIndex;
+	int i;
 	
-	// search directory entry matching file name in root directory.
-	rootEntry = (DirEntry*)g_tempBuffer;
-	for (i = 0; i < FS_MAXDIRECTORYENTRYCOUNT; i++) {
-		if (k_memcmp(rootEntry[i].fileName, fileName, len) == 0) {
-			k_memcpy(entry, rootEntry + i, sizeof(DirEntry));
-			return i; // return directory entry index matching file name.
+	// search used directory entry following the cluster chain of directory.
+	clusterIndex = dirClusterIndex;
+	while (clusterIndex != FS_LASTCLUSTER) {
+		if (k_readDirCluster(clusterIndex, g_tempBuffer) == false) {
+			return false;
+		}
+		
+		entry = (DirEntry*)g_tempBuffer;
+		for (i = 0; i < FS_MAXDIRECTORYENTRYCOUNT; i++) {
+			if (entry[i].startClusterIndex != 0x00) {
+				return false;
+			}
+		}
+		
+		if (k_getClusterLinkData(clusterIndex, &clusterIndex) == false) {
+			return false;
 		}
 	}
 	
-	return -1;
+	return true;
 }
 
 void k_getFileSystemInfo(FileSystemManager* manager) {
 	k_memcpy(manager, &g_fileSystemManager, sizeof(g_fileSystemManager));
 }
 
-static void* k_allocFileDirHandle(void) {
-	int i;
-	File* file;
+bool k_getFragmentationInfo(FragmentationInfo* info) {
+	DirEntry* entry;
+	dword clusterIndex, nextClusterIndex;
+	dword extentCount;
+	dword freeExtentSize;
+	dword i;
 	
-	// search handle pool, and return free handle.
-	file = g_fileSystemManager.handlePool;
-	for (i = 0; i < FS_HANDLE_MAXCOUNT; i++) {
-		// If it's free handle.
-		if (file->type == FS_TYPE_FREE) {
-			// set it to file handle.
-			file->type = FS_TYPE_FILE;
-			return file;
+	k_memset(info, 0, sizeof(FragmentationInfo));
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	if (g_fileSystemManager.mounted == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return false;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// count extents of each file by following its cluster chain.
+	// A new extent starts whenever the next cluster isn't contiguous to the current cluster.
+	//----------------------------------------------------------------------------------------------------
+	for (i = 0; i < g_fileSystemManager.dentryMaxCount; i++) {
+		entry = &(g_fileSystemManager.dentryPool[i].entry);
+		if ((entry->startClusterIndex == 0) || (entry->attribute != FS_ATTRIBUTE_FILE)) {
+			continue;
+		}
+		
+		extentCount = 1;
+		clusterIndex = entry->startClusterIndex;
+		while (k_getClusterLinkData(clusterIndex, &nextClusterIndex) == true) {
+			if (nextClusterIndex == FS_LASTCLUSTER) {
+				break;
+			}
+			
+			if (nextClusterIndex != (clusterIndex + 1)) {
+				extentCount++;
+			}
+			
+			clusterIndex = nextClusterIndex;
 		}
 		
-		file++;
+		info->fileCount++;
+		info->fileExtentCount += extentCount;
+		info->maxFileExtentCount = MAX(info->maxFileExtentCount, extentCount);
+		if (extentCount > 1) {
+			info->fragmentedFileCount++;
+		}
 	}
 	
-	return null;
-}
-
-static void k_freeFileDirHandle(File* file) {
-	// initialize file handle.
-	k_memset(file, 0, sizeof(File));
+	//----------------------------------------------------------------------------------------------------
+	// count free extents in free cluster bitmap.
+	//----------------------------------------------------------------------------------------------------
+	k_lock(&(g_fileSystemManager.allocMutex));
 	
-	// set it to free handle.
-	file->type = FS_TYPE_FREE;
+	freeExtentSize = 0;
+	for (i = 0; i < g_fileSystemManager.totalClusterCount; i++) {
+		if (k_isFreeCluster(i) == true) {
+			if (freeExtentSize == 0) {
+				info->freeExtentCount++;
+			}
+			
+			freeExtentSize++;
+			info->maxFreeExtentSize = MAX(info->maxFreeExtentSize, freeExtentSize);
+			
+		} else {
+			freeExtentSize = 0;
+		}
+	}
+	
+	info->freeClusterCount = g_fileSystemManager.freeClusterCount;
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	k_unlock(&(g_fileSystemManager.mutex));
+	return true;
 }
 
-static bool k_createFile(const char* fileName, DirEntry* entry, int* dirEntryIndex) {
-	dword cluster; // free cluster index
+static bool k_initDentryCache(int maxCount) {
+	int i;
 	
-	// search free cluster, and set it to allocated cluster (last cluster)
-	cluster = k_findFreeCluster();
-	if ((cluster == FS_LASTCLUSTER) || (k_setClusterLinkData(cluster, FS_LASTCLUSTER) == false)) {
-		return false;
+	// free the dentry cache of previous mount.
+	if (g_fileSystemManager.dentryPool != null) {
+		k_freeMem(g_fileSystemManager.dentryPool);
+		g_fileSystemManager.dentryPool = null;
 	}
 	
-	// search free directory entry.
-	*dirEntryIndex = k_findFreeDirEntry();
-	if (*dirEntryIndex == -1) {
-		// If fails, free the allocated cluster.
-		k_setClusterLinkData(cluster, FS_FREECLUSTER);
-		return false;
+	if (g_fileSystemManager.dentryHashTable != null) {
+		k_freeMem(g_fileSystemManager.dentryHashTable);
+		g_fileSystemManager.dentryHashTable = null;
 	}
 	
-	// set directory entry.
-	k_memcpy(entry->fileName, fileName, k_strlen(fileName) + 1);
-	entry->fileSize = 0;
-	entry->startClusterIndex = cluster;
-	
-	// register directory entry.
-	if (k_setDirEntryData(*dirEntryIndex, entry) == false) {
-		// If fails, free the allocated cluster.
-		k_setClusterLinkData(cluster, FS_FREECLUSTER);
+	// allocate dentry pool and hash table.
+	g_fileSystemManager.dentryPool = (Dentry*)k_allocMem(sizeof(Dentry) * maxCount);
+	g_fileSystemManager.dentryHashTable = (int*)k_allocMem(sizeof(int) * maxCount);
+	if ((g_fileSystemManager.dentryPool == null) || (g_fileSystemManager.dentryHashTable == null)) {
+		if (g_fileSystemManager.dentryPool != null) {
+			k_freeMem(g_fileSystemManager.dentryPool);
+			g_fileSystemManager.dentryPool = null;
+		}
+		
+		if (g_fileSystemManager.dentryHashTable != null) {
+			k_freeMem(g_fileSystemManager.dentryHashTable);
+			g_fileSystemManager.dentryHashTable = null;
+		}
+		
 		return false;
 	}
 	
+	// initialize all hash buckets as empty, and link all dentries to free dentry list.
+	k_memset(g_fileSystemManager.dentryPool, 0, sizeof(Dentry) * maxCount);
+	for (i = 0; i < maxCount; i++) {
+		g_fileSystemManager.dentryHashTable[i] = FS_INVALIDDENTRY;
+		g_fileSystemManager.dentryPool[i].next = (i == (maxCount - 1)) ? FS_INVALIDDENTRY : (i + 1);
+	}
+	
+	g_fileSystemManager.dentryMaxCount = maxCount;
+	g_fileSystemManager.dentryCount = 0;
+	g_fileSystemManager.freeDentryIndex = 0;
+	
 	return true;
 }
 
-static bool k_freeClusterUntilEnd(dword clusterIndex) {
-	dword currentClusterIndex;
-	dword nextClusterIndex;
+static bool k_buildDentryCache(void) {
+	DirEntry* entry;
+	dword dirClusterIndex;
+	dword clusterIndex;
+	int dentryIndex;
+	int i;
 	
-	currentClusterIndex = clusterIndex;
+	if (k_initDentryCache(FS_MINDENTRYCOUNT) == false) {
+		return false;
+	}
 	
-	// free all clusters of file from parameter cluster to last cluster.
-	while (currentClusterIndex != FS_LASTCLUSTER) {
+	//----------------------------------------------------------------------------------------------------
+	// walk all directories from root directory in breadth-first order.
+	// dentries are allocated in order from free dentry list while building,
+	// so dentry pool itself works as the queue of directories to walk.
+	//----------------------------------------------------------------------------------------------------
+	dirClusterIndex = FS_ROOTCLUSTER;
+	dentryIndex = 0;
+	while (true) {
+		// add all directory entries of a directory to dentry cache.
+		clusterIndex = dirClusterIndex;
+		while (clusterIndex != FS_LASTCLUSTER) {
+			if (k_readDirCluster(clusterIndex, g_tempBuffer) == false) {
+				return false;
+			}
+			
+			entry = (DirEntry*)g_tempBuffer;
+			for (i = 0; i < FS_MAXDIRECTORYENTRYCOUNT; i++) {
+				if ((entry[i].startClusterIndex == 0x00) || (entry[i].startClusterIndex >= g_fileSystemManager.totalClusterCount)) {
+					continue;
+				}
+				
+				if (k_addDentry(dirClusterIndex, clusterIndex, i, entry + i) == FS_INVALIDDENTRY) {
+					return false;
+				}
+			}
+			
+			if (k_getClusterLinkData(clusterIndex, &clusterIndex) == false) {
+				return false;
+			}
+		}
 		
-		// get next cluster index.
-		if (k_getClusterLinkData(currentClusterIndex, &nextClusterIndex) == false) {
-			return false;
+		// move to next directory.
+		while ((dentryIndex < g_fileSystemManager.dentryCount) && (g_fileSystemManager.dentryPool[dentryIndex].entry.attribute != FS_ATTRIBUTE_DIRECTORY)) {
+			dentryIndex++;
 		}
 		
-		// free current cluster.
-		if (k_setClusterLinkData(currentClusterIndex, FS_FREECLUSTER) == false) {
-			return false;
+		if (dentryIndex >= g_fileSystemManager.dentryCount) {
+			break;
 		}
 		
-		// move to next cluster.
-		currentClusterIndex = nextClusterIndex;
+		dirClusterIndex = g_fileSystemManager.dentryPool[dentryIndex++].entry.startClusterIndex;
 	}
 	
 	return true;
 }
 
-static bool k_updateDirEntry(FileHandle* fileHandle) {
-	DirEntry entry;
+static bool k_growDentryCache(void) {
+	Dentry* newPool;
+	int* newHashTable;
+	int newMaxCount;
+	dword bucket;
+	int i;
 	
-	// get directory entry.
-	if ((fileHandle == null) || (k_getDirEntryData(fileHandle->dirEntryOffset, &entry) == false)) {
+	// double dentry pool and hash table.
+	newMaxCount = g_fileSystemManager.dentryMaxCount * 2;
+	newPool = (Dentry*)k_allocMem(sizeof(Dentry) * newMaxCount);
+	newHashTable = (int*)k_allocMem(sizeof(int) * newMaxCount);
+	if ((newPool == null) || (newHashTable == null)) {
+		if (newPool != null) {
+			k_freeMem(newPool);
+		}
+		
+		if (newHashTable != null) {
+			k_freeMem(newHashTable);
+		}
+		
 		return false;
 	}
 	
-	// update file size, start cluster index.
-	entry.fileSize = fileHandle->fileSize;
-	entry.startClusterIndex = fileHandle->startClusterIndex;
+	// copy old dentries (dentry index doesn't change), and link new dentries to free dentry list.
+	k_memset(newPool, 0, sizeof(Dentry) * newMaxCount);
+	k_memcpy(newPool, g_fileSystemManager.dentryPool, sizeof(Dentry) * g_fileSystemManager.dentryMaxCount);
+	for (i = g_fileSystemManager.dentryMaxCount; i < newMaxCount; i++) {
+		newPool[i].next = (i == (newMaxCount - 1)) ? FS_INVALIDDENTRY : (i + 1);
+	}
 	
-	// set directory entry.
-	if (k_setDirEntryData(fileHandle->dirEntryOffset, &entry) == false) {
-		return false;
+	// rehash all used dentries, because bucket count changes.
+	for (i = 0; i < newMaxCount; i++) {
+		newHashTable[i] = FS_INVALIDDENTRY;
 	}
 	
+	for (i = 0; i < g_fileSystemManager.dentryMaxCount; i++) {
+		if (newPool[i].entry.startClusterIndex == 0x00) {
+			continue;
+		}
+		
+		bucket = k_hashDentry(newPool[i].parentClusterIndex, newPool[i].entry.fileName) & (newMaxCount - 1);
+		newPool[i].next = newHashTable[bucket];
+		newHashTable[bucket] = i;
+	}
+	
+	k_freeMem(g_fileSystemManager.dentryPool);
+	k_freeMem(g_fileSystemManager.dentryHashTable);
+	
+	// growing happens only when free dentry list is empty, so new dentries become free dentry list.
+	g_fileSystemManager.freeDentryIndex = g_fileSystemManager.dentryMaxCount;
+	g_fileSystemManager.dentryPool = newPool;
+	g_fileSystemManager.dentryHashTable = newHashTable;
+	g_fileSystemManager.dentryMaxCount = newMaxCount;
+	
 	return true;
 }
 
-/**
-  ====================================================================================================
-   < k_openFile Function's File Open Mode (mode) >
-  ====================================================================================================
-   File Open Mode  | Description
-  ----------------------------------------------------------------------------------------------------
-   "r"      | - read mode
-            | - If file doesn't exist, open fails
-  ----------------------------------------------------------------------------------------------------
-   "w"      | - write mode
-            | - If file doesn't exist, create file. If file exists, flush file.
-  ----------------------------------------------------------------------------------------------------
-   "a"      | - append mode
-            | - If file doesn't exist, create file. If file exists, move to the end of file.
-  ----------------------------------------------------------------------------------------------------
-   "r+"     | - read write mode
-            | - the same as "r" mode except writing is possible.
-  ----------------------------------------------------------------------------------------------------
+static dword k_hashDentry(dword parentClusterIndex, const char* fileName) {
+	dword hash;
+	int i;
+	
+	// FNV-1a hash of parent directory cluster index and file name.
+	hash = 2166136261;
+	for (i = 0; i < 4; i++) {
+		hash = (hash ^ ((parentClusterIndex >> (i * 8)) & 0xFF)) * 16777619;
+	}
+	
+	for (i = 0; (i < (FS_MAXFILENAMELENGTH - 1)) && (fileName[i] != '\0'); i++) {
+		hash = (hash ^ (byte)fileName[i]) * 16777619;
+	}
+	
+	return hash;
+}
+
+static int k_lookupDentry(dword parentClusterIndex, const char* fileName) {
+	Dentry* dentry;
+	int dentryIndex;
+	
+	if (g_fileSystemManager.dentryPool == null) {
+		return FS_INVALIDDENTRY;
+	}
+	
+	// search dentry in hash bucket chain.
+	dentryIndex = g_fileSystemManager.dentryHashTable[k_hashDentry(parentClusterIndex, fileName) & (g_fileSystemManager.dentryMaxCount - 1)];
+	while (dentryIndex != FS_INVALIDDENTRY) {
+		dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+		if ((dentry->parentClusterIndex == parentClusterIndex) && (k_equalStr(dentry->entry.fileName, fileName) == true)) {
+			return dentryIndex;
+		}
+		
+		dentryIndex = dentry->next;
+	}
+	
+	return FS_INVALIDDENTRY;
+}
+
+static int k_addDentry(dword parentClusterIndex, dword clusterIndex, int index, const DirEntry* entry) {
+	Dentry* dentry;
+	int dentryIndex;
+	dword bucket;
+	
+	// If free dentry doesn't exist, grow dentry cache.
+	if ((g_fileSystemManager.freeDentryIndex == FS_INVALIDDENTRY) && (k_growDentryCache() == false)) {
+		return FS_INVALIDDENTRY;
+	}
+	
+	// allocate dentry from free dentry list.
+	dentryIndex = g_fileSystemManager.freeDentryIndex;
+	dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+	g_fileSystemManager.freeDentryIndex = dentry->next;
+	
+	// set dentry, and terminate file name with null character always.
+	k_memcpy(&(dentry->entry), entry, sizeof(DirEntry));
+	dentry->entry.fileName[FS_MAXFILENAMELENGTH - 1] = '\0';
+	dentry->parentClusterIndex = parentClusterIndex;
+	dentry->clusterIndex = clusterIndex;
+	dentry->index = index;
+	
+	// insert dentry to the head of hash bucket chain.
+	bucket = k_hashDentry(parentClusterIndex, dentry->entry.fileName) & (g_fileSystemManager.dentryMaxCount - 1);
+	dentry->next = g_fileSystemManager.dentryHashTable[bucket];
+	g_fileSystemManager.dentryHashTable[bucket] = dentryIndex;
+	g_fileSystemManager.dentryCount++;
+	
+	return dentryIndex;
+}
+
+static void k_removeDentry(int dentryIndex) {
+	Dentry* dentry;
+	int* link;
+	
+	if ((dentryIndex < 0) || (dentryIndex >= g_fileSystemManager.dentryMaxCount)) {
+		return;
+	}
+	
+	dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+	
+	// unlink dentry from hash bucket chain.
+	link = &(g_fileSystemManager.dentryHashTable[k_hashDentry(dentry->parentClusterIndex, dentry->entry.fileName) & (g_fileSystemManager.dentryMaxCount - 1)]);
+	while (*link != FS_INVALIDDENTRY) {
+		if (*link == dentryIndex) {
+			*link = dentry->next;
+			break;
+		}
+		
+		link = &(g_fileSystemManager.dentryPool[*link].next);
+	}
+	
+	// return dentry to free dentry list.
+	k_memset(dentry, 0, sizeof(Dentry));
+	dentry->next = g_fileSystemManager.freeDentryIndex;
+	g_fileSystemManager.freeDentryIndex = dentryIndex;
+	g_fileSystemManager.dentryCount--;
+}
+
+static void* k_allocFileDirHandle(void) {
+	File* file;
+	
+	// pop free handle from free list of handle pool.
+	file = (File*)k_allocPool(&(g_fileSystemManager.handlePool));
+	if (file == null) {
+		return null;
+	}
+	
+	// set it to file handle.
+	file->type = FS_TYPE_FILE;
+	file->next = POOL_INVALIDINDEX;
+	
+	return file;
+}
+
+static void k_freeFileDirHandle(File* file) {
+	// initialize file handle.
+	k_memset(file, 0, sizeof(File));
+	
+	// set it to free handle, and push it to free list of handle pool.
+	file->type = FS_TYPE_FREE;
+	k_freePool(&(g_fileSystemManager.handlePool), file);
+}
+
+static void k_addOpenHandle(File* file) {
+	dword startClusterIndex;
+	dword bucket;
+	
+	startClusterIndex = (file->type == FS_TYPE_FILE) ? file->fileHandle.startClusterIndex : file->dirHandle.startClusterIndex;
+	
+	// insert handle to the head of open handle hash bucket chain.
+	bucket = startClusterIndex & (FS_OPENHASHCOUNT - 1);
+	file->next = g_fileSystemManager.openHashTable[bucket];
+	g_fileSystemManager.openHashTable[bucket] = k_getPoolIndex(&(g_fileSystemManager.handlePool), file);
+}
+
+static void k_removeOpenHandle(File* file) {
+	dword startClusterIndex;
+	int handleIndex;
+	int* link;
+	
+	startClusterIndex = (file->type == FS_TYPE_FILE) ? file->fileHandle.startClusterIndex : file->dirHandle.startClusterIndex;
+	handleIndex = k_getPoolIndex(&(g_fileSystemManager.handlePool), file);
+	
+	// unlink handle from open handle hash bucket chain.
+	link = &(g_fileSystemManager.openHashTable[startClusterIndex & (FS_OPENHASHCOUNT - 1)]);
+	while (*link != POOL_INVALIDINDEX) {
+		if (*link == handleIndex) {
+			*link = file->next;
+			break;
+		}
+		
+		link = &(((File*)k_getPoolData(&(g_fileSystemManager.handlePool), *link))->next);
+	}
+	
+	file->next = POOL_INVALIDINDEX;
+}
+
+static File* k_findOpenHandle(byte type, dword startClusterIndex) {
+	File* file;
+	int handleIndex;
+	dword handleClusterIndex;
+	
+	// search handle in open handle hash bucket chain.
+	handleIndex = g_fileSystemManager.openHashTable[startClusterIndex & (FS_OPENHASHCOUNT - 1)];
+	while (handleIndex != POOL_INVALIDINDEX) {
+		file = (File*)k_getPoolData(&(g_fileSystemManager.handlePool), handleIndex);
+		handleClusterIndex = (file->type == FS_TYPE_FILE) ? file->fileHandle.startClusterIndex : file->dirHandle.startClusterIndex;
+		if ((file->type == type) && (handleClusterIndex == startClusterIndex)) {
+			return file;
+		}
+		
+		handleIndex = file->next;
+	}
+	
+	return null;
+}
+
+static void k_truncateOpenFileHandles(dword startClusterIndex) {
+	File* file;
+	FileHandle* fileHandle;
+	int handleIndex;
+	
+	// invalidate extent maps of all open handles of the truncated file, and move their file pointers to the start of file.
+	// [NOTE] File lock of the file must be held, because handles might be reading/writing it.
+	handleIndex = g_fileSystemManager.openHashTable[startClusterIndex & (FS_OPENHASHCOUNT - 1)];
+	while (handleIndex != POOL_INVALIDINDEX) {
+		file = (File*)k_getPoolData(&(g_fileSystemManager.handlePool), handleIndex);
+		fileHandle = &(file->fileHandle);
+		if ((file->type == FS_TYPE_FILE) && (fileHandle->startClusterIndex == startClusterIndex)) {
+			fileHandle->extentCount = 0;
+			fileHandle->mappedClusterCount = 0;
+			fileHandle->fileSize = 0;
+			fileHandle->currentOffset = 0;
+			fileHandle->currentClusterIndex = startClusterIndex;
+			fileHandle->prevClusterIndex = startClusterIndex;
+		}
+		
+		handleIndex = file->next;
+	}
+}
+
+static int k_createFile(const char* path, byte attribute, DirEntry* entry) {
+	dword parentClusterIndex; // start cluster index of parent directory
+	char fileName[FS_MAXFILENAMELENGTH];
+	dword cluster;            // free cluster index
+	dword dirClusterIndex;    // directory cluster index which has free directory entry
+	int index;                // free directory entry index in directory cluster
+	int dentryIndex;
+	
+	// resolve parent directory, and check if the name already exists.
+	if ((k_parsePath(path, &parentClusterIndex, fileName) == false) || (fileName[0] == '\0') ||
+	    (k_lookupDentry(parentClusterIndex, fileName) != FS_INVALIDDENTRY)) {
+		return -1;
+	}
+	
+	// search free cluster, and set it to allocated cluster (last cluster)
+	k_lock(&(g_fileSystemManager.allocMutex));
+	cluster = k_findFreeCluster();
+	if ((cluster == FS_LASTCLUSTER) || (k_setClusterLinkData(cluster, FS_LASTCLUSTER) == false)) {
+		k_unlock(&(g_fileSystemManager.allocMutex));
+		return -1;
+	}
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	
+	// initialize the first cluster of directory as 0 (all directory entries are free).
+	if (attribute == FS_ATTRIBUTE_DIRECTORY) {
+		k_memset(g_tempBuffer, 0, FS_CLUSTERSIZE);
+		if (k_writeDirCluster(cluster, g_tempBuffer) == false) {
+			k_setClusterLinkData(cluster, FS_FREECLUSTER);
+			return -1;
+		}
+	}
+	
+	// search free directory entry in parent directory (parent directory grows if it's full).
+	dirClusterIndex = k_findFreeDirEntry(parentClusterIndex, &index);
+	if (dirClusterIndex == FS_LASTCLUSTER) {
+		// If fails, free the allocated cluster.
+		k_setClusterLinkData(cluster, FS_FREECLUSTER);
+		return -1;
+	}
+	
+	// set directory entry.
+	k_memset(entry, 0, sizeof(DirEntry));
+	k_memcpy(entry->fileName, fileName, k_strlen(fileName) + 1);
+	entry->attribute = attribute;
+	entry->fileSize = 0;
+	entry->startClusterIndex = cluster;
+	
+	// register directory entry.
+	if (k_setDirEntryData(dirClusterIndex, index, entry) == false) {
+		// If fails, free the allocated cluster.
+		k_setClusterLinkData(cluster, FS_FREECLUSTER);
+		return -1;
+	}
+	
+	// add directory entry to dentry cache.
+	dentryIndex = k_addDentry(parentClusterIndex, dirClusterIndex, index, entry);
+	if (dentryIndex == FS_INVALIDDENTRY) {
+		// If fails, unregister directory entry, and free the allocated cluster.
+		k_memset(entry, 0, sizeof(DirEntry));
+		k_setDirEntryData(dirClusterIndex, index, entry);
+		k_setClusterLinkData(cluster, FS_FREECLUSTER);
+		return -1;
+	}
+	
+	return dentryIndex;
+}
+
+static bool k_freeClusterUntilEnd(dword clusterIndex) {
+	dword currentClusterIndex;
+	dword nextClusterIndex;
+	
+	currentClusterIndex = clusterIndex;
+	
+	k_lock(&(g_fileSystemManager.allocMutex));
+	
+	// free all clusters of file from parameter cluster to last cluster.
+	while (currentClusterIndex != FS_LASTCLUSTER) {
+		
+		// get next cluster index.
+		if (k_getClusterLinkData(currentClusterIndex, &nextClusterIndex) == false) {
+			k_unlock(&(g_fileSystemManager.allocMutex));
+			return false;
+		}
+		
+		// free current cluster.
+		if (k_setClusterLinkData(currentClusterIndex, FS_FREECLUSTER) == false) {
+			k_unlock(&(g_fileSystemManager.allocMutex));
+			return false;
+		}
+		
+		// move to next cluster.
+		currentClusterIndex = nextClusterIndex;
+	}
+	
+	k_unlock(&(g_fileSystemManager.allocMutex));
+	return true;
+}
+
+static bool k_addFileExtent(FileHandle* fileHandle, dword clusterIndex) {
+	FileExtent* lastExtent;
+	FileExtent* newExtentMap;
+	dword newMaxCount;
+	
+	// If cluster is contiguous to the last extent, extend the last extent.
+	if (fileHandle->extentCount > 0) {
+		lastExtent = &(fileHandle->extentMap[fileHandle->extentCount - 1]);
+		if ((lastExtent->clusterIndex + lastExtent->clusterCount) == clusterIndex) {
+			lastExtent->clusterCount++;
+			fileHandle->mappedClusterCount++;
+			return true;
+		}
+	}
+	
+	// If extent map is full, allocate double-sized extent map, and copy extents to it.
+	if (fileHandle->extentCount == fileHandle->extentMaxCount) {
+		newMaxCount = (fileHandle->extentMaxCount == 0) ? FS_MINEXTENTMAPCOUNT : (fileHandle->extentMaxCount * 2);
+		newExtentMap = (FileExtent*)k_allocMem(newMaxCount * sizeof(FileExtent));
+		if (newExtentMap == null) {
+			return false;
+		}
+		
+		if (fileHandle->extentMap != null) {
+			k_memcpy(newExtentMap, fileHandle->extentMap, fileHandle->extentCount * sizeof(FileExtent));
+			k_freeMem(fileHandle->extentMap);
+		}
+		
+		fileHandle->extentMap = newExtentMap;
+		fileHandle->extentMaxCount = newMaxCount;
+	}
+	
+	// add new extent.
+	fileHandle->extentMap[fileHandle->extentCount].clusterOffset = fileHandle->mappedClusterCount;
+	fileHandle->extentMap[fileHandle->extentCount].clusterIndex = clusterIndex;
+	fileHandle->extentMap[fileHandle->extentCount].clusterCount = 1;
+	fileHandle->extentCount++;
+	fileHandle->mappedClusterCount++;
+	
+	return true;
+}
+
+static bool k_extendFileExtentMap(FileHandle* fileHandle, dword clusterOffset) {
+	FileExtent* lastExtent;
+	dword nextClusterIndex;
+	
+	// add start cluster first.
+	if ((fileHandle->mappedClusterCount == 0) && (k_addFileExtent(fileHandle, fileHandle->startClusterIndex) == false)) {
+		return false;
+	}
+	
+	// follow cluster chain from the last mapped cluster until extent map covers the cluster offset.
+	// [NOTE] Extent map is always a prefix of cluster chain, because clusters of open file are only appended,
+	//        and extent maps of open handles are invalidated when the file is truncated by opening it with "w" mode.
+	while (fileHandle->mappedClusterCount <= clusterOffset) {
+		lastExtent = &(fileHandle->extentMap[fileHandle->extentCount - 1]);
+		if (k_getClusterLinkData(lastExtent->clusterIndex + lastExtent->clusterCount - 1, &nextClusterIndex) == false) {
+			return false;
+		}
+		
+		// If it's the end of cluster chain, stop.
+		if (nextClusterIndex == FS_LASTCLUSTER) {
+			return false;
+		}
+		
+		if (k_addFileExtent(fileHandle, nextClusterIndex) == false) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+static bool k_findClusterInExtentMap(FileHandle* fileHandle, dword clusterOffset, dword* clusterIndex, dword* prevClusterIndex) {
+	FileExtent* extent;
+	int low, high, middle;
+	
+	// If extent map doesn't cover the cluster offset, extend it.
+	if (clusterOffset >= fileHandle->mappedClusterCount) {
+		k_extendFileExtentMap(fileHandle, clusterOffset);
+		
+		if (fileHandle->mappedClusterCount == 0) {
+			return false;
+		}
+		
+		// If cluster chain ends right before the cluster offset, it's the position to append new cluster.
+		if (clusterOffset == fileHandle->mappedClusterCount) {
+			extent = &(fileHandle->extentMap[fileHandle->extentCount - 1]);
+			*clusterIndex = FS_LASTCLUSTER;
+			*prevClusterIndex = extent->clusterIndex + extent->clusterCount - 1;
+			return true;
+		}
+		
+		if (clusterOffset > fileHandle->mappedClusterCount) {
+			return false;
+		}
+	}
+	
+	// binary search the last extent which starts at or before the cluster offset.
+	low = 0;
+	high = fileHandle->extentCount - 1;
+	while (low < high) {
+		middle = (low + high + 1) / 2;
+		if (fileHandle->extentMap[middle].clusterOffset <= clusterOffset) {
+			low = middle;
+			
+		} else {
+			high = middle - 1;
+		}
+	}
+	
+	extent = &(fileHandle->extentMap[low]);
+	*clusterIndex = extent->clusterIndex + (clusterOffset - extent->clusterOffset);
+	
+	// previous cluster is start cluster (at the start of file), the previous cluster in the same extent, or the last cluster of the previous extent.
+	if (clusterOffset == 0) {
+		*prevClusterIndex = fileHandle->startClusterIndex;
+		
+	} else if (clusterOffset > extent->clusterOffset) {
+		*prevClusterIndex = *clusterIndex - 1;
+		
+	} else {
+		*prevClusterIndex = fileHandle->extentMap[low - 1].clusterIndex + fileHandle->extentMap[low - 1].clusterCount - 1;
+	}
+	
+	return true;
+}
+
+static void k_freeFileExtentMap(FileHandle* fileHandle) {
+	if (fileHandle->extentMap != null) {
+		k_freeMem(fileHandle->extentMap);
+	}
+	
+	fileHandle->extentMap = null;
+	fileHandle->extentCount = 0;
+	fileHandle->extentMaxCount = 0;
+	fileHandle->mappedClusterCount = 0;
+}
+
+static Mutex* k_getFileLock(FileHandle* fileHandle) {
+	// select file lock by start cluster index, so that all handles of the same file share a lock.
+	return &(g_fileSystemManager.fileLocks[fileHandle->startClusterIndex % FS_FILELOCKCOUNT]);
+}
+
+static byte* k_getFileClusterBuffer(FileHandle* fileHandle) {
+	// allocate scratch cluster buffer of handle at first use, so that handles don't share a temporary buffer.
+	if (fileHandle->clusterBuffer == null) {
+		fileHandle->clusterBuffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
+	}
+	
+	return fileHandle->clusterBuffer;
+}
+
+static bool k_updateDirEntry(FileHandle* fileHandle) {
+	Dentry* dentry;
+	
+	// get dentry.
+	if ((fileHandle == null) || (fileHandle->dentryIndex < 0) || (fileHandle->dentryIndex >= g_fileSystemManager.dentryMaxCount)) {
+		return false;
+	}
+	
+	dentry = &(g_fileSystemManager.dentryPool[fileHandle->dentryIndex]);
+	
+	// update file size, start cluster index.
+	dentry->entry.fileSize = fileHandle->fileSize;
+	dentry->entry.startClusterIndex = fileHandle->startClusterIndex;
+	
+	// write through directory entry.
+	if (k_setDirEntryData(dentry->clusterIndex, dentry->index, &(dentry->entry)) == false) {
+		return false;
+	}
+	
+	return true;
+}
+
+/**
+  ====================================================================================================
+   < k_openFile Function's File Open Mode (mode) >
+  ====================================================================================================
+   File Open Mode  | Description
+  ----------------------------------------------------------------------------------------------------
+   "r"      | - read mode
+            | - If file doesn't exist, open fails
+  ----------------------------------------------------------------------------------------------------
+   "w"      | - write mode
+            | - If file doesn't exist, create file. If file exists, flush file.
+  ----------------------------------------------------------------------------------------------------
+   "a"      | - append mode
+            | - If file doesn't exist, create file. If file exists, move to the end of file.
+  ----------------------------------------------------------------------------------------------------
+   "r+"     | - read write mode
+            | - the same as "r" mode except writing is possible.
+  ----------------------------------------------------------------------------------------------------
    "w+"     | - write read mode
             | - the same as "w" mode except reading is possible.
   ----------------------------------------------------------------------------------------------------
@@ -757,14 +2037,16 @@ static bool k_updateDirEntry(FileHandle* fileHandle) {
  */
 File* k_openFile(const char* fileName, const char* mode) {
 	DirEntry entry;      // directory entry of open file
-	int dirEntryOffset;  // directory entry offset of open file
-	int fileNameLen;     // file name length
+	int dentryIndex;     // dentry index of open file
+	int fileNameLen;     // file name length (path length)
 	dword secondCluster; // second cluster index of open file
+	Dentry* dentry;      // dentry of open file
+	Mutex* fileLock;     // file lock of open file
 	File* file;          // file handle to return
 	
 	// check file name length
 	fileNameLen = k_strlen(fileName);
-	if ((fileNameLen > (sizeof(entry.fileName) - 1)) || (fileNameLen == 0)) {
+	if ((fileNameLen > (FS_MAXPATHLENGTH - 1)) || (fileNameLen == 0)) {
 		return null;
 	}
 	
@@ -776,10 +2058,10 @@ File* k_openFile(const char* fileName, const char* mode) {
 	//----------------------------------------------------------------------------------------------------
 	
 	// search directory entry matching file name.
-	dirEntryOffset = k_findDirEntry(fileName, &entry);
+	dentryIndex = k_findDirEntry(fileName, &entry);
 	
 	// If file doesn't exist.
-	if (dirEntryOffset == -1) {
+	if (dentryIndex == -1) {
 		
 		// If it's read-related mode (r, r+), open fails.
 		if (mode[0] == 'r') {
@@ -788,38 +2070,63 @@ File* k_openFile(const char* fileName, const char* mode) {
 		}
 		
 		// If it's other mode (w, w+, a, a+), create file.
-		if (k_createFile(fileName, &entry, &dirEntryOffset) == false) {
+		dentryIndex = k_createFile(fileName, FS_ATTRIBUTE_FILE, &entry);
+		if (dentryIndex == -1) {
 			k_unlock(&(g_fileSystemManager.mutex));
 			return null;
 		}
 		
+	// If it's directory, open fails.
+	} else if (entry.attribute == FS_ATTRIBUTE_DIRECTORY) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+		
+	// If file is mapped, write-related mode (w, w+, a, a+, r+) fails, because mapped view must not change.
+	} else if (((mode[0] != 'r') || (mode[1] == '+') || ((mode[1] != '\0') && (mode[2] == '+'))) && (k_findFileMapping(entry.startClusterIndex) != null)) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+		
 	//----------------------------------------------------------------------------------------------------
 	// If write-related mode (w, w+), flush file.
 	// free all clusters of file except start cluster, set file size to 0.
 	//----------------------------------------------------------------------------------------------------
 	} else if (mode[0] == 'w') {
 		
+		// lock file while freeing its clusters, because another handle of the file might be reading/writing it.
+		fileLock = &(g_fileSystemManager.fileLocks[entry.startClusterIndex % FS_FILELOCKCOUNT]);
+		k_lock(fileLock);
+		
 		// get second cluster index.
 		if (k_getClusterLinkData(entry.startClusterIndex, &secondCluster) == false) {
+			k_unlock(fileLock);
 			k_unlock(&(g_fileSystemManager.mutex));
 			return null;
 		}
 		
 		// set start cluster to last cluster.
 		if (k_setClusterLinkData(entry.startClusterIndex, FS_LASTCLUSTER) == false) {
+			k_unlock(fileLock);
 			k_unlock(&(g_fileSystemManager.mutex));
 			return null;
 		}
 		
 		// free all clusters from second cluster to last cluster.
 		if (k_freeClusterUntilEnd(secondCluster) == false) {
+			k_unlock(fileLock);
 			k_unlock(&(g_fileSystemManager.mutex));
 			return null;
 		}
 		
+		// other handles of the file must not use freed clusters, which might be reused by other files.
+		k_truncateOpenFileHandles(entry.startClusterIndex);
+		
+		k_unlock(fileLock);
+		
 		// set file size to 0.
 		entry.fileSize = 0;
-		if (k_setDirEntryData(dirEntryOffset, &entry) == false) {
+		dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+		dentry->entry.fileSize = 0;
+		if (k_setDirEntryData(dentry->clusterIndex, dentry->index, &(dentry->entry)) == false) {
 			k_unlock(&(g_fileSystemManager.mutex));
 			return null;
 		}
@@ -839,12 +2146,20 @@ File* k_openFile(const char* fileName, const char* mode) {
 	
 	// set file info to file handle.
 	file->type = FS_TYPE_FILE;
-	file->fileHandle.dirEntryOffset = dirEntryOffset;
+	file->fileHandle.dentryIndex = dentryIndex;
 	file->fileHandle.fileSize = entry.fileSize;
 	file->fileHandle.startClusterIndex = entry.startClusterIndex;
 	file->fileHandle.currentClusterIndex = entry.startClusterIndex;
 	file->fileHandle.prevClusterIndex = entry.startClusterIndex;
 	file->fileHandle.currentOffset = 0;
+	file->fileHandle.extentMap = null;
+	file->fileHandle.extentCount = 0;
+	file->fileHandle.extentMaxCount = 0;
+	file->fileHandle.mappedClusterCount = 0;
+	file->fileHandle.clusterBuffer = null;
+	
+	// register file handle to open handle hash table.
+	k_addOpenHandle(file);
 	
 	// If it's append-related mode (a, a+), move file pointer to the end of file.
 	if (mode[0] == 'a') {
@@ -857,13 +2172,17 @@ File* k_openFile(const char* fileName, const char* mode) {
 	return file;
 }
 
-dword k_readFile(void* buffer, dword size, dword count, File* file) {
-	dword totalCount;       // total byte count
-	dword readCount;        // read byte count
+qword k_readFile(void* buffer, qword size, qword count, File* file) {
+	qword totalCount;       // total byte count
+	qword readCount;        // read byte count
 	dword offsetInCluster;  // file point offset in cluster
 	dword copySize;         // byte count coping to buffer
 	FileHandle* fileHandle; // file handle
 	dword nextClusterIndex; // next cluster index
+	dword startClusterOffset, endClusterOffset; // cluster offset range to read ahead
+	byte* clusterBuffer;    // cluster buffer: pointer to the cluster in RAM disk, or scratch buffer of handle
+	dword prevClusterIndex; // previous cluster index (searched in extent map)
+	Mutex* fileLock;        // file lock
 	
 	// If handle == null or hanle type != file handle, return
 	if ((file == null) || (file->type != FS_TYPE_FILE)) {
@@ -872,15 +2191,26 @@ dword k_readFile(void* buffer, dword size, dword count, File* file) {
 	
 	fileHandle = &(file->fileHandle);
 	
+	// lock only the file, so that reading/writing other files isn't blocked.
+	fileLock = k_getFileLock(fileHandle);
+	k_lock(fileLock);
+	
 	// If it's the end of file or the last cluster, return.
 	if ((fileHandle->currentOffset == fileHandle->fileSize) || (fileHandle->currentClusterIndex == FS_LASTCLUSTER)) {
+		k_unlock(fileLock);
 		return 0;
 	}
 	
 	// total byte count = MIN(requested byte count, remaining byte count of file)
 	totalCount = MIN(size * count, fileHandle->fileSize - fileHandle->currentOffset);
 	
-	k_lock(&(g_fileSystemManager.mutex));
+	// read ahead the clusters to read and the next cluster of them at once,
+	// so that HDD request queue merges them into a command, and reading the next cluster overlaps with processing of the caller.
+	if (g_fileSystemManager.cacheEnabled == true) {
+		startClusterOffset = (dword)(fileHandle->currentOffset / FS_CLUSTERSIZE);
+		endClusterOffset = (dword)MIN(((fileHandle->currentOffset + totalCount - 1) / FS_CLUSTERSIZE) + 1, (fileHandle->fileSize - 1) / FS_CLUSTERSIZE);
+		k_readAheadClusters(fileHandle->currentClusterIndex, MIN(endClusterOffset - startClusterOffset + 1, FS_READAHEADCLUSTERCOUNT));
+	}
 	
 	// looping until finishing reading as many as total byte count.
 	readCount = 0;
@@ -890,20 +2220,25 @@ dword k_readFile(void* buffer, dword size, dword count, File* file) {
 		// read current cluster, and copy it to buffer.
 		//----------------------------------------------------------------------------------------------------
 		
-		// read current cluster.
-		if (k_readCluster(fileHandle->currentClusterIndex, g_tempBuffer) == false) {
-			break;
+		// get a pointer to current cluster in RAM disk without copying.
+		// If it fails, read current cluster to scratch buffer of handle.
+		clusterBuffer = k_getClusterPointer(fileHandle->currentClusterIndex, false);
+		if (clusterBuffer == null) {
+			clusterBuffer = k_getFileClusterBuffer(fileHandle);
+			if ((clusterBuffer == null) || (k_readCluster(fileHandle->currentClusterIndex, clusterBuffer) == false)) {
+				break;
+			}
 		}
 		
 		// calculate file pointer position in cluster.
-		offsetInCluster = fileHandle->currentOffset % FS_CLUSTERSIZE;
+		offsetInCluster = (dword)(fileHandle->currentOffset % FS_CLUSTERSIZE);
 		
 		// If total byte count covers over many clusters, read as many as remaining byte count in current cluster, and move to next cluster.
 		// byte count coping to buffer = MIX(remaining byte count in cluster, read byte count more)
 		copySize = MIN(FS_CLUSTERSIZE - offsetInCluster, totalCount - readCount);
 		
 		// copy to buffer.
-		k_memcpy((char*)buffer + readCount, g_tempBuffer + offsetInCluster, copySize);
+		k_memcpy((char*)buffer + readCount, clusterBuffer + offsetInCluster, copySize);
 		
 		// update read byte count, current offset of file pointer.
 		readCount += copySize;
@@ -914,8 +2249,13 @@ dword k_readFile(void* buffer, dword size, dword count, File* file) {
 		//----------------------------------------------------------------------------------------------------
 		if ((fileHandle->currentOffset % FS_CLUSTERSIZE) == 0) {
 			
-			// get next cluster index.
-			if (k_getClusterLinkData(fileHandle->currentClusterIndex, &nextClusterIndex) == false) {
+			// get next cluster index. If extent map has been built, search it instead of cluster link table.
+			if (fileHandle->extentMap != null) {
+				if (k_findClusterInExtentMap(fileHandle, (dword)(fileHandle->currentOffset / FS_CLUSTERSIZE), &nextClusterIndex, &prevClusterIndex) == false) {
+					break;
+				}
+				
+			} else if (k_getClusterLinkData(fileHandle->currentClusterIndex, &nextClusterIndex) == false) {
 				break;
 			}
 			
@@ -925,90 +2265,149 @@ dword k_readFile(void* buffer, dword size, dword count, File* file) {
 		}
 	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
+	k_unlock(fileLock);
 	
 	// return read byte count.
 	return readCount;
 }
 
-dword k_writeFile(const void* buffer, dword size, dword count, File* file) {
-	dword totalCount;          // total byte count
-	dword writeCount;          // write byte count
-	dword offsetInCluster;     // file pointer offset in cluster
-	dword copySize;            // byte count copying to buffer
-	FileHandle* fileHandle;    // file handle
-	dword nextClusterIndex;    // next cluster index
-	dword allocedClusterIndex; // allocated cluster index
+qword k_writeFile(const void* buffer, qword size, qword count, File* file) {
+	qword writeCount;       // write byte count
+	qword oldFileSize;      // file size before writing
+	bool sizeChanged;       // file size change flag
+	Mutex* fileLock;        // file lock
 	
 	// If handle == null or handle type != file handle, return.
 	if ((file == null) || (file->type != FS_TYPE_FILE)) {
 		return 0;
 	}
 	
-	fileHandle = &(file->fileHandle);
+	// lock only the file, so that reading/writing other files isn't blocked.
+	// (allocating clusters locks allocation mutex inside.)
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
 	
-	// total byte count = requested byte count
-	totalCount = size * count;
+	oldFileSize = file->fileHandle.fileSize;
+	writeCount = k_writeFileData(file, buffer, size * count);
 	
-	k_lock(&(g_fileSystemManager.mutex));
+	//----------------------------------------------------------------------------------------------------
+	// If file size changes, update directory entry.
+	// [NOTE] file lock is unlocked before locking mutex in order to keep locking order (mutex -> file lock).
+	//----------------------------------------------------------------------------------------------------
+	sizeChanged = (file->fileHandle.fileSize != oldFileSize);
+	k_unlock(fileLock);
+	
+	if (sizeChanged == true) {
+		k_lock(&(g_fileSystemManager.mutex));
+		k_updateDirEntry(&(file->fileHandle));
+		k_unlock(&(g_fileSystemManager.mutex));
+	}
+	
+	// return write byte count.
+	return writeCount;
+}
+
+static qword k_writeFileData(File* file, const void* buffer, qword totalCount) {
+	qword writeCount;          // write byte count
+	dword offsetInCluster;     // file pointer offset in cluster
+	dword copySize;            // byte count copying to buffer
+	FileHandle* fileHandle;    // file handle
+	dword nextClusterIndex;    // next cluster index
+	dword allocedClusterIndex; // allocated cluster index
+	dword allocedCount;        // allocated cluster count of extent
+	dword newExtentStart = FS_LASTCLUSTER, newExtentEnd = FS_LASTCLUSTER; // cluster index range of new extent allocated in this call
+	bool newCluster;           // new cluster flag
+	bool zeroCopy;             // zero-copy flag: cluster buffer is a pointer to the cluster in RAM disk
+	byte* clusterBuffer;       // cluster buffer: pointer to the cluster in RAM disk, or scratch buffer of handle
+	
+	fileHandle = &(file->fileHandle);
 	
 	// loop until finishing writing as many as total byte count.
 	writeCount = 0;
 	while (writeCount != totalCount) {
 		
 		//----------------------------------------------------------------------------------------------------
-		// If current cluster is last cluster, allocate new cluster, and connect it.
+		// If current cluster is last cluster, allocate new clusters as a contiguous run (extent), and connect it.
+		// The extent covers the remaining byte count, so that file is laid out sequentially.
 		//----------------------------------------------------------------------------------------------------
 		if (fileHandle->currentClusterIndex == FS_LASTCLUSTER) {
 			
-			// allocate new cluster.
-			allocedClusterIndex = k_findFreeCluster();
+			// allocate new extent from the cluster next to the last cluster of file.
+			allocedClusterIndex = k_allocClusterExtent(fileHandle->prevClusterIndex + 1, (dword)MIN((totalCount - writeCount + FS_CLUSTERSIZE - 1) / FS_CLUSTERSIZE, FS_MAXEXTENTCLUSTERCOUNT), &allocedCount);
 			if (allocedClusterIndex == FS_LASTCLUSTER) {
 				break;
 			}
 			
-			// set new cluster to last cluster.
-			if (k_setClusterLinkData(allocedClusterIndex, FS_LASTCLUSTER) == false) {
-				break;
-			}
-			
-			// connect new cluster to last cluster
+			// connect new extent to last cluster
 			if (k_setClusterLinkData(fileHandle->prevClusterIndex, allocedClusterIndex) == false) {
-				// If fails, free the allocated cluster.
-				k_setClusterLinkData(allocedClusterIndex, FS_FREECLUSTER);
+				// If fails, free the allocated extent.
+				k_freeClusterUntilEnd(allocedClusterIndex);
 				break;
 			}
 			
-			// set current cluster to new cluster.
+			// set current cluster to the first cluster of new extent.
 			fileHandle->currentClusterIndex = allocedClusterIndex;
+			newExtentStart = allocedClusterIndex;
+			newExtentEnd = allocedClusterIndex + allocedCount;
+		}
+		
+		// new cluster is the cluster of new extent allocated in this call.
+		if ((fileHandle->currentClusterIndex >= newExtentStart) && (fileHandle->currentClusterIndex < newExtentEnd)) {
+			newCluster = true;
 			
-			// initialize temporary buffer.
-			k_memset(g_tempBuffer, 0, sizeof(g_tempBuffer));
-			
+		} else {
+			newCluster = false;
+		}
+		
 		//----------------------------------------------------------------------------------------------------
-		// If current cluster can't be written all, read current cluster, and copy it to temporary buffer.
+		// get a pointer to current cluster in RAM disk, and write to it directly without copying.
 		//----------------------------------------------------------------------------------------------------
-		} else if (((fileHandle->currentOffset % FS_CLUSTERSIZE) != 0) || ((totalCount - writeCount) < FS_CLUSTERSIZE)) {
+		clusterBuffer = k_getClusterPointer(fileHandle->currentClusterIndex, true);
+		if (clusterBuffer != null) {
+			zeroCopy = true;
+			
+			// initialize new cluster, because it might have data of the removed file.
+			if (newCluster == true) {
+				k_memset(clusterBuffer, 0, FS_CLUSTERSIZE);
+			}
 			
-			// read current cluster and copy it to temporary buffer,
-			//  because it overrides the part of cluster if it doesn't override the whole cluster.
-			if (k_readCluster(fileHandle->currentClusterIndex, g_tempBuffer) == false) {
+		//----------------------------------------------------------------------------------------------------
+		// If it fails, write through scratch buffer of handle.
+		//----------------------------------------------------------------------------------------------------
+		} else {
+			zeroCopy = false;
+			clusterBuffer = k_getFileClusterBuffer(fileHandle);
+			if (clusterBuffer == null) {
 				break;
 			}
+			
+			// initialize scratch buffer for new cluster.
+			if (newCluster == true) {
+				k_memset(clusterBuffer, 0, FS_CLUSTERSIZE);
+				
+			// If current cluster can't be written all, read current cluster, and copy it to scratch buffer.
+			} else if (((fileHandle->currentOffset % FS_CLUSTERSIZE) != 0) || ((totalCount - writeCount) < FS_CLUSTERSIZE)) {
+				
+				// read current cluster and copy it to scratch buffer,
+				//  because it overrides the part of cluster if it doesn't override the whole cluster.
+				if (k_readCluster(fileHandle->currentClusterIndex, clusterBuffer) == false) {
+					break;
+				}
+			}
 		}
 		
 		// calculate file pointer offset in cluster.
-		offsetInCluster = fileHandle->currentOffset % FS_CLUSTERSIZE;
+		offsetInCluster = (dword)(fileHandle->currentOffset % FS_CLUSTERSIZE);
 		
 		// If total byte count covers over many clusters, write as many as remaining byte count of current cluster, move to next cluster.
 		// byte count coping to buffer = MIN(remaining byte count of cluster, write byte count more)
 		copySize = MIN(FS_CLUSTERSIZE - offsetInCluster, totalCount - writeCount);
 		
-		// copy from buffer to temporary buffer.
-		k_memcpy(g_tempBuffer + offsetInCluster, (char*)buffer + writeCount, copySize);
+		// copy from buffer to cluster buffer.
+		k_memcpy(clusterBuffer + offsetInCluster, (char*)buffer + writeCount, copySize);
 		
-		// write temporary buffer to hard disk.
-		if (k_writeCluster(fileHandle->currentClusterIndex, g_tempBuffer) == false) {
+		// write scratch buffer to hard disk. (cluster in RAM disk has been already written.)
+		if ((zeroCopy == false) && (k_writeCluster(fileHandle->currentClusterIndex, clusterBuffer) == false)) {
 			break;
 		}
 		
@@ -1032,31 +2431,22 @@ dword k_writeFile(const void* buffer, dword size, dword count, File* file) {
 		}
 	}
 	
-	//----------------------------------------------------------------------------------------------------
-	// If file size changes, update directory entry.
-	//----------------------------------------------------------------------------------------------------
+	// If file grows, update file size of handle. (directory entry is updated by caller.)
 	if (fileHandle->fileSize < fileHandle->currentOffset) {
 		fileHandle->fileSize = fileHandle->currentOffset;
-		k_updateDirEntry(fileHandle);
 	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
-	
-	// return write byte count.
 	return writeCount;
 }
 
-int k_seekFile(File* file, int offset, int origin) {
-	dword realOffset;           // real offset: file pointer offset from the start of file
+int k_seekFile(File* file, long offset, int origin) {
+	qword realOffset;           // real offset: file pointer offset from the start of file
 	dword clusterOffsetToMove;  // moving cluster offset
-	dword currentClusterOffset; // current cluster offset
 	dword lastClusterOffset;    // last cluster offset
-	dword moveCount;            // moving cluster count
-	dword i;                    // index
-	dword startClusterIndex;    // start cluster index
 	dword prevClusterIndex;     // previous cluster index
 	dword currentClusterIndex;  // current cluster index
 	FileHandle* fileHandle;     // file handle
+	Mutex* fileLock;            // file lock
 	
 	// If handle == null or handle type != file handle, return
 	if ((file == null) || (file->type != FS_TYPE_FILE)) {
@@ -1065,6 +2455,9 @@ int k_seekFile(File* file, int offset, int origin) {
 	
 	fileHandle = &(file->fileHandle);
 	
+	fileLock = k_getFileLock(fileHandle);
+	k_lock(fileLock);
+	
 	//----------------------------------------------------------------------------------------------------
 	// calculate file pointer offset from the start of file using parameter origin, offset.
 	//----------------------------------------------------------------------------------------------------
@@ -1089,7 +2482,7 @@ int k_seekFile(File* file, int offset, int origin) {
 	case FS_SEEK_CUR:
 		// If parameter offset is a negative number and parameter offset is greater than current file pointer offset,
 		// move out of file, so set real offset to the start of file (0).
-		if ((offset < 0) && (fileHandle->currentOffset <= (dword)-offset)) {
+		if ((offset < 0) && (fileHandle->currentOffset <= (qword)-offset)) {
 			realOffset = 0;
 			
 		} else {
@@ -1102,7 +2495,7 @@ int k_seekFile(File* file, int offset, int origin) {
 	case FS_SEEK_END:
 		// If parameter offset is a negative number and parameter offset is greater than file size.
 		// move out of file, so set real offset to the start of file (0).
-		if ((offset < 0) && (fileHandle->fileSize <= (dword)-offset)) {
+		if ((offset < 0) && (fileHandle->fileSize <= (qword)-offset)) {
 			realOffset = 0;
 			
 		} else {
@@ -1113,330 +2506,2007 @@ int k_seekFile(File* file, int offset, int origin) {
 	}
 	
 	//----------------------------------------------------------------------------------------------------
-	// search cluster to move using file cluster count and current file pointer offset.
+	// search cluster to move using extent map of file handle (binary search).
+	// Extent map is built lazily from cluster link table at first seek, and extended when it's needed.
 	//----------------------------------------------------------------------------------------------------
 	
-	// calculate last cluster offset, moving cluster offset, current cluster offset.
-	lastClusterOffset = fileHandle->fileSize / FS_CLUSTERSIZE;
-	clusterOffsetToMove = realOffset / FS_CLUSTERSIZE;
-	currentClusterOffset = fileHandle->currentOffset / FS_CLUSTERSIZE;
-	
-	// calculate moving cluster count, start cluster index.
-	if (lastClusterOffset < clusterOffsetToMove) {
-		moveCount = lastClusterOffset - currentClusterOffset;
-		startClusterIndex = fileHandle->currentClusterIndex;
-		
-	} else if (currentClusterOffset <= clusterOffsetToMove) {
-		moveCount = clusterOffsetToMove - currentClusterOffset;
-		startClusterIndex = fileHandle->currentClusterIndex;
-		
-	} else {
-		moveCount = clusterOffsetToMove;
-		startClusterIndex = fileHandle->startClusterIndex;
-	}
-	
-	k_lock(&(g_fileSystemManager.mutex));
+	// calculate last cluster offset, moving cluster offset.
+	// If moving offset exceeds file size, move to the last cluster first.
+	lastClusterOffset = (dword)(fileHandle->fileSize / FS_CLUSTERSIZE);
+	clusterOffsetToMove = (dword)MIN(realOffset / FS_CLUSTERSIZE, lastClusterOffset);
 	
 	// move cluster
-	currentClusterIndex = startClusterIndex;
-	for (i = 0; i < moveCount; i++) {
-		prevClusterIndex = currentClusterIndex;
-		
-		// get next cluster index.
-		if (k_getClusterLinkData(prevClusterIndex, &currentClusterIndex) == false) {
-			k_unlock(&(g_fileSystemManager.mutex));
-			return -1;
-		}
+	if (k_findClusterInExtentMap(fileHandle, clusterOffsetToMove, &currentClusterIndex, &prevClusterIndex) == false) {
+		k_unlock(fileLock);
+		return -1;
 	}
 	
 	// update cluster info of file handle.
-	if (moveCount > 0) {
-		fileHandle->prevClusterIndex = prevClusterIndex;
-		fileHandle->currentClusterIndex = currentClusterIndex;
-		
-	} else if (startClusterIndex == fileHandle->startClusterIndex) {
-		fileHandle->prevClusterIndex = fileHandle->startClusterIndex;
-		fileHandle->currentClusterIndex = fileHandle->startClusterIndex;
-	}
+	fileHandle->prevClusterIndex = prevClusterIndex;
+	fileHandle->currentClusterIndex = currentClusterIndex;
 	
 	//----------------------------------------------------------------------------------------------------
 	// If moving offset exceeds file size, put 0 to the remaining part, update current file pointer offset.
 	//----------------------------------------------------------------------------------------------------
 	
 	// If moving offset exceeds file size.
-	if (lastClusterOffset < clusterOffsetToMove) {
+	if (realOffset > fileHandle->fileSize) {
 		fileHandle->currentOffset = fileHandle->fileSize;
 		
-		k_unlock(&(g_fileSystemManager.mutex));
+		// [NOTE] file lock is unlocked before writing, because writing may lock mutex to update directory entry.
+		k_unlock(fileLock);
 		
 		// put 0 to the remaining part in order to expand file size.
 		if (k_writeZero(file, realOffset - fileHandle->fileSize) == false) {
-			return 0;
+			return -1;
 		}
+		
+		k_lock(fileLock);
 	}
 	
 	// update current file pointer offset.
 	fileHandle->currentOffset = realOffset;
 	
-	k_unlock(&(g_fileSystemManager.mutex));
+	k_unlock(fileLock);
 	
 	return 0;
 }
 
-int k_closeFile(File* file) {
-	// If handle == null of handle type != file handle, return.
-	if ((file == null) || (file->type != FS_TYPE_FILE)) {
-		return -1;
+qword k_readFileVector(File* file, const IoVec* vectors, int count) {
+	qword totalCount; // total read byte count
+	qword readCount;  // read byte count of a vector
+	Mutex* fileLock;  // file lock
+	int i;
+	
+	if ((file == null) || (file->type != FS_TYPE_FILE) || (count < 0) || (count > FS_IOVEC_MAXCOUNT)) {
+		return 0;
 	}
 	
-	// free file handle.
-	k_freeFileDirHandle(file);
-	return 0;
+	// lock the file during all vectors, so that they are read from contiguous file area.
+	// reading continues from current cluster without searching it again, and read-ahead merges contiguous clusters.
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
+	
+	totalCount = 0;
+	for (i = 0; i < count; i++) {
+		if (vectors[i].length == 0) {
+			continue;
+		}
+		
+		readCount = k_readFile(vectors[i].base, 1, vectors[i].length, file);
+		totalCount += readCount;
+		
+		// If it's the end of file, stop.
+		if (readCount != vectors[i].length) {
+			break;
+		}
+	}
+	
+	k_unlock(fileLock);
+	
+	return totalCount;
 }
 
-int k_removeFile(const char* fileName) {
-	DirEntry entry;
-	int dirEntryOffset;
-	int fileNameLen;
+qword k_writeFileVector(File* file, const IoVec* vectors, int count) {
+	byte* gatherBuffer;   // gather buffer: small vectors are gathered into it up to the end of current cluster.
+	dword gatherCount;    // byte count in gather buffer
+	dword gatherSize;     // byte count to fill gather buffer (up to the end of current cluster)
+	qword totalCount;     // total written byte count
+	qword offset;         // offset in current vector
+	qword copySize;       // byte count to copy or write
+	qword writeCount;     // written byte count of a write
+	qword oldFileSize;    // file size before writing
+	bool sizeChanged;     // file size change flag
+	Mutex* fileLock;      // file lock
+	bool result = true;
+	int i;
 	
-	// check file name length.
-	fileNameLen = k_strlen(fileName);
-	if ((fileNameLen > (sizeof(entry.fileName) - 1)) || (fileNameLen == 0)) {
-		return -1;
+	if ((file == null) || (file->type != FS_TYPE_FILE) || (count < 0) || (count > FS_IOVEC_MAXCOUNT)) {
+		return 0;
 	}
 	
-	k_lock(&(g_fileSystemManager.mutex));
-	
-	// If file doesn't exist, can't delete it.
-	dirEntryOffset = k_findDirEntry(fileName, &entry);
-	if (dirEntryOffset == -1) {
-		k_unlock(&(g_fileSystemManager.mutex));
-		return -1;
+	gatherBuffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
+	if (gatherBuffer == null) {
+		return 0;
 	}
 	
-	// If file is open, can't delete it.
-	if (k_isFileOpen(&entry) == true) {
-		k_unlock(&(g_fileSystemManager.mutex));
-		return -1;
+	// lock only the file during all vectors, so that they are written to contiguous file area without other writers.
+	// directory entry is updated once after unlocking the file, so that other files and directories aren't blocked by writing.
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
+	oldFileSize = file->fileHandle.fileSize;
+	
+	//----------------------------------------------------------------------------------------------------
+	// gather vectors into cluster-aligned chunks, and write each chunk at once.
+	// So, many small vectors cause a write per cluster instead of a read-modify-write of the cluster per vector,
+	// and a vector which covers whole clusters is written directly without copying it.
+	// [NOTE] file pointer offset moves only by this function while the file is locked, so the end of current cluster is calculated from it.
+	//----------------------------------------------------------------------------------------------------
+	totalCount = 0;
+	gatherCount = 0;
+	gatherSize = FS_CLUSTERSIZE - (dword)(file->fileHandle.currentOffset % FS_CLUSTERSIZE);
+	for (i = 0; (i < count) && (result == true); i++) {
+		offset = 0;
+		while (offset < vectors[i].length) {
+			// If gather buffer is empty and vector has enough data, write it directly.
+			if ((gatherCount == 0) && ((vectors[i].length - offset) >= gatherSize)) {
+				copySize = gatherSize + (((vectors[i].length - offset - gatherSize) / FS_CLUSTERSIZE) * FS_CLUSTERSIZE);
+				writeCount = k_writeFileData(file, (byte*)vectors[i].base + offset, copySize);
+				totalCount += writeCount;
+				if (writeCount != copySize) {
+					result = false;
+					break;
+				}
+				
+				offset += copySize;
+				gatherSize = FS_CLUSTERSIZE;
+				continue;
+			}
+			
+			// gather data to gather buffer, and write it if it reaches the end of cluster.
+			copySize = MIN(gatherSize - gatherCount, vectors[i].length - offset);
+			k_memcpy(gatherBuffer + gatherCount, (byte*)vectors[i].base + offset, copySize);
+			gatherCount += copySize;
+			offset += copySize;
+			
+			if (gatherCount == gatherSize) {
+				writeCount = k_writeFileData(file, gatherBuffer, gatherCount);
+				totalCount += writeCount;
+				if (writeCount != gatherCount) {
+					result = false;
+					break;
+				}
+				
+				gatherCount = 0;
+				gatherSize = FS_CLUSTERSIZE;
+			}
+		}
 	}
 	
-	// free all clusters of file.
-	if (k_freeClusterUntilEnd(entry.startClusterIndex) == false) {
-		k_unlock(&(g_fileSystemManager.mutex));
-		return -1;
+	// write the remaining data in gather buffer.
+	// [NOTE] The returned count includes bytes written before failure, so that caller knows how much of file changed.
+	if ((result == true) && (gatherCount > 0)) {
+		totalCount += k_writeFileData(file, gatherBuffer, gatherCount);
 	}
 	
-	// initialize directory entry as 0.
-	k_memset(&entry, 0, sizeof(entry));
-	if (k_setDirEntryData(dirEntryOffset, &entry) == false) {
+	// If file size changes, update directory entry after unlocking the file, in order to keep locking order (mutex -> file lock).
+	sizeChanged = (file->fileHandle.fileSize != oldFileSize);
+	k_unlock(fileLock);
+	
+	if (sizeChanged == true) {
+		k_lock(&(g_fileSystemManager.mutex));
+		k_updateDirEntry(&(file->fileHandle));
 		k_unlock(&(g_fileSystemManager.mutex));
-		return -1;
 	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
-	return 0;
+	k_freeMem(gatherBuffer);
+	
+	return totalCount;
 }
 
-// ignore dirName, because only root directory exists.
-Dir* k_openDir(const char* dirName) {
-	Dir* dir;
-	DirEntry* dirBuffer;
-	
-	k_lock(&(g_fileSystemManager.mutex));
+qword k_readFileAt(File* file, void* buffer, qword size, qword offset) {
+	qword savedOffset; // saved file pointer offset
+	qword readCount;   // read byte count
+	Mutex* fileLock;   // file lock
 	
-	// allocate directory handle.
-	dir = (Dir*)k_allocFileDirHandle();
-	if (dir == null) {
-		k_unlock(&(g_fileSystemManager.mutex));
-		return null;
+	if ((file == null) || (file->type != FS_TYPE_FILE)) {
+		return 0;
 	}
 	
-	// allocate root directory buffer.
-	dirBuffer = (DirEntry*)k_allocMem(FS_CLUSTERSIZE);
-	if (dirBuffer == null) {
-		k_freeFileDirHandle(dir);
-		k_unlock(&(g_fileSystemManager.mutex));
-		return null;
-	}
+	// lock the file during seeking, reading and restoring, so that file pointer offset doesn't change for other users.
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
 	
-	// read root directory.
-	if (k_readCluster(0, (byte*)dirBuffer) == false) {
-		k_freeFileDirHandle(dir);
-		k_freeMem(dirBuffer);
-		k_unlock(&(g_fileSystemManager.mutex));
-		return null;
+	// If offset is over the end of file, there is nothing to read.
+	if (offset >= file->fileHandle.fileSize) {
+		k_unlock(fileLock);
+		return 0;
 	}
 	
-	// initialize directory handle.
-	dir->type = FS_TYPE_DIRECTORY;
-	dir->dirHandle.currentOffset = 0;
-	dir->dirHandle.dirBuffer = dirBuffer;
+	// move file pointer to offset (in file, so seek doesn't write zero), read, and restore file pointer offset.
+	savedOffset = file->fileHandle.currentOffset;
+	k_seekFile(file, offset, FS_SEEK_SET);
+	readCount = k_readFile(buffer, 1, size, file);
+	k_seekFile(file, savedOffset, FS_SEEK_SET);
 	
-	k_unlock(&(g_fileSystemManager.mutex));
+	k_unlock(fileLock);
 	
-	return dir;
+	return readCount;
 }
 
-DirEntry* k_readDir(Dir* dir) {
-	DirHandle* dirHandle;
-	DirEntry* entry;
+qword k_writeFileAt(File* file, const void* buffer, qword size, qword offset) {
+	qword savedOffset;  // saved file pointer offset
+	qword oldFileSize;  // file size before writing
+	qword writeCount;   // written byte count
+	bool sizeChanged;   // file size change flag
+	Mutex* fileLock;    // file lock
 	
-	// If handle == null or handle type != directory handle, return.
-	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
-		return null;
+	if ((file == null) || (file->type != FS_TYPE_FILE)) {
+		return 0;
 	}
 	
-	dirHandle = &(dir->dirHandle);
-	
-	// check the range of current directory pointer offset.
-	if ((dirHandle->currentOffset < 0) || (dirHandle->currentOffset >= FS_MAXDIRECTORYENTRYCOUNT)) {
-		return null;
-	}
+	//----------------------------------------------------------------------------------------------------
+	// lock only the file during seeking, writing and restoring, so that file pointer offset doesn't change for other users.
+	// [NOTE] seeking and writing inside the file lock don't update directory entry,
+	//        and directory entry is updated once after unlocking the file, in order to keep locking order (mutex -> file lock).
+	//----------------------------------------------------------------------------------------------------
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
 	
-	k_lock(&(g_fileSystemManager.mutex));
+	savedOffset = file->fileHandle.currentOffset;
+	oldFileSize = file->fileHandle.fileSize;
+	writeCount = 0;
 	
-	// search as many as max directory entry count of root directory.
-	entry = dirHandle->dirBuffer;
-	while (dirHandle->currentOffset < FS_MAXDIRECTORYENTRYCOUNT) {
-		// If file exists, return the directory entry.
-		if (entry[dirHandle->currentOffset].startClusterIndex != 0) {
-			k_unlock(&(g_fileSystemManager.mutex));
-			return &(entry[dirHandle->currentOffset++]);
+	// move file pointer to offset. If it's over the end of file, move to the end of file, and fill the gap with 0.
+	if (k_seekFile(file, MIN(offset, oldFileSize), FS_SEEK_SET) == 0) {
+		if (offset > oldFileSize) {
+			k_writeZeroData(file, offset - oldFileSize);
 		}
 		
-		dirHandle->currentOffset++;
+		// write only if file pointer has been moved to offset exactly.
+		if (file->fileHandle.currentOffset == offset) {
+			writeCount = k_writeFileData(file, buffer, size);
+		}
 	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
-	return null;
-}
-
-void k_rewindDir(Dir* dir) {
-	DirHandle* dirHandle;
+	// restore file pointer offset. (It's in file, so seek doesn't write zero.)
+	k_seekFile(file, savedOffset, FS_SEEK_SET);
 	
-	// If handle == null or handle type != directory handle, return.
-	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
-		return;
+	sizeChanged = (file->fileHandle.fileSize != oldFileSize);
+	k_unlock(fileLock);
+	
+	if (sizeChanged == true) {
+		k_lock(&(g_fileSystemManager.mutex));
+		k_updateDirEntry(&(file->fileHandle));
+		k_unlock(&(g_fileSystemManager.mutex));
 	}
 	
-	dirHandle = &(dir->dirHandle);
+	return writeCount;
+}
+
+int k_closeFile(File* file) {
+	// If handle == null of handle type != file handle, return.
+	if ((file == null) || (file->type != FS_TYPE_FILE)) {
+		return -1;
+	}
 	
 	k_lock(&(g_fileSystemManager.mutex));
 	
-	// set 0 to current directory pointer offset.
-	dirHandle->currentOffset = 0;
+	// free extent map, scratch cluster buffer.
+	k_freeFileExtentMap(&(file->fileHandle));
+	if (file->fileHandle.clusterBuffer != null) {
+		k_freeMem(file->fileHandle.clusterBuffer);
+	}
+	
+	// unregister file handle from open handle hash table, and free it.
+	k_removeOpenHandle(file);
+	k_freeFileDirHandle(file);
 	
 	k_unlock(&(g_fileSystemManager.mutex));
+	return 0;
 }
 
-int k_closeDir(Dir* dir) {
-	DirHandle* dirHandle;
+int k_syncFile(File* file) {
+	FileHandle* fileHandle;
+	Mutex* fileLock;
+	dword commitCount;
+	bool result = true;
 	
-	// If handle == null or handle type != directory handle, return.
-	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
+	// If handle == null or handle type != file handle, return.
+	if ((file == null) || (file->type != FS_TYPE_FILE)) {
 		return -1;
 	}
 	
-	dirHandle = &(dir->dirHandle);
+	// If cache is disabled (RAM disk), data is already on disk.
+	if (g_fileSystemManager.cacheEnabled == false) {
+		return 0;
+	}
 	
-	k_lock(&(g_fileSystemManager.mutex));
+	fileHandle = &(file->fileHandle);
+	fileLock = k_getFileLock(fileHandle);
 	
-	// free root directory buffer.
-	k_freeMem(dirHandle->dirBuffer);
+	// write back changed data clusters of the file only, not the whole cache.
+	k_lock(fileLock);
+	result = k_writeBackFileCacheBuffers(fileHandle);
+	k_unlock(fileLock);
 	
-	// free directory handle.
-	k_freeFileDirHandle(dir);
+	if (result == false) {
+		return -1;
+	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
+	//----------------------------------------------------------------------------------------------------
+	// commit running transaction which has metadata of the file (cluster links, directory entry).
+	// If journal is disabled, metadata becomes durable only by writing back all cache buffers.
+	// And then, flush write cache of hard disk, unless commit has already flushed it.
+	//----------------------------------------------------------------------------------------------------
+	k_lock(&(g_fileSystemManager.journal.mutex));
 	
-	return 0;
-}
-
-bool k_isFileOpen(const DirEntry* entry) {
-	int i;
-	File* file;
+	commitCount = g_fileSystemManager.journal.commitCount;
+	if (g_fileSystemManager.journal.enabled == true) {
+		result = k_commitJournal();
+		
+	} else {
+		result = k_writeBackAllCacheBuffers();
+	}
 	
-	// search open file from start address to end address of handle pool.
-	file = g_fileSystemManager.handlePool;
-	for (i = 0; i < FS_HANDLE_MAXCOUNT; i++) {
-		if ((file[i].type == FS_TYPE_FILE) && (file[i].fileHandle.startClusterIndex == entry->startClusterIndex)) {
-			return true;
-		}
+	if ((result == true) && (commitCount == g_fileSystemManager.journal.commitCount)) {
+		result = k_flushHddWriteCache();
 	}
 	
-	return false;
+	k_unlock(&(g_fileSystemManager.journal.mutex));
+	
+	return (result == true) ? 0 : -1;
 }
 
-bool k_writeZero(File* file, dword count) {
-	byte* buffer;
-	dword remainCount;
-	dword writeCount;
+int k_removeFile(const char* fileName) {
+	DirEntry entry;
+	int dentryIndex;
+	int fileNameLen;
+	Dentry* dentry;
 	
-	if (file == null) {
-		return false;
+	// check file name length.
+	fileNameLen = k_strlen(fileName);
+	if ((fileNameLen > (FS_MAXPATHLENGTH - 1)) || (fileNameLen == 0)) {
+		return -1;
 	}
 	
-	// allocate memory and write by cluster-level in order to improve speed.
-	buffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
-	if (buffer == null) {
-		return false;
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// If file doesn't exist or it's directory, can't delete it.
+	dentryIndex = k_findDirEntry(fileName, &entry);
+	if ((dentryIndex == -1) || (entry.attribute != FS_ATTRIBUTE_FILE)) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// If file is open, can't delete it.
+	if (k_isFileOpen(&entry) == true) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// free all clusters of file.
+	if (k_freeClusterUntilEnd(entry.startClusterIndex) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// initialize directory entry as 0, and remove it from dentry cache.
+	dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+	k_memset(&entry, 0, sizeof(entry));
+	if (k_setDirEntryData(dentry->clusterIndex, dentry->index, &entry) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	k_removeDentry(dentryIndex);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	return 0;
+}
+
+int k_statFile(const char* fileName, DirEntry* entry) {
+	int dentryIndex;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// get directory entry from dentry cache without reading directory.
+	dentryIndex = k_findDirEntry(fileName, entry);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	
+	return (dentryIndex == -1) ? -1 : 0;
+}
+
+int k_makeDir(const char* dirName) {
+	DirEntry entry;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// create directory (If the name already exists, creation fails).
+	if (k_createFile(dirName, FS_ATTRIBUTE_DIRECTORY, &entry) == -1) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	return 0;
+}
+
+int k_removeDir(const char* dirName) {
+	DirEntry entry;
+	int dentryIndex;
+	Dentry* dentry;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// If directory doesn't exist or it's file, can't delete it.
+	dentryIndex = k_findDirEntry(dirName, &entry);
+	if ((dentryIndex == -1) || (entry.attribute != FS_ATTRIBUTE_DIRECTORY)) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// If directory is open, can't delete it.
+	if (k_findOpenHandle(FS_TYPE_DIRECTORY, entry.startClusterIndex) != null) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// If directory isn't empty, can't delete it.
+	if (k_isDirEmpty(entry.startClusterIndex) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// free all clusters of directory.
+	if (k_freeClusterUntilEnd(entry.startClusterIndex) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	// initialize directory entry as 0, and remove it from dentry cache.
+	dentry = &(g_fileSystemManager.dentryPool[dentryIndex]);
+	k_memset(&entry, 0, sizeof(entry));
+	if (k_setDirEntryData(dentry->clusterIndex, dentry->index, &entry) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return -1;
+	}
+	
+	k_removeDentry(dentryIndex);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	return 0;
+}
+
+Dir* k_openDir(const char* dirName) {
+	Dir* dir;
+	DirEntry* dirBuffer;
+	dword parentClusterIndex;
+	dword startClusterIndex;
+	char fileName[FS_MAXFILENAMELENGTH];
+	int dentryIndex;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// resolve directory (empty name means root directory).
+	if (k_parsePath(dirName, &parentClusterIndex, fileName) == false) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+	}
+	
+	if (fileName[0] == '\0') {
+		startClusterIndex = FS_ROOTCLUSTER;
+		
+	} else {
+		dentryIndex = k_lookupDentry(parentClusterIndex, fileName);
+		if ((dentryIndex == FS_INVALIDDENTRY) || (g_fileSystemManager.dentryPool[dentryIndex].entry.attribute != FS_ATTRIBUTE_DIRECTORY)) {
+			k_unlock(&(g_fileSystemManager.mutex));
+			return null;
+		}
+		
+		startClusterIndex = g_fileSystemManager.dentryPool[dentryIndex].entry.startClusterIndex;
+	}
+	
+	// allocate directory handle.
+	dir = (Dir*)k_allocFileDirHandle();
+	if (dir == null) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+	}
+	
+	// allocate directory cluster buffer.
+	dirBuffer = (DirEntry*)k_allocMem(FS_CLUSTERSIZE);
+	if (dirBuffer == null) {
+		k_freeFileDirHandle(dir);
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+	}
+	
+	// read the first cluster of directory.
+	if (k_readDirCluster(startClusterIndex, (byte*)dirBuffer) == false) {
+		k_freeFileDirHandle(dir);
+		k_freeMem(dirBuffer);
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+	}
+	
+	// initialize directory handle.
+	dir->type = FS_TYPE_DIRECTORY;
+	dir->dirHandle.currentOffset = 0;
+	dir->dirHandle.dirBuffer = dirBuffer;
+	dir->dirHandle.startClusterIndex = startClusterIndex;
+	dir->dirHandle.currentClusterIndex = startClusterIndex;
+	
+	// register directory handle to open handle hash table.
+	k_addOpenHandle(dir);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	
+	return dir;
+}
+
+DirEntry* k_readDir(Dir* dir) {
+	DirHandle* dirHandle;
+	DirEntry* entry;
+	dword nextClusterIndex;
+	
+	// If handle == null or handle type != directory handle, return.
+	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
+		return null;
+	}
+	
+	dirHandle = &(dir->dirHandle);
+	
+	// check the range of current directory pointer offset.
+	if (dirHandle->currentOffset < 0) {
+		return null;
+	}
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// search directory entries following the cluster chain of directory.
+	entry = dirHandle->dirBuffer;
+	while (true) {
+		while (dirHandle->currentOffset < FS_MAXDIRECTORYENTRYCOUNT) {
+			// If file exists, return the directory entry.
+			if (entry[dirHandle->currentOffset].startClusterIndex != 0) {
+				k_unlock(&(g_fileSystemManager.mutex));
+				return &(entry[dirHandle->currentOffset++]);
+			}
+			
+			dirHandle->currentOffset++;
+		}
+		
+		// move to next directory cluster. (If it's last cluster, directory pointer stays at the end.)
+		if ((k_getClusterLinkData(dirHandle->currentClusterIndex, &nextClusterIndex) == false) || (nextClusterIndex == FS_LASTCLUSTER)) {
+			break;
+		}
+		
+		if (k_readDirCluster(nextClusterIndex, (byte*)entry) == false) {
+			break;
+		}
+		
+		dirHandle->currentClusterIndex = nextClusterIndex;
+		dirHandle->currentOffset = 0;
+	}
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	return null;
+}
+
+void k_rewindDir(Dir* dir) {
+	DirHandle* dirHandle;
+	
+	// If handle == null or handle type != directory handle, return.
+	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
+		return;
+	}
+	
+	dirHandle = &(dir->dirHandle);
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// read the first cluster of directory again, if directory pointer moved to next cluster.
+	if (dirHandle->currentClusterIndex != dirHandle->startClusterIndex) {
+		if (k_readDirCluster(dirHandle->startClusterIndex, (byte*)dirHandle->dirBuffer) == false) {
+			k_unlock(&(g_fileSystemManager.mutex));
+			return;
+		}
+		
+		dirHandle->currentClusterIndex = dirHandle->startClusterIndex;
+	}
+	
+	// set 0 to current directory pointer offset.
+	dirHandle->currentOffset = 0;
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+}
+
+int k_closeDir(Dir* dir) {
+	DirHandle* dirHandle;
+	
+	// If handle == null or handle type != directory handle, return.
+	if ((dir == null) || (dir->type != FS_TYPE_DIRECTORY)) {
+		return -1;
+	}
+	
+	dirHandle = &(dir->dirHandle);
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// free directory cluster buffer.
+	k_freeMem(dirHandle->dirBuffer);
+	
+	// unregister directory handle from open handle hash table, and free it.
+	k_removeOpenHandle(dir);
+	k_freeFileDirHandle(dir);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	
+	return 0;
+}
+
+bool k_isFileOpen(const DirEntry* entry) {
+	// search open file in open handle hash table without scanning handle pool.
+	if (k_findOpenHandle(FS_TYPE_FILE, entry->startClusterIndex) != null) {
+		return true;
+	}
+	
+	return false;
+}
+
+bool k_writeZero(File* file, qword count) {
+	qword oldFileSize;
+	Mutex* fileLock;
+	bool sizeChanged;
+	bool result;
+	
+	if ((file == null) || (file->type != FS_TYPE_FILE)) {
+		return false;
+	}
+	
+	fileLock = k_getFileLock(&(file->fileHandle));
+	k_lock(fileLock);
+	
+	oldFileSize = file->fileHandle.fileSize;
+	result = k_writeZeroData(file, count);
+	
+	// If file size changes, update directory entry once after unlocking the file, in order to keep locking order (mutex -> file lock).
+	sizeChanged = (file->fileHandle.fileSize != oldFileSize);
+	k_unlock(fileLock);
+	
+	if (sizeChanged == true) {
+		k_lock(&(g_fileSystemManager.mutex));
+		k_updateDirEntry(&(file->fileHandle));
+		k_unlock(&(g_fileSystemManager.mutex));
+	}
+	
+	return result;
+}
+
+static bool k_writeZeroData(File* file, qword count) {
+	byte* buffer;
+	qword remainCount;
+	qword writeCount;
+	
+	// allocate memory and write by cluster-level in order to improve speed.
+	buffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
+	if (buffer == null) {
+		return false;
+	}
+	
+	// put 0 to buffer.
+	k_memset(buffer, 0, FS_CLUSTERSIZE);
+	
+	// write by cluster-level.
+	remainCount = count;
+	while (remainCount != 0) {
+		writeCount = MIN(remainCount, FS_CLUSTERSIZE);
+		if (k_writeFileData(file, buffer, writeCount) != writeCount) {
+			k_freeMem(buffer);
+			return false;
+		}
+		
+		remainCount -= writeCount;
+	}
+	
+	k_freeMem(buffer);
+	return true;
+}
+
+static bool k_formatJournal(dword startAddr) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	bool result;
+	
+	k_lock(&(journal->mutex));
+	
+	// disable journal and drop running transaction, because it belongs to the file system before formatting.
+	journal->enabled = false;
+	if (journal->logBuffer != null) {
+		k_memset(journal->logBuffer, 0, 512);
+	}
+	
+	// write journal header which has empty log (the first transaction sequence is 1).
+	journal->startAddr = startAddr;
+	journal->sequence = 1;
+	journal->logOffset = 1;
+	journal->loggedDirClusterCount = 0;
+	result = k_writeJournalHeader();
+	
+	k_unlock(&(journal->mutex));
+	
+	return result;
+}
+
+static bool k_mountJournal(void) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalHeader* header;
+	
+	k_lock(&(journal->mutex));
+	
+	journal->enabled = false;
+	journal->startAddr = 1;
+	journal->commitCount = 0;
+	journal->checkpointCount = 0;
+	journal->loggedDirClusterCount = 0;
+	
+	// If reserved area doesn't have journal (file system formatted by old version), mount without journal.
+	if (g_fileSystemManager.reservedSectorCount < FS_JOURNALSECTORCOUNT) {
+		k_unlock(&(journal->mutex));
+		return true;
+	}
+	
+	header = (JournalHeader*)g_tempBuffer;
+	if ((g_readHddSector(true, true, journal->startAddr, 1, (char*)header) != 1) || (header->signature != FS_JOURNALSIGNATURE)) {
+		k_unlock(&(journal->mutex));
+		return true;
+	}
+	
+	journal->sequence = header->sequence;
+	journal->logOffset = 1;
+	
+	// allocate log buffer: descriptor sector + max metadata sectors of a transaction.
+	if (journal->logBuffer == null) {
+		journal->logBuffer = (byte*)k_allocMem(512 * (1 + FS_JOURNALMAXSECTORCOUNT));
+		if (journal->logBuffer == null) {
+			k_unlock(&(journal->mutex));
+			return false;
+		}
+	}
+	
+	k_memset(journal->logBuffer, 0, 512);
+	
+	// replay committed transactions in log.
+	if (k_replayJournal() == false) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// enable journal only for hard disk, because RAM disk is volatile.
+	if (g_getHddSectorPointer == null) {
+		journal->enabled = true;
+	}
+	
+	k_unlock(&(journal->mutex));
+	
+	return true;
+}
+
+static bool k_replayJournal(void) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalBlockTag* tag;
+	byte* block;
+	dword startSequence;
+	dword replayedCount;
+	bool valid;
+	dword i;
+	
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	startSequence = journal->sequence;
+	journal->revokeCount = 0;
+	
+	//----------------------------------------------------------------------------------------------------
+	// read transactions from the start of log in sequence order, and build revoke table from revoke records.
+	// The first invalid transaction (not committed, or left by the previous round of log) ends log.
+	//----------------------------------------------------------------------------------------------------
+	while (true) {
+		if (k_readJournalTransaction(&valid) == false) {
+			return false;
+		}
+		
+		if (valid == false) {
+			break;
+		}
+		
+		for (i = 0; i < descriptor->blockCount; i++) {
+			tag = &(descriptor->tags[i]);
+			if ((tag->type == FS_JOURNALBLOCK_REVOKE) && (k_addJournalRevoke(tag->offset, journal->sequence) == false)) {
+				return false;
+			}
+		}
+		
+		journal->logOffset += descriptor->sectorCount + 2;
+		journal->sequence++;
+	}
+	
+	replayedCount = journal->sequence - startSequence;
+	
+	//----------------------------------------------------------------------------------------------------
+	// read committed transactions again, and write metadata blocks of each transaction to home locations.
+	// Directory cluster isn't written if it has been revoked by the same or later transaction.
+	//----------------------------------------------------------------------------------------------------
+	journal->logOffset = 1;
+	journal->sequence = startSequence;
+	for (i = 0; i < replayedCount; i++) {
+		if ((k_readJournalTransaction(&valid) == false) || (valid == false)) {
+			return false;
+		}
+		
+		// write metadata blocks to home locations directly. (cache isn't used while replaying.)
+		block = journal->logBuffer + 512;
+		for (tag = descriptor->tags; tag < (descriptor->tags + descriptor->blockCount); tag++) {
+			if (tag->type == FS_JOURNALBLOCK_CLUSTERLINK) {
+				if (k_writeClusterLinkTableWithoutCache(tag->offset, block) == false) {
+					return false;
+				}
+				
+			} else if ((tag->type == FS_JOURNALBLOCK_DIRECTORY) && (k_isJournalBlockRevoked(tag->offset, journal->sequence) == false)) {
+				if (k_writeClusterWithoutCache(tag->offset, block) == false) {
+					return false;
+				}
+			}
+			
+			block += k_getJournalBlockSectorCount(tag->type) * 512;
+		}
+		
+		journal->logOffset += descriptor->sectorCount + 2;
+		journal->sequence++;
+	}
+	
+	// make replayed blocks durable before log restarts.
+	if ((replayedCount > 0) && (k_flushHddWriteCache() == false)) {
+		return false;
+	}
+	
+	// drop the last read descriptor, and restart log from the start (all replayed blocks are on home locations).
+	k_memset(descriptor, 0, 512);
+	journal->logOffset = 1;
+	if (k_writeJournalHeader() == false) {
+		return false;
+	}
+	
+	// If file system is mounted again, cache buffers might be older than replayed blocks, so discard them.
+	if ((replayedCount > 0) && (g_fileSystemManager.cacheEnabled == true)) {
+		k_lock(&(g_fileSystemManager.cacheMutex));
+		k_waitAllCacheBufferIo();
+		k_discardAllCacheBuffer(CACHE_CLUSTERLINKTABLEAREA);
+		k_discardAllCacheBuffer(CACHE_DATAAREA);
+		k_unlock(&(g_fileSystemManager.cacheMutex));
+	}
+	
+	return true;
+}
+
+static bool k_readJournalTransaction(bool* valid) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalCommit* commit;
+	
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	commit = (JournalCommit*)g_tempBuffer;
+	*valid = false;
+	
+	// If log doesn't have space for a transaction, it ends log.
+	if ((journal->logOffset + 2) > FS_JOURNALSECTORCOUNT) {
+		return true;
+	}
+	
+	// read descriptor sector.
+	if (g_readHddSector(true, true, journal->startAddr + journal->logOffset, 1, (char*)descriptor) != 1) {
+		return false;
+	}
+	
+	if ((descriptor->signature != FS_JOURNALDESCRIPTORSIGNATURE) || (descriptor->sequence != journal->sequence) ||
+	    (descriptor->blockCount > FS_JOURNALMAXBLOCKCOUNT) || (descriptor->sectorCount > FS_JOURNALMAXSECTORCOUNT) ||
+	    ((journal->logOffset + descriptor->sectorCount + 2) > FS_JOURNALSECTORCOUNT)) {
+		return true;
+	}
+	
+	// read metadata blocks and commit sector.
+	if ((descriptor->sectorCount > 0) && 
+	    (g_readHddSector(true, true, journal->startAddr + journal->logOffset + 1, descriptor->sectorCount, (char*)(journal->logBuffer + 512)) != descriptor->sectorCount)) {
+		return false;
+	}
+	
+	if (g_readHddSector(true, true, journal->startAddr + journal->logOffset + 1 + descriptor->sectorCount, 1, (char*)commit) != 1) {
+		return false;
+	}
+	
+	// The transaction is valid only if commit sector matches it.
+	if ((commit->signature == FS_JOURNALCOMMITSIGNATURE) && (commit->sequence == journal->sequence) &&
+	    (commit->checksum == k_calcJournalChecksum(journal->logBuffer + 512, descriptor->sectorCount))) {
+		*valid = true;
+	}
+	
+	return true;
+}
+
+static bool k_addJournalRevoke(dword offset, dword sequence) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	dword i;
+	
+	// If the cluster has been revoked already, update the sequence (transactions are read in sequence order).
+	for (i = 0; i < journal->revokeCount; i++) {
+		if (journal->revokes[i].offset == offset) {
+			journal->revokes[i].sequence = sequence;
+			return true;
+		}
+	}
+	
+	// [NOTE] only directory clusters which are in log can be revoked, so revoke table is never full unless log is broken.
+	if (journal->revokeCount >= FS_JOURNALMAXREVOKECOUNT) {
+		return false;
+	}
+	
+	journal->revokes[journal->revokeCount].offset = offset;
+	journal->revokes[journal->revokeCount].sequence = sequence;
+	journal->revokeCount++;
+	
+	return true;
+}
+
+static bool k_isJournalBlockRevoked(dword offset, dword sequence) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	dword i;
+	
+	for (i = 0; i < journal->revokeCount; i++) {
+		if (journal->revokes[i].offset == offset) {
+			return (journal->revokes[i].sequence >= sequence);
+		}
+	}
+	
+	return false;
+}
+
+static void k_addLoggedDirCluster(dword clusterIndex) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	dword i;
+	
+	for (i = 0; i < journal->loggedDirClusterCount; i++) {
+		if (journal->loggedDirClusters[i] == clusterIndex) {
+			return;
+		}
+	}
+	
+	// [NOTE] a directory cluster takes 8 sectors of log, so log has at most 127 directory clusters until it restarts.
+	if (journal->loggedDirClusterCount < FS_JOURNALMAXREVOKECOUNT) {
+		journal->loggedDirClusters[journal->loggedDirClusterCount++] = clusterIndex;
+	}
+}
+
+static bool k_restartJournalLog(void) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	
+	// [NOTE] It's called after all metadata in log has been written to home locations and flushed (checkpoint),
+	//        so no committed transaction is replayed and no directory cluster needs to be revoked after it.
+	journal->logOffset = 1;
+	journal->checkpointCount++;
+	journal->loggedDirClusterCount = 0;
+	
+	return k_writeJournalHeader();
+}
+
+static bool k_writeJournalHeader(void) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalHeader header;
+	
+	// the transactions before the sequence of header are ignored when replaying.
+	k_memset(&header, 0, sizeof(header));
+	header.signature = FS_JOURNALSIGNATURE;
+	header.sequence = journal->sequence;
+	
+	if (g_writeHddSector(true, true, journal->startAddr, 1, (char*)&header) != 1) {
+		return false;
+	}
+	
+	return true;
+}
+
+static bool k_addJournalBlock(dword type, dword offset, const byte* buffer) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalBlockTag* tag;
+	byte* block;
+	dword sectorCount;
+	dword i;
+	
+	k_lock(&(journal->mutex));
+	
+	// If journal is disabled while waiting for journal mutex (formatting), fail.
+	if (journal->enabled == false) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// If directory cluster is reused, cancel its revoke record in running transaction.
+	if (type == FS_JOURNALBLOCK_DIRECTORY) {
+		k_removeJournalBlock(FS_JOURNALBLOCK_REVOKE, offset);
+	}
+	
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	sectorCount = k_getJournalBlockSectorCount(type);
+	
+	// If running transaction already has the block, overwrite it.
+	block = journal->logBuffer + 512;
+	for (i = 0; i < descriptor->blockCount; i++) {
+		tag = &(descriptor->tags[i]);
+		if ((tag->type == type) && (tag->offset == offset)) {
+			k_memcpy(block, buffer, sectorCount * 512);
+			k_unlock(&(journal->mutex));
+			return true;
+		}
+		
+		block += k_getJournalBlockSectorCount(tag->type) * 512;
+	}
+	
+	// If running transaction is full, commit it, and start a new transaction.
+	if ((descriptor->blockCount >= FS_JOURNALMAXBLOCKCOUNT) || ((descriptor->sectorCount + sectorCount) > FS_JOURNALMAXSECTORCOUNT)) {
+		if (k_commitJournal() == false) {
+			k_unlock(&(journal->mutex));
+			return false;
+		}
+		
+		block = journal->logBuffer + 512;
+	}
+	
+	// append the block to the end of running transaction.
+	tag = &(descriptor->tags[descriptor->blockCount]);
+	tag->type = type;
+	tag->offset = offset;
+	k_memcpy(block, buffer, sectorCount * 512);
+	descriptor->blockCount++;
+	descriptor->sectorCount += sectorCount;
+	
+	k_unlock(&(journal->mutex));
+	
+	return true;
+}
+
+static bool k_readJournalBlock(dword type, dword offset, byte* buffer) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalBlockTag* tag;
+	byte* block;
+	dword i;
+	
+	// [NOTE] check without journal mutex for fast path. 
+	//        metadata block is read and written with mutex or allocation mutex, so the result doesn't change for the caller.
+	if ((journal->enabled == false) || (((JournalDescriptor*)journal->logBuffer)->blockCount == 0)) {
+		return false;
+	}
+	
+	k_lock(&(journal->mutex));
+	
+	// search the block in running transaction.
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	block = journal->logBuffer + 512;
+	for (i = 0; i < descriptor->blockCount; i++) {
+		tag = &(descriptor->tags[i]);
+		if ((tag->type == type) && (tag->offset == offset)) {
+			k_memcpy(buffer, block, k_getJournalBlockSectorCount(type) * 512);
+			k_unlock(&(journal->mutex));
+			return true;
+		}
+		
+		block += k_getJournalBlockSectorCount(tag->type) * 512;
+	}
+	
+	k_unlock(&(journal->mutex));
+	
+	return false;
+}
+
+static bool k_discardJournalBlock(dword type, dword offset) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	bool result = true;
+	dword i;
+	
+	if ((journal->enabled == false) || ((((JournalDescriptor*)journal->logBuffer)->blockCount == 0) && (journal->loggedDirClusterCount == 0))) {
+		return true;
+	}
+	
+	k_lock(&(journal->mutex));
+	
+	// remove the block from running transaction.
+	k_removeJournalBlock(type, offset);
+	
+	// If committed transactions in log have the directory cluster, add revoke record to running transaction,
+	// because k_removeJournalBlock can't remove it from log.
+	if (type == FS_JOURNALBLOCK_DIRECTORY) {
+		for (i = 0; i < journal->loggedDirClusterCount; i++) {
+			if (journal->loggedDirClusters[i] != offset) {
+				continue;
+			}
+			
+			// remove it from logged directory clusters first, because adding revoke record might commit and restart log.
+			journal->loggedDirClusters[i] = journal->loggedDirClusters[--journal->loggedDirClusterCount];
+			result = k_addJournalBlock(FS_JOURNALBLOCK_REVOKE, offset, null);
+			if (result == false) {
+				k_addLoggedDirCluster(offset);
+			}
+			
+			break;
+		}
+	}
+	
+	k_unlock(&(journal->mutex));
+	
+	return result;
+}
+
+static void k_removeJournalBlock(dword type, dword offset) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalBlockTag* tag;
+	byte* block;
+	dword sectorCount;
+	dword remainSectorCount;
+	dword i;
+	
+	// [NOTE] It's called with journal mutex.
+	
+	// search the block in running transaction.
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	block = journal->logBuffer + 512;
+	remainSectorCount = descriptor->sectorCount;
+	for (i = 0; i < descriptor->blockCount; i++) {
+		tag = &(descriptor->tags[i]);
+		sectorCount = k_getJournalBlockSectorCount(tag->type);
+		remainSectorCount -= sectorCount;
+		if ((tag->type == type) && (tag->offset == offset)) {
+			break;
+		}
+		
+		block += sectorCount * 512;
+	}
+	
+	// remove the block by moving the following tags and blocks forward.
+	// [NOTE] k_memcpy copies forward, so it's safe when destination is lower than source.
+	if (i < descriptor->blockCount) {
+		k_memcpy(tag, tag + 1, sizeof(JournalBlockTag) * (descriptor->blockCount - i - 1));
+		k_memcpy(block, block + (sectorCount * 512), remainSectorCount * 512);
+		descriptor->blockCount--;
+		descriptor->sectorCount -= sectorCount;
+	}
+}
+
+static bool k_commitJournal(void) {
+	Journal* journal = &(g_fileSystemManager.journal);
+	JournalDescriptor* descriptor;
+	JournalCommit commit;
+	byte* block;
+	dword logSectorCount;
+	dword i;
+	
+	k_lock(&(journal->mutex));
+	
+	descriptor = (JournalDescriptor*)journal->logBuffer;
+	if ((journal->enabled == false) || (descriptor->blockCount == 0)) {
+		k_unlock(&(journal->mutex));
+		return true;
+	}
+	
+	descriptor->signature = FS_JOURNALDESCRIPTORSIGNATURE;
+	descriptor->sequence = journal->sequence;
+	logSectorCount = 1 + descriptor->sectorCount + 1; // descriptor sector + metadata sectors + commit sector
+	
+	//----------------------------------------------------------------------------------------------------
+	// If log doesn't have enough space, write back all cache buffers in order to make home locations
+	// of committed transactions durable (checkpoint), and restart log from the start.
+	// If not, write back changed data clusters only, because metadata of the transaction might point to them (ordered).
+	//----------------------------------------------------------------------------------------------------
+	if ((journal->logOffset + logSectorCount) > FS_JOURNALSECTORCOUNT) {
+		if ((k_writeBackAllCacheBuffers() == false) || (k_flushHddWriteCache() == false) || (k_restartJournalLog() == false)) {
+			k_unlock(&(journal->mutex));
+			return false;
+		}
+		
+	} else if (k_writeBackCacheBuffers(CACHE_DATAAREA) == false) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// write descriptor sector and metadata blocks to log sequentially at once.
+	if (g_writeHddSector(true, true, journal->startAddr + journal->logOffset, 1 + descriptor->sectorCount, (char*)journal->logBuffer) != (1 + descriptor->sectorCount)) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// flush write cache of hard disk, so that data clusters and the transaction reach media before commit sector.
+	if (k_flushHddWriteCache() == false) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// write commit sector after them. The transaction is committed when commit sector is written.
+	k_memset(&commit, 0, sizeof(commit));
+	commit.signature = FS_JOURNALCOMMITSIGNATURE;
+	commit.sequence = journal->sequence;
+	commit.checksum = k_calcJournalChecksum(journal->logBuffer + 512, descriptor->sectorCount);
+	if (g_writeHddSector(true, true, journal->startAddr + journal->logOffset + 1 + descriptor->sectorCount, 1, (char*)&commit) != 1) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// flush write cache of hard disk again, so that commit sector reaches media before home locations are written back.
+	if (k_flushHddWriteCache() == false) {
+		k_unlock(&(journal->mutex));
+		return false;
+	}
+	
+	// write metadata blocks to home locations through cache. (They're written back later.)
+	// Directory clusters are remembered, because they must be revoked if they're freed before log restarts.
+	block = journal->logBuffer + 512;
+	for (i = 0; i < descriptor->blockCount; i++) {
+		if (k_writeJournalBlockToHome(&(descriptor->tags[i]), block) == false) {
+			k_unlock(&(journal->mutex));
+			return false;
+		}
+		
+		if (descriptor->tags[i].type == FS_JOURNALBLOCK_DIRECTORY) {
+			k_addLoggedDirCluster(descriptor->tags[i].offset);
+		}
+		
+		block += k_getJournalBlockSectorCount(descriptor->tags[i].type) * 512;
+	}
+	
+	// start a new transaction.
+	journal->logOffset += logSectorCount;
+	journal->sequence++;
+	journal->commitCount++;
+	k_memset(descriptor, 0, 512);
+	
+	k_unlock(&(journal->mutex));
+	
+	return true;
+}
+
+static bool k_writeJournalBlockToHome(const JournalBlockTag* tag, byte* buffer) {
+	bool result;
+	
+	// revoke record has no block.
+	if (tag->type == FS_JOURNALBLOCK_REVOKE) {
+		return true;
+	}
+	
+	if (g_fileSystemManager.cacheEnabled == false) {
+		if (tag->type == FS_JOURNALBLOCK_CLUSTERLINK) {
+			return k_writeClusterLinkTableWithoutCache(tag->offset, buffer);
+		}
+		
+		return k_writeClusterWithoutCache(tag->offset, buffer);
+	}
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	
+	if (tag->type == FS_JOURNALBLOCK_CLUSTERLINK) {
+		result = k_writeClusterLinkTableWithCache(tag->offset, buffer);
+		
+	} else {
+		result = k_writeClusterWithCache(tag->offset, buffer);
+	}
+	
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
+}
+
+static dword k_getJournalBlockSectorCount(dword type) {
+	if (type == FS_JOURNALBLOCK_CLUSTERLINK) {
+		return 1;
+		
+	} else if (type == FS_JOURNALBLOCK_DIRECTORY) {
+		return FS_SECTORSPERCLUSTER;
+	}
+	
+	return 0; // revoke record
+}
+
+static dword k_calcJournalChecksum(const byte* buffer, dword sectorCount) {
+	dword checksum;
+	dword i;
+	
+	// rotate-xor checksum of all dwords in metadata sectors.
+	checksum = 0;
+	for (i = 0; i < (sectorCount * 512 / 4); i++) {
+		checksum = ((checksum << 1) | (checksum >> 31)) ^ ((dword*)buffer)[i];
+	}
+	
+	return checksum;
+}
+
+static bool k_readDirCluster(dword clusterIndex, byte* buffer) {
+	// If running transaction of journal has the directory cluster, read it.
+	if (k_readJournalBlock(FS_JOURNALBLOCK_DIRECTORY, clusterIndex, buffer) == true) {
+		return true;
+	}
+	
+	return k_readCluster(clusterIndex, buffer);
+}
+
+static bool k_writeDirCluster(dword clusterIndex, byte* buffer) {
+	// If journal is enabled, write the directory cluster to running transaction. It's written to home location at commit.
+	if (g_fileSystemManager.journal.enabled == true) {
+		return k_addJournalBlock(FS_JOURNALBLOCK_DIRECTORY, clusterIndex, buffer);
+	}
+	
+	return k_writeCluster(clusterIndex, buffer);
+}
+
+const void* k_mapFile(const char* fileName, dword* size) {
+	Task* task;
+	DirEntry entry;
+	FileMapping* mapping;
+	File* file;
+	qword addr;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	// If file doesn't exist or it's directory or zero-sized, mapping fails.
+	// If file is 4GB or larger, mapping also fails, because a view is mapped in memory at once. (use pread for large files.)
+	if ((k_findDirEntry(fileName, &entry) == -1) || (entry.attribute != FS_ATTRIBUTE_FILE) || (entry.fileSize == 0) || (entry.fileSize > 0xFFFFFFFF)) {
+		k_unlock(&(g_fileSystemManager.mutex));
+		return null;
+	}
+	
+	// If file is already mapped, share the file mapping.
+	mapping = k_findFileMapping(entry.startClusterIndex);
+	if (mapping != null) {
+		k_lockSpin(&(mapping->spinlock));
+		mapping->refCount++;
+		k_unlockSpin(&(mapping->spinlock));
+		
+	} else {
+		// open file in order to keep it open while it's mapped.
+		file = k_openFile(fileName, "r");
+		if (file == null) {
+			k_unlock(&(g_fileSystemManager.mutex));
+			return null;
+		}
+		
+		// allocate file mapping. (It's initialized outside mutex.)
+		mapping = (FileMapping*)k_allocPool(&(g_fileSystemManager.mappingPool));
+		if (mapping == null) {
+			k_closeFile(file);
+			k_unlock(&(g_fileSystemManager.mutex));
+			return null;
+		}
+		
+		k_memset(mapping, 0, sizeof(FileMapping));
+		mapping->file = file;
+		mapping->size = (dword)entry.fileSize;
+		mapping->pageCount = (dword)((entry.fileSize + (FS_CLUSTERSIZE - 1)) / FS_CLUSTERSIZE);
+		k_initMutex(&(mapping->mutex));
+		k_initSpinlock(&(mapping->spinlock));
+		mapping->refCount = 1;
+	}
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+	
+	//----------------------------------------------------------------------------------------------------
+	// initialize file mapping if it hasn't been initialized. (The other mappings of the same file wait for it.)
+	// No page is read here: pages of process view are filled at page faults.
+	//----------------------------------------------------------------------------------------------------
+	k_lock(&(mapping->mutex));
+	
+	if ((mapping->clusters == null) && (k_initFileMapping(mapping) == false)) {
+		k_unlock(&(mapping->mutex));
+		k_releaseFileMapping(mapping);
+		return null;
+	}
+	
+	// If task has address space, add file view region to it. Otherwise (kernel task), make kernel view.
+	task = k_getRunningTask(k_getApicId());
+	if (task->addressSpace != null) {
+		addr = k_addFileViewRegion(task->addressSpace, mapping->size, mapping);
+		
+	} else {
+		addr = (qword)k_makeKernelView(mapping);
+	}
+	
+	k_unlock(&(mapping->mutex));
+	
+	if (addr == 0) {
+		k_releaseFileMapping(mapping);
+		return null;
+	}
+	
+	*size = mapping->size;
+	
+	return (const void*)addr;
+}
+
+int k_unmapFile(const void* addr) {
+	Task* task;
+	FileMapping* mapping = null;
+	FileMapping* current;
+	int i;
+	
+	task = k_getRunningTask(k_getApicId());
+	
+	// If task has address space, remove file view region from it.
+	if (task->addressSpace != null) {
+		mapping = k_removeFileViewRegion(task->addressSpace, (qword)addr);
+		
+	// If task is kernel task, search file mapping matching kernel view.
+	} else {
+		k_lock(&(g_fileSystemManager.mutex));
+		
+		for (i = 0; i < k_getPoolUsedCount(&(g_fileSystemManager.mappingPool)); i++) {
+			current = (FileMapping*)k_getPoolUsedData(&(g_fileSystemManager.mappingPool), i);
+			if ((current->kernelView != null) && (current->kernelView == addr)) {
+				mapping = current;
+				break;
+			}
+		}
+		
+		k_unlock(&(g_fileSystemManager.mutex));
 	}
 	
-	// put 0 to buffer.
-	k_memset(buffer, 0, FS_CLUSTERSIZE);
+	if (mapping == null) {
+		return -1;
+	}
 	
-	// write by cluster-level.
-	remainCount = count;
-	while (remainCount != 0) {
-		writeCount = MIN(remainCount, FS_CLUSTERSIZE);
-		if (k_writeFile(buffer, 1, writeCount, file) != writeCount) {
-			k_freeMem(buffer);
+	k_releaseFileMapping(mapping);
+	
+	return 0;
+}
+
+static FileMapping* k_findFileMapping(dword startClusterIndex) {
+	FileMapping* mapping;
+	int i;
+	
+	// search file mapping in used mappings only (max 64).
+	for (i = 0; i < k_getPoolUsedCount(&(g_fileSystemManager.mappingPool)); i++) {
+		mapping = (FileMapping*)k_getPoolUsedData(&(g_fileSystemManager.mappingPool), i);
+		if (mapping->file->fileHandle.startClusterIndex == startClusterIndex) {
+			return mapping;
+		}
+	}
+	
+	return null;
+}
+
+static bool k_initFileMapping(FileMapping* mapping) {
+	FileHandle* fileHandle = &(mapping->file->fileHandle);
+	Mutex* fileLock;
+	dword* clusters;
+	qword* pages;
+	HddRequest** requests;
+	dword clusterIndex;
+	bool result = true;
+	dword i;
+	
+	clusters = (dword*)k_allocMem(mapping->pageCount * sizeof(dword));
+	pages = (qword*)k_allocMem(mapping->pageCount * sizeof(qword));
+	requests = (HddRequest**)k_allocMem(mapping->pageCount * sizeof(HddRequest*));
+	if ((clusters == null) || (pages == null) || (requests == null)) {
+		result = false;
+	}
+	
+	fileLock = k_getFileLock(fileHandle);
+	k_lock(fileLock);
+	
+	// write back changed cache buffers of file, because pages are read from hard disk directly, not through cache.
+	if ((result == true) && (g_fileSystemManager.cacheEnabled == true)) {
+		result = k_writeBackFileCacheBuffers(fileHandle);
+	}
+	
+	// resolve cluster of each page following cluster chain, so that page fault handler doesn't need cluster link table.
+	clusterIndex = fileHandle->startClusterIndex;
+	for (i = 0; (result == true) && (i < mapping->pageCount); i++) {
+		if (clusterIndex == FS_LASTCLUSTER) {
+			result = false;
+			break;
+		}
+		
+		clusters[i] = clusterIndex;
+		result = k_getClusterLinkData(clusterIndex, &clusterIndex);
+	}
+	
+	k_unlock(fileLock);
+	
+	if (result == false) {
+		if (clusters != null) {
+			k_freeMem(clusters);
+		}
+		
+		if (pages != null) {
+			k_freeMem(pages);
+		}
+		
+		if (requests != null) {
+			k_freeMem(requests);
+		}
+		
+		return false;
+	}
+	
+	k_memset(pages, 0, mapping->pageCount * sizeof(qword));
+	k_memset(requests, 0, mapping->pageCount * sizeof(HddRequest*));
+	
+	k_lockSpin(&(mapping->spinlock));
+	mapping->clusters = clusters;
+	mapping->pages = pages;
+	mapping->requests = requests;
+	k_unlockSpin(&(mapping->spinlock));
+	
+	return true;
+}
+
+static byte* k_makeKernelView(FileMapping* mapping) {
+	byte* view;
+	
+	// If kernel view has already been made, share it.
+	if (mapping->kernelView != null) {
+		return mapping->kernelView;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// If all clusters of file are contiguous in RAM disk memory, point to them directly (zero-copy).
+	// Otherwise, copy the whole file once to a private view buffer through cache and read-ahead.
+	// [NOTE] kernel memory has no per-page protection and demand paging, so kernel view is made at mapping time,
+	//        and it's kept unchanged by refusing write-related opens while it's mapped.
+	//----------------------------------------------------------------------------------------------------
+	view = k_getFileDirectPointer(mapping);
+	mapping->direct = (view != null);
+	if (mapping->direct == false) {
+		view = (byte*)k_allocMem(mapping->size);
+		if (view == null) {
+			return null;
+		}
+		
+		if (k_readFileAt(mapping->file, view, mapping->size, 0) != mapping->size) {
+			k_freeMem(view);
+			return null;
+		}
+	}
+	
+	mapping->kernelView = view;
+	
+	return view;
+}
+
+bool k_getFileMappingPage(FileMapping* mapping, qword offset, byte** page) {
+	HddRequest* request;
+	byte* pointer;
+	byte* frame;
+	dword pageIndex;
+	dword validSize;
+	int doneCount;
+	
+	*page = null;
+	
+	pageIndex = (dword)(offset / FS_CLUSTERSIZE);
+	if (pageIndex >= mapping->pageCount) {
+		return false;
+	}
+	
+	// byte count of file data in page (the last page may be partial, and the rest is filled with 0.)
+	validSize = mapping->size - (pageIndex * FS_CLUSTERSIZE);
+	if (validSize > FS_CLUSTERSIZE) {
+		validSize = FS_CLUSTERSIZE;
+	}
+	
+	k_lockSpin(&(mapping->spinlock));
+	
+	// If page has already been filled, return it.
+	if (mapping->pages[pageIndex] != 0) {
+		*page = (byte*)(mapping->pages[pageIndex] & FS_MAPPINGPAGE_ADDRMASK);
+		k_unlockSpin(&(mapping->spinlock));
+		return true;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// RAM disk: use the RAM disk page of cluster directly (zero-copy).
+	// But, copy the last partial page in order not to show data after end of file,
+	// and copy the shared zero buffer of clusters which haven't been written, because it might not be page-aligned.
+	//----------------------------------------------------------------------------------------------------
+	if (g_getHddSectorPointer != null) {
+		pointer = k_getClusterPointer(mapping->clusters[pageIndex], false);
+		if (pointer == null) {
+			k_unlockSpin(&(mapping->spinlock));
 			return false;
 		}
 		
-		remainCount -= writeCount;
+		if ((((qword)pointer & ~FS_MAPPINGPAGE_ADDRMASK) == 0) && (validSize == FS_CLUSTERSIZE)) {
+			mapping->pages[pageIndex] = (qword)pointer;
+			
+		} else {
+			frame = (byte*)k_allocFrame();
+			if (frame == null) {
+				k_unlockSpin(&(mapping->spinlock));
+				return false;
+			}
+			
+			k_memcpy(frame, pointer, validSize);
+			k_memset(frame + validSize, 0, FS_CLUSTERSIZE - validSize);
+			mapping->pages[pageIndex] = (qword)frame | FS_MAPPINGPAGE_OWNED;
+		}
+		
+		*page = (byte*)(mapping->pages[pageIndex] & FS_MAPPINGPAGE_ADDRMASK);
+		k_unlockSpin(&(mapping->spinlock));
+		return true;
 	}
 	
-	k_freeMem(buffer);
+	//----------------------------------------------------------------------------------------------------
+	// hard disk: submit read request of cluster to a frame at the first fault, and return the frame after it completes.
+	// [NOTE] page fault handler can't sleep, so request is only checked here, and the caller retries later.
+	//        If request pool is full, request is submitted at the next fault.
+	//----------------------------------------------------------------------------------------------------
+	request = mapping->requests[pageIndex];
+	if (request == null) {
+		frame = (byte*)k_allocFrame();
+		if (frame == null) {
+			k_unlockSpin(&(mapping->spinlock));
+			return false;
+		}
+		
+		request = k_submitHddRequest(true, true, false, g_fileSystemManager.dataAreaStartAddr + ((qword)mapping->clusters[pageIndex] * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, (char*)frame);
+		if (request == null) {
+			k_freeFrame(frame);
+		}
+		
+		mapping->requests[pageIndex] = request;
+		k_unlockSpin(&(mapping->spinlock));
+		return true;
+	}
+	
+	if (k_isHddRequestDone(true, request) == false) {
+		k_unlockSpin(&(mapping->spinlock));
+		return true;
+	}
+	
+	// free the completed request. (It doesn't sleep, because the request has been completed.)
+	frame = (byte*)request->buffer;
+	doneCount = k_waitHddRequest(true, request);
+	mapping->requests[pageIndex] = null;
+	
+	if (doneCount != FS_SECTORSPERCLUSTER) {
+		k_freeFrame(frame);
+		k_unlockSpin(&(mapping->spinlock));
+		return false;
+	}
+	
+	k_memset(frame + validSize, 0, FS_CLUSTERSIZE - validSize);
+	mapping->pages[pageIndex] = (qword)frame | FS_MAPPINGPAGE_OWNED;
+	*page = frame;
+	
+	k_unlockSpin(&(mapping->spinlock));
+	
 	return true;
 }
 
+void k_shareFileMapping(FileMapping* mapping) {
+	// [NOTE] It's called only while the caller holds a reference, so file mapping isn't freed at the same time.
+	k_lockSpin(&(mapping->spinlock));
+	mapping->refCount++;
+	k_unlockSpin(&(mapping->spinlock));
+}
+
+void k_releaseFileMapping(FileMapping* mapping) {
+	byte* frame;
+	dword i;
+	
+	k_lock(&(g_fileSystemManager.mutex));
+	
+	k_lockSpin(&(mapping->spinlock));
+	mapping->refCount--;
+	if (mapping->refCount > 0) {
+		k_unlockSpin(&(mapping->spinlock));
+		k_unlock(&(g_fileSystemManager.mutex));
+		return;
+	}
+	
+	k_unlockSpin(&(mapping->spinlock));
+	
+	// If it's the last reference, wait for read requests in progress, and free pages owned by file mapping.
+	if (mapping->clusters != null) {
+		for (i = 0; i < mapping->pageCount; i++) {
+			if (mapping->requests[i] != null) {
+				frame = (byte*)mapping->requests[i]->buffer;
+				k_waitHddRequest(true, mapping->requests[i]);
+				k_freeFrame(frame);
+			}
+			
+			if (mapping->pages[i] & FS_MAPPINGPAGE_OWNED) {
+				k_freeFrame((void*)(mapping->pages[i] & FS_MAPPINGPAGE_ADDRMASK));
+			}
+		}
+		
+		k_freeMem(mapping->clusters);
+		k_freeMem(mapping->pages);
+		k_freeMem(mapping->requests);
+	}
+	
+	if ((mapping->kernelView != null) && (mapping->direct == false)) {
+		k_freeMem(mapping->kernelView);
+	}
+	
+	// close file, and free file mapping.
+	k_closeFile(mapping->file);
+	k_memset(mapping, 0, sizeof(FileMapping));
+	k_freePool(&(g_fileSystemManager.mappingPool), mapping);
+	
+	k_unlock(&(g_fileSystemManager.mutex));
+}
+
+static byte* k_getFileDirectPointer(const FileMapping* mapping) {
+	byte* startPointer;
+	byte* pointer;
+	dword i;
+	
+	// get the first cluster pointer (null if disk can't hand out a pointer).
+	startPointer = k_getClusterPointer(mapping->clusters[0], false);
+	if (startPointer == null) {
+		return null;
+	}
+	
+	// check if all clusters of file are contiguous in memory.
+	for (i = 1; i < mapping->pageCount; i++) {
+		pointer = k_getClusterPointer(mapping->clusters[i], false);
+		if (pointer != (startPointer + (i * FS_CLUSTERSIZE))) {
+			return null;
+		}
+	}
+	
+	return startPointer;
+}
+
 bool k_flushFileSystemCache(void) {
-	CacheBuffer* cacheBuffer;
-	int cacheCount;
-	int i;
+	Journal* journal = &(g_fileSystemManager.journal);
+	bool result;
 	
 	if (g_fileSystemManager.cacheEnabled == false) {
 		return true;
 	}
 	
-	k_lock(&(g_fileSystemManager.mutex));
+	k_lock(&(journal->mutex));
 	
-	// write changed cache buffer to hard disk. (cluster link table area)
-	k_getCacheBufferAndCount(CACHE_CLUSTERLINKTABLEAREA, &cacheBuffer, &cacheCount);
-	for (i = 0; i < cacheCount; i++) {
-		if (cacheBuffer[i].changed == true) {
-			if (k_writeClusterLinkTableWithoutCache(cacheBuffer[i].tag, cacheBuffer[i].buffer) == false) {
-				return false;
+	// commit running transaction, write back all cache buffers, and flush write cache of hard disk.
+	result = k_commitJournal();
+	if (result == true) {
+		result = k_writeBackAllCacheBuffers();
+	}
+	
+	if (result == true) {
+		result = k_flushHddWriteCache();
+	}
+	
+	// all metadata in log has been written to home locations, so log restarts from the start (checkpoint).
+	if ((result == true) && (journal->enabled == true) && (journal->logOffset > 1)) {
+		result = k_restartJournalLog();
+	}
+	
+	k_unlock(&(journal->mutex));
+	
+	return result;
+}
+
+static bool k_writeBackAllCacheBuffers(void) {
+	return k_writeBackCacheBuffers(CACHE_CLUSTERLINKTABLEAREA);
+}
+
+static bool k_writeBackCacheBuffers(int startCacheTableIndex) {
+	CacheBuffer* cacheBuffer;
+	int cacheCount;
+	int cacheTableIndex;
+	bool result = true;
+	int i;
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	
+	// submit all changed cache buffers of cache tables from start index to HDD request queue at once (write-back),
+	// so that request queue sorts them by LBA and merges contiguous buffers into a command.
+	for (cacheTableIndex = startCacheTableIndex; cacheTableIndex < CACHE_MAXCACHETABLEINDEX; cacheTableIndex++) {
+		k_getCacheBufferAndCount(cacheTableIndex, &cacheBuffer, &cacheCount);
+		for (i = 0; i < cacheCount; i++) {
+			if (cacheBuffer[i].changed == false) {
+				continue;
 			}
 			
+			// wait for the previous request of the buffer.
+			k_waitCacheBufferIo(cacheTableIndex, &(cacheBuffer[i]));
+			
+			cacheBuffer[i].request = k_submitCacheBufferIo(cacheTableIndex, &(cacheBuffer[i]), true);
 			cacheBuffer[i].changed = false;
+			
+			// If request pool is full, write it synchronously.
+			if (cacheBuffer[i].request == null) {
+				if (cacheTableIndex == CACHE_CLUSTERLINKTABLEAREA) {
+					result = k_writeClusterLinkTableWithoutCache(cacheBuffer[i].tag, cacheBuffer[i].buffer);
+					
+				} else {
+					result = k_writeClusterWithoutCache(cacheBuffer[i].tag, cacheBuffer[i].buffer);
+				}
+				
+				if (result == false) {
+					cacheBuffer[i].changed = true;
+					k_unlock(&(g_fileSystemManager.cacheMutex));
+					return false;
+				}
+			}
 		}
 	}
 	
-	// write changed cache buffer to hard disk. (data area)
-	k_getCacheBufferAndCount(CACHE_DATAAREA, &cacheBuffer, &cacheCount);
-	for (i = 0; i < cacheCount; i++) {
-		if (cacheBuffer[i].changed == true) {
-			if (k_writeClusterWithoutCache(cacheBuffer[i].tag, cacheBuffer[i].buffer) == false) {
-				return false;
+	// wait until all write requests are completed.
+	for (cacheTableIndex = startCacheTableIndex; cacheTableIndex < CACHE_MAXCACHETABLEINDEX; cacheTableIndex++) {
+		k_getCacheBufferAndCount(cacheTableIndex, &cacheBuffer, &cacheCount);
+		for (i = 0; i < cacheCount; i++) {
+			// If writing fails, keep the buffer changed in order to write it again later.
+			if (k_waitCacheBufferIo(cacheTableIndex, &(cacheBuffer[i])) == false) {
+				cacheBuffer[i].changed = true;
+				result = false;
 			}
+		}
+	}
+	
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
+}
+
+static bool k_writeBackFileCacheBuffers(FileHandle* fileHandle) {
+	CacheBuffer* cacheBuffer;
+	CacheBuffer* submittedBuffers[CACHE_MAXDATAAREACOUNT]; // cache buffers whose write requests have been submitted
+	int submittedCount;
+	dword clusterIndex;
+	dword clusterCount;
+	bool result = true;
+	dword i;
+	int j;
+	
+	//----------------------------------------------------------------------------------------------------
+	// submit changed cache buffers of file data to HDD request queue following cluster chain of file.
+	// [NOTE] It's called with file lock, so cluster chain of file doesn't change.
+	//----------------------------------------------------------------------------------------------------
+	submittedCount = 0;
+	clusterIndex = fileHandle->startClusterIndex;
+	clusterCount = (dword)((fileHandle->fileSize + (FS_CLUSTERSIZE - 1)) / FS_CLUSTERSIZE);
+	for (i = 0; (i < clusterCount) && (clusterIndex != FS_LASTCLUSTER) && (submittedCount < CACHE_MAXDATAAREACOUNT); i++) {
+		k_lock(&(g_fileSystemManager.cacheMutex));
+		
+		cacheBuffer = k_findCacheBuffer(CACHE_DATAAREA, clusterIndex);
+		if ((cacheBuffer != null) && (cacheBuffer->changed == true)) {
+			// wait for the previous request of the buffer.
+			k_waitCacheBufferIo(CACHE_DATAAREA, cacheBuffer);
 			
-			cacheBuffer[i].changed = false;
+			cacheBuffer->request = k_submitCacheBufferIo(CACHE_DATAAREA, cacheBuffer, true);
+			cacheBuffer->changed = false;
+			
+			// If request pool is full, write it synchronously.
+			if (cacheBuffer->request == null) {
+				if (k_writeClusterWithoutCache(cacheBuffer->tag, cacheBuffer->buffer) == false) {
+					cacheBuffer->changed = true;
+					k_unlock(&(g_fileSystemManager.cacheMutex));
+					result = false;
+					break;
+				}
+				
+			} else {
+				submittedBuffers[submittedCount++] = cacheBuffer;
+			}
+		}
+		
+		k_unlock(&(g_fileSystemManager.cacheMutex));
+		
+		if (k_getClusterLinkData(clusterIndex, &clusterIndex) == false) {
+			result = false;
+			break;
 		}
 	}
 	
-	k_unlock(&(g_fileSystemManager.mutex));
+	// wait until the submitted write requests are completed.
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	for (j = 0; j < submittedCount; j++) {
+		// If writing fails, keep the buffer changed in order to write it again later.
+		if (k_waitCacheBufferIo(CACHE_DATAAREA, submittedBuffers[j]) == false) {
+			submittedBuffers[j]->changed = true;
+			result = false;
+		}
+	}
+	
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+	
+	return result;
+}
+
+static bool k_flushHddWriteCache(void) {
+	// RAM disk has no write cache.
+	if (g_flushHddCache == null) {
+		return true;
+	}
+	
+	return g_flushHddCache(true, true);
+}
+
+static HddRequest* k_submitCacheBufferIo(int cacheTableIndex, CacheBuffer* cacheBuffer, bool write) {
+	// [NOTE] Cache is enabled only on hard disk, so it's safe to use HDD request queue directly.
+	if (cacheTableIndex == CACHE_CLUSTERLINKTABLEAREA) {
+		return k_submitHddRequest(true, true, write, (qword)g_fileSystemManager.clusterLinkAreaStartAddr + cacheBuffer->tag, 1, cacheBuffer->buffer);
+	}
+	
+	return k_submitHddRequest(true, true, write, g_fileSystemManager.dataAreaStartAddr + ((qword)cacheBuffer->tag * FS_SECTORSPERCLUSTER), FS_SECTORSPERCLUSTER, cacheBuffer->buffer);
+}
+
+static bool k_waitCacheBufferIo(int cacheTableIndex, CacheBuffer* cacheBuffer) {
+	int sectorCount;
+	int doneCount;
+	
+	// If there is no request in progress, return.
+	if (cacheBuffer->request == null) {
+		return true;
+	}
+	
+	if (cacheTableIndex == CACHE_CLUSTERLINKTABLEAREA) {
+		sectorCount = 1;
+		
+	} else {
+		sectorCount = FS_SECTORSPERCLUSTER;
+	}
+	
+	// sleep until the request is completed.
+	doneCount = k_waitHddRequest(true, cacheBuffer->request);
+	cacheBuffer->request = null;
+	
+	if (doneCount != sectorCount) {
+		// If read-ahead fails, set the buffer to be free, because the data is invalid.
+		if (cacheBuffer->changed == false) {
+			cacheBuffer->tag = CACHE_INVALIDTAG;
+		}
+		
+		return false;
+	}
 	
 	return true;
 }
+
+static void k_waitAllCacheBufferIo(void) {
+	CacheBuffer* cacheBuffer;
+	int cacheCount;
+	int cacheTableIndex;
+	int i;
+	
+	for (cacheTableIndex = 0; cacheTableIndex < CACHE_MAXCACHETABLEINDEX; cacheTableIndex++) {
+		k_getCacheBufferAndCount(cacheTableIndex, &cacheBuffer, &cacheCount);
+		for (i = 0; i < cacheCount; i++) {
+			k_waitCacheBufferIo(cacheTableIndex, &(cacheBuffer[i]));
+		}
+	}
+}
+
+static void k_readAheadCluster(dword offset) {
+	CacheBuffer* cacheBuffer;
+	
+	k_lock(&(g_fileSystemManager.cacheMutex));
+	
+	// If cluster is already in cache, do nothing.
+	if (k_findCacheBuffer(CACHE_DATAAREA, offset) != null) {
+		k_unlock(&(g_fileSystemManager.cacheMutex));
+		return;
+	}
+	
+	// allocate cache buffer.
+	cacheBuffer = k_allocCacheBufferWithFlush(CACHE_DATAAREA);
+	if (cacheBuffer == null) {
+		k_unlock(&(g_fileSystemManager.cacheMutex));
+		return;
+	}
+	
+	// submit read request without waiting. The reader waits for it when accessing the cache buffer.
+	cacheBuffer->tag = offset;
+	cacheBuffer->changed = false;
+	cacheBuffer->request = k_submitCacheBufferIo(CACHE_DATAAREA, cacheBuffer, false);
+	
+	// If request pool is full, give up reading ahead.
+	if (cacheBuffer->request == null) {
+		cacheBuffer->tag = CACHE_INVALIDTAG;
+	}
+	
+	k_unlock(&(g_fileSystemManager.cacheMutex));
+}
+
+static void k_readAheadClusters(dword clusterIndex, dword count) {
+	dword i;
+	
+	// read ahead clusters following cluster links from parameter cluster.
+	for (i = 0; (i < count) && (clusterIndex != FS_LASTCLUSTER); i++) {
+		k_readAheadCluster(clusterIndex);
+		
+		if (k_getClusterLinkData(clusterIndex, &clusterIndex) == false) {
+			break;
+		}
+	}
+}
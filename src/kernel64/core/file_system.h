@@ -5,16 +5,50 @@
 #include "sync.h"
 #include "hdd.h"
 #include "cache.h"
+#include "../utils/pool.h"
 
 // file system-related macros
-#define FS_SIGNATURE              0x7E38CF10 // hFS signature.
+#define FS_SIGNATURE              0x7E38CF20 // hFS signature (version 2: 64-bit file size, 64-byte directory entry).
+#define FS_SIGNATURE_V1           0x7E38CF10 // hFS version 1 signature (32-bit file size, 32-byte directory entry, upgraded at mount).
 #define FS_SECTORSPERCLUSTER      8          // sector count per cluster (8)
 #define FS_LASTCLUSTER            0xFFFFFFFF // last cluster
 #define FS_FREECLUSTER            0x00       // free cluster
 #define FS_CLUSTERSIZE            (FS_SECTORSPERCLUSTER * 512)        // cluster size (byte count, 4KB)
-#define FS_MAXDIRECTORYENTRYCOUNT (FS_CLUSTERSIZE / sizeof(DirEntry)) // max directory entry count of root directory (128)
+#define FS_MAXDIRECTORYENTRYCOUNT (FS_CLUSTERSIZE / sizeof(DirEntry)) // max directory entry count of a directory cluster (64)
 #define FS_HANDLE_MAXCOUNT        3072 // max handle count(max file count, max directory count): 3072 = 1024 (max task count) * 3
-#define FS_MAXFILENAMELENGTH      24   // max file name length (include file extension and last null character)
+#define FS_MAXFILENAMELENGTH      23   // max file name length (include file extension and last null character)
+#define FS_MAXPATHLENGTH          256  // max path length (include directory names, path separators and last null character)
+#define FS_PATHSEPARATOR          '/'  // path separator
+#define FS_ROOTCLUSTER            0    // start cluster index of root directory
+#define FS_MINDENTRYCOUNT         1024 // initial dentry count of dentry cache (doubled when it's full, always power of 2)
+#define FS_INVALIDDENTRY          -1   // invalid dentry index (end of hash bucket chain and free dentry list)
+#define FS_OPENHASHCOUNT          1024 // open handle hash bucket count (open handle is hashed by start cluster index, power of 2)
+#define FS_MAPPING_MAXCOUNT       64   // max file mapping count (files mapped at the same time)
+#define FS_MAPPINGPAGE_OWNED      0x01 // page flag of file mapping: page is a frame owned by file mapping (not a RAM disk page)
+#define FS_MAPPINGPAGE_ADDRMASK   0xFFFFFFFFFFFFF000 // page address mask of file mapping page entry
+#define FS_FILELOCKCOUNT          64   // file lock count (file lock is selected by start cluster index of file)
+#define FS_IOVEC_MAXCOUNT         1024 // max I/O vector count of readv/writev
+#define FS_JOURNALSECTORCOUNT     1024 // sector count of journal in reserved area (512KB): header sector + log area
+#define FS_JOURNALMAXBLOCKCOUNT   60   // max metadata block count of a transaction (limited by descriptor sector size)
+#define FS_JOURNALMAXSECTORCOUNT  128  // max metadata sector count of a transaction (64KB, committed when it's full)
+#define FS_JOURNALMAXREVOKECOUNT  (FS_JOURNALSECTORCOUNT / FS_SECTORSPERCLUSTER) // max directory cluster count which can be in log at the same time (128)
+#define FS_READAHEADCLUSTERCOUNT  8    // max cluster count to read ahead at once (submitted to HDD request queue together)
+#define FS_MAXEXTENTCLUSTERCOUNT  256  // max cluster count to allocate at once as a contiguous run (extent, 1MB)
+#define FS_MINEXTENTMAPCOUNT      16   // initial extent count of extent map of file handle (doubled when it's full)
+#define FS_MINUPGRADELISTCOUNT    64   // initial item count of cluster lists of upgrade (doubled when it's full)
+#define FS_UPGRADEMARK            0x80000000 // mark of root cluster link while upgrade replaces root directory (mark | start cluster index of converted root directory)
+
+// file attribute
+#define FS_ATTRIBUTE_FILE      0x00 // file
+#define FS_ATTRIBUTE_DIRECTORY 0x01 // directory
+
+// journal-related macros
+#define FS_JOURNALSIGNATURE           0x4A524E4C // journal header signature ("JRNL")
+#define FS_JOURNALDESCRIPTORSIGNATURE 0x4A445343 // journal descriptor sector signature ("JDSC")
+#define FS_JOURNALCOMMITSIGNATURE     0x4A434D54 // journal commit sector signature ("JCMT")
+#define FS_JOURNALBLOCK_CLUSTERLINK   0          // metadata block type: cluster link table sector (512B, offset is sector offset)
+#define FS_JOURNALBLOCK_DIRECTORY     1          // metadata block type: directory cluster (4KB, offset is cluster index)
+#define FS_JOURNALBLOCK_REVOKE        2          // metadata block type: revoke record of freed directory cluster (no block, offset is cluster index)
 
 // handle type
 #define FS_TYPE_FREE      0 // free handle
@@ -28,8 +62,10 @@
 
 // function pointers related with hard disk and ram disk control
 typedef bool (* ReadHddInfo)(bool primary, bool master, HddInfo* hddInfo);
-typedef int (* ReadHddSector)(bool primary, bool master, dword lba, int sectorCount, char* buffer);
-typedef int (* WriteHddSector)(bool primary, bool master, dword lba, int sectorCount, char* buffer);
+typedef int (* ReadHddSector)(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+typedef int (* WriteHddSector)(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+typedef byte* (* GetHddSectorPointer)(qword lba, int sectorCount, bool write);
+typedef bool (* FlushHddCache)(bool primary, bool master);
 
 /* macros redefined as C standard I/O names  */
 // redefine hFS function names as C standard I/O function names.
@@ -44,6 +80,14 @@ typedef int (* WriteHddSector)(bool primary, bool master, dword lba, int sectorC
 #define rewinddir k_rewindDir
 #define closedir  k_closeDir
 #define isfopen   k_isFileOpen
+#define mkdir     k_makeDir
+#define rmdir     k_removeDir
+#define stat      k_statFile
+#define fsync     k_syncFile
+#define readv     k_readFileVector
+#define writev    k_writeFileVector
+#define pread     k_readFileAt
+#define pwrite    k_writeFileAt
 
 // redefine hFS macro names as C standard I/O macro names.
 #define SEEK_SET FS_SEEK_SET
@@ -51,10 +95,14 @@ typedef int (* WriteHddSector)(bool primary, bool master, dword lba, int sectorC
 #define SEEK_END FS_SEEK_END
 
 // redefine hFS type names as C standard I/O type names.
-#define size_t dword
+#define size_t qword
 #define dirent DirEntry
 #define d_name fileName
 #define d_size fileSize
+#define d_attr attribute
+#define iovec IoVec
+#define iov_base base
+#define iov_len length
 
 /**
   ====================================================================================================
@@ -63,15 +111,55 @@ typedef int (* WriteHddSector)(bool primary, bool master, dword lba, int sectorC
   |                    Meta Data Area                       |           General Data Area            |
   ----------------------------------------------------------------------------------------------------
   | MBR Area                | Reserved | Cluster Link Table | Root Directory               | Data    |
-  | (LBA 0, 1 sector-sized) | Area     | Area               | (cluster 0, 1 cluster-sized) | Area    |
+  | (LBA 0, 1 sector-sized) | Area     | Area               | (cluster 0, cluster chain)   | Area    |
   ----------------------------------------------------------------------------------------------------
    -> MBR Area (512B): boot-loader code and file system info (446B), partition table(16B*4=64B), boot-loader signature(2B)
-   -> Reserved Area: not used
+   -> Reserved Area: metadata journal (512KB) and padding which aligns the start of general data area with cluster-level (8 sectors).
    -> Cluster Link Table Area: can create 128 cluster links (4B) in a sector (512B).
                                the size of cluster link table area depends on the size of hard disk.
-   -> Root Directory (4KB): can create 128 directory entries (32B) in root directory (4KB).
-                            128 files can be created in root directory.
-   -> Data Area: file data exists in this area.
+   -> Root Directory (4KB~): can create 64 directory entries (64B) in a directory cluster (4KB).
+                             root directory starts at cluster 0, and grows by linking a new cluster when all entries are used.
+   -> Data Area: file data and subdirectories exist in this area.
+                 A subdirectory is a cluster chain of directory entries like root directory, and its directory entry has directory attribute.
+                 A path consists of directory names and a file name separated by '/' (ex: /apps/games/tetris.elf).
+   -> Free cluster bitmap (in RAM): built from cluster link table at mount, and used to allocate contiguous clusters (extent) without reading cluster link table.
+   -> Dentry cache (in RAM): copies of all directory entries, built by walking all directories at mount.
+                             It's a hash table keyed by (start cluster index of parent directory, file name),
+                             so a path is resolved without reading directories, and directory entries are written through on update.
+   -> Journal (hard disk only): write-ahead log of metadata (cluster link table sectors, directory clusters).
+      - metadata writes are gathered into the running transaction in RAM, and reads of metadata see the running transaction first.
+      - commit writes the transaction to log sequentially (descriptor sector + metadata blocks, then commit sector),
+        and after that, writes metadata blocks to home locations through cache (write-back).
+      - ordered: commit writes back changed data clusters first, so committed metadata never points to stale data.
+      - barrier: write cache of hard disk is flushed before and after commit sector, so commit sector never reaches media
+        before the transaction, and home locations never reach media before commit sector.
+      - revoke: If directory cluster in committed transactions is freed, revoke record is added to the running transaction,
+        so replay doesn't write the old directory cluster onto the cluster reused as file data.
+      - commit happens when the transaction is full, when fsync is called, and when cache is flushed.
+      - when log is full or cache is flushed, all cache buffers are written back (checkpoint), and log restarts from the start.
+      - mount replays committed transactions which are in log, so metadata is consistent after crash.
+   -> Version: file size and file pointer offset are 64-bit since version 2, so directory entry is 64B (version 1: 32-bit, 32B).
+      - mount upgrades version 1 out of place: each directory cluster is converted into 2 new clusters (lower/upper 64 entries),
+        so version 1 directories stay intact until all converted directories are flushed.
+      - After that, root cluster link is marked with converted root directory (commit point), and the first cluster of it
+        is copied to root cluster (cluster 0), and the signature is changed to version 2. Mount finishes it if it was interrupted.
+      - version 1 directory clusters are freed at last. (If power fails before it, they just leak.)
+   -> File mapping: a read-only view of the whole file. Pages of the view are shared by all mappings of the same file.
+      - mapping resolves cluster of each page (cluster size is page size) and writes back cache buffers of file,
+        so pages can be filled without locks and cache later. It's done outside mutex.
+      - view of process is a file view region of its address space, and its pages are mapped read-only at page faults.
+      - RAM disk: a page is the RAM disk page of the cluster (zero-copy). The last page and the shared zero buffer are copied.
+      - hard disk: a page is a frame of file mapping, which is read asynchronously at the first fault.
+        Page fault handler can't sleep, so it gives up processor time until the read completes, and the access faults again.
+      - view of kernel task is contiguous, because kernel memory has no per-page protection and demand paging:
+        RAM disk clusters if they're contiguous (zero-copy), otherwise a private copy which is read at mapping time.
+      - the file can't be opened with write-related modes while it's mapped, so pages don't change.
+   -> Locking: mutex -> file lock -> allocation mutex -> journal mutex -> cache mutex (must be locked in this order)
+      - mutex protects directories, dentry cache, handle pool. (open, close, remove, directory functions)
+      - file lock protects file data and file handle, so reading/writing independent files runs in parallel. (read, write, seek)
+      - allocation mutex protects cluster link table and free cluster bitmap.
+      - journal mutex protects running transaction and log.
+      - cache mutex protects cache buffers.
   ====================================================================================================
 
   ====================================================================================================
@@ -113,33 +201,137 @@ typedef struct k_Mbr {
 } Mbr; // 1 sector-sized (512 bytes)
 
 typedef struct k_DirEntry {
-	char fileName[FS_MAXFILENAMELENGTH]; // [byte 0~23]  : file name (include file extension and last null character)
-	dword fileSize;                      // [byte 24~27] : file size (byte-level)
+	char fileName[FS_MAXFILENAMELENGTH]; // [byte 0~22]  : file name (include file extension and last null character)
+	byte attribute;                      // [byte 23]    : file attribute: [0x00:file], [0x01:directory]
+	qword fileSize;                      // [byte 24~31] : file size (byte-level, 0 for directory)
+	dword startClusterIndex;             // [byte 32~35] : start cluster index (0x00:free directory entry)
+	byte reserved[28];                   // [byte 36~63] : reserved
+} DirEntry; // 64 bytes-sized
+
+typedef struct k_DirEntryV1 {
+	char fileName[FS_MAXFILENAMELENGTH]; // [byte 0~22]  : file name (include file extension and last null character)
+	byte attribute;                      // [byte 23]    : file attribute: [0x00:file], [0x01:directory]
+	dword fileSize;                      // [byte 24~27] : file size (byte-level, 0 for directory)
 	dword startClusterIndex;             // [byte 28~31] : start cluster index (0x00:free directory entry)
-} DirEntry; // 32 bytes-sized
+} DirEntryV1; // 32 bytes-sized (hFS version 1 directory entry, used only to upgrade)
+
+typedef struct k_UpgradeList {
+	dword* items;    // items (cluster indexes)
+	dword maxCount;  // max item count (allocated size)
+	dword count;     // item count
+} UpgradeList;
+
+typedef struct k_Dentry {
+	DirEntry entry;           // copy of directory entry
+	dword parentClusterIndex; // start cluster index of parent directory (hash key with file name)
+	dword clusterIndex;       // cluster index of directory cluster where directory entry exists
+	int index;                // directory entry index in directory cluster
+	int next;                 // next dentry index in hash bucket chain or free dentry list (-1:end)
+} Dentry;
+
+typedef struct k_FileExtent {
+	dword clusterOffset; // cluster offset in file of the first cluster of extent
+	dword clusterIndex;  // cluster index of the first cluster of extent
+	dword clusterCount;  // contiguous cluster count of extent
+} FileExtent;
 
 typedef struct k_FileHandle {
-	int dirEntryOffset;        // directory entry offset (directory entry index matching file name)
-	dword fileSize;            // file size (byte-level)
+	int dentryIndex;           // dentry index of file in dentry cache
+	qword fileSize;            // file size (byte-level)
 	dword startClusterIndex;   // start cluster index
 	dword currentClusterIndex; // current cluster index (cluster index which current I/O is working)
 	dword prevClusterIndex;    // previous cluster index
-	dword currentOffset;       // current file pointer offset (byte-level)
+	qword currentOffset;       // current file pointer offset (byte-level)
+	FileExtent* extentMap;     // extent map: cluster runs of file sorted by cluster offset (built lazily at first seek, null if not built)
+	dword extentCount;         // extent count of extent map
+	dword extentMaxCount;      // max extent count of extent map (allocated size)
+	dword mappedClusterCount;  // cluster count covered by extent map from the start of file
+	byte* clusterBuffer;       // scratch cluster buffer of handle (allocated at first use, null if disk hands out cluster pointers)
 } FileHandle;
 
 typedef struct k_DirHandle {
-	DirEntry* dirBuffer; // root directory buffer
-	int currentOffset;   // current directory pointer offset
+	DirEntry* dirBuffer;       // directory cluster buffer
+	int currentOffset;         // current directory pointer offset (directory entry index in directory cluster)
+	dword startClusterIndex;   // start cluster index of directory
+	dword currentClusterIndex; // cluster index of directory cluster in directory cluster buffer
 } DirHandle;
 
+typedef struct k_IoVec {
+	void* base;   // buffer address
+	qword length; // buffer size (byte-level)
+} IoVec;
+
 typedef struct k_FileDirHandle {
 	byte type; // handle type: free handle, file handle, directory handle	
+	int next;  // next handle index: next open handle in open handle hash bucket chain if used, next free handle in handle pool if free (-1:end)
 	union {
 		FileHandle fileHandle; // file handle
 		DirHandle dirHandle;   // directory handle
 	};
 } File, Dir;
 
+typedef struct k_FileMapping {
+	File* file;            // file handle which keeps file open while it's mapped, so mapped file can't be removed.
+	dword size;            // mapped size (file size at mapping time)
+	dword pageCount;       // page count of view (cluster count of file)
+	dword* clusters;       // cluster index array of pages (null until mapping is initialized)
+	qword* pages;          // page array: page address | FS_MAPPINGPAGE_OWNED (0 if page hasn't been filled yet)
+	HddRequest** requests; // read request array of pages which are being read from hard disk (null if no request)
+	byte* kernelView;      // contiguous view of kernel tasks (null if it hasn't been made)
+	bool direct;           // direct flag: true if kernel view points to clusters in RAM disk (zero-copy), false if it's a private copy.
+	Mutex mutex;           // mutex: protects initialization and kernel view (may sleep)
+	Spinlock spinlock;     // spinlock: protects pages and requests (used in page fault handler, never sleeps)
+	int refCount;          // reference count: count of mappings sharing this file mapping (changed with spinlock)
+	int next;              // next mapping index in free list of mapping pool (used only while free)
+} FileMapping;
+
+typedef struct k_JournalHeader {
+	dword signature;     // journal header signature (0x4A524E4C)
+	dword sequence;      // sequence of the first transaction in log (transactions before it have been checkpointed)
+	byte reserved[504];  // reserved
+} JournalHeader; // 1 sector-sized (512 bytes)
+
+typedef struct k_JournalBlockTag {
+	dword type;   // metadata block type: [0:cluster link table sector], [1:directory cluster], [2:revoke record]
+	dword offset; // sector offset of cluster link table area, or cluster index of directory cluster
+} JournalBlockTag;
+
+typedef struct k_JournalDescriptor {
+	dword signature;                               // journal descriptor sector signature (0x4A445343)
+	dword sequence;                                // transaction sequence
+	dword blockCount;                              // metadata block count (metadata blocks follow descriptor sector in log in tag order)
+	dword sectorCount;                             // metadata sector count
+	JournalBlockTag tags[FS_JOURNALMAXBLOCKCOUNT]; // metadata block tags
+	byte reserved[16];                             // reserved
+} JournalDescriptor; // 1 sector-sized (512 bytes)
+
+typedef struct k_JournalCommit {
+	dword signature;    // journal commit sector signature (0x4A434D54)
+	dword sequence;     // transaction sequence
+	dword checksum;     // checksum of metadata blocks
+	byte reserved[500]; // reserved
+} JournalCommit; // 1 sector-sized (512 bytes)
+
+typedef struct k_JournalRevoke {
+	dword offset;   // cluster index of revoked directory cluster
+	dword sequence; // the last transaction sequence which has revoke record of the cluster
+} JournalRevoke;
+
+typedef struct k_Journal {
+	bool enabled;         // journal enable flag (hard disk only, RAM disk is volatile.)
+	Mutex mutex;          // journal mutex: synchronization object of running transaction and log
+	dword startAddr;      // start address of journal (sector-level, header sector)
+	dword sequence;       // sequence of running transaction
+	dword logOffset;      // sector offset in journal where running transaction will be written
+	byte* logBuffer;      // log buffer: descriptor sector + metadata blocks of running transaction (written to log at once)
+	dword commitCount;    // committed transaction count since mount
+	dword checkpointCount; // checkpoint count since mount
+	dword loggedDirClusters[FS_JOURNALMAXREVOKECOUNT]; // directory clusters in committed transactions of log (revoked when they're freed)
+	dword loggedDirClusterCount;                       // count of directory clusters in committed transactions of log
+	JournalRevoke revokes[FS_JOURNALMAXREVOKECOUNT];   // revoke table built from log while replaying
+	dword revokeCount;                                 // count of revoke table
+} Journal;
+
 typedef struct k_FileSystemManager {
 	bool mounted;                             // file system mount flag
 	dword reservedSectorCount;                // sector count of reserved area
@@ -147,12 +339,38 @@ typedef struct k_FileSystemManager {
 	dword clusterLinkAreaSize;                // size of cluster link table area (sector count)
 	dword dataAreaStartAddr;                  // start address of general data area (sector-level)
 	dword totalClusterCount;                  // total cluster count of general data area
-	dword lastAllocedClusterLinkSectorOffset; // sector offset of last allocated cluster link table
-	Mutex mutex;                              // mutex: synchronization object
-	File* handlePool;                         // file/directory handle pool address
+	dword lastAllocedClusterIndex;            // last allocated cluster index (start position to search free cluster)
+	Mutex mutex;                              // mutex: synchronization object of directories, dentry cache, handle pool, open handle hash table, mapping pool
+	Mutex allocMutex;                         // allocation mutex: synchronization object of cluster link table, free cluster bitmap
+	Mutex cacheMutex;                         // cache mutex: synchronization object of cache buffers
+	Mutex fileLocks[FS_FILELOCKCOUNT];        // file locks: synchronization object of file data and file handle (shared by files whose start cluster indexes are the same modulo 64)
+	Pool handlePool;                          // file/directory handle pool: free handles are linked through next field of handle.
+	int* openHashTable;                       // open handle hash table: head handle index of each hash bucket chain (-1:empty bucket)
+	Pool mappingPool;                         // file mapping pool
+	FileMapping mappings[FS_MAPPING_MAXCOUNT]; // file mappings of mapping pool
+	int mappingUsedIndexes[FS_MAPPING_MAXCOUNT]; // used index array of mapping pool
+	int mappingUsedPositions[FS_MAPPING_MAXCOUNT]; // used position array of mapping pool
 	bool cacheEnabled;                        // cache enable flag
+	Journal journal;                          // metadata journal
+	byte* freeClusterBitmap;                  // free cluster bitmap: A bit represents a cluster (1:free, 0:allocated), built from cluster link table at mount.
+	dword freeClusterCount;                   // free cluster count
+	Dentry* dentryPool;                       // dentry pool: dentries of dentry cache, built from all directories at mount.
+	int* dentryHashTable;                     // dentry hash table: head dentry index of each hash bucket chain (-1:empty bucket)
+	int dentryMaxCount;                       // max dentry count (also hash bucket count, power of 2)
+	int dentryCount;                          // used dentry count
+	int freeDentryIndex;                      // head dentry index of free dentry list
 } FileSystemManager;
 
+typedef struct k_FragmentationInfo {
+	dword fileCount;           // file count
+	dword fragmentedFileCount; // file count which has 2 or more extents
+	dword fileExtentCount;     // total extent count of all files (extent: contiguous clusters)
+	dword maxFileExtentCount;  // max extent count of a file
+	dword freeClusterCount;    // free cluster count
+	dword freeExtentCount;     // free extent count
+	dword maxFreeExtentSize;   // max free extent size (cluster count)
+} FragmentationInfo;
+
 #pragma pack(pop)
 
 /* General Functions */
@@ -160,39 +378,114 @@ bool k_initFileSystem(void);
 bool k_formatHdd(void);
 bool k_mountHdd(void);
 bool k_getHddInfo(HddInfo* info);
+static bool k_upgradeFileSystem(bool convert); // convert version 1 if convert is true, and finish interrupted upgrade.
+static bool k_replaceUpgradedRootDir(dword newRootClusterIndex);
+static bool k_upgradeDir(dword oldDirClusterIndex, dword newDirClusterIndex, byte* buffer, UpgradeList* queue, UpgradeList* oldClusters, UpgradeList* newClusters);
+static void k_convertDirEntries(const DirEntryV1* src, DirEntry* dest, int count);
+static bool k_initUpgradeList(UpgradeList* list);
+static void k_freeUpgradeList(UpgradeList* list);
+static bool k_addUpgradeList(UpgradeList* list, dword item);
 
 /* Low-Level Functions */
 static bool k_readClusterLinkTable(dword offset, byte* buffer);
 static bool k_writeClusterLinkTable(dword offset, byte* buffer);
 static bool k_readCluster(dword offset, byte* buffer);
 static bool k_writeCluster(dword offset, byte* buffer);
+static byte* k_getClusterPointer(dword offset, bool write);
 static dword k_findFreeCluster(void);
+static dword k_allocClusterExtent(dword preferredClusterIndex, dword count, dword* allocedCount);
+static bool k_buildFreeClusterBitmap(void);
+static void k_setFreeClusterBitmap(dword clusterIndex, bool free);
+static bool k_isFreeCluster(dword clusterIndex);
+bool k_getFragmentationInfo(FragmentationInfo* info);
 static bool k_setClusterLinkData(dword clusterIndex, dword data);
 static bool k_getClusterLinkData(dword clusterIndex, dword* data);
-static int k_findFreeDirEntry(void);
-static bool k_setDirEntryData(int index, DirEntry* entry);
-static bool k_getDirEntryData(int index, DirEntry* entry);
-static int k_findDirEntry(const char* fileName, DirEntry* entry);
+static dword k_findFreeDirEntry(dword dirClusterIndex, int* index);
+static bool k_setDirEntryData(dword clusterIndex, int index, DirEntry* entry);
+static int k_findDirEntry(const char* path, DirEntry* entry);
+static bool k_parsePath(const char* path, dword* parentClusterIndex, char* fileName);
+static bool k_isDirEmpty(dword dirClusterIndex);
 void k_getFileSystemInfo(FileSystemManager* manager);
 
+/* Dentry Cache Functions */
+static bool k_initDentryCache(int maxCount);
+static bool k_buildDentryCache(void);
+static bool k_growDentryCache(void);
+static dword k_hashDentry(dword parentClusterIndex, const char* fileName);
+static int k_lookupDentry(dword parentClusterIndex, const char* fileName);
+static int k_addDentry(dword parentClusterIndex, dword clusterIndex, int index, const DirEntry* entry);
+static void k_removeDentry(int dentryIndex);
+
 /* High-Level Functions */
 static void* k_allocFileDirHandle(void);
 static void k_freeFileDirHandle(File* file);
-static bool k_createFile(const char* fileName, DirEntry* entry, int* dirEntryIndex);
+static void k_addOpenHandle(File* file);
+static void k_removeOpenHandle(File* file);
+static File* k_findOpenHandle(byte type, dword startClusterIndex);
+static void k_truncateOpenFileHandles(dword startClusterIndex);
+static int k_createFile(const char* path, byte attribute, DirEntry* entry);
 static bool k_freeClusterUntilEnd(dword clusterIndex);
 static bool k_updateDirEntry(FileHandle* fileHandle);
+static bool k_addFileExtent(FileHandle* fileHandle, dword clusterIndex);
+static bool k_extendFileExtentMap(FileHandle* fileHandle, dword clusterOffset);
+static bool k_findClusterInExtentMap(FileHandle* fileHandle, dword clusterOffset, dword* clusterIndex, dword* prevClusterIndex);
+static void k_freeFileExtentMap(FileHandle* fileHandle);
+static Mutex* k_getFileLock(FileHandle* fileHandle);
+static byte* k_getFileClusterBuffer(FileHandle* fileHandle);
 File* k_openFile(const char* fileName, const char* mode);
-dword k_readFile(void* buffer, dword size, dword count, File* file);
-dword k_writeFile(const void* buffer, dword size, dword count, File* file);
-int k_seekFile(File* file, int offset, int origin);
+qword k_readFile(void* buffer, qword size, qword count, File* file);
+qword k_writeFile(const void* buffer, qword size, qword count, File* file);
+static qword k_writeFileData(File* file, const void* buffer, qword totalCount); // write at file pointer offset without updating directory entry (file lock must be locked).
+int k_seekFile(File* file, long offset, int origin);
 int k_closeFile(File* file);
 int k_removeFile(const char* fileName);
+int k_statFile(const char* fileName, DirEntry* entry);
+int k_makeDir(const char* dirName);
+int k_removeDir(const char* dirName);
+int k_syncFile(File* file);
+qword k_readFileVector(File* file, const IoVec* vectors, int count);
+qword k_writeFileVector(File* file, const IoVec* vectors, int count);
+qword k_readFileAt(File* file, void* buffer, qword size, qword offset);
+qword k_writeFileAt(File* file, const void* buffer, qword size, qword offset);
 Dir* k_openDir(const char* dirName);
 DirEntry* k_readDir(Dir* dir);
 void k_rewindDir(Dir* dir);
 int k_closeDir(Dir* dir);
 bool k_isFileOpen(const DirEntry* entry);
-bool k_writeZero(File* file, dword count);
+bool k_writeZero(File* file, qword count);
+static bool k_writeZeroData(File* file, qword count); // write 0 without updating directory entry (file lock must be locked).
+
+/* Journal Functions */
+static bool k_formatJournal(dword startAddr);
+static bool k_mountJournal(void);
+static bool k_replayJournal(void);
+static bool k_readJournalTransaction(bool* valid);
+static bool k_addJournalRevoke(dword offset, dword sequence);
+static bool k_isJournalBlockRevoked(dword offset, dword sequence);
+static void k_addLoggedDirCluster(dword clusterIndex);
+static bool k_restartJournalLog(void);
+static bool k_writeJournalHeader(void);
+static bool k_addJournalBlock(dword type, dword offset, const byte* buffer);
+static bool k_readJournalBlock(dword type, dword offset, byte* buffer);
+static bool k_discardJournalBlock(dword type, dword offset);
+static void k_removeJournalBlock(dword type, dword offset);
+static bool k_commitJournal(void);
+static bool k_writeJournalBlockToHome(const JournalBlockTag* tag, byte* buffer);
+static dword k_getJournalBlockSectorCount(dword type);
+static dword k_calcJournalChecksum(const byte* buffer, dword sectorCount);
+static bool k_readDirCluster(dword clusterIndex, byte* buffer);
+static bool k_writeDirCluster(dword clusterIndex, byte* buffer);
+
+/* File Mapping Functions */
+const void* k_mapFile(const char* fileName, dword* size);
+int k_unmapFile(const void* addr);
+static FileMapping* k_findFileMapping(dword startClusterIndex);
+static bool k_initFileMapping(FileMapping* mapping);
+static byte* k_makeKernelView(FileMapping* mapping);
+bool k_getFileMappingPage(FileMapping* mapping, qword offset, byte** page); // return page (null if it's not ready yet) without sleeping.
+void k_shareFileMapping(FileMapping* mapping); // increase reference count without sleeping (for cloning address space).
+void k_releaseFileMapping(FileMapping* mapping);
+static byte* k_getFileDirectPointer(const FileMapping* mapping);
 
 /* Cache Functions */
 static CacheBuffer* k_allocCacheBufferWithFlush(int cacheTableIndex);
@@ -205,5 +498,14 @@ static bool k_readClusterWithCache(dword offset, byte* buffer);
 static bool k_writeClusterWithoutCache(dword offset, byte* buffer);
 static bool k_writeClusterWithCache(dword offset, byte* buffer);
 bool k_flushFileSystemCache(void);
+static bool k_writeBackAllCacheBuffers(void);
+static bool k_writeBackCacheBuffers(int startCacheTableIndex);
+static bool k_flushHddWriteCache(void);
+static bool k_writeBackFileCacheBuffers(FileHandle* fileHandle);
+static HddRequest* k_submitCacheBufferIo(int cacheTableIndex, CacheBuffer* cacheBuffer, bool write);
+static bool k_waitCacheBufferIo(int cacheTableIndex, CacheBuffer* cacheBuffer);
+static void k_waitAllCacheBufferIo(void);
+static void k_readAheadCluster(dword offset);
+static void k_readAheadClusters(dword clusterIndex, dword count);
 
 #endif // __CORE_FILESYSTEM_H__
@@ -0,0 +1,482 @@
+#include "frame_mem.h"
+#include "dynamic_mem.h"
+#include "console.h"
+#include "../utils/util.h"
+
+static FrameMemManager g_frameMemManager;
+
+void k_initFrameMem(qword startAddr, qword endAddr) {
+	dword hugeFrameCount;
+	qword frameCount;
+	HugeFrame* hugeFrames;
+	word* refCounts;
+	dword i;
+
+	k_memset(&g_frameMemManager, 0, sizeof(g_frameMemManager));
+	g_frameMemManager.nodeCount = k_getNodeCount();
+	for (i = 0; i < ACPI_MAXNODECOUNT; i++) {
+		g_frameMemManager.nodes[i].freeHugeList = FMEM_INVALIDINDEX;
+	}
+
+	k_initSpinlock(&(g_frameMemManager.spinlock));
+
+	// aligned with 2 MB (start: rounding up, end: rounding down)
+	startAddr = (startAddr + FMEM_HUGEFRAMESIZE - 1) & ~((qword)FMEM_HUGEFRAMESIZE - 1);
+	endAddr = endAddr & ~((qword)FMEM_HUGEFRAMESIZE - 1);
+	if (endAddr <= startAddr) {
+		return;
+	}
+
+	hugeFrameCount = (dword)((endAddr - startAddr) / FMEM_HUGEFRAMESIZE);
+	frameCount = (qword)hugeFrameCount * FMEM_FRAMESPERHUGEFRAME;
+
+	// allocate meta data from dynamic memory.
+	// [NOTE] huge frame count is still 0 here, so k_allocMem doesn't try to allocate huge frames.
+	hugeFrames = (HugeFrame*)k_allocMem(sizeof(HugeFrame) * hugeFrameCount);
+	refCounts = (word*)k_allocMem(sizeof(word) * frameCount);
+	if ((hugeFrames == null) || (refCounts == null)) {
+		k_printf("frame memory error: meta data allocation failure\n");
+		if (hugeFrames != null) {
+			k_freeMem(hugeFrames);
+		}
+
+		if (refCounts != null) {
+			k_freeMem(refCounts);
+		}
+
+		return;
+	}
+
+	k_memset(refCounts, 0, sizeof(word) * frameCount);
+
+	g_frameMemManager.startAddr = startAddr;
+	g_frameMemManager.endAddr = endAddr;
+	g_frameMemManager.hugeFrames = hugeFrames;
+	g_frameMemManager.refCounts = refCounts;
+
+	// add all huge frames to free huge frame list of their nodes in descending order, so that lower frames are allocated first.
+	for (i = hugeFrameCount; i > 0; i--) {
+		hugeFrames[i - 1].node = k_getNodeByAddr(startAddr + ((qword)(i - 1) * FMEM_HUGEFRAMESIZE));
+		hugeFrames[i - 1].runCount = 0;
+		hugeFrames[i - 1].usedFrameCount = 0;
+		g_frameMemManager.nodes[hugeFrames[i - 1].node].hugeFrameCount++;
+		k_addFreeHugeFrame(i - 1);
+	}
+
+	g_frameMemManager.hugeFrameCount = hugeFrameCount;
+}
+
+bool k_isFrameMem(const void* addr) {
+	return (((qword)addr >= g_frameMemManager.startAddr) && ((qword)addr < g_frameMemManager.endAddr));
+}
+
+void k_getFrameMemInfo(qword* startAddr, qword* totalSize, qword* usedSize, dword* freeHugeCount) {
+	int i;
+
+	if (startAddr != null) {
+		*startAddr = g_frameMemManager.startAddr;
+	}
+
+	if (totalSize != null) {
+		*totalSize = g_frameMemManager.endAddr - g_frameMemManager.startAddr;
+	}
+
+	if (usedSize != null) {
+		*usedSize = g_frameMemManager.usedSize;
+	}
+
+	if (freeHugeCount != null) {
+		*freeHugeCount = 0;
+		for (i = 0; i < g_frameMemManager.nodeCount; i++) {
+			*freeHugeCount += g_frameMemManager.nodes[i].freeHugeCount;
+		}
+	}
+}
+
+bool k_getFrameNodeInfo(byte node, qword* totalSize, qword* usedSize) {
+	if (node >= g_frameMemManager.nodeCount) {
+		return false;
+	}
+
+	if (totalSize != null) {
+		*totalSize = (qword)g_frameMemManager.nodes[node].hugeFrameCount * FMEM_HUGEFRAMESIZE;
+	}
+
+	if (usedSize != null) {
+		*usedSize = g_frameMemManager.nodes[node].usedSize;
+	}
+
+	return true;
+}
+
+byte k_getFrameNode(const void* addr) {
+	if (k_isFrameMem(addr) == false) {
+		return k_getNodeByAddr((qword)addr);
+	}
+
+	return g_frameMemManager.hugeFrames[((qword)addr - g_frameMemManager.startAddr) / FMEM_HUGEFRAMESIZE].node;
+}
+
+void* k_allocHugeFrames(qword size) {
+	return k_allocHugeFramesOnNode(size, k_getCurrentNode());
+}
+
+void* k_allocHugeFramesOnNode(qword size, byte node) {
+	byte nodes[ACPI_MAXNODECOUNT];
+	int nodeCount;
+	dword count;
+	dword index;
+	dword i;
+	int j;
+
+	count = (dword)((size + FMEM_HUGEFRAMESIZE - 1) / FMEM_HUGEFRAMESIZE);
+	if ((count == 0) || (count > g_frameMemManager.hugeFrameCount)) {
+		return null;
+	}
+
+	nodeCount = k_getNodesByDistance(node, nodes);
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+
+	// search the requested node first, and then the other nodes in the order of distance.
+	// a huge frame is taken from free huge frame list, and contiguous huge frames are searched in huge frame table.
+	index = FMEM_INVALIDINDEX;
+	for (j = 0; (j < nodeCount) && (index == FMEM_INVALIDINDEX); j++) {
+		if (count == 1) {
+			index = g_frameMemManager.nodes[nodes[j]].freeHugeList;
+
+		} else {
+			index = k_findFreeHugeFrames(count, nodes[j]);
+		}
+	}
+
+	if (index == FMEM_INVALIDINDEX) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		return null;
+	}
+
+	for (i = index; i < (index + count); i++) {
+		k_removeFreeHugeFrame(i);
+		g_frameMemManager.hugeFrames[i].type = FMEM_TYPE_HUGE;
+		g_frameMemManager.hugeFrames[i].runCount = 0;
+	}
+
+	g_frameMemManager.hugeFrames[index].runCount = count;
+	g_frameMemManager.usedSize += (qword)count * FMEM_HUGEFRAMESIZE;
+	g_frameMemManager.nodes[g_frameMemManager.hugeFrames[index].node].usedSize += (qword)count * FMEM_HUGEFRAMESIZE;
+
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return (void*)(g_frameMemManager.startAddr + ((qword)index * FMEM_HUGEFRAMESIZE));
+}
+
+bool k_freeHugeFrames(void* addr) {
+	dword index;
+	dword count;
+	dword i;
+
+	if ((k_isFrameMem(addr) == false) || (((qword)addr & (FMEM_HUGEFRAMESIZE - 1)) != 0)) {
+		k_printf("frame memory error: invalid huge frame address: 0x%q\n", addr);
+		return false;
+	}
+
+	index = (dword)(((qword)addr - g_frameMemManager.startAddr) / FMEM_HUGEFRAMESIZE);
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+
+	// fail if it's not the first huge frame of contiguous huge frames.
+	count = g_frameMemManager.hugeFrames[index].runCount;
+	if ((g_frameMemManager.hugeFrames[index].type != FMEM_TYPE_HUGE) || (count == 0)) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		k_printf("frame memory error: not allocated huge frame: 0x%q\n", addr);
+		return false;
+	}
+
+	for (i = index; i < (index + count); i++) {
+		g_frameMemManager.hugeFrames[i].runCount = 0;
+		k_addFreeHugeFrame(i);
+	}
+
+	g_frameMemManager.usedSize -= (qword)count * FMEM_HUGEFRAMESIZE;
+	g_frameMemManager.nodes[g_frameMemManager.hugeFrames[index].node].usedSize -= (qword)count * FMEM_HUGEFRAMESIZE;
+
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return true;
+}
+
+static void k_addFreeHugeFrame(dword index) {
+	HugeFrame* hugeFrame;
+	FrameNode* node;
+
+	// add huge frame to the head of free huge frame list of its node.
+	hugeFrame = &(g_frameMemManager.hugeFrames[index]);
+	node = &(g_frameMemManager.nodes[hugeFrame->node]);
+	hugeFrame->type = FMEM_TYPE_FREE;
+	hugeFrame->prev = FMEM_INVALIDINDEX;
+	hugeFrame->next = node->freeHugeList;
+
+	if (node->freeHugeList != FMEM_INVALIDINDEX) {
+		g_frameMemManager.hugeFrames[node->freeHugeList].prev = index;
+	}
+
+	node->freeHugeList = index;
+	node->freeHugeCount++;
+}
+
+static void k_removeFreeHugeFrame(dword index) {
+	HugeFrame* hugeFrame;
+	FrameNode* node;
+
+	hugeFrame = &(g_frameMemManager.hugeFrames[index]);
+	node = &(g_frameMemManager.nodes[hugeFrame->node]);
+
+	if (hugeFrame->prev != FMEM_INVALIDINDEX) {
+		g_frameMemManager.hugeFrames[hugeFrame->prev].next = hugeFrame->next;
+
+	} else {
+		node->freeHugeList = hugeFrame->next;
+	}
+
+	if (hugeFrame->next != FMEM_INVALIDINDEX) {
+		g_frameMemManager.hugeFrames[hugeFrame->next].prev = hugeFrame->prev;
+	}
+
+	hugeFrame->prev = FMEM_INVALIDINDEX;
+	hugeFrame->next = FMEM_INVALIDINDEX;
+	node->freeHugeCount--;
+}
+
+static dword k_findFreeHugeFrames(dword count, byte node) {
+	dword runStart;
+	dword runCount;
+	dword i;
+
+	// search the first run of free huge frames of node as long as count. (first fit)
+	runStart = 0;
+	runCount = 0;
+	for (i = 0; i < g_frameMemManager.hugeFrameCount; i++) {
+		if ((g_frameMemManager.hugeFrames[i].type != FMEM_TYPE_FREE) || (g_frameMemManager.hugeFrames[i].node != node)) {
+			runCount = 0;
+			continue;
+		}
+
+		if (runCount == 0) {
+			runStart = i;
+		}
+
+		runCount++;
+		if (runCount == count) {
+			return runStart;
+		}
+	}
+
+	return FMEM_INVALIDINDEX;
+}
+
+void* k_allocFrame(void) {
+	return k_allocFrameOnNode(k_getCurrentNode());
+}
+
+void* k_allocFrameOnNode(byte node) {
+	byte nodes[ACPI_MAXNODECOUNT];
+	int nodeCount;
+	FrameNode* frameNode;
+	FreeFrame* frame;
+	qword frameIndex;
+	int i;
+
+	nodeCount = k_getNodesByDistance(node, nodes);
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+
+	// search the requested node first, and then the other nodes in the order of distance.
+	frameNode = null;
+	for (i = 0; i < nodeCount; i++) {
+		if ((g_frameMemManager.nodes[nodes[i]].freeFrameList != null) || (k_splitHugeFrame(nodes[i]) == true)) {
+			frameNode = &(g_frameMemManager.nodes[nodes[i]]);
+			break;
+		}
+	}
+
+	if (frameNode == null) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		return null;
+	}
+
+	// remove frame from the head of free 4 KB frame list.
+	frame = frameNode->freeFrameList;
+	frameNode->freeFrameList = frame->next;
+	if (frame->next != null) {
+		frame->next->prev = null;
+	}
+
+	frameNode->freeFrameCount--;
+	frameNode->usedSize += FMEM_FRAMESIZE;
+
+	frameIndex = ((qword)frame - g_frameMemManager.startAddr) / FMEM_FRAMESIZE;
+	g_frameMemManager.refCounts[frameIndex] = 1;
+	g_frameMemManager.hugeFrames[frameIndex / FMEM_FRAMESPERHUGEFRAME].usedFrameCount++;
+	g_frameMemManager.usedSize += FMEM_FRAMESIZE;
+
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return frame;
+}
+
+bool k_freeFrame(void* frame) {
+	FreeFrame* freeFrame;
+	FrameNode* frameNode;
+	qword frameIndex;
+	dword hugeIndex;
+
+	if ((k_isFrameMem(frame) == false) || (((qword)frame & (FMEM_FRAMESIZE - 1)) != 0)) {
+		k_printf("frame memory error: invalid frame address: 0x%q\n", frame);
+		return false;
+	}
+
+	frameIndex = ((qword)frame - g_frameMemManager.startAddr) / FMEM_FRAMESIZE;
+	hugeIndex = (dword)(frameIndex / FMEM_FRAMESPERHUGEFRAME);
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+
+	if ((g_frameMemManager.hugeFrames[hugeIndex].type != FMEM_TYPE_SPLIT) || (g_frameMemManager.refCounts[frameIndex] == 0)) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		k_printf("frame memory error: not allocated frame: 0x%q\n", frame);
+		return false;
+	}
+
+	// If frame is still shared by another address space, only decrease reference count.
+	g_frameMemManager.refCounts[frameIndex]--;
+	if (g_frameMemManager.refCounts[frameIndex] > 0) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		return true;
+	}
+
+	// add frame to the head of free 4 KB frame list of its node.
+	frameNode = &(g_frameMemManager.nodes[g_frameMemManager.hugeFrames[hugeIndex].node]);
+	freeFrame = (FreeFrame*)frame;
+	freeFrame->prev = null;
+	freeFrame->next = frameNode->freeFrameList;
+	if (frameNode->freeFrameList != null) {
+		frameNode->freeFrameList->prev = freeFrame;
+	}
+
+	frameNode->freeFrameList = freeFrame;
+	frameNode->freeFrameCount++;
+	frameNode->usedSize -= FMEM_FRAMESIZE;
+	g_frameMemManager.hugeFrames[hugeIndex].usedFrameCount--;
+	g_frameMemManager.usedSize -= FMEM_FRAMESIZE;
+
+	// merge frames back into huge frame if all of them are free.
+	// [NOTE] Keep at least a huge frame worth of free 4 KB frames in node, in order not to split and merge repeatedly.
+	if ((g_frameMemManager.hugeFrames[hugeIndex].usedFrameCount == 0) && (frameNode->freeFrameCount >= (2 * FMEM_FRAMESPERHUGEFRAME))) {
+		k_mergeHugeFrame(hugeIndex);
+	}
+
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return true;
+}
+
+bool k_shareFrame(void* frame) {
+	qword frameIndex;
+
+	if ((k_isFrameMem(frame) == false) || (((qword)frame & (FMEM_FRAMESIZE - 1)) != 0)) {
+		k_printf("frame memory error: invalid frame address: 0x%q\n", frame);
+		return false;
+	}
+
+	frameIndex = ((qword)frame - g_frameMemManager.startAddr) / FMEM_FRAMESIZE;
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+
+	// fail sharing if frame isn't allocated, or reference count is full.
+	if ((g_frameMemManager.refCounts[frameIndex] == 0) || (g_frameMemManager.refCounts[frameIndex] == FMEM_MAXREFCOUNT)) {
+		k_unlockSpin(&(g_frameMemManager.spinlock));
+		return false;
+	}
+
+	g_frameMemManager.refCounts[frameIndex]++;
+
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return true;
+}
+
+word k_getFrameRefCount(const void* frame) {
+	word refCount;
+
+	if (k_isFrameMem(frame) == false) {
+		return 0;
+	}
+
+	k_lockSpin(&(g_frameMemManager.spinlock));
+	refCount = g_frameMemManager.refCounts[((qword)frame - g_frameMemManager.startAddr) / FMEM_FRAMESIZE];
+	k_unlockSpin(&(g_frameMemManager.spinlock));
+
+	return refCount;
+}
+
+static bool k_splitHugeFrame(byte node) {
+	FrameNode* frameNode;
+	dword index;
+	qword hugeFrameAddr;
+	FreeFrame* frame;
+	int i;
+
+	frameNode = &(g_frameMemManager.nodes[node]);
+	index = frameNode->freeHugeList;
+	if (index == FMEM_INVALIDINDEX) {
+		return false;
+	}
+
+	k_removeFreeHugeFrame(index);
+	g_frameMemManager.hugeFrames[index].type = FMEM_TYPE_SPLIT;
+	g_frameMemManager.hugeFrames[index].usedFrameCount = 0;
+
+	// add 4 KB frames to free 4 KB frame list in descending order, so that lower frames are allocated first.
+	hugeFrameAddr = g_frameMemManager.startAddr + ((qword)index * FMEM_HUGEFRAMESIZE);
+	for (i = FMEM_FRAMESPERHUGEFRAME - 1; i >= 0; i--) {
+		frame = (FreeFrame*)(hugeFrameAddr + ((qword)i * FMEM_FRAMESIZE));
+		frame->prev = null;
+		frame->next = frameNode->freeFrameList;
+		if (frameNode->freeFrameList != null) {
+			frameNode->freeFrameList->prev = frame;
+		}
+
+		frameNode->freeFrameList = frame;
+	}
+
+	frameNode->freeFrameCount += FMEM_FRAMESPERHUGEFRAME;
+
+	return true;
+}
+
+static void k_mergeHugeFrame(dword index) {
+	FrameNode* frameNode;
+	qword hugeFrameAddr;
+	FreeFrame* frame;
+	int i;
+
+	// remove all 4 KB frames of huge frame from free 4 KB frame list of its node.
+	frameNode = &(g_frameMemManager.nodes[g_frameMemManager.hugeFrames[index].node]);
+	hugeFrameAddr = g_frameMemManager.startAddr + ((qword)index * FMEM_HUGEFRAMESIZE);
+	for (i = 0; i < FMEM_FRAMESPERHUGEFRAME; i++) {
+		frame = (FreeFrame*)(hugeFrameAddr + ((qword)i * FMEM_FRAMESIZE));
+		if (frame->prev != null) {
+			frame->prev->next = frame->next;
+
+		} else {
+			frameNode->freeFrameList = frame->next;
+		}
+
+		if (frame->next != null) {
+			frame->next->prev = frame->prev;
+		}
+	}
+
+	frameNode->freeFrameCount -= FMEM_FRAMESPERHUGEFRAME;
+
+	k_addFreeHugeFrame(index);
+}
@@ -0,0 +1,115 @@
+#ifndef __CORE_FRAMEMEM_H__
+#define __CORE_FRAMEMEM_H__
+
+#include "types.h"
+#include "sync.h"
+#include "acpi.h"
+
+/**
+  < Frame Memory >
+  - Frame memory is the upper part of RAM above dynamic memory (buddy heap), and it's managed by physical frames.
+    - 2 MB huge frame : naturally aligned with 2 MB, so it's mapped with a 2 MB page (a TLB entry) of kernel address space.
+    - 4 KB frame      : split from a huge frame, and used for pages of user address space.
+  - Dynamic memory (buddy heap) is reserved for small kernel objects, and large allocations (>= 1 MB) of k_allocMem
+    are served with contiguous huge frames, such as window buffers, RAM disk pages and image decode buffers.
+
+  < Frame Memory Layout >
+    dynamic memory end (2 MB-aligned) ------------------------------ RAM end
+    | huge frame 0 | huge frame 1 | huge frame 2 (split) | ... | huge frame N-1 |
+                                   | 4 KB frames (512) |
+
+  < Free Lists >
+  1. free huge frame list : doubly linked with huge frame indexes in huge frame table.
+  2. free 4 KB frame list : doubly linked through the first 16 bytes of free 4 KB frames.
+  - If there is no free 4 KB frame, a free huge frame is split into 4 KB frames.
+  - If all 4 KB frames of a split huge frame are freed, they are merged back into the huge frame.
+  - Contiguous huge frames for a large allocation are searched in huge frame table (first fit).
+
+  < NUMA Node Pools >
+  - Each huge frame belongs to the NUMA node of its address (SRAT), and each node has its own free lists.
+    - 4 KB frames split from a huge frame stay in the free 4 KB frame list of its node.
+    - contiguous huge frames are searched only in a node, so they never cross node boundary.
+  - Frames are allocated from the node of current core by default, or from the node requested by caller.
+    If the node is exhausted, they are allocated from the other nodes in the order of distance (SLIT).
+*/
+
+// frame size
+#define FMEM_FRAMESIZE          0x1000   // 4 KB
+#define FMEM_HUGEFRAMESIZE      0x200000 // 2 MB
+#define FMEM_FRAMESPERHUGEFRAME (FMEM_HUGEFRAMESIZE / FMEM_FRAMESIZE) // 512
+
+// huge frame type
+#define FMEM_TYPE_FREE  0x00 // free: in free huge frame list
+#define FMEM_TYPE_HUGE  0x01 // allocated as (a part of) contiguous huge frames
+#define FMEM_TYPE_SPLIT 0x02 // split into 4 KB frames
+
+// invalid huge frame index
+#define FMEM_INVALIDINDEX 0xFFFFFFFF
+
+// max reference count of 4 KB frame (size of reference count is word)
+#define FMEM_MAXREFCOUNT 0xFFFF
+
+#pragma pack(push, 1)
+
+typedef struct k_HugeFrame {
+	byte type;            // huge frame type
+	byte node;            // NUMA node
+	dword prev;           // previous free huge frame index (FMEM_INVALIDINDEX if none)
+	dword next;           // next free huge frame index (FMEM_INVALIDINDEX if none)
+	dword runCount;       // huge frame count allocated at once: valid in the first huge frame of contiguous huge frames.
+	dword usedFrameCount; // allocated 4 KB frame count: valid in split huge frame.
+} HugeFrame;
+
+typedef struct k_FreeFrame {
+	struct k_FreeFrame* prev; // previous free 4 KB frame
+	struct k_FreeFrame* next; // next free 4 KB frame
+} FreeFrame;
+
+typedef struct k_FrameNode {
+	dword hugeFrameCount;     // total huge frame count of node
+	dword freeHugeList;       // free huge frame list (head index)
+	dword freeHugeCount;      // free huge frame count
+	FreeFrame* freeFrameList; // free 4 KB frame list (head)
+	qword freeFrameCount;     // free 4 KB frame count
+	qword usedSize;           // used memory size of node
+} FrameNode;
+
+typedef struct k_FrameMemManager {
+	Spinlock spinlock;                   // spinlock
+	qword startAddr;                     // frame memory start address (aligned with 2 MB)
+	qword endAddr;                       // frame memory end address (aligned with 2 MB)
+	dword hugeFrameCount;                // total huge frame count
+	HugeFrame* hugeFrames;               // huge frame table
+	word* refCounts;                     // reference count table of 4 KB frames: Frames shared by copy-on-write have counts > 1.
+	int nodeCount;                       // NUMA node count
+	FrameNode nodes[ACPI_MAXNODECOUNT];  // free lists by NUMA node
+	qword usedSize;                      // used memory size: allocated huge frames + allocated 4 KB frames
+} FrameMemManager;
+
+#pragma pack(pop)
+
+/* Frame Memory Functions */
+void k_initFrameMem(qword startAddr, qword endAddr);
+bool k_isFrameMem(const void* addr);
+void k_getFrameMemInfo(qword* startAddr, qword* totalSize, qword* usedSize, dword* freeHugeCount);
+bool k_getFrameNodeInfo(byte node, qword* totalSize, qword* usedSize);
+byte k_getFrameNode(const void* addr); // get NUMA node of frame.
+
+/* Huge Frame Functions */
+void* k_allocHugeFrames(qword size); // allocate contiguous huge frames which are aligned with 2 MB, from the node of current core.
+void* k_allocHugeFramesOnNode(qword size, byte node);
+bool k_freeHugeFrames(void* addr);
+static void k_addFreeHugeFrame(dword index);
+static void k_removeFreeHugeFrame(dword index);
+static dword k_findFreeHugeFrames(dword count, byte node);
+
+/* 4 KB Frame Functions */
+void* k_allocFrame(void); // allocate a 4 KB frame from the node of current core.
+void* k_allocFrameOnNode(byte node);
+bool k_freeFrame(void* frame); // decrease reference count of frame, and free it if it's not shared anymore.
+bool k_shareFrame(void* frame); // increase reference count of frame: fail if it isn't allocated or is full.
+word k_getFrameRefCount(const void* frame);
+static bool k_splitHugeFrame(byte node);
+static void k_mergeHugeFrame(dword index);
+
+#endif // __CORE_FRAMEMEM_H__
@@ -2,6 +2,10 @@
 #include "asm_util.h"
 #include "../utils/util.h"
 #include "console.h"
+#include "task.h"
+#include "multiprocessor.h"
+#include "dynamic_mem.h"
+#include "virtual_mem.h"
 
 static HddManager g_hddManager;
 
@@ -10,6 +14,10 @@ bool k_initHdd(void) {
 	// initialize mutex.
 	k_initMutex(&(g_hddManager.mutex));
 	
+	// initialize request queues.
+	k_initHddRequestQueue(&(g_hddManager.requestQueues[0]), HDD_WAITGROUPIDBASE);
+	k_initHddRequestQueue(&(g_hddManager.requestQueues[1]), HDD_WAITGROUPIDBASE + HDD_MAXREQUESTCOUNT);
+	
 	// initialize interrupt flag.
 	g_hddManager.primaryInterruptOccurred = false;
 	g_hddManager.secondaryInterruptOccurred = false;
@@ -35,6 +43,276 @@ bool k_initHdd(void) {
 		g_hddManager.writable = false;
 	}
 	
+	// set LBA48 and read/write multiple modes.
+	k_initHddTransferMode();
+	
+	// initialize bus master IDE controller, and use DMA if it's supported.
+	k_initHddBusMaster();
+	
+	return true;
+}
+
+static void k_initHddTransferMode(void) {
+	int multipleSectorCount;
+	
+	// use LBA48 commands if hard disk supports them.
+	g_hddManager.totalSectorCount = k_getHddTotalSectorCount(&(g_hddManager.hddInfo));
+	if ((g_hddManager.hddInfo.commandSetSupported & HDD_COMMANDSET_LBA48) == HDD_COMMANDSET_LBA48) {
+		g_hddManager.lba48Supported = true;
+		g_hddManager.maxSectorCount = HDD_MAXBULKSECTORCOUNTLBA48;
+		
+	} else {
+		g_hddManager.lba48Supported = false;
+		g_hddManager.maxSectorCount = HDD_MAXBULKSECTORCOUNT;
+	}
+	
+	// flush write cache of hard disk if it supports flush cache command.
+	if ((g_hddManager.hddInfo.commandSetSupported & HDD_COMMANDSET_FLUSHCACHE) == HDD_COMMANDSET_FLUSHCACHE) {
+		g_hddManager.flushSupported = true;
+		
+	} else {
+		g_hddManager.flushSupported = false;
+	}
+	
+	// use read/write multiple commands with max sector count per block which hard disk supports.
+	// If not, use read/write sectors commands (1 sector per block).
+	g_hddManager.multipleSectorCount = 1;
+	multipleSectorCount = g_hddManager.hddInfo.maxMultipleSectors & HDD_MULTIPLESECTOR_COUNTMASK;
+	if ((multipleSectorCount > 1) && (k_setHddMultipleMode(true, true, multipleSectorCount) == true)) {
+		g_hddManager.multipleSectorCount = multipleSectorCount;
+	}
+}
+
+qword k_getHddTotalSectorCount(const HddInfo* hddInfo) {
+	// If hard disk supports LBA48, the total sector count of LBA28 is limited to 2^28 - 1, so use the total sector count of LBA48.
+	if (((hddInfo->commandSetSupported & HDD_COMMANDSET_LBA48) == HDD_COMMANDSET_LBA48) && (hddInfo->totalSectorsLba48 > hddInfo->totalSectors)) {
+		return hddInfo->totalSectorsLba48;
+	}
+	
+	return hddInfo->totalSectors;
+}
+
+int k_getHddMaxSectorCount(void) {
+	return g_hddManager.maxSectorCount;
+}
+
+static int k_getHddDriveMaxSectorCount(bool primary, bool master) {
+	// [NOTE] LBA48 has been checked and set only for primary master hard disk,
+	//        so other drives use LBA28 commands, whose Sector Count Register is 8 bits (max 256 sectors).
+	if ((primary == true) && (master == true)) {
+		return g_hddManager.maxSectorCount;
+	}
+	
+	return HDD_MAXBULKSECTORCOUNT;
+}
+
+static bool k_isHddRangeValid(bool primary, bool master, qword lba, int sectorCount) {
+	// check the range of sector count (1 ~ 256 sectors, or 1 ~ 65536 sectors in LBA48 mode).
+	if ((sectorCount <= 0) || (sectorCount > k_getHddDriveMaxSectorCount(primary, master)) || ((lba + sectorCount) >= g_hddManager.totalSectorCount)) {
+		return false;
+	}
+	
+	// LBA28 commands can address only the first 2^28 sectors.
+	if (((primary == false) || (master == false) || (g_hddManager.lba48Supported == false)) && ((lba + sectorCount) > HDD_MAXLBA28)) {
+		return false;
+	}
+	
+	return true;
+}
+
+static bool k_setHddMultipleMode(bool primary, bool master, int sectorCount) {
+	word portBase;
+	byte status;
+	byte driveFlag;
+	bool waitResult;
+	
+	if (primary == true) {
+		portBase = HDD_PORT_PRIMARYBASE;
+		
+	} else {
+		portBase = HDD_PORT_SECONDARYBASE;
+	}
+	
+	k_lock(&(g_hddManager.mutex));
+	
+	// wait for a wile If hard disk already has executing commands.
+	if (k_waitHddNoBusy(primary) == false) {
+		k_unlock(&(g_hddManager.mutex));
+		return false;
+	}
+	
+	if (master == true) {
+		driveFlag = HDD_DRIVEANDHEAD_LBA;
+		
+	} else {
+		driveFlag = HDD_DRIVEANDHEAD_LBA | HDD_DRIVEANDHEAD_SLAVE;
+	}
+	
+	// send sector count per block to Sector Count Register, and configuration value to Drive/Head Register.
+	k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount);
+	k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, driveFlag);
+	
+	// wait until hard disk is ready to receive commands, or limit time expires
+	if (k_waitHddReady(primary) == false) {
+		k_unlock(&(g_hddManager.mutex));
+		return false;
+	}
+	
+	k_setHddInterruptFlag(primary, false);
+	
+	// send Set Multiple Mode Command to Command Register, and wait for interrupt.
+	k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, HDD_COMMAND_SETMULTIPLEMODE);
+	waitResult = k_waitHddInterrupt(primary);
+	
+	// If interrupt doesn't occur or hard disk aborts the command, return false.
+	status = k_readHddStatus(primary);
+	if ((waitResult == false) || ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR)) {
+		k_unlock(&(g_hddManager.mutex));
+		return false;
+	}
+	
+	k_unlock(&(g_hddManager.mutex));
+	return true;
+}
+
+static void k_initHddBusMaster(void) {
+	PciDevice pciDevice;
+	dword bar4;
+	dword command;
+	HddPrd* prdTables;
+	
+	g_hddManager.busMasterBase = 0;
+	g_hddManager.dmaSupported = false;
+	g_hddManager.dmaEnabled = false;
+	
+	// If hard disk doesn't support DMA, use PIO.
+	if ((g_hddManager.hddInfo.capabilities & HDD_CAPABILITIES_DMA) != HDD_CAPABILITIES_DMA) {
+		return;
+	}
+	
+	// search PCI IDE controller which supports bus master (bit 7 of programming interface).
+	if ((k_findPciDevice(PCI_CLASS_MASSSTORAGE, PCI_SUBCLASS_IDE, &pciDevice) == false) || ((pciDevice.progIf & 0x80) != 0x80)) {
+		return;
+	}
+	
+	// BAR4 must be I/O space BAR, which has I/O port base of bus master IDE controller.
+	bar4 = k_readPciConfig(pciDevice.bus, pciDevice.device, pciDevice.function, PCI_CONFIG_BAR4);
+	if (((bar4 & PCI_BAR_IOSPACE) != PCI_BAR_IOSPACE) || ((bar4 & PCI_BAR_IOADDRMASK) == 0)) {
+		return;
+	}
+	
+	// enable I/O space access and bus master of PCI IDE controller.
+	command = k_readPciConfig(pciDevice.bus, pciDevice.device, pciDevice.function, PCI_CONFIG_COMMAND);
+	command = (command & 0xFFFF) | PCI_COMMAND_IOSPACE | PCI_COMMAND_BUSMASTER;
+	k_writePciConfig(pciDevice.bus, pciDevice.device, pciDevice.function, PCI_CONFIG_COMMAND, command);
+	
+	// allocate PRD tables of both PATA ports at once.
+	// [NOTE] PRD table must be aligned with 4 bytes and must not cross 64KB boundary.
+	//        Buddy block is aligned with its size, so each 8KB-sized half of 16KB-sized block never crosses 64KB boundary.
+	prdTables = (HddPrd*)k_allocMem(2 * HDD_MAXPRDCOUNT * sizeof(HddPrd));
+	if (prdTables == null) {
+		return;
+	}
+	
+	g_hddManager.requestQueues[0].prdTable = prdTables;
+	g_hddManager.requestQueues[1].prdTable = prdTables + HDD_MAXPRDCOUNT;
+	
+	g_hddManager.busMasterBase = bar4 & PCI_BAR_IOADDRMASK;
+	
+	// stop bus master, and clear error and interrupt bits of both PATA ports (write 1 to clear).
+	k_stopHddBusMaster(true);
+	k_stopHddBusMaster(false);
+	
+	// use DMA by default.
+	g_hddManager.dmaSupported = true;
+	g_hddManager.dmaEnabled = true;
+}
+
+bool k_setHddDmaMode(bool enable) {
+	if ((enable == true) && (g_hddManager.dmaSupported == false)) {
+		return false;
+	}
+	
+	// [NOTE] It's applied from the next batch, because running batch is completed in the mode that it has been issued.
+	g_hddManager.dmaEnabled = enable;
+	
+	return true;
+}
+
+void k_getHddTransferMode(bool* dmaSupported, bool* dmaEnabled, bool* lba48Supported, int* multipleSectorCount) {
+	*dmaSupported = g_hddManager.dmaSupported;
+	*dmaEnabled = g_hddManager.dmaEnabled;
+	*lba48Supported = g_hddManager.lba48Supported;
+	*multipleSectorCount = g_hddManager.multipleSectorCount;
+}
+
+static word k_getHddBusMasterPort(bool primary, word index) {
+	if (primary == true) {
+		return g_hddManager.busMasterBase + index;
+	}
+	
+	return g_hddManager.busMasterBase + HDD_BM_PORT_INDEX_SECONDARY + index;
+}
+
+static void k_stopHddBusMaster(bool primary) {
+	// clear start bit of Bus Master Command Register.
+	k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_COMMAND), 0);
+	
+	// clear error and interrupt bits of Bus Master Status Register by writing 1.
+	k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_STATUS), HDD_BM_STATUS_ERROR | HDD_BM_STATUS_INTERRUPT);
+}
+
+static bool k_buildHddPrdTable(bool primary) {
+	HddRequestQueue* queue;
+	HddRequest* request;
+	HddPrd* prdTable;
+	qword addr;
+	qword remainByteCount;
+	qword byteCount;
+	int prdCount = 0;
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	prdTable = queue->prdTable;
+	
+	// create PRDs for all request buffers in the batch.
+	// [NOTE] Virtual address is equal to physical address, because kernel uses identity mapping.
+	for (request = queue->batch; request != null; request = request->next) {
+		addr = (qword)request->buffer;
+		remainByteCount = request->sectorCount * 512;
+		
+		// bus master can access only the memory below 4GB aligned with 2 bytes, so use PIO if not.
+		if (((addr & 0x01) != 0) || ((addr + remainByteCount) > 0x100000000)) {
+			return false;
+		}
+		
+		// split memory region at 64KB boundary.
+		while (remainByteCount > 0) {
+			if (prdCount >= HDD_MAXPRDCOUNT) {
+				return false;
+			}
+			
+			byteCount = HDD_PRD_MAXBYTECOUNT - (addr & (HDD_PRD_MAXBYTECOUNT - 1));
+			if (byteCount > remainByteCount) {
+				byteCount = remainByteCount;
+			}
+			
+			prdTable[prdCount].addr = (dword)addr;
+			prdTable[prdCount].byteCount = (word)byteCount; // 64KB is saved as 0.
+			prdTable[prdCount].flags = 0;
+			prdCount++;
+			
+			addr += byteCount;
+			remainByteCount -= byteCount;
+		}
+	}
+	
+	if (prdCount == 0) {
+		return false;
+	}
+	
+	// set EOT to the last PRD.
+	prdTable[prdCount - 1].flags = HDD_PRD_ENDOFTABLE;
+	
 	return true;
 }
 
@@ -126,6 +404,13 @@ bool k_readHddInfo(bool primary, bool master, HddInfo* hddInfo) {
 	int i;
 	bool waitResult;
 	
+	// If hard disk info has been already read, return it without sending command,
+	// because drive recognition command must not be interleaved with requests in request queue.
+	if ((g_hddManager.hddDetected == true) && (primary == true) && (master == true)) {
+		k_memcpy(hddInfo, &(g_hddManager.hddInfo), sizeof(HddInfo));
+		return true;
+	}
+	
 	if (primary == true) {
 		portBase = HDD_PORT_PRIMARYBASE;
 		
@@ -207,19 +492,306 @@ static void k_swapByteInWord(word* data, int wordCount) {
 	}
 }
 
-int k_readHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
-	word portBase;
-	int i, j;
-	byte driveFlag;
-	byte status;
-	long readCount = 0;
-	bool waitResult;
+int k_readHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
+	HddRequest* request;
+	
+	// check the range of reading sectors.
+	if ((g_hddManager.hddDetected == false) || (k_isHddRangeValid(primary, master, lba, sectorCount) == false)) {
+		return 0;
+	}
+	
+	// buffer in user space (system call buffer or user stack) is bounced through kernel buffer.
+	if ((qword)buffer >= VMEM_USERSPACESTARTADDRESS) {
+		return k_transferHddSectorWithBounce(primary, master, false, lba, sectorCount, buffer);
+	}
 	
-	// check the range of reading sector count (1 ~ 256 sectors).
-	if ((g_hddManager.hddDetected == false) || (sectorCount <= 0) || (sectorCount > 256) || ((lba + sectorCount) >= g_hddManager.hddInfo.totalSectors)) {
+	// submit request to request queue. If request pool is full, wait for a while.
+	while ((request = k_submitHddRequest(primary, master, false, lba, sectorCount, buffer)) == null) {
+		k_sleep(1);
+	}
+	
+	// sleep until HDD interrupt handler completes the request.
+	return k_waitHddRequest(primary, request); // return real read sector count.
+}
+
+int k_writeHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
+	HddRequest* request;
+	
+	// check the range of writing sectors.
+	if ((g_hddManager.writable == false) || (k_isHddRangeValid(primary, master, lba, sectorCount) == false)) {
 		return 0;
 	}
 	
+	// buffer in user space (system call buffer or user stack) is bounced through kernel buffer.
+	if ((qword)buffer >= VMEM_USERSPACESTARTADDRESS) {
+		return k_transferHddSectorWithBounce(primary, master, true, lba, sectorCount, buffer);
+	}
+	
+	// submit request to request queue. If request pool is full, wait for a while.
+	while ((request = k_submitHddRequest(primary, master, true, lba, sectorCount, buffer)) == null) {
+		k_sleep(1);
+	}
+	
+	// sleep until HDD interrupt handler completes the request.
+	return k_waitHddRequest(primary, request); // return real written sector count.
+}
+
+static int k_transferHddSectorWithBounce(bool primary, bool master, bool write, qword lba, int sectorCount, char* buffer) {
+	HddRequest* request;
+	char* bounceBuffer;
+	int doneCount;
+	
+	// [NOTE] HDD interrupt handler copies data of PIO transfer under any CR3, and interrupt handlers must not touch user space.
+	//        So, request always uses kernel buffer, and data is copied from/to user space here, in the address space of caller.
+	bounceBuffer = (char*)k_allocMem(sectorCount * 512);
+	if (bounceBuffer == null) {
+		return 0;
+	}
+	
+	if (write == true) {
+		k_memcpy(bounceBuffer, buffer, sectorCount * 512);
+	}
+	
+	// submit request to request queue. If request pool is full, wait for a while.
+	while ((request = k_submitHddRequest(primary, master, write, lba, sectorCount, bounceBuffer)) == null) {
+		k_sleep(1);
+	}
+	
+	// sleep until HDD interrupt handler completes the request.
+	doneCount = k_waitHddRequest(primary, request);
+	
+	if ((write == false) && (doneCount > 0)) {
+		k_memcpy(buffer, bounceBuffer, doneCount * 512);
+	}
+	
+	k_freeMem(bounceBuffer);
+	
+	return doneCount;
+}
+
+static void k_initHddRequestQueue(HddRequestQueue* queue, qword waitGroupIdBase) {
+	int i;
+	
+	k_memset(queue, 0, sizeof(HddRequestQueue));
+	k_initSpinlock(&(queue->spinlock));
+	
+	// set all requests to free requests, and assign wait group ID to each request.
+	for (i = 0; i < HDD_MAXREQUESTCOUNT; i++) {
+		queue->requestPool[i].status = HDD_REQUEST_FREE;
+		queue->requestPool[i].waitGroupId = waitGroupIdBase + i;
+	}
+}
+
+static HddRequest* k_allocHddRequest(HddRequestQueue* queue) {
+	int i;
+	
+	// allocate free request from request pool.
+	for (i = 0; i < HDD_MAXREQUESTCOUNT; i++) {
+		if (queue->requestPool[i].status == HDD_REQUEST_FREE) {
+			queue->usedCount++;
+			return &(queue->requestPool[i]);
+		}
+	}
+	
+	return null;
+}
+
+HddRequest* k_submitHddRequest(bool primary, bool master, bool write, qword lba, int sectorCount, char* buffer) {
+	HddRequestQueue* queue;
+	HddRequest* request;
+	HddRequest* prev, * current;
+	
+	// check the range of sectors.
+	if ((g_hddManager.hddDetected == false) || (k_isHddRangeValid(primary, master, lba, sectorCount) == false)) {
+		return null;
+	}
+	
+	if ((write == true) && (g_hddManager.writable == false)) {
+		return null;
+	}
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	
+	k_lockSpin(&(queue->spinlock));
+	
+	// allocate free request from request pool.
+	request = k_allocHddRequest(queue);
+	if (request == null) {
+		k_unlockSpin(&(queue->spinlock));
+		return null;
+	}
+	
+	// set request.
+	request->master = master;
+	request->write = write;
+	request->flush = false;
+	request->lba = lba;
+	request->sectorCount = sectorCount;
+	request->buffer = buffer;
+	request->status = HDD_REQUEST_PENDING;
+	request->doneCount = 0;
+	request->waiting = false;
+	request->submitTime = k_getTickCount();
+	
+	// insert request to pending list sorted ascendingly by LBA.
+	// Requests which have the same LBA are inserted in the submitted order.
+	prev = null;
+	current = queue->pendingHead;
+	while ((current != null) && (current->lba <= lba)) {
+		prev = current;
+		current = current->next;
+	}
+	
+	request->next = current;
+	if (prev == null) {
+		queue->pendingHead = request;
+		
+	} else {
+		prev->next = request;
+	}
+	
+	// If hard disk is idle, start batch right now. If not, interrupt handler will start it.
+	if (queue->batch == null) {
+		k_startHddBatch(primary);
+	}
+	
+	k_unlockSpin(&(queue->spinlock));
+	
+	return request;
+}
+
+int k_waitHddRequest(bool primary, HddRequest* request) {
+	HddRequestQueue* queue;
+	int doneCount;
+	
+	if (request == null) {
+		return 0;
+	}
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	
+	k_lockSpin(&(queue->spinlock));
+	
+	// sleep until interrupt handler completes the request.
+	// [NOTE] waiting flag is set and the task enters wait group while holding spinlock, and interrupt handler completes
+	//        the request and notifies wait group while holding the same spinlock, so notification is never lost.
+	//        (If there is no other task to run, k_waitGroup returns right away, and the request status is checked again.)
+	while ((request->status == HDD_REQUEST_PENDING) || (request->status == HDD_REQUEST_RUNNING)) {
+		request->waiting = true;
+		k_waitGroup(request->waitGroupId, &(queue->spinlock));
+	}
+	
+	// free the request.
+	doneCount = request->doneCount;
+	request->waiting = false;
+	request->status = HDD_REQUEST_FREE;
+	queue->usedCount--;
+	
+	k_unlockSpin(&(queue->spinlock));
+	
+	return doneCount;
+}
+
+bool k_flushHddCache(bool primary, bool master) {
+	HddRequestQueue* queue;
+	HddRequest* request;
+	
+	if (g_hddManager.hddDetected == false) {
+		return false;
+	}
+	
+	// If hard disk isn't writable, there is nothing to flush.
+	// [NOTE] flush cache support has been checked only for primary master hard disk, and other drives are always flushed.
+	if ((g_hddManager.writable == false) || ((primary == true) && (master == true) && (g_hddManager.flushSupported == false))) {
+		return true;
+	}
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	
+	// submit flush request to the tail of flush request list. If request pool is full, wait for a while.
+	while (true) {
+		k_lockSpin(&(queue->spinlock));
+		
+		request = k_allocHddRequest(queue);
+		if (request != null) {
+			break;
+		}
+		
+		k_unlockSpin(&(queue->spinlock));
+		k_sleep(1);
+	}
+	
+	request->next = null;
+	request->master = master;
+	request->write = true;
+	request->flush = true;
+	request->lba = 0;
+	request->sectorCount = 0;
+	request->buffer = null;
+	request->status = HDD_REQUEST_PENDING;
+	request->doneCount = 0;
+	request->waiting = false;
+	request->submitTime = k_getTickCount();
+	
+	if (queue->flushHead == null) {
+		queue->flushHead = request;
+		
+	} else {
+		queue->flushTail->next = request;
+	}
+	
+	queue->flushTail = request;
+	
+	// If hard disk is idle, start flush right now. If not, interrupt handler will start it.
+	if (queue->batch == null) {
+		k_startHddBatch(primary);
+	}
+	
+	k_unlockSpin(&(queue->spinlock));
+	
+	// sleep until HDD interrupt handler completes the request.
+	return (k_waitHddRequest(primary, request) == 1);
+}
+
+bool k_isHddRequestDone(bool primary, const HddRequest* request) {
+	if ((request->status == HDD_REQUEST_DONE) || (request->status == HDD_REQUEST_ERROR)) {
+		return true;
+	}
+	
+	return false;
+}
+
+static bool k_pollHddStatus(bool primary, byte mask, byte value) {
+	byte status;
+	int i;
+	
+	// poll Status Register without sleeping, because it's called while holding spinlock.
+	for (i = 0; i < HDD_MAXPOLLCOUNT; i++) {
+		status = k_readHddStatus(primary);
+		
+		// If error occurs while waiting for data request, stop polling.
+		if (((mask & HDD_STATUS_DATAREQUEST) == HDD_STATUS_DATAREQUEST) && ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR)) {
+			return false;
+		}
+		
+		if ((status & mask) == value) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+static void k_transferHddSector(bool primary) {
+	HddRequestQueue* queue;
+	HddRequest* request;
+	word portBase;
+	word* data;
+	int i;
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	request = queue->currentRequest;
+	
 	if (primary == true) {
 		portBase = HDD_PORT_PRIMARYBASE;
 		
@@ -227,31 +799,83 @@ int k_readHddSector(bool primary, bool master, dword lba, int sectorCount, char*
 		portBase = HDD_PORT_SECONDARYBASE;
 	}
 	
-	k_lock(&(g_hddManager.mutex));
+	data = (word*)(request->buffer + (queue->sectorIndexInRequest * 512));
 	
-	// wait until hard disk already has executing commands, or limit time expires
-	if (k_waitHddNoBusy(primary) == false) {
-		k_unlock(&(g_hddManager.mutex));
-		return false;
+	// send/receive 1 sector to/from Data Register.
+	if (request->write == true) {
+		for (i = 0; i < (512 / 2); i++) {
+			k_outPortWord(portBase + HDD_PORT_INDEX_DATA, data[i]);
+		}
+		
+	} else {
+		for (i = 0; i < (512 / 2); i++) {
+			data[i] = k_inPortWord(portBase + HDD_PORT_INDEX_DATA);
+		}
 	}
 	
-	//----------------------------------------------------------------------------------------------------
-	// send reading sector count, sector offset to many registers,
-	// and send configuration value (LBA mode, drive number) to Drive/Head Register.
-	// save [bit 0~7: sector number], [bit 8~15: cylinder number LSB], [bit 16~23: cylinder number MSB], [bit 24~27: head number] of LBA address (28 bits).
-	//----------------------------------------------------------------------------------------------------
+	request->doneCount++;
+	queue->remainSectorCount--;
 	
-	// send sector count to Sector Count Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount);
+	// If current request is finished, move to next request in the batch.
+	queue->sectorIndexInRequest++;
+	if (queue->sectorIndexInRequest == request->sectorCount) {
+		queue->currentRequest = request->next;
+		queue->sectorIndexInRequest = 0;
+	}
+}
+
+static void k_transferHddBlock(bool primary) {
+	HddRequestQueue* queue;
+	int sectorCount;
+	int i;
 	
-	// send sector offset (LBA bit 0~7) to Sector Number Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_SECTORNUMBER, lba);
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
 	
-	// send sector offset (LBA bit 8~15) to Cylinder LSB Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERLSB, lba >> 8);
+	// transfer 1 block (the last block might be smaller than block size).
+	sectorCount = MIN(queue->blockSectorCount, queue->remainSectorCount);
+	for (i = 0; i < sectorCount; i++) {
+		k_transferHddSector(primary);
+	}
+}
+
+static bool k_issueHddCommand(bool primary, bool master, bool write, qword lba, int sectorCount) {
+	HddRequestQueue* queue;
+	word portBase;
+	byte driveFlag;
+	bool lba48;
+	byte command;
 	
-	// send sector offset (LBA bit 16~23) to Cylinder MSB Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERMSB, lba >> 16);
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	
+	// use DMA if it's enabled and all buffers of the batch are accessible by bus master. If not, use PIO.
+	if ((g_hddManager.dmaEnabled == true) && (k_buildHddPrdTable(primary) == true)) {
+		queue->dmaBatch = true;
+		
+	} else {
+		queue->dmaBatch = false;
+	}
+	
+	// [NOTE] LBA48 and multiple mode have been checked and set only for primary master hard disk.
+	if ((primary == true) && (master == true)) {
+		lba48 = (g_hddManager.lba48Supported == true) && ((sectorCount > HDD_MAXBULKSECTORCOUNT) || ((lba + sectorCount) > HDD_MAXLBA28));
+		queue->blockSectorCount = g_hddManager.multipleSectorCount;
+		
+	} else {
+		lba48 = false;
+		queue->blockSectorCount = 1;
+	}
+	
+	if (primary == true) {
+		portBase = HDD_PORT_PRIMARYBASE;
+		
+	} else {
+		portBase = HDD_PORT_SECONDARYBASE;
+	}
+	
+	// wait until hard disk finishes executing commands.
+	if (k_pollHddStatus(primary, HDD_STATUS_BUSY, 0) == false) {
+		return false;
+	}
 	
 	if (master == true) {
 		driveFlag = HDD_DRIVEANDHEAD_LBA;
@@ -260,76 +884,132 @@ int k_readHddSector(bool primary, bool master, dword lba, int sectorCount, char*
 		driveFlag = HDD_DRIVEANDHEAD_LBA | HDD_DRIVEANDHEAD_SLAVE;
 	}
 	
-	// send sector offset (LBA bit 24~27) and configuration value (LBA mode, drive number) to Drive/Head Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, driveFlag | ((lba >> 24) & 0x0F));
+	if (lba48 == false) {
+		//----------------------------------------------------------------------------------------------------
+		// LBA28: send sector count, sector offset to many registers,
+		// and send configuration value (LBA mode, drive number) to Drive/Head Register.
+		// save [bit 0~7: sector number], [bit 8~15: cylinder number LSB], [bit 16~23: cylinder number MSB], [bit 24~27: head number] of LBA address (28 bits).
+		//----------------------------------------------------------------------------------------------------
+		
+		// send sector count to Sector Count Register. (256 is sent as 0)
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount);
+		
+		// send sector offset (LBA bit 0~7) to Sector Number Register.
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORNUMBER, lba);
+		
+		// send sector offset (LBA bit 8~15) to Cylinder LSB Register.
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERLSB, lba >> 8);
+		
+		// send sector offset (LBA bit 16~23) to Cylinder MSB Register.
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERMSB, lba >> 16);
+		
+		// send sector offset (LBA bit 24~27) and configuration value (LBA mode, drive number) to Drive/Head Register.
+		k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, driveFlag | ((lba >> 24) & 0x0F));
+		
+	} else {
+		//----------------------------------------------------------------------------------------------------
+		// LBA48: send high bytes first and then low bytes to the same registers (each register is a 2 bytes-sized FIFO).
+		// save [bit 0~7, 24~31: sector number], [bit 8~15, 32~39: cylinder number LSB], [bit 16~23, 40~47: cylinder number MSB] of LBA address (48 bits).
+		//----------------------------------------------------------------------------------------------------
+		
+		// send sector count (bit 8~15) and sector offset (LBA bit 24~47) first. (65536 is sent as 0)
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount >> 8);
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORNUMBER, lba >> 24);
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERLSB, lba >> 32); // LBA bit 32~39
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERMSB, lba >> 40); // LBA bit 40~47
+		
+		// send sector count (bit 0~7) and sector offset (LBA bit 0~23).
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount);
+		k_outPortByte(portBase + HDD_PORT_INDEX_SECTORNUMBER, lba);
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERLSB, lba >> 8);
+		k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERMSB, lba >> 16);
+		
+		// send configuration value (LBA mode, drive number) to Drive/Head Register. (head number field isn't used.)
+		k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, driveFlag);
+	}
 	
 	//----------------------------------------------------------------------------------------------------
-	// send Sector Read Command.
+	// send Sector Read/Write Command.
 	//----------------------------------------------------------------------------------------------------
 	
-	// wait until hard disk is ready to receive commands, or limit time expires
-	if (k_waitHddReady(primary) == false) {
-		k_unlock(&(g_hddManager.mutex));
+	// wait until hard disk is ready to receive commands.
+	if (k_pollHddStatus(primary, HDD_STATUS_READY, HDD_STATUS_READY) == false) {
 		return false;
 	}
 	
 	k_setHddInterruptFlag(primary, false);
 	
-	// send Sector Read Command to Command Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, HDD_COMMAND_READ);
-	
 	//----------------------------------------------------------------------------------------------------
-	// after waiting for interrupts, receive data.
+	// DMA: set PRD table and direction to bus master, send Read/Write DMA Command, and start bus master.
+	// The whole batch is transferred by bus master, and interrupt occurs only once when it finishes.
 	//----------------------------------------------------------------------------------------------------
-	
-	// read data as many as sector count from Data Register.
-	for (i = 0; i < sectorCount; i++) {
-		// If error occurs in processing, return.
-		status = k_readHddStatus(primary);
-		if ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR) {
-			k_printf("HDD error: Error has occured while reading HDD sector.\n");
-			k_unlock(&(g_hddManager.mutex));
-			return i; // return real read sector count.
-		}
+	if (queue->dmaBatch == true) {
+		k_stopHddBusMaster(primary);
+		k_outPortDword(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_PRDT), (dword)(qword)queue->prdTable);
 		
-		// wait until it finishes receiving data, or limit time expires
-		if ((status & HDD_STATUS_DATAREQUEST) != HDD_STATUS_DATAREQUEST) {
-			
-			// wait until it finishes receiving data and interrupt occurs, or limit time expires
-			waitResult = k_waitHddInterrupt(primary);
+		if (write == false) {
+			k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_COMMAND), HDD_BM_COMMAND_READ);
+			k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, (lba48 == true) ? HDD_COMMAND_READDMAEXT : HDD_COMMAND_READDMA);
+			k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_COMMAND), HDD_BM_COMMAND_READ | HDD_BM_COMMAND_START);
 			
-			k_setHddInterruptFlag(primary, false);
-			
-			// If interrupt doesn't occurs, return.
-			if (waitResult == false) {
-				k_printf("HDD error: Interrupt has not occured while reading HDD sector.\n");
-				k_unlock(&(g_hddManager.mutex));
-				return false;
-			}
+		} else {
+			k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_COMMAND), 0);
+			k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, (lba48 == true) ? HDD_COMMAND_WRITEDMAEXT : HDD_COMMAND_WRITEDMA);
+			k_outPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_COMMAND), HDD_BM_COMMAND_START);
 		}
 		
-		// read data as many as 1 sector from Data Register.
-		for (j = 0; j < (512 / 2); j++) {
-			((word*)buffer)[readCount++] = k_inPortWord(portBase + HDD_PORT_INDEX_DATA);
+		return true;
+	}
+	
+	//----------------------------------------------------------------------------------------------------
+	// PIO: send Read/Write Sector (Multiple) Command, and transfer each block in interrupt handler.
+	// A block is 1 sector for read/write sectors commands, and multiple sectors for read/write multiple commands.
+	//----------------------------------------------------------------------------------------------------
+	if (write == false) {
+		if (queue->blockSectorCount > 1) {
+			command = (lba48 == true) ? HDD_COMMAND_READMULTIPLEEXT : HDD_COMMAND_READMULTIPLE;
+			
+		} else {
+			command = (lba48 == true) ? HDD_COMMAND_READEXT : HDD_COMMAND_READ;
 		}
+		
+		// send Sector Read Command to Command Register.
+		// The data of each block is received by interrupt handler.
+		k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, command);
+		return true;
 	}
 	
-	k_unlock(&(g_hddManager.mutex));
-	return i; // return real read sector count.
+	if (queue->blockSectorCount > 1) {
+		command = (lba48 == true) ? HDD_COMMAND_WRITEMULTIPLEEXT : HDD_COMMAND_WRITEMULTIPLE;
+		
+	} else {
+		command = (lba48 == true) ? HDD_COMMAND_WRITEEXT : HDD_COMMAND_WRITE;
+	}
+	
+	// send Sector Write Command to Command Register.
+	k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, command);
+	
+	// wait until data is ready to receive, and send the first block.
+	// The next blocks are sent by interrupt handler.
+	if (k_pollHddStatus(primary, HDD_STATUS_DATAREQUEST, HDD_STATUS_DATAREQUEST) == false) {
+		return false;
+	}
+	
+	k_transferHddBlock(primary);
+	
+	return true;
 }
 
-int k_writeHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
+static bool k_issueHddFlushCommand(bool primary, bool master) {
+	HddRequestQueue* queue;
 	word portBase;
-	int i, j;
-	byte driveFlag;
-	byte status;
-	long writeCount = 0;
-	bool waitResult;
+	bool lba48;
 	
-	// check the range of writing sector count (1~256 sectors).
-	if ((g_hddManager.writable == false) || (sectorCount <= 0) || (sectorCount > 256) || ((lba + sectorCount) >= g_hddManager.hddInfo.totalSectors)) {
-		return 0;
-	}
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	queue->dmaBatch = false;
+	
+	// [NOTE] LBA48 has been checked and set only for primary master hard disk.
+	lba48 = (primary == true) && (master == true) && (g_hddManager.lba48Supported == true);
 	
 	if (primary == true) {
 		portBase = HDD_PORT_PRIMARYBASE;
@@ -338,112 +1018,304 @@ int k_writeHddSector(bool primary, bool master, dword lba, int sectorCount, char
 		portBase = HDD_PORT_SECONDARYBASE;
 	}
 	
-	// wait until hard disk already has executing commands, or limit time expires.
-	if (k_waitHddNoBusy(primary) == false) {
+	// wait until hard disk finishes executing commands.
+	if (k_pollHddStatus(primary, HDD_STATUS_BUSY, 0) == false) {
 		return false;
 	}
 	
-	k_lock(&(g_hddManager.mutex));
+	// send configuration value (LBA mode, drive number) to Drive/Head Register.
+	if (master == true) {
+		k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, HDD_DRIVEANDHEAD_LBA);
+		
+	} else {
+		k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, HDD_DRIVEANDHEAD_LBA | HDD_DRIVEANDHEAD_SLAVE);
+	}
 	
-	//----------------------------------------------------------------------------------------------------
-	// send writing sector count, sector offset to many registers,
-	// and send configuration value (LBA mode, drive number) to Drive/Head Register.
-	// save [bit 0~7: sector number], [bit 8~15: cylinder number LSB], [bit 16~23: cylinder number MSB], [bit 24~27: head number] of LBA address (28 bits).
-	//----------------------------------------------------------------------------------------------------
+	// wait until hard disk is ready to receive commands.
+	if (k_pollHddStatus(primary, HDD_STATUS_READY, HDD_STATUS_READY) == false) {
+		return false;
+	}
 	
-	// send sector count to Sector Count Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_SECTORCOUNT, sectorCount);
+	k_setHddInterruptFlag(primary, false);
 	
-	// send sector offset (LBA bit 0~7) to Sector Number Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_SECTORNUMBER, lba);
+	// send Flush Cache Command to Command Register. Interrupt occurs when all data in write cache has been written to media.
+	k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, (lba48 == true) ? HDD_COMMAND_FLUSHCACHEEXT : HDD_COMMAND_FLUSHCACHE);
 	
-	// send sector offset (LBA bit 8~15) to Cylinder LSB Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERLSB, lba >> 8);
+	return true;
+}
+
+static void k_startHddBatch(bool primary) {
+	HddRequestQueue* queue;
+	HddRequest* request, * prev;
+	HddRequest* first, * firstPrev, * last;
+	int sectorCount;
+	int maxSectorCount;
+	qword tickCount;
+	
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
+	
+	// loop until a batch is issued successfully, or pending list and flush request list become empty.
+	while ((queue->pendingHead != null) || (queue->flushHead != null)) {
+		tickCount = k_getTickCount();
+		first = null;
+		firstPrev = null;
+		
+		//----------------------------------------------------------------------------------------------------
+		// flush request is served alone before pending requests.
+		//----------------------------------------------------------------------------------------------------
+		if (queue->flushHead != null) {
+			first = queue->flushHead;
+			queue->flushHead = first->next;
+			first->next = null;
+			first->status = HDD_REQUEST_RUNNING;
+			
+			// set running batch. (head position doesn't change.)
+			queue->batch = first;
+			queue->currentRequest = first;
+			queue->sectorIndexInRequest = 0;
+			queue->remainSectorCount = 0;
+			queue->issueTime = tickCount;
+			
+			if (k_issueHddFlushCommand(primary, first->master) == true) {
+				return;
+			}
+			
+			k_completeHddBatch(primary, HDD_REQUEST_ERROR);
+			continue;
+		}
+		
+		//----------------------------------------------------------------------------------------------------
+		// select the first request of batch.
+		//----------------------------------------------------------------------------------------------------
+		
+		// deadline: If there are requests older than deadline, select the oldest one.
+		prev = null;
+		for (request = queue->pendingHead; request != null; request = request->next) {
+			if (((tickCount - request->submitTime) > HDD_REQUESTDEADLINE) && ((first == null) || (request->submitTime < first->submitTime))) {
+				first = request;
+				firstPrev = prev;
+			}
+			
+			prev = request;
+		}
+		
+		// elevator (C-LOOK): select the first request from head position, or wrap around to the lowest LBA.
+		if (first == null) {
+			prev = null;
+			for (request = queue->pendingHead; request != null; request = request->next) {
+				if (request->lba >= queue->headLba) {
+					first = request;
+					firstPrev = prev;
+					break;
+				}
+				
+				prev = request;
+			}
+			
+			if (first == null) {
+				first = queue->pendingHead;
+				firstPrev = null;
+			}
+		}
+		
+		//----------------------------------------------------------------------------------------------------
+		// merge contiguous requests which have the same direction and drive into a batch (up to max sector count of the drive).
+		// Because pending list is sorted by LBA, contiguous requests follow the first request.
+		//----------------------------------------------------------------------------------------------------
+		maxSectorCount = k_getHddDriveMaxSectorCount(primary, first->master);
+		sectorCount = first->sectorCount;
+		last = first;
+		while ((last->next != null) && (last->next->write == first->write) && (last->next->master == first->master) &&
+		       (last->next->lba == (last->lba + last->sectorCount)) && ((sectorCount + last->next->sectorCount) <= maxSectorCount)) {
+			sectorCount += last->next->sectorCount;
+			last = last->next;
+		}
+		
+		// remove batch from pending list.
+		if (firstPrev == null) {
+			queue->pendingHead = last->next;
+			
+		} else {
+			firstPrev->next = last->next;
+		}
+		
+		last->next = null;
+		
+		for (request = first; request != null; request = request->next) {
+			request->status = HDD_REQUEST_RUNNING;
+		}
+		
+		// set running batch.
+		queue->batch = first;
+		queue->currentRequest = first;
+		queue->sectorIndexInRequest = 0;
+		queue->remainSectorCount = sectorCount;
+		queue->headLba = first->lba + sectorCount;
+		queue->issueTime = tickCount;
+		
+		// issue command of batch.
+		if (k_issueHddCommand(primary, first->master, first->write, first->lba, sectorCount) == true) {
+			return;
+		}
+		
+		// If issuing command fails, complete the batch with error, and try next batch.
+		k_completeHddBatch(primary, HDD_REQUEST_ERROR);
+	}
+}
+
+static void k_completeHddBatch(bool primary, byte status) {
+	HddRequestQueue* queue;
+	HddRequest* request, * next;
 	
-	// send sector offset (LBA bit 16~23) to Cylinder MSB Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_CYLINDERMSB, lba >> 16);
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
 	
-	if (master == true) {
-		driveFlag = HDD_DRIVEANDHEAD_LBA;
+	// stop bus master, because DMA batch might be completed by error or timeout while transferring.
+	if (queue->dmaBatch == true) {
+		k_stopHddBusMaster(primary);
+		queue->dmaBatch = false;
+	}
+	
+	// complete all requests in the batch, and wake up the waiting tasks.
+	request = queue->batch;
+	while (request != null) {
+		next = request->next;
+		request->next = null;
 		
-	} else {
-		driveFlag = HDD_DRIVEANDHEAD_LBA | HDD_DRIVEANDHEAD_SLAVE;
+		if (status == HDD_REQUEST_DONE) {
+			request->doneCount = (request->flush == true) ? 1 : request->sectorCount;
+		}
+		
+		request->status = status;
+		
+		if (request->waiting == true) {
+			k_notifyAllInWaitGroup(request->waitGroupId);
+		}
+		
+		request = next;
 	}
 	
-	// send sector count (LBA bit 24~27) and configuration value (LBA mode, drive number) to Drive/Head Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_DRIVEANDHEAD, driveFlag | ((lba >> 24) & 0x0F));
+	// set hard disk to idle.
+	queue->batch = null;
+	queue->currentRequest = null;
+	queue->sectorIndexInRequest = 0;
+	queue->remainSectorCount = 0;
+}
+
+void k_processHddInterrupt(bool primary) {
+	HddRequestQueue* queue;
+	byte status;
+	byte bmStatus = 0;
 	
-	//----------------------------------------------------------------------------------------------------
-	// send Sector Write Command, and wait until data is ready to receive.
-	//----------------------------------------------------------------------------------------------------
+	queue = &(g_hddManager.requestQueues[(primary == true) ? 0 : 1]);
 	
-	// wait until hard disk is ready to receive commands, or limit time expires.
-	if (k_waitHddReady(primary) == false) {
-		k_unlock(&(g_hddManager.mutex));
-		return false;
+	k_lockSpin(&(queue->spinlock));
+	
+	// set interrupt flag for the command which doesn't use request queue (drive recognition command).
+	k_setHddInterruptFlag(primary, true);
+	
+	// If there is no running batch, return.
+	if (queue->batch == null) {
+		k_unlockSpin(&(queue->spinlock));
+		return;
 	}
 	
-	// send Sector Write Command to Command Register.
-	k_outPortByte(portBase + HDD_PORT_INDEX_COMMAND, HDD_COMMAND_WRITE);
+	// DMA: If bus master hasn't raised interrupt, ignore it (interrupt of other command).
+	if (queue->dmaBatch == true) {
+		bmStatus = k_inPortByte(k_getHddBusMasterPort(primary, HDD_BM_PORT_INDEX_STATUS));
+		if ((bmStatus & HDD_BM_STATUS_INTERRUPT) != HDD_BM_STATUS_INTERRUPT) {
+			k_readHddStatus(primary);
+			k_unlockSpin(&(queue->spinlock));
+			return;
+		}
+	}
 	
-	// wait until data is ready to receive.
-	while (true) {
-		status = k_readHddStatus(primary);
-		
-		// If error occurs, return.
-		if ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR) {
-			k_unlock(&(g_hddManager.mutex));
-			return 0;
+	// read Status Register. (It also clears interrupt of hard disk.)
+	status = k_readHddStatus(primary);
+	
+	// DMA: the whole batch has been transferred by bus master at once.
+	if (queue->dmaBatch == true) {
+		if (((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR) || ((bmStatus & HDD_BM_STATUS_ERROR) == HDD_BM_STATUS_ERROR)) {
+			k_completeHddBatch(primary, HDD_REQUEST_ERROR);
+			
+		} else {
+			k_completeHddBatch(primary, HDD_REQUEST_DONE);
 		}
 		
-		// <DRQ(bit 3) of Status Register == 1> means that it's ready to send data.
+	// If error occurs in processing, fail the batch.
+	} else if ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR) {
+		k_completeHddBatch(primary, HDD_REQUEST_ERROR);
+		
+	// flush: write cache has been written to media.
+	} else if (queue->batch->flush == true) {
+		k_completeHddBatch(primary, HDD_REQUEST_DONE);
+		
+	} else if (queue->batch->write == false) {
+		// receive 1 block from Data Register.
 		if ((status & HDD_STATUS_DATAREQUEST) == HDD_STATUS_DATAREQUEST) {
-			break;
+			k_transferHddBlock(primary);
 		}
 		
-		k_sleep(1);
+		if (queue->remainSectorCount == 0) {
+			k_completeHddBatch(primary, HDD_REQUEST_DONE);
+		}
+		
+	} else {
+		// the previous block has been written, so send next block.
+		if (queue->remainSectorCount == 0) {
+			k_completeHddBatch(primary, HDD_REQUEST_DONE);
+			
+		} else if (k_pollHddStatus(primary, HDD_STATUS_DATAREQUEST, HDD_STATUS_DATAREQUEST) == true) {
+			k_transferHddBlock(primary);
+			
+		} else {
+			k_completeHddBatch(primary, HDD_REQUEST_ERROR);
+		}
 	}
 	
-	//----------------------------------------------------------------------------------------------------
-	// send data, and wait for interrupts.
-	//----------------------------------------------------------------------------------------------------
+	// If the batch has been completed, start next batch. If not, reset the timeout.
+	if (queue->batch == null) {
+		k_startHddBatch(primary);
+		
+	} else {
+		queue->issueTime = k_getTickCount();
+	}
 	
-	// write data as many as sector count to Data Register.
-	for (i = 0; i < sectorCount; i++) {
+	k_unlockSpin(&(queue->spinlock));
+}
+
+void k_checkHddRequestTimeout(void) {
+	HddRequestQueue* queue;
+	qword limitTime;
+	int i;
+	
+	for (i = 0; i < 2; i++) {
+		queue = &(g_hddManager.requestQueues[i]);
 		
-		// initialize interrupt flag, write data as many as 1 sector to Data Register.
-		k_setHddInterruptFlag(primary, false);
-		for (j = 0; j < (512 / 2); j++) {
-			k_outPortWord(portBase + HDD_PORT_INDEX_DATA, ((word*)buffer)[writeCount++]);
+		// If there is no request, skip it without lock.
+		if (queue->usedCount == 0) {
+			continue;
 		}
 		
-		// If error occurs in processing, return.
-		status = k_readHddStatus(primary);
-		if ((status & HDD_STATUS_ERROR) == HDD_STATUS_ERROR) {
-			k_printf("HDD error: Error has occured while writing HDD sector.\n");
-			k_unlock(&(g_hddManager.mutex));
-			return i; // return real written sector count.
-		}
+		k_lockSpin(&(queue->spinlock));
 		
-		// wait until it finishes sending data, or limit time expires
-		if ((status & HDD_STATUS_DATAREQUEST) != HDD_STATUS_DATAREQUEST) {
-			
-			// wait until it finishes sending data and interrupt occurs, or limit time expires
-			waitResult = k_waitHddInterrupt(primary);
-			
-			k_setHddInterruptFlag(primary, false);
+		// If running batch has no response for the limit time, fail it and start next batch.
+		// DMA batch raises interrupt only once, so its limit time increases by transfer size (1 ms per 32KB).
+		if (queue->batch != null) {
+			if (queue->batch->flush == true) {
+				limitTime = HDD_FLUSHWAITTIME;
+				
+			} else {
+				limitTime = HDD_WAITTIME + ((queue->dmaBatch == true) ? (queue->remainSectorCount / 64) : 0);
+			}
 			
-			// If interrupt doesn't occur, return.
-			if (waitResult == false) {
-				k_printf("HDD error: Interrupt has not occured while writing HDD sector.\n");
-				k_unlock(&(g_hddManager.mutex));
-				return false;
+			if ((k_getTickCount() - queue->issueTime) > limitTime) {
+				k_completeHddBatch((i == 0) ? true : false, HDD_REQUEST_ERROR);
+				k_startHddBatch((i == 0) ? true : false);
 			}
 		}
+		
+		k_unlockSpin(&(queue->spinlock));
 	}
-	
-	k_unlock(&(g_hddManager.mutex));
-	return i; // return real written sector count.
 }
 
 static bool k_isHddBusy(bool primary) {
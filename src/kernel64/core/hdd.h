@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "sync.h"
+#include "pci.h"
 
 // I/O port base value of Hard Disk Controller
 #define HDD_PORT_PRIMARYBASE   0x1F0 // first PATA port base value
@@ -11,6 +12,7 @@
 // I/O port index of Hard Disk Controller
 #define HDD_PORT_INDEX_DATA          0x00  // Data Register (0x1F0, 0x170): Read/Write, 2 bytes-sized, save data which is sent/received to/from hard disk.
 #define HDD_PORT_INDEX_SECTORCOUNT   0x02  // Sector Count Register (0x1F2, 0x172): Read/Write, 1 byte-sized, save sector count. (range 1~256 sectors, 0 means 256)
+                                           // In LBA48 mode, it's written twice (high 8 bits first, and then low 8 bits). (range 1~65536 sectors, 0 means 65536)
 #define HDD_PORT_INDEX_SECTORNUMBER  0x03  // Sector Number Register (0x1F3, 0x173): Read/Write, 1 byte-sized, save sector number.
 #define HDD_PORT_INDEX_CYLINDERLSB   0x04  // Cylinder LSB Register (0x1F4, 0x174): Read/Write, 1 byte-sized, save low 8 bits of cylinder number.
 #define HDD_PORT_INDEX_CYLINDERMSB   0x05  // Cylinder MSB Register (0x1F5, 0x175): Read/Write, 1 byte-sized, save high 8 bits of cylinder number.
@@ -20,9 +22,22 @@
 #define HDD_PORT_INDEX_DIGITALOUTPUT 0x206 // Digital Output Register (0x3F6, 0x376): Read/Write, 1 byte-sized, process interrupt enable and hard disk reset.
 
 // commands of Command Register (8 bits)
-#define HDD_COMMAND_READ     0x20 // read sectors: The required registers to read sectors are Sector Count Register, Sector Number Register, Cylinder LSB/MSB Register, and Drive/Head Register.
-#define HDD_COMMAND_WRITE    0x30 // write sectors: The required registers to write sectors are Sector Count Register, Sector Number Register, Cylinder LSB/MSB Register, and Drive/Head Register.
-#define HDD_COMMAND_IDENTIFY 0xEC // recognize drive (read hard disk info): The required registers to recognize drive are Drive/Head Register.
+#define HDD_COMMAND_READ             0x20 // read sectors: The required registers to read sectors are Sector Count Register, Sector Number Register, Cylinder LSB/MSB Register, and Drive/Head Register.
+#define HDD_COMMAND_READEXT          0x24 // read sectors ext: The required registers are the same as read sectors, but LBA address (48 bits) and sector count (16 bits) are written twice.
+#define HDD_COMMAND_READDMAEXT       0x25 // read DMA ext: LBA48 version of read DMA
+#define HDD_COMMAND_READMULTIPLEEXT  0x29 // read multiple ext: LBA48 version of read multiple
+#define HDD_COMMAND_WRITE            0x30 // write sectors: The required registers to write sectors are Sector Count Register, Sector Number Register, Cylinder LSB/MSB Register, and Drive/Head Register.
+#define HDD_COMMAND_WRITEEXT         0x34 // write sectors ext: LBA48 version of write sectors
+#define HDD_COMMAND_WRITEDMAEXT      0x35 // write DMA ext: LBA48 version of write DMA
+#define HDD_COMMAND_WRITEMULTIPLEEXT 0x39 // write multiple ext: LBA48 version of write multiple
+#define HDD_COMMAND_READMULTIPLE     0xC4 // read multiple: The required registers are the same as read sectors, and interrupt occurs once per block (multiple sectors).
+#define HDD_COMMAND_WRITEMULTIPLE    0xC5 // write multiple: The required registers are the same as write sectors, and interrupt occurs once per block (multiple sectors).
+#define HDD_COMMAND_SETMULTIPLEMODE  0xC6 // set multiple mode: The required registers are Sector Count Register (sector count per block) and Drive/Head Register.
+#define HDD_COMMAND_READDMA          0xC8 // read DMA: The required registers are the same as read sectors, and data is transferred by bus master IDE controller.
+#define HDD_COMMAND_WRITEDMA         0xCA // write DMA: The required registers are the same as write sectors, and data is transferred by bus master IDE controller.
+#define HDD_COMMAND_FLUSHCACHE       0xE7 // flush cache: write all data in write cache of hard disk to media. The required registers are Drive/Head Register.
+#define HDD_COMMAND_FLUSHCACHEEXT    0xEA // flush cache ext: LBA48 version of flush cache
+#define HDD_COMMAND_IDENTIFY         0xEC // recognize drive (read hard disk info): The required registers to recognize drive are Drive/Head Register.
 
 // fields of Status Register (8 bits)
 #define HDD_STATUS_ERROR         0x01 // ERR(bit 0): Error, mean that error has occurred in previous command.
@@ -34,6 +49,32 @@
 #define HDD_STATUS_READY         0x40 // DRDY(bit 6): Device Ready, mean that hard disk is ready to receive a command.
 #define HDD_STATUS_BUSY          0x80 // BSY(bit 7): Busy, mean that hard disk is executing a command.
 
+// I/O port index of Bus Master IDE Controller (base address is BAR4 of PCI IDE controller)
+#define HDD_BM_PORT_INDEX_COMMAND   0x00 // Bus Master Command Register: Read/Write, 1 byte-sized, start/stop bus master and set transfer direction.
+#define HDD_BM_PORT_INDEX_STATUS    0x02 // Bus Master Status Register: Read/Write-Clear, 1 byte-sized, save status of bus master.
+#define HDD_BM_PORT_INDEX_PRDT      0x04 // PRD Table Address Register: Read/Write, 4 bytes-sized, save physical address of PRD table. (aligned with 4 bytes)
+#define HDD_BM_PORT_INDEX_SECONDARY 0x08 // offset of second PATA port registers from first PATA port registers
+
+// fields of Bus Master Command Register (8 bits)
+#define HDD_BM_COMMAND_START 0x01 // Start/Stop Bus Master (bit 0): 1 starts bus master transfer, 0 stops it.
+#define HDD_BM_COMMAND_READ  0x08 // Read/Write Control (bit 3): 1 means bus master writes to memory (read sectors), 0 means bus master reads from memory (write sectors).
+
+// fields of Bus Master Status Register (8 bits)
+#define HDD_BM_STATUS_ACTIVE    0x01 // Bus Master IDE Active (bit 0): transfer is in progress.
+#define HDD_BM_STATUS_ERROR     0x02 // Error (bit 1): error has occurred in transfer, cleared by writing 1.
+#define HDD_BM_STATUS_INTERRUPT 0x04 // Interrupt (bit 2): hard disk has raised interrupt, cleared by writing 1.
+
+// fields of PRD (Physical Region Descriptor)
+#define HDD_PRD_ENDOFTABLE   0x8000  // EOT (bit 15 of flags): the last PRD of PRD table
+#define HDD_PRD_MAXBYTECOUNT 0x10000 // max byte count of a PRD (64KB, saved as 0): memory region of a PRD must not cross 64KB boundary.
+#define HDD_MAXPRDCOUNT      1024    // max PRD count of PRD table (8KB-sized PRD table covers 65536 sectors, and doesn't cross 64KB boundary if it's aligned with its size.)
+
+// fields of hard disk info
+#define HDD_CAPABILITIES_DMA           0x0100 // capabilities: DMA supported (bit 8)
+#define HDD_COMMANDSET_LBA48           0x0400 // command set supported: 48-bit address feature set supported (bit 10)
+#define HDD_COMMANDSET_FLUSHCACHE      0x1000 // command set supported: flush cache command supported (bit 12)
+#define HDD_MULTIPLESECTOR_COUNTMASK   0x00FF // max multiple sectors, multiple sector setting: sector count per block (bit 0~7)
+
 /**
   fields of Drive/Head Register (8 bits)
   - LBA mode (bit 6)=0: CHS mode: save sector count to Sector Count Register, sector number to Sector Number Register, cylinder number to Cylinder LSB/MSB Register, and head number to head number field of Drive/Head Register.
@@ -48,8 +89,30 @@
 // waiting time for responses from hard disk (millisecond).
 #define HDD_WAITTIME 500
 
-// max sector count to read/write from/to hard disk at once.
-#define HDD_MAXBULKSECTORCOUNT 256
+// waiting time for response of flush cache command from hard disk (millisecond): writing all data in write cache to media might take long.
+#define HDD_FLUSHWAITTIME 30000
+
+// max sector count to read/write from/to hard disk at once: [LBA28 commands: 256 sectors], [LBA48 commands: 65536 sectors]
+#define HDD_MAXBULKSECTORCOUNT      256
+#define HDD_MAXBULKSECTORCOUNTLBA48 65536
+
+// max LBA address count of LBA28 commands (2^28)
+#define HDD_MAXLBA28 0x10000000
+
+// max polling count of Status Register in interrupt context (can't sleep while holding spinlock).
+#define HDD_MAXPOLLCOUNT 100000
+
+// request queue-related macros
+#define HDD_MAXREQUESTCOUNT    64    // max request count of request queue (request pool size per PATA port)
+#define HDD_REQUESTDEADLINE    100   // deadline of pending request (millisecond): older request is served first in order to prevent starvation.
+#define HDD_WAITGROUPIDBASE    0x100 // wait group ID base of requests: It's in the system range of KID (count=0), so it never conflicts with allocated KID.
+
+// request status
+#define HDD_REQUEST_FREE    0 // free request
+#define HDD_REQUEST_PENDING 1 // request is waiting in request queue.
+#define HDD_REQUEST_RUNNING 2 // request is being processed by hard disk.
+#define HDD_REQUEST_DONE    3 // request has been completed successfully.
+#define HDD_REQUEST_ERROR   4 // request has failed.
 
 #pragma pack(push, 1)
 
@@ -81,29 +144,128 @@ typedef struct k_HddInfo {
 	
 	// model number
 	word modelNumber[20];
-	word reserved2[13];
+	word maxMultipleSectors;
+	word reserved2;
+	
+	// capabilities (bit 8: DMA supported)
+	word capabilities;
+	word reserved3[9];
+	word multipleSectorSetting;
 	
 	// total sector count (used in LBA mode)
 	dword totalSectors;
-	word reserved3[196];
+	word reserved4[21];
+	
+	// command set supported (bit 10: LBA48 supported)
+	word commandSetSupported;
+	word reserved5[16];
+	
+	// total sector count (used in LBA48 mode)
+	qword totalSectorsLba48;
+	word reserved6[152];
 } HddInfo;
 
+typedef struct k_HddPrd {
+	dword addr;      // physical address of memory region (aligned with 2 bytes)
+	word byteCount;  // byte count of memory region (0 means 64KB)
+	word flags;      // flags (bit 15: EOT)
+} HddPrd;
+
+typedef struct k_HddRequest {
+	struct k_HddRequest* next; // next request: link of sorted pending list or running batch
+	bool master;               // master/slave flag
+	bool write;                // write flag: [true:write sectors], [false:read sectors]
+	bool flush;                // flush flag: flush write cache of hard disk (no sector is transferred.)
+	qword lba;                 // start LBA address (48 bits)
+	int sectorCount;           // requested sector count (1 ~ 256 sectors, or 1 ~ 65536 sectors in LBA48 mode)
+	char* buffer;              // data buffer
+	volatile byte status;      // request status
+	volatile int doneCount;    // real read/written sector count (1 if flush request has been completed successfully)
+	volatile bool waiting;     // waiting flag: It indicates whether a task is waiting for the request.
+	qword submitTime;          // tick count when request has been submitted (used for deadline)
+	qword waitGroupId;         // wait group ID for task waiting for the request
+} HddRequest;
+
+/**
+  < Request Queue >
+  - Tasks submit requests to request queue and sleep, and HDD interrupt handler completes them.
+  - Pending requests are sorted by LBA, and served in ascending order of LBA from head position (C-LOOK elevator).
+  - But, if the oldest pending request is older than deadline, it's served first.
+  - Contiguous pending requests which have the same direction are merged into a command (batch) up to max bulk sector count (256 or 65536 sectors).
+  - Flush requests are served before pending requests one by one, and flush all writes which have been completed before.
+    So, the caller must wait for its write requests before submitting flush request (barrier).
+*/
+typedef struct k_HddRequestQueue {
+	Spinlock spinlock;                          // spinlock: shared by tasks and interrupt handler.
+	HddRequest requestPool[HDD_MAXREQUESTCOUNT]; // request pool
+	int usedCount;                              // used request count
+	HddRequest* pendingHead;                    // pending request list sorted ascendingly by LBA
+	HddRequest* flushHead;                      // pending flush request list in submitted order
+	HddRequest* flushTail;                      // tail of pending flush request list
+	HddRequest* batch;                          // running batch: merged requests linked by next (null if hard disk is idle)
+	HddRequest* currentRequest;                 // current request in running batch
+	int sectorIndexInRequest;                   // transferred sector index in current request
+	int remainSectorCount;                      // remaining sector count of running batch
+	int blockSectorCount;                       // sector count per interrupt (block) of running batch
+	qword headLba;                              // head position: LBA address after the last transfer
+	qword issueTime;                            // tick count when running batch has been issued (used for timeout)
+	bool dmaBatch;                              // DMA flag: running batch is transferred by bus master.
+	HddPrd* prdTable;                           // PRD table of bus master IDE controller (allocated at initialization)
+} HddRequestQueue;
+
 typedef struct k_HddManager {
 	bool hddDetected;                         // hard disk detected flag
 	bool writable;                            // writable flag: can write to hard disk only on QEMU
 	volatile bool primaryInterruptOccurred;   // first interrupt flag
 	volatile bool secondaryInterruptOccurred; // second interrupt flag
-	Mutex mutex;                              // mutex: synchronization object
+	Mutex mutex;                              // mutex: synchronization object (used for drive recognition)
 	HddInfo hddInfo;                          // hard disk info.
+	HddRequestQueue requestQueues[2];         // request queues: [0:first PATA port], [1:second PATA port]
+	word busMasterBase;                       // I/O port base of bus master IDE controller (0 if not found)
+	bool dmaSupported;                        // DMA supported flag: bus master IDE controller exists and hard disk supports DMA.
+	volatile bool dmaEnabled;                 // DMA enabled flag: If it's false, PIO is used.
+	bool lba48Supported;                      // LBA48 supported flag: If it's true, LBA48 commands are used for large transfer or high LBA address.
+	bool flushSupported;                      // flush cache supported flag: If it's false, write cache isn't flushed.
+	int maxSectorCount;                       // max sector count per command (256 or 65536)
+	int multipleSectorCount;                  // sector count per block of read/write multiple commands (1 means read/write sectors commands are used.)
+	qword totalSectorCount;                   // total sector count of hard disk (LBA28 or LBA48)
 } HddManager;
 
 #pragma pack(pop)
 
 bool k_initHdd(void);
 bool k_readHddInfo(bool primary, bool master, HddInfo* hddInfo);
-int k_readHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
-int k_writeHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
+int k_readHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+int k_writeHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
 void k_setHddInterruptFlag(bool primary, bool flag);
+HddRequest* k_submitHddRequest(bool primary, bool master, bool write, qword lba, int sectorCount, char* buffer);
+int k_waitHddRequest(bool primary, HddRequest* request);
+bool k_isHddRequestDone(bool primary, const HddRequest* request);
+bool k_flushHddCache(bool primary, bool master);
+void k_processHddInterrupt(bool primary);
+void k_checkHddRequestTimeout(void);
+bool k_setHddDmaMode(bool enable);
+void k_getHddTransferMode(bool* dmaSupported, bool* dmaEnabled, bool* lba48Supported, int* multipleSectorCount);
+qword k_getHddTotalSectorCount(const HddInfo* hddInfo);
+int k_getHddMaxSectorCount(void);
+static void k_initHddBusMaster(void);
+static void k_initHddTransferMode(void);
+static bool k_setHddMultipleMode(bool primary, bool master, int sectorCount);
+static void k_transferHddBlock(bool primary);
+static word k_getHddBusMasterPort(bool primary, word index);
+static bool k_buildHddPrdTable(bool primary);
+static void k_stopHddBusMaster(bool primary);
+static int k_transferHddSectorWithBounce(bool primary, bool master, bool write, qword lba, int sectorCount, char* buffer);
+static int k_getHddDriveMaxSectorCount(bool primary, bool master); // get max sector count per command of drive.
+static bool k_isHddRangeValid(bool primary, bool master, qword lba, int sectorCount);
+static void k_initHddRequestQueue(HddRequestQueue* queue, qword waitGroupIdBase);
+static HddRequest* k_allocHddRequest(HddRequestQueue* queue);
+static void k_startHddBatch(bool primary);
+static void k_completeHddBatch(bool primary, byte status);
+static bool k_pollHddStatus(bool primary, byte mask, byte value);
+static void k_transferHddSector(bool primary);
+static bool k_issueHddCommand(bool primary, bool master, bool write, qword lba, int sectorCount);
+static bool k_issueHddFlushCommand(bool primary, bool master);
 static void k_swapByteInWord(word* data, int wordCount);
 static byte k_readHddStatus(bool primary);
 static bool k_isHddBusy(bool primary);  // [NOTE] implemented by hs.kwon.
@@ -12,6 +12,7 @@
 #include "multiprocessor.h"
 #include "io_apic.h"
 #include "mouse.h"
+#include "virtual_mem.h"
 
 static InterruptManager g_interruptManager = {0, };
 
@@ -115,10 +116,17 @@ void k_commonExceptionHandler(int vector, qword errorCode) {
 	}
 }
 
+void k_pageFaultHandler(int vector, qword errorCode) {
+	// If the page is in user space of current address space, map it by demand paging, and re-execute the faulted instruction.
+	if (k_handlePageFault(k_readCr2(), errorCode) == true) {
+		return;
+	}
+	
+	k_commonExceptionHandler(vector, errorCode);
+}
+
 void k_deviceNotAvailableHandler(int vector) {
-	Task* fpuTask;       // last FPU-used task
-	Task* currentTask;   // current task
-	qword lastFpuTaskId; // last FPU-used task ID
+	Task* currentTask; // current task
 	byte currentApicId;
 	
 	#if __DEBUG__
@@ -143,33 +151,22 @@ void k_deviceNotAvailableHandler(int vector) {
 	// set CR0.TS=0
 	k_clearTs();
 	
-	lastFpuTaskId = k_getLastFpuUsedTaskId(currentApicId);
 	currentTask = k_getRunningTask(currentApicId);
 	
-	// If last FPU-used task is current task, it's not required to save and restore FPU context, and use current FPU context as is.
-	if (lastFpuTaskId == currentTask->link.id) {
+	// If FPU registers of current core still hold FPU context of current task, use it as is.
+	if (k_isFpuOwner(currentApicId, currentTask) == true) {
 		return;
-		
-	// If last FPU-used task exists, save current FPU context to memory.
-	} else if (lastFpuTaskId != TASK_INVALIDID) {
-		fpuTask = k_getTaskFromPool(GETTASKOFFSET(lastFpuTaskId));
-		if ((fpuTask != null) && (fpuTask->link.id == lastFpuTaskId)) {
-			k_saveFpuContext(fpuTask->fpuContext);
-		}
 	}
 	
-	// If current task has never used FPU, initialize FPU.
-	if (currentTask->fpuUsed == false) {
-		k_initFpu();
-		currentTask->fpuUsed = true;
-		
-	// If current task has used FPU, restore FPU context of current task from memory.
-	} else {
-		k_loadFpuContext(currentTask->fpuContext);
-	}
+	// restore FPU context of current task from memory. (initial FPU context if current task has never used FPU)
+	// [NOTE] FPU context of last FPU-used task is not required to be saved here,
+	//        because it has already been saved to memory when it was switched out (k_switchFpuContext).
+	k_loadTaskFpuContext(currentTask);
 	
 	// set last FPU-used task to current task.
 	k_setLastFpuUsedTaskId(currentApicId, currentTask->link.id);
+	currentTask->fpuApicId = currentApicId;
+	currentTask->fpuUseCount++;
 }
 
 void k_commonInterruptHandler(int vector) {
@@ -232,6 +229,9 @@ void k_timerHandler(int vector) {
 	
 	if (currentApicId == APICID_BSP) {
 		g_tickCount++;
+		
+		// check timeout of HDD requests.
+		k_checkHddRequestTimeout();
 	}
 	
 	k_decreaseProcessorTime(currentApicId);
@@ -360,14 +360,13 @@ void k_hddHandler(int vector) {
 	irq = vector - PIC_IRQSTARTVECTOR;
 	
 	// process interrupt vector of first PATA port (IRQ 14).
+	// set interrupt flag, and process request queue (complete requests and start next requests).
 	if (irq == IRQ_HDD1) {
-		// set interrupt flag of first PATA port to true.
-		k_setHddInterruptFlag(true, true);
+		k_processHddInterrupt(true);
 		
 	// process interrupt vector of second PATA port (IRQ 15).
 	} else {
-		// set interrupt flag of second PATA port to true.
-		k_setHddInterruptFlag(false, true);
+		k_processHddInterrupt(false);
 	}
 	
 	k_sendEoi(irq);
@@ -376,3 +375,11 @@ void k_hddHandler(int vector) {
 	
 	k_processLoadBalancing(irq);
 }
+
+void k_tlbShootdownHandler(int vector) {
+	// flush TLB requested by another core.
+	k_processTlbShootdown();
+	
+	// IPI is delivered by local APIC, so send EOI to local APIC regardless of interrupt mode.
+	k_sendEoiToLocalApic();
+}
@@ -59,6 +59,7 @@ void k_processLoadBalancing(int irq);
 /* Exception Handlers */
 void k_commonExceptionHandler(int vector, qword errorCode);
 void k_deviceNotAvailableHandler(int vector);
+void k_pageFaultHandler(int vector, qword errorCode);
 
 /* Interrupt Handlers */
 void k_commonInterruptHandler(int vector);
@@ -66,5 +67,6 @@ void k_timerHandler(int vector);
 void k_keyboardHandler(int vector);
 void k_mouseHandler(int vector);
 void k_hddHandler(int vector);
+void k_tlbShootdownHandler(int vector);
 
 #endif // __CORE_INTERRUPTHANDLERS_H__
@@ -2,9 +2,9 @@
 
 SECTION .text
 
-; handlers (7)
+; handlers (8)
 extern k_commonExceptionHandler, k_deviceNotAvailableHandler, k_commonInterruptHandler, k_timerHandler, k_keyboardHandler
-extern k_mouseHandler, k_hddHandler
+extern k_mouseHandler, k_hddHandler, k_pageFaultHandler, k_tlbShootdownHandler
 
 ; Exception Handling ISR (21)
 global k_isrDivideError, k_isrDebug, k_isrNmi, k_isrBreakPoint, k_isrOverflow
@@ -13,11 +13,11 @@ global k_isrInvalidTss, k_isrSegmentNotPresent, k_isrStackSegmentFault, k_isrGen
 global k_isr15, k_isrFpuError, k_isrAlignmentCheck, k_isrMachineCheck, k_isrSimdError
 global k_isrEtcException
 
-; Interrupt Handling ISR (17)
+; Interrupt Handling ISR (18)
 global k_isrTimer, k_isrKeyboard, k_isrSlavePic, k_isrSerialPort2, k_isrSerialPort1
 global k_isrParallelPort2, k_isrFloppyDisk, k_isrParallelPort1, k_isrRtc, k_isrReserved
 global k_isrNotUsed1, k_isrNotUsed2, k_isrMouse, k_isrCoprocessor, k_isrHdd1
-global k_isrHdd2, k_isrEtcInterrupt
+global k_isrHdd2, k_isrTlbShootdown, k_isrEtcInterrupt
 
 ; Order to Save/Restore Conxtet in hOS (use IST stack)
 ; 1. saved/restored by processor (6): SS, RSP, RFLAGS, CS, RIP, error code (optional)
@@ -244,7 +244,7 @@ k_isrPageFault:
 	
 	mov rdi, 14                   ; set vector number to first parameter.
 	mov rsi, qword [rbp + 8]      ; set error code to second parameter.
-	call k_commonExceptionHandler ; call C handler function.
+	call k_pageFaultHandler       ; call C handler function.
 	
 	KLOADCONTEXT                  ; restore context.
 	add rsp, 8                    ; remove error code from stack.
@@ -313,7 +313,7 @@ k_isrEtcException:
 	iretq                         ; restore context saved by processor, and return to the code where had be running.
 
 ;====================================================================================================
-; Interrupt Handling ISR (17): #32 ~ #47, #48 ~ #99
+; Interrupt Handling ISR (18): #32 ~ #47, #48, #49 ~ #99
 ;====================================================================================================
 ; #32 : Timer ISR
 k_isrTimer:
@@ -475,11 +475,21 @@ k_isrHdd2:
 	KLOADCONTEXT                  ; restore context.
 	iretq                         ; restore context saved by processor, and return to the code where had be running.
 
-; #48~#99 : ETC Interrupt ISR
-k_isrEtcInterrupt:
+; #48 : TLB Shootdown IPI ISR
+k_isrTlbShootdown:
 	KSAVECONTEXT                  ; save context and switch segment selectors.
 	
 	mov rdi, 48                   ; set vector number to first parameter.
+	call k_tlbShootdownHandler    ; call C handler function.
+	
+	KLOADCONTEXT                  ; restore context.
+	iretq                         ; restore context saved by processor, and return to the code where had be running.
+
+; #49~#99 : ETC Interrupt ISR
+k_isrEtcInterrupt:
+	KSAVECONTEXT                  ; save context and switch segment selectors.
+	
+	mov rdi, 49                   ; set vector number to first parameter.
 	call k_commonInterruptHandler ; call C handler function.
 	
 	KLOADCONTEXT                  ; restore context.
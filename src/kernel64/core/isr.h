@@ -24,7 +24,7 @@ void k_isrMachineCheck(void);
 void k_isrSimdError(void);
 void k_isrEtcException(void);
 
-/* Interrupt Handling ISR (17) */
+/* Interrupt Handling ISR (18) */
 void k_isrTimer(void);
 void k_isrKeyboard(void);
 void k_isrSlavePic(void);
@@ -41,6 +41,7 @@ void k_isrMouse(void);
 void k_isrCoprocessor(void);
 void k_isrHdd1(void);
 void k_isrHdd2(void);
+void k_isrTlbShootdown(void);
 void k_isrEtcInterrupt(void);
 
 #endif // __CORE_ISR_H__
@@ -1,5 +1,6 @@
 #include "local_apic.h"
 #include "mp_config_table.h"
+#include "asm_util.h"
 
 qword k_getLocalApicBaseAddr(void) {
 	MpConfigTableHeader* mpHeader;
@@ -65,3 +66,23 @@ void k_initLocalVectorTable(void) {
 	*(dword*)(localApicBaseAddr + LAPIC_REGISTER_ERROR) |= LAPIC_INTERRUPT_MASK;
 }
 
+void k_sendIpiToLocalApic(byte apicId, byte vector) {
+	qword localApicBaseAddr;
+	
+	localApicBaseAddr = k_getLocalApicBaseAddr();
+	
+	// wait until the previous IPI is sent.
+	while (*(dword*)(localApicBaseAddr + LAPIC_REGISTER_ICRLOWER) & LAPIC_DELIVERYSTATUS_PENDING) {
+		k_pause();
+	}
+	
+	// set destination (bit 63~56) to Upper Interrupt Command Register, and then set the rest to Lower Interrupt Command Register, which sends IPI.
+	*(dword*)(localApicBaseAddr + LAPIC_REGISTER_ICRUPPER) = (dword)apicId << 24;
+	*(dword*)(localApicBaseAddr + LAPIC_REGISTER_ICRLOWER) = LAPIC_DESTINATIONSHORTHAND_NOSHORTHAND |
+	                                                         LAPIC_TRIGGERMODE_EDGE |
+	                                                         LAPIC_LEVEL_ASSERT |
+	                                                         LAPIC_DESTINATIONMODE_PHYSICAL |
+	                                                         LAPIC_DELIVERYMODE_FIXED |
+	                                                         vector;
+}
+
@@ -24,6 +24,7 @@
 
 // Interrupt Command Register (64 bits) - interrupt vector (bit 7~0)
 #define LAPIC_VECTOR_KERNEL32STARTADDRESS 0x10 // 0x10=0x10000/4KB : start address of kernel32
+#define LAPIC_VECTOR_TLBSHOOTDOWN         0x30 // 48 : TLB shootdown IPI between cores
 
 // Interrupt Command Register (64 bits) - delivery mode (bit 10~8)
 #define LAPIC_DELIVERYMODE_FIXED          0x000000 // 000 : fixed: use interrupt vector
@@ -74,5 +75,6 @@ void k_enableSoftwareLocalApic(void);
 void k_sendEoiToLocalApic(void);
 void k_setInterruptPriority(byte priority);
 void k_initLocalVectorTable(void);
+void k_sendIpiToLocalApic(byte apicId, byte vector); // send fixed IPI to a core (interrupt must be disabled).
 
 #endif // __CORE_LOCALAPIC_H__
@@ -6,6 +6,7 @@
 #include "console.h"
 #include "shell.h"
 #include "task.h"
+#include "acpi.h"
 #include "pit.h"
 #include "../utils/util.h"
 #include "dynamic_mem.h"
@@ -23,11 +24,15 @@
 #include "window_manager.h"
 #include "syscall.h"
 #include "../utils/kid.h"
+#include "boot_profile.h"
+#include "virtual_mem.h"
 
 static void k_mainForAp(void);
 static bool k_switchToMultiprocessorMode(void);
 
 void k_main(void) {
+	bool apStarted;
+	
 	// compare BSP flag.
 	if (BSPFLAG == BSPFLAG_AP) {
 		k_mainForAp();
@@ -37,18 +42,20 @@ void k_main(void) {
 	BSPFLAG = BSPFLAG_AP;
 	
 	// initialize console.
-	k_initConsole(0, 12);
+	k_initConsole(0, 13);
 	
-	// print the first message of kernel64 at line 12.
+	// print the first message of kernel64 at line 13.
 	k_printf("- switch to IA-32e mode......................pass\n");
 	k_printf("- start IA-32e mode C kernel.................pass\n");
 	k_printf("- initialize console.........................pass\n");
+	k_addBootPhase("switch to kernel64");
 	
 	// initialize GDT/TSS and load GDT.
 	k_printf("- initialize GDT/TSS and load GDT............");
 	k_initGdtAndTss();
 	k_loadGdt(GDTR_STARTADDRESS);
 	k_printf("pass\n");
+	k_addBootPhase("initialize GDT/TSS");
 	
 	// load TSS.
 	k_printf("- load TSS...................................");
@@ -60,27 +67,71 @@ void k_main(void) {
 	k_initIdt();
 	k_loadIdt(IDTR_STARTADDRESS);
 	k_printf("pass\n");
+	k_addBootPhase("initialize IDT");
 	
 	// check total RAM size.
 	k_printf("- check total RAM size.......................");
 	k_checkTotalRamSize();
 	k_printf("pass, %d MB\n", k_getTotalRamSize());
+	k_addBootPhase("check total RAM size");
+	
+	// analyze ACPI tables (MADT, SRAT, SLIT) for NUMA topology.
+	// [NOTE] It must be done before initializing dynamic memory, because frame memory is divided by NUMA node.
+	k_printf("- analyze ACPI tables........................");
+	if (k_analyzeAcpiTables() == true) {
+		k_printf("pass, %d NUMA node(s)\n", k_getNodeCount());
+		
+	} else {
+		k_printf("fail\n");
+	}
+	k_addBootPhase("analyze ACPI tables");
 	
 	// initialize scheduler.
 	k_printf("- initialize scheduler.......................");
 	k_initScheduler();
 	k_printf("pass\n");
+	k_addBootPhase("initialize scheduler");
+	
+	// initialize FPU context save mode (XSAVEOPT/XSAVE/FXSAVE).
+	k_printf("- initialize FPU save mode...................");
+	k_initFpuSaveMode();
+	k_printf("pass\n");
 	
 	// initialize dynamic memory.
 	k_printf("- initialize dynamic memory..................");
 	k_initDynamicMem();
 	k_printf("pass\n");
+	k_addBootPhase("initialize dynamic memory");
+
+	// initialize virtual memory (user address spaces).
+	k_printf("- initialize virtual memory..................");
+	k_initVirtualMem();
+	k_printf("pass\n");
 	
 	// initialize PIT.
 	// Timer interrupt occurs once per 1 millisecond periodically.
 	k_printf("- initialize PIT (once per 1 ms).............");
 	k_initPit(MSTOCOUNT(1), true);
 	k_printf("pass\n");
+	k_addBootPhase("initialize PIT");
+	
+	// create idle task.
+	// [NOTE] Idle task must be created before starting APs, because k_startupAp has a problem on Mac QEMU if it's not created yet.
+	//        So, it's created here (Interrupt is still disabled, so it doesn't run until PIC is initialized.)
+	k_createTask(TASK_PRIORITY_LOWEST | TASK_FLAGS_SYSTEM | TASK_FLAGS_THREAD | TASK_FLAGS_IDLE, null, 0, (qword)k_idleTask, 0, k_getApicId());
+	
+	// start application processors.
+	// APs initialize themselves in parallel with the following device initialization of BSP.
+	k_printf("- start application processors..............");
+	apStarted = k_startupAp();
+	if (apStarted == true) {
+		k_printf("pass\n");
+		
+	} else {
+		k_printf("fail\n");
+	}
+	
+	k_addBootPhase("start application processors");
 	
 	// initialize keyboard.
 	k_printf("- initialize keyboard........................");
@@ -93,6 +144,8 @@ void k_main(void) {
 		while (true);
 	}
 	
+	k_addBootPhase("initialize keyboard");
+	
 	// initialize mouse.
 	k_printf("- initialize mouse...........................");
 	if (k_initMouse() == true) {
@@ -103,6 +156,8 @@ void k_main(void) {
 		k_printf("fail\n");
 		while (true);	
 	}
+	
+	k_addBootPhase("initialize mouse");
 
 	// initialize PIC and enable interrupt.
 	k_printf("- initialize PIC and enable interrupt........");
@@ -110,6 +165,7 @@ void k_main(void) {
 	k_maskPicInterrupt(0);
 	k_enableInterrupt();
 	k_printf("pass\n");
+	k_addBootPhase("initialize PIC");
 	
 	// initialize file system.
 	k_printf("- initialize file system.....................");
@@ -122,24 +178,24 @@ void k_main(void) {
 		// because it could fail when hard disk has never been formatted.
 	}
 	
+	k_addBootPhase("initialize HDD and file system");
+	
 	// initialize serial port.
 	k_printf("- initialize serial port.....................");
 	k_initSerialPort();
 	k_printf("pass\n");
+	k_addBootPhase("initialize serial port");
 	
-	// create idle task.
-	k_createTask(TASK_PRIORITY_LOWEST | TASK_FLAGS_SYSTEM | TASK_FLAGS_THREAD | TASK_FLAGS_IDLE, null, 0, (qword)k_idleTask, 0, k_getApicId());
-	
-	// [NOTE] Calling k_switchToMultiprocessorMode before k_createTask is the original order.
-	//        But, it changed the order because k_startupAp has a problem in the original order on Mac QEMU.
 	// switch to multiprocessor or multi-core processor mode.
 	k_printf("- switch to multiprocessor mode..............");
-	if (k_switchToMultiprocessorMode() == true) {
+	if ((apStarted == true) && (k_switchToMultiprocessorMode() == true)) {
 		k_printf("pass\n");
 
 	} else {
 		k_printf("fail\n");
 	}
+	
+	k_addBootPhase("switch to multiprocessor mode");
 
 	// initialize system call.
 	k_printf("- initialize system call.....................");
@@ -148,9 +204,11 @@ void k_main(void) {
 
 	// initialize KID manager.
 	k_initKidManager();
+	k_addBootPhase("initialize system call");
 	
 	// If it's text mode, run shell task.
 	if (k_isGraphicMode() == false) {
+		k_addBootPhase("start shell");
 		k_shellTask();
 	
 	// If it's graphic mode, run window manager task.
@@ -174,6 +232,9 @@ static void k_mainForAp(void) {
 	// initialize scheduler.
 	k_initScheduler();
 	
+	// initialize FPU context save mode.
+	k_initFpuSaveMode();
+	
 	/* support symmetric IO mode. */
 	k_enableSoftwareLocalApic();
 	k_setInterruptPriority(0);
@@ -183,6 +244,9 @@ static void k_mainForAp(void) {
 	// initialize system call.
 	k_initSyscall();
 	
+	// notify BSP that this AP is ready.
+	k_setApReady();
+	
 	//k_printf("AP (%d) has been activated.\n", k_getApicId());
 	
 	// run idle task.
@@ -194,8 +258,9 @@ static bool k_switchToMultiprocessorMode(void) {
 	bool interruptFlag;
 	int i;
 
-	/* start application processors */
-	if (k_startupAp() == false) {
+	/* wait for application processors */
+	// APs have been started by k_startupAp in k_main, so wait until they finish their initialization.
+	if (k_waitForAp() == false) {
 		return false;
 	}
 
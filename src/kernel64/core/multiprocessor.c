@@ -7,9 +7,19 @@
 
 volatile int g_awakeApCount = 0; // awake AP count
 volatile qword g_apicIdAddr = 0; // Local APIC ID Register address
+static volatile bool g_apReadyFlags[MAXPROCESSORCOUNT] = {false, }; // AP ready flags: Each AP sets only its own flag, so it doesn't need lock.
+static bool g_apStarted = false; // AP started flag: APs are started only once.
 
+// [NOTE] k_startupAp only broadcasts INIT-SIPI and returns without waiting for APs,
+//        in order that APs initialize themselves (GDT, TSS, IDT, scheduler, local APIC, system call) in parallel with BSP.
+//        So, call k_waitForAp before using APs.
 bool k_startupAp(void) {
 	
+	// If APs have been already started (by k_main), do not broadcast INIT-SIPI again, because it resets running APs.
+	if (g_apStarted == true) {
+		return true;
+	}
+	
 	// analyze MP configuration table.
 	if (k_analyzeMpConfigTable() == false) {
 		return false;
@@ -26,6 +36,8 @@ bool k_startupAp(void) {
 		return false;
 	}
 	
+	g_apStarted = true;
+	
 	return true;
 }
 
@@ -114,10 +126,41 @@ static bool k_wakeupAp(void) {
 	
 	k_setInterruptFlag(interruptFlag);
 	
-	// wait until all APs are awaked.
-	while (g_awakeApCount < (mpManager->processorCount - 1)) {
-		k_sleep(50);
+	return true;
+}
+
+bool k_waitForAp(void) {
+	MpConfigManager* mpManager;
+	qword startTickCount;
+	
+	mpManager = k_getMpConfigManager();
+	startTickCount = k_getTickCount();
+	
+	// wait until all APs are ready.
+	while (k_getReadyApCount() < (mpManager->processorCount - 1)) {
+		if (k_getTickCount() - startTickCount > MP_APWAITTIMEOUT) {
+			return false;
+		}
+		
+		k_sleep(1);
 	}
 	
 	return true;
 }
+
+void k_setApReady(void) {
+	g_apReadyFlags[k_getApicId()] = true;
+}
+
+int k_getReadyApCount(void) {
+	int count = 0;
+	int i;
+	
+	for (i = 0; i < MAXPROCESSORCOUNT; i++) {
+		if (g_apReadyFlags[i] == true) {
+			count++;
+		}
+	}
+	
+	return count;
+}
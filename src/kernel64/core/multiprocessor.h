@@ -16,7 +16,13 @@
 #define APICID_BROADCAST 0xFF // broadcast
 #define APICID_INVALID   0xFF // invalid APIC ID
 
-bool k_startupAp(void);
+// AP wait timeout
+#define MP_APWAITTIMEOUT 1000 // 1000 ms
+
+bool k_startupAp(void); // broadcast INIT-SIPI to APs without waiting.
+bool k_waitForAp(void); // wait until all APs finish their initialization.
+void k_setApReady(void); // called by AP at the end of its initialization.
+int k_getReadyApCount(void);
 byte k_getApicId(void); // get Local APIC ID of current core. [REF] in hOS, Local APIC ID == core index == scheduler index
 static bool k_wakeupAp(void);
 
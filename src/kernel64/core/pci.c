@@ -0,0 +1,81 @@
+#include "pci.h"
+#include "asm_util.h"
+
+dword k_readPciConfig(byte bus, byte device, byte function, byte offset) {
+	dword addr;
+	
+	// set enable bit, bus/device/function number, register offset (aligned with 4 bytes) to Configuration Address Register.
+	addr = PCI_CONFIGADDRESS_ENABLE | ((dword)bus << 16) | ((dword)device << 11) | ((dword)function << 8) | (offset & 0xFC);
+	k_outPortDword(PCI_PORT_CONFIGADDRESS, addr);
+	
+	// read 4 bytes from Configuration Data Register, and shift it as many as the offset in 4 bytes.
+	return k_inPortDword(PCI_PORT_CONFIGDATA) >> ((offset & 0x03) * 8);
+}
+
+void k_writePciConfig(byte bus, byte device, byte function, byte offset, dword data) {
+	dword addr;
+	
+	// [NOTE] offset must be aligned with 4 bytes, because 4 bytes are written at once.
+	addr = PCI_CONFIGADDRESS_ENABLE | ((dword)bus << 16) | ((dword)device << 11) | ((dword)function << 8) | (offset & 0xFC);
+	k_outPortDword(PCI_PORT_CONFIGADDRESS, addr);
+	k_outPortDword(PCI_PORT_CONFIGDATA, data);
+}
+
+static bool k_readPciDevice(byte bus, byte device, byte function, PciDevice* pciDevice) {
+	dword data;
+	
+	// If vendor ID is invalid, device doesn't exist.
+	data = k_readPciConfig(bus, device, function, PCI_CONFIG_VENDORID);
+	if ((data & 0xFFFF) == PCI_VENDORID_INVALID) {
+		return false;
+	}
+	
+	pciDevice->bus = bus;
+	pciDevice->device = device;
+	pciDevice->function = function;
+	pciDevice->vendorId = data & 0xFFFF;
+	pciDevice->deviceId = (data >> 16) & 0xFFFF;
+	
+	// read programming interface, subclass code, class code at once. (offset 0x09 ~ 0x0B)
+	data = k_readPciConfig(bus, device, function, PCI_CONFIG_PROGIF);
+	pciDevice->progIf = data & 0xFF;
+	pciDevice->subclass = (data >> 8) & 0xFF;
+	pciDevice->classCode = (data >> 16) & 0xFF;
+	
+	return true;
+}
+
+bool k_findPciDevice(byte classCode, byte subclass, PciDevice* pciDevice) {
+	int bus, device, function;
+	int functionCount;
+	
+	// search all buses and devices using brute force.
+	for (bus = 0; bus < PCI_MAXBUSCOUNT; bus++) {
+		for (device = 0; device < PCI_MAXDEVICECOUNT; device++) {
+			// If function 0 doesn't exist, device doesn't exist.
+			if (k_readPciDevice(bus, device, 0, pciDevice) == false) {
+				continue;
+			}
+			
+			// If it's multi-function device, search all functions.
+			if ((k_readPciConfig(bus, device, 0, PCI_CONFIG_HEADERTYPE) & PCI_HEADERTYPE_MULTIFUNCTION) == PCI_HEADERTYPE_MULTIFUNCTION) {
+				functionCount = PCI_MAXFUNCTIONCOUNT;
+				
+			} else {
+				functionCount = 1;
+			}
+			
+			for (function = 0; function < functionCount; function++) {
+				if (k_readPciDevice(bus, device, function, pciDevice) == false) {
+					continue;
+				}
+				
+				if ((pciDevice->classCode == classCode) && (pciDevice->subclass == subclass)) {
+					return true;
+				}
+			}
+		}
+	}
+	
+	return false;
+}
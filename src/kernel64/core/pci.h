@@ -0,0 +1,69 @@
+#ifndef __CORE_PCI_H__
+#define __CORE_PCI_H__
+
+#include "types.h"
+
+// I/O port of PCI configuration space (configuration mechanism #1)
+#define PCI_PORT_CONFIGADDRESS 0xCF8 // Configuration Address Register: Write, 4 bytes-sized, save enable bit, bus/device/function number, and register offset.
+#define PCI_PORT_CONFIGDATA    0xCFC // Configuration Data Register: Read/Write, 4 bytes-sized, save data of the register selected by Configuration Address Register.
+
+// fields of Configuration Address Register (32 bits)
+#define PCI_CONFIGADDRESS_ENABLE 0x80000000 // enable bit (bit 31)=1
+
+// max count of bus, device, function
+#define PCI_MAXBUSCOUNT      256
+#define PCI_MAXDEVICECOUNT   32
+#define PCI_MAXFUNCTIONCOUNT 8
+
+// register offset of PCI configuration space header
+#define PCI_CONFIG_VENDORID   0x00 // Vendor ID (2 bytes): 0xFFFF means that device doesn't exist.
+#define PCI_CONFIG_DEVICEID   0x02 // Device ID (2 bytes)
+#define PCI_CONFIG_COMMAND    0x04 // Command Register (2 bytes)
+#define PCI_CONFIG_STATUS     0x06 // Status Register (2 bytes)
+#define PCI_CONFIG_PROGIF     0x09 // Programming Interface (1 byte)
+#define PCI_CONFIG_SUBCLASS   0x0A // Subclass Code (1 byte)
+#define PCI_CONFIG_CLASS      0x0B // Class Code (1 byte)
+#define PCI_CONFIG_HEADERTYPE 0x0E // Header Type (1 byte)
+#define PCI_CONFIG_BAR0       0x10 // Base Address Register 0 (4 bytes)
+#define PCI_CONFIG_BAR4       0x20 // Base Address Register 4 (4 bytes)
+
+// fields of Command Register (16 bits)
+#define PCI_COMMAND_IOSPACE   0x0001 // I/O Space (bit 0): enable response to I/O space access.
+#define PCI_COMMAND_MEMSPACE  0x0002 // Memory Space (bit 1): enable response to memory space access.
+#define PCI_COMMAND_BUSMASTER 0x0004 // Bus Master (bit 2): enable device to act as bus master (DMA).
+
+// fields of Header Type (8 bits)
+#define PCI_HEADERTYPE_MULTIFUNCTION 0x80 // Multi-Function (bit 7): device has multiple functions.
+
+// fields of Base Address Register (32 bits)
+#define PCI_BAR_IOSPACE    0x00000001 // bit 0=1: I/O space BAR
+#define PCI_BAR_IOADDRMASK 0xFFFFFFFC // I/O base address mask (bit 2~31)
+
+// class code, subclass code
+#define PCI_CLASS_MASSSTORAGE 0x01 // mass storage controller
+#define PCI_SUBCLASS_IDE      0x01 // IDE controller
+
+// vendor ID
+#define PCI_VENDORID_INVALID 0xFFFF // device doesn't exist.
+
+#pragma pack(push, 1)
+
+typedef struct k_PciDevice {
+	byte bus;       // bus number
+	byte device;    // device number
+	byte function;  // function number
+	word vendorId;  // vendor ID
+	word deviceId;  // device ID
+	byte classCode; // class code
+	byte subclass;  // subclass code
+	byte progIf;    // programming interface
+} PciDevice;
+
+#pragma pack(pop)
+
+dword k_readPciConfig(byte bus, byte device, byte function, byte offset);
+void k_writePciConfig(byte bus, byte device, byte function, byte offset, dword data);
+bool k_findPciDevice(byte classCode, byte subclass, PciDevice* pciDevice);
+static bool k_readPciDevice(byte bus, byte device, byte function, PciDevice* pciDevice);
+
+#endif // __CORE_PCI_H__
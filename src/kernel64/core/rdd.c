@@ -4,16 +4,28 @@
 
 static RddManager g_rddManager;
 
+// zero buffer: It's handed out as a read-only pointer for the pages not allocated yet.
+static byte g_rddZeroBuffer[RDD_ZEROBUFFERSIZE];
+
 bool k_initRdd(dword totalSectorCount) {
 	
 	k_memset(&g_rddManager, 0, sizeof(g_rddManager));
 	
-	// allocate memory for RAM disk (8 MB).
-	g_rddManager.buffer = (byte*)k_allocMem(totalSectorCount * 512);
-	if (g_rddManager.buffer == null) {
+	// aligned with page-level (rounding down).
+	totalSectorCount = (totalSectorCount / RDD_SECTORSPERPAGE) * RDD_SECTORSPERPAGE;
+	if (totalSectorCount == 0) {
 		return false;
 	}
 	
+	// allocate memory for page table. (memory of pages is allocated on demand.)
+	g_rddManager.pageCount = totalSectorCount / RDD_SECTORSPERPAGE;
+	g_rddManager.pageTable = (byte**)k_allocMem(g_rddManager.pageCount * sizeof(byte*));
+	if (g_rddManager.pageTable == null) {
+		return false;
+	}
+	
+	k_memset(g_rddManager.pageTable, 0, g_rddManager.pageCount * sizeof(byte*));
+	
 	// initialize total sector count, mutex.
 	g_rddManager.totalSectorCount = totalSectorCount;
 	k_initMutex(&(g_rddManager.mutex));
@@ -21,44 +33,142 @@ bool k_initRdd(dword totalSectorCount) {
 	return true;
 }
 
+dword k_calcRddTotalSectorCount(void) {
+	qword totalSize;
+	qword usedSize;
+	qword sectorCount;
+	
+	// RAM disk size = free frame memory size / 2 (at least 8 MB)
+	k_getFrameMemInfo(null, &totalSize, &usedSize, null);
+	sectorCount = ((totalSize - usedSize) / RDD_FREEMEMRATIO) / 512;
+	sectorCount = MAX(sectorCount, RDD_MINTOTALSECTORCOUNT);
+	
+	// [NOTE] LBA address is 32 bits.
+	return (dword)MIN(sectorCount, 0xFFFFFFFF - RDD_SECTORSPERPAGE);
+}
+
 bool k_readRddInfo(bool primary, bool master, HddInfo* hddInfo) {
 	
 	k_memset(hddInfo, 0, sizeof(HddInfo));
 	
 	// set total sector count, model number, serial number.
 	hddInfo->totalSectors = g_rddManager.totalSectorCount;
-	k_memcpy(hddInfo->modelNumber, "hos-ram-disk-v1.0", 17);
+	k_memcpy(hddInfo->modelNumber, "hos-ram-disk-v2.0", 17);
 	k_memcpy(hddInfo->serialNumber, "0000-0000", 9);
 	
 	return true;
 }
 
-int k_readRddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
+static byte* k_getRddPage(dword pageIndex, bool alloc) {
+	byte* page;
+	
+	page = g_rddManager.pageTable[pageIndex];
+	if ((page != null) || (alloc == false)) {
+		return page;
+	}
+	
+	k_lock(&(g_rddManager.mutex));
+	
+	// allocate page on demand, and initialize it as 0.
+	// [NOTE] check again in lock, because other task might have allocated it.
+	page = g_rddManager.pageTable[pageIndex];
+	if (page == null) {
+		page = (byte*)k_allocMem(RDD_PAGESIZE);
+		if (page != null) {
+			k_memset(page, 0, RDD_PAGESIZE);
+			g_rddManager.pageTable[pageIndex] = page;
+			g_rddManager.allocatedPageCount++;
+		}
+	}
+	
+	k_unlock(&(g_rddManager.mutex));
+	
+	return page;
+}
+
+int k_readRddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
 	int realReadCount; // real read sector count
+	int copyCount;     // sector count copying in a page
+	int i;
+	byte* page;
+	
+	if (lba >= g_rddManager.totalSectorCount) {
+		return 0;
+	}
 	
 	// read read sector count = MIN(remaining sector count of RAM disk, requested sector count)
-	// [NOTE] modified by hs.kwon
-	//realReadCount = MIN(g_rddManager->totalSectorCount - (dwLBA + sectorCount), sectorCount);
 	realReadCount = MIN(g_rddManager.totalSectorCount - lba, sectorCount);
 	
-	// read sector: copy data from RAM disk to buffer.
-	k_memcpy(buffer, g_rddManager.buffer + (lba * 512), realReadCount * 512);
+	// read sector: copy data from each page of RAM disk to buffer. (the page not allocated yet is read as 0.)
+	for (i = 0; i < realReadCount; i += copyCount) {
+		copyCount = MIN(RDD_SECTORSPERPAGE - ((lba + i) % RDD_SECTORSPERPAGE), realReadCount - i);
+		page = k_getRddPage((lba + i) / RDD_SECTORSPERPAGE, false);
+		
+		if (page == null) {
+			k_memset(buffer + (i * 512), 0, copyCount * 512);
+			
+		} else {
+			k_memcpy(buffer + (i * 512), page + (((lba + i) % RDD_SECTORSPERPAGE) * 512), copyCount * 512);
+		}
+	}
 	
 	// return real read sector count.
 	return realReadCount;
 }
 
-int k_writeRddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
+int k_writeRddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
 	int realWriteCount; // real written sector count
+	int copyCount;      // sector count copying in a page
+	int i;
+	byte* page;
+	
+	if (lba >= g_rddManager.totalSectorCount) {
+		return 0;
+	}
 	
 	// real written sector count = MIN(remaining sector count of RAM disk, requested sector count)
-	// [NOTE] modified by hs.kwon
-	//realWriteCount = MIN(g_rddManager.totalSectorCount - (dwLBA + sectorCount), sectorCount);
 	realWriteCount = MIN(g_rddManager.totalSectorCount - lba, sectorCount);
 	
-	// write sector: copy data from buffer to RAM disk.
-	k_memcpy(g_rddManager.buffer + (lba * 512), buffer, realWriteCount * 512);
+	// write sector: copy data from buffer to each page of RAM disk. (the page not allocated yet is allocated.)
+	for (i = 0; i < realWriteCount; i += copyCount) {
+		copyCount = MIN(RDD_SECTORSPERPAGE - ((lba + i) % RDD_SECTORSPERPAGE), realWriteCount - i);
+		page = k_getRddPage((lba + i) / RDD_SECTORSPERPAGE, true);
+		
+		// If memory is insufficient, return written sector count so far.
+		if (page == null) {
+			return i;
+		}
+		
+		k_memcpy(page + (((lba + i) % RDD_SECTORSPERPAGE) * 512), buffer + (i * 512), copyCount * 512);
+	}
 	
 	// return real written sector count.
 	return realWriteCount;
 }
+
+byte* k_getRddSectorPointer(qword lba, int sectorCount, bool write) {
+	byte* page;
+	
+	// sectors must be in a page.
+	if ((sectorCount <= 0) || (lba >= g_rddManager.totalSectorCount) || (((lba % RDD_SECTORSPERPAGE) + sectorCount) > RDD_SECTORSPERPAGE)) {
+		return null;
+	}
+	
+	page = k_getRddPage(lba / RDD_SECTORSPERPAGE, write);
+	
+	// If page hasn't been allocated yet for reading, return zero buffer. (It must not be written.)
+	if (page == null) {
+		if ((write == false) && ((sectorCount * 512) <= RDD_ZEROBUFFERSIZE)) {
+			return g_rddZeroBuffer;
+		}
+		
+		return null;
+	}
+	
+	return page + ((lba % RDD_SECTORSPERPAGE) * 512);
+}
+
+void k_getRddMemInfo(qword* totalSize, qword* allocatedSize) {
+	*totalSize = (qword)g_rddManager.totalSectorCount * 512;
+	*allocatedSize = (qword)g_rddManager.allocatedPageCount * RDD_PAGESIZE;
+}
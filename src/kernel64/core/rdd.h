@@ -4,22 +4,42 @@
 #include "types.h"
 #include "sync.h"
 #include "hdd.h"
+#include "frame_mem.h"
 
-#define RDD_TOTALSECTORCOUNT (8 * 1024 * 1024 / 512) // total sector count of RAM disk (8 MB)
+// RAM disk-related macros
+#define RDD_PAGESIZE             FMEM_HUGEFRAMESIZE          // page size of RAM disk (2MB): a huge frame is allocated when page is written first.
+#define RDD_SECTORSPERPAGE       (RDD_PAGESIZE / 512)        // sector count per page (4096)
+#define RDD_MINTOTALSECTORCOUNT  (8 * 1024 * 1024 / 512)     // min total sector count of RAM disk (8 MB)
+#define RDD_FREEMEMRATIO         2                           // RAM disk size = free frame memory size / 2
+#define RDD_ZEROBUFFERSIZE       4096                        // size of zero buffer which is handed out for the pages not allocated yet
+
+/**
+  < Page-backed RAM Disk >
+  - RAM disk size is set by free frame memory at booting, but memory isn't allocated at that time.
+  - RAM disk consists of pages (2MB), and a huge frame of each page is allocated on demand when it's written first.
+  - The pages not allocated yet are read as 0.
+  - Page is aligned with cluster (4KB), so file system can access a cluster by a pointer to page without copying.
+*/
 
 #pragma pack(push, 1)
 
 typedef struct k_RddManager {
-	byte* buffer;           // memory buffer for RAM disk
-	dword totalSectorCount; // total sector count
-	Mutex mutex;            // mutex
+	byte** pageTable;         // page table: memory address of each page (null if page hasn't been allocated yet)
+	dword pageCount;          // total page count
+	dword allocatedPageCount; // allocated page count
+	dword totalSectorCount;   // total sector count
+	Mutex mutex;              // mutex (used for page allocation)
 } RddManager;
 
 #pragma pack(pop)
 
 bool k_initRdd(dword totalSectorCount);
+dword k_calcRddTotalSectorCount(void);
 bool k_readRddInfo(bool primary, bool master, HddInfo* hddInfo);
-int k_readRddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
-int k_writeRddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
+int k_readRddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+int k_writeRddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+byte* k_getRddSectorPointer(qword lba, int sectorCount, bool write);
+void k_getRddMemInfo(qword* totalSize, qword* allocatedSize);
+static byte* k_getRddPage(dword pageIndex, bool alloc);
 
-#endif // __CORE_RDD_H__
\ No newline at end of file
+#endif // __CORE_RDD_H__
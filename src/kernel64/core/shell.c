@@ -12,6 +12,7 @@
 #include "file_system.h"
 #include "serial_port.h"
 #include "mp_config_table.h"
+#include "acpi.h"
 #include "multiprocessor.h"
 #include "pic.h"
 #include "local_apic.h"
@@ -24,6 +25,8 @@
 #include "syscall.h"
 #include "app_manager.h"
 #include "../utils/queue.h"
+#include "boot_profile.h"
+#include "frame_mem.h"
 
 static ShellCommandEntry g_commandTable[] = {
 		{"help", "show help", k_help},
@@ -44,19 +47,23 @@ static ShellCommandEntry g_commandTable[] = {
 		{"format", "format HDD", k_format},
 		{"mount", "mount HDD", k_mount},
 		{"fs", "show file system info", k_showFileSystemInfo},
-		{"ls", "show directory", k_showRootDir},
-		{"ll", "show directory", k_showRootDir},
-		{"create", "create file, usage) create <file>", k_createFileInRootDir},
-		{"delete", "delete file, usage) delete <file>", k_deleteFileInRootDir},
+		{"ls", "show directory, usage) ls <dir>", k_showDir},
+		{"ll", "show directory, usage) ll <dir>", k_showDir},
+		{"create", "create file, usage) create <file>", k_createFileInDir},
+		{"delete", "delete file, usage) delete <file>", k_deleteFileInDir},
+		{"mkdir", "make directory, usage) mkdir <dir>", k_makeDirectory},
+		{"rmdir", "remove empty directory, usage) rmdir <dir>", k_removeDirectory},
 		{"write", "write file, usage) write <file>", k_writeDataToFile},
 		{"read", "read file, usage) read <file>", k_readDataFromFile},
 		{"flush", "flush file system cache", k_flushCache},
 		{"download", "download file using serial port, usage) download <file>", k_downloadFile},
 		{"mpconf", "show MP configuration table info", k_showMpConfigTable},
+		{"acpi", "show ACPI table info (MADT, SRAT, SLIT)", k_showAcpiTables},
 		{"irqmap", "show IRQ to INTIN Map", k_showIrqToIntinMap},
 		{"intcnt", "show interrupt count by core * IRQ, usage) intcnt <irq>", k_showInterruptCounts},
 		{"chaf" ,"change task affinity, usage) chaf <taskId> <affinity>", k_changeAffinity},
 		{"vbe", "show VBE mode info", k_showVbeModeInfo},
+		{"bootprof", "show boot profile, usage) bootprof <option>", k_showBootProfile},
 		{"run", "run application (.elf), usage) run <app> <arg1> <arg2> ...", k_runApp},
 		{"install", "install application (.elf), usage) install <app>", k_install},
 		{"uninstall", "uninstall application (.elf), usage) uninstall <app>", k_uninstall},
@@ -74,7 +81,7 @@ static ShellCommandEntry g_commandTable[] = {
 		{"writes", "write HDD sector, usage) writes <lba> <count>", k_writeSector},
 		{"reads", "read HDD sector, usage) reads <lba> <count>", k_readSector},
 		{"testfile", "test file IO", k_testFileIo},
-		{"testperf", "test file IO performance", k_testPerformance},
+		{"testperf", "test file IO or HDD transfer performance, usage) testperf <option>", k_testPerformance},
 		{"stap", "start application processor", k_startAp},
 		{"stsim", "start symmetric IO mode", k_startSymmetricIoMode},
 		{"stilb", "start interrupt load balancing", k_startInterruptLoadBalancing},
@@ -733,10 +740,15 @@ static void k_showDynamicMemInfo(const char* paramBuffer) {
 	qword startAddr, totalSize, metaSize, usedSize;
 	qword endAddredss;
 	qword totalRamSize;
+	qword frameStartAddr, frameTotalSize, frameUsedSize;
+	dword freeHugeCount;
+	qword nodeTotalSize, nodeUsedSize;
+	int i;
 	
 	k_getDynamicMemInfo(&startAddr, &totalSize, &metaSize, &usedSize);
 	endAddredss = startAddr + totalSize;
 	totalRamSize = k_getTotalRamSize();
+	k_getFrameMemInfo(&frameStartAddr, &frameTotalSize, &frameUsedSize, &freeHugeCount);
 	
 	k_printf("*** Dynamic Memory Info ***\n");
 	k_printf("- start address  : 0x%q bytes (%d MB)\n", startAddr, startAddr / 1024 / 1024);
@@ -745,11 +757,25 @@ static void k_showDynamicMemInfo(const char* paramBuffer) {
 	k_printf("- meta size      : 0x%q bytes (%d KB)\n", metaSize, metaSize / 1024);
 	k_printf("- used size      : 0x%q bytes (%d KB)\n", usedSize, usedSize / 1024);
 	k_printf("- total RAM size : 0x%q bytes (%d MB)\n", totalRamSize * 1024 * 1024, totalRamSize);
+	
+	k_printf("*** Frame Memory Info ***\n");
+	k_printf("- start address  : 0x%q bytes (%d MB)\n", frameStartAddr, frameStartAddr / 1024 / 1024);
+	k_printf("- total size     : 0x%q bytes (%d MB)\n", frameTotalSize, frameTotalSize / 1024 / 1024);
+	k_printf("- used size      : 0x%q bytes (%d KB)\n", frameUsedSize, frameUsedSize / 1024);
+	k_printf("- free 2MB frames: %d\n", freeHugeCount);
+	
+	// print frame memory by NUMA node.
+	for (i = 0; k_getFrameNodeInfo(i, &nodeTotalSize, &nodeUsedSize) == true; i++) {
+		k_printf("- node %d         : %d MB total, %d KB used\n", i, nodeTotalSize / 1024 / 1024, nodeUsedSize / 1024);
+	}
 }
 
 static void k_showHddInfo(const char* paramBuffer) {
 	HddInfo hddInfo;
 	char buffer[100];
+	bool dmaSupported, dmaEnabled;
+	bool lba48Supported;
+	int multipleSectorCount;
 	
 	// read hard disk info.
 	if (k_getHddInfo(&hddInfo) == false) {
@@ -775,7 +801,13 @@ static void k_showHddInfo(const char* paramBuffer) {
 	k_printf("- sector count   : %d\n", hddInfo.numberOfSectorPerCylinder);
 	
 	// print total sector count.
-	k_printf("- total sectors  : %d sectors (%d MB)\n", hddInfo.totalSectors, hddInfo.totalSectors / 2 / 1024);
+	k_printf("- total sectors  : 0x%q sectors (%d MB)\n", k_getHddTotalSectorCount(&hddInfo), (int)(k_getHddTotalSectorCount(&hddInfo) / 2 / 1024));
+	
+	// print transfer mode.
+	k_getHddTransferMode(&dmaSupported, &dmaEnabled, &lba48Supported, &multipleSectorCount);
+	k_printf("- transfer mode  : %s (DMA %s)\n", (dmaEnabled == true) ? "DMA" : "PIO", (dmaSupported == true) ? "supported" : "not supported");
+	k_printf("- address mode   : %s (max %d sectors per command)\n", (lba48Supported == true) ? "LBA48" : "LBA28", k_getHddMaxSectorCount());
+	k_printf("- PIO block size : %d sectors per interrupt (%s)\n", multipleSectorCount, (multipleSectorCount > 1) ? "read/write multiple" : "read/write sectors");
 }
 
 static void k_format(const char* paramBuffer) {
@@ -798,6 +830,7 @@ static void k_mount(const char* paramBuffer) {
 
 static void k_showFileSystemInfo(const char* paramBuffer) {
 	FileSystemManager manager;
+	FragmentationInfo info;
 	
 	k_getFileSystemInfo(&manager);
 	
@@ -810,34 +843,63 @@ static void k_showFileSystemInfo(const char* paramBuffer) {
 	k_printf("- data area start address          : %d sectors\n",  manager.dataAreaStartAddr);
 	k_printf("- total cluster count              : %d clusters\n", manager.totalClusterCount);
 	k_printf("- cache enable                     : %s\n",         (manager.cacheEnabled == true) ? "true" : "false");
+	k_printf("- journal enable                   : %s (%d commits, %d checkpoints)\n", (manager.journal.enabled == true) ? "true" : "false",
+	         manager.journal.commitCount, manager.journal.checkpointCount);
+	
+	// print fragmentation report.
+	if (k_getFragmentationInfo(&info) == false) {
+		return;
+	}
+	
+	k_printf("*** Fragmentation Report ***\n");
+	k_printf("- file count                       : %d files (%d fragmented)\n", info.fileCount, info.fragmentedFileCount);
+	k_printf("- file extent count                : %d extents (max %d extents per file)\n", info.fileExtentCount, info.maxFileExtentCount);
+	k_printf("- average extent count per file    : %d.%d extents\n", (info.fileCount == 0) ? 0 : info.fileExtentCount / info.fileCount,
+	         (info.fileCount == 0) ? 0 : ((info.fileExtentCount % info.fileCount) * 10) / info.fileCount);
+	k_printf("- free cluster count               : %d clusters\n", info.freeClusterCount);
+	k_printf("- free extent count                : %d extents (max %d clusters)\n", info.freeExtentCount, info.maxFreeExtentSize);
 }
 
-static void k_showRootDir(const char* paramBuffer) {
+static void k_showDir(const char* paramBuffer) {
+	ParamList list;
+	char dirName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int len;
 	Dir* dir;
 	int i, count, totalCount;
 	dirent* entry;
 	char buffer[76]; // make buffer size (76 bytes) fit to a line of text video memory (screen).
 	char tempValue[50];
-	dword totalByte;
+	qword totalByte;
 	dword usedClusterCount;
 	FileSystemManager manager;
 	
+	// initialize parameter.
+	k_initParam(&list, paramBuffer);
+	
+	// get No.1 parameter: dir (optional, root directory if omitted)
+	if ((len = k_getNextParam(&list, dirName)) <= 0) {
+		k_memcpy(dirName, "/", 2);
+		
+	} else {
+		dirName[len] = '\0';
+	}
+	
 	// get file system info.
 	k_getFileSystemInfo(&manager);
 	
-	// open root directory. (ignore directory name(/), because only root directory exists.)
-	dir = opendir("/");
+	// open directory.
+	dir = opendir(dirName);
 	if (dir == null) {
-		k_printf("root directory opening failure\n");
+		k_printf("directory opening failure: %s\n", dirName);
 		return;
 	}
 	
-	// get total file count, total file size, used cluster count in root directory.
+	// get total file count, total file size, used cluster count in directory.
 	totalCount = 0;
 	totalByte = 0;
 	usedClusterCount = 0;
 	while (true) {
-		// read root directory.
+		// read directory.
 		entry = readdir(dir);
 		if (entry == null) {
 			break;
@@ -862,7 +924,7 @@ static void k_showRootDir(const char* paramBuffer) {
 	rewinddir(dir);
 	count = 0;
 	while (true) {
-		// read root directory.
+		// read directory.
 		entry = readdir(dir);
 		if (entry == null) {
 			break;
@@ -875,8 +937,14 @@ static void k_showRootDir(const char* paramBuffer) {
 		// set file name to buffer.
 		k_memcpy(buffer, entry->d_name, k_strlen(entry->d_name));
 		
-		// set file size to buffer.
-		k_sprintf(tempValue, "%d bytes", entry->fileSize);
+		// set file size (or directory mark) to buffer.
+		if (entry->d_attr == FS_ATTRIBUTE_DIRECTORY) {
+			k_sprintf(tempValue, "<DIR>");
+			
+		} else {
+			k_sprintf(tempValue, "%l bytes", entry->fileSize);
+		}
+		
 		k_memcpy(buffer + 30, tempValue, k_strlen(tempValue));
 		
 		// set start cluster index to buffer.
@@ -904,14 +972,14 @@ static void k_showRootDir(const char* paramBuffer) {
 	
 	// print total file count, total file size, free space of hard disk.
 	k_printf("\t\ttotal file count : %d\n", totalCount);
-	k_printf("\t\ttotal file size  : %d bytes (%d clusters)\n", totalByte, usedClusterCount);
-	k_printf("\t\tfree space       : %d KB (%d clusters)\n", (manager.totalClusterCount - usedClusterCount) * FS_CLUSTERSIZE / 1024, manager.totalClusterCount - usedClusterCount);
+	k_printf("\t\ttotal file size  : %l bytes (%d clusters)\n", totalByte, usedClusterCount);
+	k_printf("\t\tfree space       : %d KB (%d clusters)\n", manager.freeClusterCount * FS_CLUSTERSIZE / 1024, manager.freeClusterCount);
 	
-	// close root directory.
+	// close directory.
 	closedir(dir);
 }
 
-static void k_createFileInRootDir(const char* paramBuffer) {
+static void k_createFileInDir(const char* paramBuffer) {
 	ParamList list;
 	char fileName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
 	int len;
@@ -923,14 +991,14 @@ static void k_createFileInRootDir(const char* paramBuffer) {
 	// get No.1 parameter: file
 	if ((len = k_getNextParam(&list, fileName)) <= 0) {
 		k_printf("Usage) create <file>\n");
-		k_printf("  - file: file name\n");
+		k_printf("  - file: file name (path)\n");
 		k_printf("  - example: create a.txt\n");
 		return;
 	}
 	
 	fileName[len] = '\0';
 	
-	if (len > (FS_MAXFILENAMELENGTH - 1)) {
+	if (len > (FS_MAXPATHLENGTH - 1)) {
 		k_printf("file creation failure: too long file name\n");
 		return;
 	}
@@ -946,7 +1014,7 @@ static void k_createFileInRootDir(const char* paramBuffer) {
 	fclose(file);
 }
 
-static void k_deleteFileInRootDir(const char* paramBuffer) {
+static void k_deleteFileInDir(const char* paramBuffer) {
 	ParamList list;
 	char fileName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
 	int len;
@@ -957,14 +1025,14 @@ static void k_deleteFileInRootDir(const char* paramBuffer) {
 	// get No.1 parameter: file
 	if ((len = k_getNextParam(&list, fileName)) <= 0) {
 		k_printf("Usage) delete <file>\n");
-		k_printf("  - file: file name\n");
+		k_printf("  - file: file name (path)\n");
 		k_printf("  - example: delete a.txt\n");
 		return;
 	}
 	
 	fileName[len] = '\0';
 	
-	if (len > (FS_MAXFILENAMELENGTH - 1)) {
+	if (len > (FS_MAXPATHLENGTH - 1)) {
 		k_printf("file deletion failure: too long file name\n");
 		return;
 	}
@@ -976,6 +1044,56 @@ static void k_deleteFileInRootDir(const char* paramBuffer) {
 	}
 }
 
+static void k_makeDirectory(const char* paramBuffer) {
+	ParamList list;
+	char dirName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int len;
+	
+	// initialize parameter.
+	k_initParam(&list, paramBuffer);
+	
+	// get No.1 parameter: dir
+	if ((len = k_getNextParam(&list, dirName)) <= 0) {
+		k_printf("Usage) mkdir <dir>\n");
+		k_printf("  - dir: directory name (path)\n");
+		k_printf("  - example: mkdir apps/games\n");
+		return;
+	}
+	
+	dirName[len] = '\0';
+	
+	// make directory.
+	if (mkdir(dirName) != 0) {
+		k_printf("directory creation failure: %s\n", dirName);
+		return;
+	}
+}
+
+static void k_removeDirectory(const char* paramBuffer) {
+	ParamList list;
+	char dirName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int len;
+	
+	// initialize parameter.
+	k_initParam(&list, paramBuffer);
+	
+	// get No.1 parameter: dir
+	if ((len = k_getNextParam(&list, dirName)) <= 0) {
+		k_printf("Usage) rmdir <dir>\n");
+		k_printf("  - dir: directory name (path)\n");
+		k_printf("  - example: rmdir apps/games\n");
+		return;
+	}
+	
+	dirName[len] = '\0';
+	
+	// remove directory (directory must be empty and not open).
+	if (rmdir(dirName) != 0) {
+		k_printf("directory deletion failure: %s (not exist, not empty or open)\n", dirName);
+		return;
+	}
+}
+
 static void k_writeDataToFile(const char* paramBuffer) {
 	ParamList list;
 	char fileName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
@@ -990,14 +1108,14 @@ static void k_writeDataToFile(const char* paramBuffer) {
 	// get No.1 parameter: file
 	if ((len = k_getNextParam(&list, fileName)) <= 0) {
 		k_printf("Usage) write <file>\n");
-		k_printf("  - file: file name\n");
+		k_printf("  - file: file name (path)\n");
 		k_printf("  - example: write a.txt\n");
 		return;
 	}
 	
 	fileName[len] = '\0';
 	
-	if (len > (FS_MAXFILENAMELENGTH - 1)) {
+	if (len > (FS_MAXPATHLENGTH - 1)) {
 		k_printf("file writing failure: too long file name\n");
 		return;
 	}
@@ -1052,14 +1170,14 @@ static void k_readDataFromFile(const char* paramBuffer) {
 	// get No.1 parameter: file
 	if ((len = k_getNextParam(&list, fileName)) <= 0) {
 		k_printf("Usage) read <file>\n");
-		k_printf("  - file:  file name\n");
+		k_printf("  - file:  file name (path)\n");
 		k_printf("  - example: read a.txt\n");
 		return;
 	}
 	
 	fileName[len] = '\0';
 	
-	if (len > (FS_MAXFILENAMELENGTH - 1)) {
+	if (len > (FS_MAXPATHLENGTH - 1)) {
 		k_printf("file reading failure: too long file name\n");
 		return;
 	}
@@ -1138,14 +1256,14 @@ static void k_downloadFile(const char* paramBuffer) {
 	// get No.1 parameter: file
 	if ((fileNameLen = k_getNextParam(&list, fileName)) <= 0) {
 		k_printf("Usage) download <file>\n");
-		k_printf("  - file: file name\n");
+		k_printf("  - file: file name (path)\n");
 		k_printf("  - example: download a.txt\n");
 		return;
 	}
 	
 	fileName[fileNameLen] = '\0';
 	
-	if (fileNameLen > (FS_MAXFILENAMELENGTH - 1)) {
+	if (fileNameLen > (FS_MAXPATHLENGTH - 1)) {
 		k_printf("file downloading failure: too long file name\n");
 		return;
 	}
@@ -1238,7 +1356,7 @@ static void k_downloadFile(const char* paramBuffer) {
 	k_printf("success\n");
 	
 	//----------------------------------------------------------------------------------------------------
-	// check if data is received successfully, and close file, and flush file system cache
+	// check if data is received successfully, and make file durable, and close file
 	//----------------------------------------------------------------------------------------------------
 	
 	// check if data is received successfully
@@ -1249,15 +1367,19 @@ static void k_downloadFile(const char* paramBuffer) {
 		k_printf("receiving complete: received size: %d bytes\n", receivedSize);
 	}
 	
-	// close file, and flush file system cache
+	// make the received file durable without flushing the whole cache, and close file.
+	fsync(file);
 	fclose(file);
-	k_flushFileSystemCache();
 }
 
 static void k_showMpConfigTable(const char* paramBuffer) {
 	k_printMpConfigTable();
 }
 
+static void k_showAcpiTables(const char* paramBuffer) {
+	k_printAcpiTables();
+}
+
 static void k_showIrqToIntinMap(const char* paramBuffer) {
 	k_printIrqToIntinMap();
 }
@@ -1480,6 +1602,32 @@ static void k_showVbeModeInfo(const char* paramBuffer) {
 	k_printf("- linear blue field position  : bit %d, mask size: %d bits\n", vbeMode->linearBlueFieldPos, vbeMode->linearBlueMaskSize);
 }
 
+static void k_showBootProfile(const char* paramBuffer) {
+	ParamList list;
+	char option[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int optionLen;
+	
+	// initialize parameter.
+	k_initParam(&list, paramBuffer);
+	
+	// get No.1 parameter: option
+	optionLen = k_getNextParam(&list, option);
+	if ((optionLen < 0) || ((optionLen != 0) && (k_equalStr(option, "-s") == false))) {
+		k_printf("Usage) bootprof <option>\n");
+		k_printf("  - option: -s (send boot profile to serial port, too)\n");
+		k_printf("  - example: bootprof\n");
+		k_printf("  - example: bootprof -s\n");
+		return;
+	}
+	
+	k_printBootProfile();
+	
+	if (optionLen != 0) {
+		k_sendBootProfileToSerial();
+		k_printf("boot profile has been sent to serial port.\n");
+	}
+}
+
 static void k_runApp(const char* paramBuffer) {
 	ParamList list;
 	char fileName[SHELL_MAXPARAMETERLENGTH] = {'\0', };
@@ -2556,7 +2704,7 @@ static void k_testFileIo(const char* paramBuffer) {
 	fail = false;
 	
 	// move to the start of file.
-	fseek(file, -maxFileSize, SEEK_CUR);
+	fseek(file, -(long)maxFileSize, SEEK_CUR);
 	
 	// loop for writing file. (write data (2MB) from the start of file).
 	for (i = 0; i < (2 * 1024 * 1024 / 1024); i++) {
@@ -2569,7 +2717,7 @@ static void k_testFileIo(const char* paramBuffer) {
 	}
 	
 	// move to the start of file.
-	fseek(file, -maxFileSize, SEEK_SET);
+	fseek(file, -(long)maxFileSize, SEEK_SET);
 	
 	// read data from file, and verify it.
 	// verify the whole area (4MB), because wrong data could have been saved by the random write.
@@ -2637,13 +2785,55 @@ static void k_testFileIo(const char* paramBuffer) {
 }
 
 static void k_testPerformance(const char* paramBuffer) {
+	ParamList list;
+	char option[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int optionLen;
 	File* file;
 	dword clusterTestFileSize;
 	dword oneByteTestFileSize;
+	char threadCountStr[SHELL_MAXPARAMETERLENGTH] = {'\0', };
+	int threadCount;
 	qword lastTickCount;
 	dword i;
 	byte* buffer;
 	
+	// initialize parameter.
+	k_initParam(&list, paramBuffer);
+	
+	// get No.1 parameter: option
+	optionLen = k_getNextParam(&list, option);
+	if (optionLen != 0) {
+		if ((optionLen < 0) || ((k_equalStr(option, "-f") == false) && (k_equalStr(option, "-d") == false) && (k_equalStr(option, "-m") == false))) {
+			k_printf("Usage) testperf <option> <threadCount>\n");
+			k_printf("  - option: -f (file IO, default)\n"); // 'testperf -f' is same as 'testperf'.
+			k_printf("  - option: -d (HDD transfer, PIO vs DMA)\n");
+			k_printf("  - option: -m (multi-threaded file IO, 1 thread vs threadCount threads)\n");
+			k_printf("  - threadCount: thread count of -m option (1~%d, default: processor count)\n", SHELL_MAXFILEIOTESTTHREADCOUNT);
+			k_printf("  - example: testperf\n");
+			k_printf("  - example: testperf -d\n");
+			k_printf("  - example: testperf -m 4\n");
+			return;
+		}
+	}
+	
+	if (k_equalStr(option, "-d") == true) {
+		k_testHddTransferPerformance();
+		return;
+	}
+	
+	if (k_equalStr(option, "-m") == true) {
+		// get No.2 parameter: threadCount (optional)
+		if (k_getNextParam(&list, threadCountStr) > 0) {
+			threadCount = k_atoi10(threadCountStr);
+			
+		} else {
+			threadCount = k_getProcessorCount();
+		}
+		
+		k_testFileIoScaling(MIN(MAX(threadCount, 1), SHELL_MAXFILEIOTESTTHREADCOUNT));
+		return;
+	}
+	
 	k_printf("*** File IO Performance Test (2 tests) ***\n");
 	
 	// set file size (cluster-level: 1MB, byte-level: 16KB)
@@ -2772,10 +2962,207 @@ static void k_testPerformance(const char* paramBuffer) {
 	k_freeMem(buffer);
 }
 
+static void k_testHddTransferPerformance(void) {
+	HddInfo hddInfo;
+	bool dmaSupported, dmaEnabled;
+	bool lba48Supported;
+	int multipleSectorCount;
+	bool dma;
+	byte* buffer;
+	dword lba;
+	dword totalSectorCount;
+	dword testSectorCount;
+	int sectorCount;
+	qword lastTickCount;
+	qword elapsedTime;
+	qword loadSum;
+	qword loadSampleCount;
+	qword throughput;
+	int coreCount;
+	int i, j;
+	
+	k_printf("*** HDD Transfer Performance Test (PIO vs DMA) ***\n");
+	
+	k_getHddTransferMode(&dmaSupported, &dmaEnabled, &lba48Supported, &multipleSectorCount);
+	if (k_readHddInfo(true, true, &hddInfo) == false) {
+		k_printf("test failure: HDD not detected\n");
+		return;
+	}
+	
+	// set test size (8 MB, or total sector count of hard disk if it's smaller).
+	totalSectorCount = MIN(k_getHddTotalSectorCount(&hddInfo), 0xFFFFFFFF);
+	testSectorCount = (8 * 1024 * 1024) / 512;
+	if (testSectorCount >= totalSectorCount) {
+		testSectorCount = totalSectorCount - HDD_MAXBULKSECTORCOUNT - 1;
+	}
+	
+	// allocate memory (max bulk sector count).
+	buffer = (byte*)k_allocMem(HDD_MAXBULKSECTORCOUNT * 512);
+	if (buffer == null) {
+		k_printf("test failure: memory allocation failure\n");
+		return;
+	}
+	
+	// flush file system cache in order to make hard disk idle.
+	k_flushFileSystemCache();
+	
+	coreCount = k_getProcessorCount();
+	
+	// test PIO first, and then DMA.
+	for (i = 0; i < 2; i++) {
+		dma = (i == 0) ? false : true;
+		if ((dma == true) && (dmaSupported == false)) {
+			k_printf("%d> DMA : not supported\n", i + 1);
+			break;
+		}
+		
+		k_setHddDmaMode(dma);
+		
+		lastTickCount = k_getTickCount();
+		loadSum = 0;
+		loadSampleCount = 0;
+		
+		// sequential read test by max bulk sector count (read-only, so data of hard disk isn't changed).
+		for (lba = 0; lba < testSectorCount; lba += sectorCount) {
+			sectorCount = MIN(testSectorCount - lba, HDD_MAXBULKSECTORCOUNT);
+			if (k_readHddSector(true, true, lba, sectorCount, (char*)buffer) != sectorCount) {
+				k_printf("test failure: HDD reading failure (LBA %d)\n", lba);
+				k_setHddDmaMode(dmaEnabled);
+				k_freeMem(buffer);
+				return;
+			}
+			
+			// sample average CPU load of all cores.
+			for (j = 0; j < coreCount; j++) {
+				loadSum += k_getProcessorLoad(j);
+			}
+			
+			loadSampleCount += coreCount;
+		}
+		
+		// print throughput (MB/s, 1 decimal place) and average CPU load.
+		elapsedTime = MAX(k_getTickCount() - lastTickCount, 1);
+		throughput = ((qword)testSectorCount * 512 / 1024) * 1000 / elapsedTime; // KB/s
+		k_printf("%d> %s : %d KB, %d ms, %d.%d MB/s, CPU load %d %%\n", i + 1, (dma == true) ? "DMA" : "PIO", testSectorCount / 2, elapsedTime,
+		         throughput / 1024, (throughput % 1024) * 10 / 1024, loadSum / loadSampleCount);
+	}
+	
+	// restore original transfer mode.
+	k_setHddDmaMode(dmaEnabled);
+	
+	k_freeMem(buffer);
+}
+
+// for file IO scaling test.
+static volatile bool g_fileIoTestResults[SHELL_MAXFILEIOTESTTHREADCOUNT];
+
+static void k_testFileIoScaling(int threadCount) {
+	Task* threads[SHELL_MAXFILEIOTESTTHREADCOUNT];
+	int testThreadCount;
+	qword lastTickCount;
+	qword elapsedTime;
+	qword baseTime = 0;
+	qword throughput;
+	int i, j;
+	
+	k_printf("*** File IO Scaling Test (1 thread vs %d threads, 1 MB write/read per thread) ***\n", threadCount);
+	
+	// test 1 thread first, and then as many threads as thread count.
+	for (i = 0; i < 2; i++) {
+		testThreadCount = (i == 0) ? 1 : threadCount;
+		
+		lastTickCount = k_getTickCount();
+		
+		// create threads. Each thread writes and reads its own file, so they don't share a file lock.
+		for (j = 0; j < testThreadCount; j++) {
+			g_fileIoTestResults[j] = false;
+			threads[j] = k_createTask(TASK_PRIORITY_LOW | TASK_FLAGS_THREAD, null, 0, (qword)k_fileIoTestThread, j, TASK_AFFINITY_LB);
+			if (threads[j] == null) {
+				k_printf("test failure: thread creation failure\n");
+				testThreadCount = j;
+				break;
+			}
+		}
+		
+		// wait until all threads end.
+		for (j = 0; j < testThreadCount; j++) {
+			while (k_existTask(threads[j]->link.id) == true) {
+				k_sleep(1);
+			}
+			
+			if (g_fileIoTestResults[j] == false) {
+				k_printf("test failure: file IO failure (thread %d)\n", j);
+			}
+		}
+		
+		// print elapsed time, total throughput (write + read) and speed-up compared with 1 thread.
+		elapsedTime = MAX(k_getTickCount() - lastTickCount, 1);
+		throughput = ((qword)testThreadCount * SHELL_FILEIOTESTFILESIZE * 2 / 1024) * 1000 / elapsedTime; // KB/s
+		if (i == 0) {
+			baseTime = elapsedTime;
+		}
+		
+		k_printf("%d> %d thread(s) : %d ms, %d.%d MB/s, speed-up %d.%d x\n", i + 1, testThreadCount, elapsedTime,
+		         throughput / 1024, (throughput % 1024) * 10 / 1024,
+		         (baseTime * testThreadCount) / elapsedTime, ((baseTime * testThreadCount * 10) / elapsedTime) % 10);
+		
+		if (threadCount == 1) {
+			break;
+		}
+	}
+}
+
+static void k_fileIoTestThread(qword threadIndex) {
+	char fileName[FS_MAXFILENAMELENGTH];
+	byte* buffer;
+	File* file;
+	dword i;
+	
+	buffer = (byte*)k_allocMem(FS_CLUSTERSIZE);
+	if (buffer == null) {
+		return;
+	}
+	
+	k_memset(buffer, (byte)threadIndex, FS_CLUSTERSIZE);
+	k_sprintf(fileName, "testperf%d.tmp", (int)threadIndex);
+	
+	// write test by cluster-level.
+	remove(fileName);
+	file = fopen(fileName, "w+");
+	if (file == null) {
+		k_freeMem(buffer);
+		return;
+	}
+	
+	for (i = 0; i < (SHELL_FILEIOTESTFILESIZE / FS_CLUSTERSIZE); i++) {
+		if (fwrite(buffer, 1, FS_CLUSTERSIZE, file) != FS_CLUSTERSIZE) {
+			break;
+		}
+	}
+	
+	// read test by cluster-level.
+	if (i == (SHELL_FILEIOTESTFILESIZE / FS_CLUSTERSIZE)) {
+		fseek(file, 0, SEEK_SET);
+		for (i = 0; i < (SHELL_FILEIOTESTFILESIZE / FS_CLUSTERSIZE); i++) {
+			if (fread(buffer, 1, FS_CLUSTERSIZE, file) != FS_CLUSTERSIZE) {
+				break;
+			}
+		}
+		
+		if (i == (SHELL_FILEIOTESTFILESIZE / FS_CLUSTERSIZE)) {
+			g_fileIoTestResults[threadIndex] = true;
+		}
+	}
+	
+	fclose(file);
+	remove(fileName);
+	k_freeMem(buffer);
+}
+
 static void k_startAp(const char* paramBuffer) {
 	k_printf("BSP (%d) wakes up APs.\n", k_getApicId());
 	
-	if (k_startupAp() == false) {
+	if ((k_startupAp() == false) || (k_waitForAp() == false)) {
 		k_printf("AP starting failure\n");
 		return;
 	}
@@ -2847,11 +3234,13 @@ static void k_testScreenUpdatePerformance(const char* paramBuffer) {
 
 	// get No.1 parameter: option
 	if (k_getNextParam(&list, option) > 0) {
-		if (k_equalStr(option, "-r") == false) {
+		if (k_equalStr(option, "-r") == false && k_equalStr(option, "-b") == false) {
 			k_printf("Usage) testsup <option>\n");
 			k_printf("  - option: -r (reset)\n");
+			k_printf("  - option: -b (full-screen blit)\n");
 			k_printf("  - example: testsup\n");
 			k_printf("  - example: testsup -r\n");
+			k_printf("  - example: testsup -b\n");
 			return;
 		}
 	}
@@ -2859,11 +3248,59 @@ static void k_testScreenUpdatePerformance(const char* paramBuffer) {
 	if (k_equalStr(option, "-r") == true) {
 		g_winMgrMinLoopCount = 0xFFFFFFFFFFFFFFFF;
 
+	} else if (k_equalStr(option, "-b") == true) {
+		k_testScreenBlitPerformance();
+
 	} else {
 		k_printf("window manager task min loop count: %d\n", g_winMgrMinLoopCount);
 	}
 }
 
+static void k_testScreenBlitPerformance(void) {
+	VbeModeInfoBlock* vbeMode;
+	Color* videoMem;
+	Color* buffer;
+	Rect screenArea;
+	qword pixelCount;
+	qword tickCount;
+	qword i;
+
+	vbeMode = k_getVbeModeInfoBlock();
+	videoMem = (Color*)(((qword)vbeMode->physicalBaseAddr) & 0xFFFFFFFF);
+	pixelCount = vbeMode->xResolution * vbeMode->yResolution;
+
+	buffer = (Color*)k_allocMem(sizeof(Color) * pixelCount);
+	if (buffer == null) {
+		k_printf("screen blit performance test failure: memory allocation failure\n");
+		return;
+	}
+
+	for (i = 0; i < pixelCount; i++) {
+		buffer[i] = RGB(i % 256, (i / 256) % 256, 128);
+	}
+
+	k_printf("video memory caching: %s\n", (k_isVideoMemWriteCombining() == true) ? "write combining" : "default (uncacheable)");
+
+	// copy full-screen buffer to video memory directly, like window manager does.
+	tickCount = k_getTickCount();
+	for (i = 0; i < SHELL_BLITTESTFRAMECOUNT; i++) {
+		k_memcpy(videoMem, buffer, sizeof(Color) * pixelCount);
+	}
+
+	// tick count is millisecond-level, so 0 ms is regarded as 1 ms.
+	tickCount = k_getTickCount() - tickCount;
+	tickCount = (tickCount == 0) ? 1 : tickCount;
+
+	k_printf("full-screen blit: %d frames in %d ms (%d frames/s, %d MB/s)\n", SHELL_BLITTESTFRAMECOUNT, tickCount,
+	         SHELL_BLITTESTFRAMECOUNT * 1000 / tickCount, (sizeof(Color) * pixelCount * SHELL_BLITTESTFRAMECOUNT * 1000 / tickCount) / (1024 * 1024));
+
+	k_freeMem(buffer);
+
+	// redraw screen overwritten by test.
+	k_getScreenArea(&screenArea);
+	k_redrawWindowByArea(WINDOW_INVALIDID, &screenArea);
+}
+
 static void k_testSyscall(const char* paramBuffer) {
 	byte* taskMem;
 
@@ -10,6 +10,13 @@
 #define SHELL_MAXPARAMETERLENGTH           30 // It's including the last null character, so the max parameter length user can input is 29.
 #define SHELL_ERROR_TOOLONGPARAMETERLENGTH -1 // too long parameter length error
 
+// file IO scaling test-related macros
+#define SHELL_MAXFILEIOTESTTHREADCOUNT 16                // max thread count of file IO scaling test
+#define SHELL_FILEIOTESTFILESIZE       (1024 * 1024)     // file size per thread of file IO scaling test (1MB)
+
+// screen blit test-related macros
+#define SHELL_BLITTESTFRAMECOUNT 100 // full-screen frame count of screen blit test
+
 typedef void (*CommandFunc)(const char* paramBuffer);
 
 #pragma pack(push, 1)
@@ -54,18 +61,22 @@ static void k_showHddInfo(const char* paramBuffer);
 static void k_format(const char* paramBuffer);
 static void k_mount(const char* paramBuffer);
 static void k_showFileSystemInfo(const char* paramBuffer);
-static void k_showRootDir(const char* paramBuffer);
-static void k_createFileInRootDir(const char* paramBuffer);
-static void k_deleteFileInRootDir(const char* paramBuffer);
+static void k_showDir(const char* paramBuffer);
+static void k_createFileInDir(const char* paramBuffer);
+static void k_deleteFileInDir(const char* paramBuffer);
+static void k_makeDirectory(const char* paramBuffer);
+static void k_removeDirectory(const char* paramBuffer);
 static void k_writeDataToFile(const char* paramBuffer);
 static void k_readDataFromFile(const char* paramBuffer);
 static void k_flushCache(const char* paramBuffer);
 static void k_downloadFile(const char* paramBuffer);
 static void k_showMpConfigTable(const char* paramBuffer);
+static void k_showAcpiTables(const char* paramBuffer);
 static void k_showIrqToIntinMap(const char* paramBuffer);
 static void k_showInterruptCounts(const char* paramBuffer);
 static void k_changeAffinity(const char* paramBuffer);
 static void k_showVbeModeInfo(const char* paramBuffer);
+static void k_showBootProfile(const char* paramBuffer);
 static void k_runApp(const char* paramBuffer);
 static void k_install(const char* paramBuffer);
 static void k_uninstall(const char* paramBuffer);
@@ -93,12 +104,16 @@ static void k_writeSector(const char* paramBuffer);
 static void k_readSector(const char* paramBuffer);
 static void k_testFileIo(const char* paramBuffer);
 static void k_testPerformance(const char* paramBuffer);
+static void k_testHddTransferPerformance(void);
+static void k_testFileIoScaling(int threadCount);
+static void k_fileIoTestThread(qword threadIndex);
 static void k_startAp(const char* paramBuffer);
 static void k_startSymmetricIoMode(const char* paramBuffer);
 static void k_startInterruptLoadBalancing(const char* paramBuffer);
 static void k_startTaskLoadBalancing(const char* paramBuffer);
 static void k_startMultiprocessorMode(const char* paramBuffer);
 static void k_testScreenUpdatePerformance(const char* paramBuffer);
+static void k_testScreenBlitPerformance(void);
 static void k_testSyscall(const char* paramBuffer);
 static void k_testWaitTask(const char* paramBuffer);
 static void k_testBlockingQueue(void);
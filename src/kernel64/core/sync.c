@@ -3,6 +3,7 @@
 #include "task.h"
 #include "asm_util.h"
 #include "multiprocessor.h"
+#include "virtual_mem.h"
 
 #if 0
 bool k_lockSystem(void) {
@@ -111,7 +112,10 @@ void k_lockSpin(Spinlock* spinlock) {
 			*/
 			
 			// loop here to prevent memory bus from being locked by repeating k_testAndSet.
+			// [NOTE] Interrupt is disabled here, so process TLB shootdown request instead of IPI handler,
+			//        in order not to deadlock with the core which holds this spinlock and waits for TLB shootdown.
 			while (spinlock->lockFlag == true) {
+				k_processTlbShootdown();
 				k_pause();
 			}
 		}
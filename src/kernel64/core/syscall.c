@@ -17,6 +17,7 @@
 #include "../utils/kid.h"
 #include "../gui_tasks/alert.h"
 #include "../gui_tasks/confirm.h"
+#include "virtual_mem.h"
 
 /**
   < SYSCALL/SYSRET Initialization Registers >
@@ -84,7 +85,12 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		return (qword)true;
 
 	/*** Syscall from task.h ***/
+	// [NOTE] Memory of process is freed by kernel after it ends, so memory in user space is rejected.
 	case SYSCALL_CREATETASK:
+		if ((PARAM(1) >= VMEM_USERSPACESTARTADDRESS) && (PARAM(1) < VMEM_USERSPACEENDADDRESS)) {
+			return TASK_INVALIDID;
+		}
+
 		task = k_createTask(PARAM(0), (void*)PARAM(1), PARAM(2), PARAM(3), PARAM(4), (byte)PARAM(5));
 		if (task == null) {
 			return TASK_INVALIDID;
@@ -152,6 +158,9 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 	case SYSCALL_CREATETHREAD:
 		return k_createThread(PARAM(0), PARAM(1), (byte)PARAM(2), PARAM(3));
 
+	case SYSCALL_CLONEPROCESS:
+		return k_cloneProcess(PARAM(0), PARAM(1), (byte)PARAM(2), PARAM(3));
+
 	/*** Syscall from sync.h ***/
 	case SYSCALL_LOCK:
 		k_lock((Mutex*)PARAM(0));
@@ -170,23 +179,23 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 
 	/*** Syscall from hdd.h ***/
 	case SYSCALL_READHDDSECTOR:
-		return (qword)k_readHddSector((bool)PARAM(0), (bool)PARAM(1), (dword)PARAM(2), (int)PARAM(3), (char*)PARAM(4));
+		return (qword)k_readHddSector((bool)PARAM(0), (bool)PARAM(1), (qword)PARAM(2), (int)PARAM(3), (char*)PARAM(4));
 
 	case SYSCALL_WRITEHDDSECTOR:
-		return (qword)k_writeHddSector((bool)PARAM(0), (bool)PARAM(1), (dword)PARAM(2), (int)PARAM(3), (char*)PARAM(4));
+		return (qword)k_writeHddSector((bool)PARAM(0), (bool)PARAM(1), (qword)PARAM(2), (int)PARAM(3), (char*)PARAM(4));
 
 	/*** Syscall from file_system.h ***/
 	case SYSCALL_FOPEN:
 		return (qword)fopen((char*)PARAM(0), (char*)PARAM(1));
 
 	case SYSCALL_FREAD:
-		return (qword)fread((void*)PARAM(0), (dword)PARAM(1), (dword)PARAM(2), (File*)PARAM(3));
+		return (qword)fread((void*)PARAM(0), (qword)PARAM(1), (qword)PARAM(2), (File*)PARAM(3));
 
 	case SYSCALL_FWRITE:
-		return (qword)fwrite((void*)PARAM(0), (dword)PARAM(1), (dword)PARAM(2), (File*)PARAM(3));
+		return (qword)fwrite((void*)PARAM(0), (qword)PARAM(1), (qword)PARAM(2), (File*)PARAM(3));
 
 	case SYSCALL_FSEEK:
-		return (qword)fseek((File*)PARAM(0), (int)PARAM(1), (int)PARAM(2));
+		return (qword)fseek((File*)PARAM(0), (long)PARAM(1), (int)PARAM(2));
 
 	case SYSCALL_FCLOSE:
 		return (qword)fclose((File*)PARAM(0));
@@ -210,6 +219,36 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 	case SYSCALL_ISFOPEN:
 		return (qword)isfopen((dirent*)PARAM(0));
 
+	case SYSCALL_STAT:
+		return (qword)stat((char*)PARAM(0), (dirent*)PARAM(1));
+
+	case SYSCALL_MKDIR:
+		return (qword)mkdir((char*)PARAM(0));
+
+	case SYSCALL_RMDIR:
+		return (qword)rmdir((char*)PARAM(0));
+
+	case SYSCALL_MAPFILE:
+		return (qword)k_mapFile((char*)PARAM(0), (dword*)PARAM(1));
+
+	case SYSCALL_UNMAPFILE:
+		return (qword)k_unmapFile((void*)PARAM(0));
+
+	case SYSCALL_FSYNC:
+		return (qword)fsync((File*)PARAM(0));
+
+	case SYSCALL_READV:
+		return (qword)readv((File*)PARAM(0), (iovec*)PARAM(1), (int)PARAM(2));
+
+	case SYSCALL_WRITEV:
+		return (qword)writev((File*)PARAM(0), (iovec*)PARAM(1), (int)PARAM(2));
+
+	case SYSCALL_PREAD:
+		return (qword)pread((File*)PARAM(0), (void*)PARAM(1), (qword)PARAM(2), (qword)PARAM(3));
+
+	case SYSCALL_PWRITE:
+		return (qword)pwrite((File*)PARAM(0), (void*)PARAM(1), (qword)PARAM(2), (qword)PARAM(3));
+
 	/*** Syscall from serial_port.h ***/
 	case SYSCALL_SENDSERIALDATA:
 		k_sendSerialData((byte*)PARAM(0), (int)PARAM(1));
@@ -238,7 +277,12 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		k_getScreenArea((Rect*)PARAM(0));
 		return (qword)true;
 
+	// [NOTE] Window manager accesses top menu of window in kernel address space, so top menu in user space is rejected.
 	case SYSCALL_CREATEWINDOW:
+		if ((PARAM(7) >= VMEM_USERSPACESTARTADDRESS) && (PARAM(7) < VMEM_USERSPACEENDADDRESS)) {
+			return WINDOW_INVALIDID;
+		}
+
 		return k_createWindow((int)PARAM(0), (int)PARAM(1), (int)PARAM(2), (int)PARAM(3), (dword)PARAM(4), (char*)PARAM(5), (Color)PARAM(6), (Menu*)PARAM(7), (void*)PARAM(8), PARAM(9));
 
 	case SYSCALL_DELETEWINDOW:
@@ -357,6 +401,9 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		k_getMouseCursorPos((int*)PARAM(0), (int*)PARAM(1));
 		return (qword)true;
 
+	case SYSCALL_DRAWDISPLAYLIST:
+		return (qword)k_drawDisplayList(PARAM(0), (DisplayList*)PARAM(1), (Rect*)PARAM(2));
+
 	/*** Syscall from jpeg.h ***/
 	case SYSCALL_INITJPEG:
 		return (qword)k_initJpeg((Jpeg*)PARAM(0), (byte*)PARAM(1), (dword)PARAM(2));
@@ -399,12 +446,12 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		k_setClock((Clock*)PARAM(0), PARAM(1), (int)PARAM(2), (int)PARAM(3), (Color)PARAM(4), (Color)PARAM(5), (byte)PARAM(6), (bool)PARAM(7));
 		return (qword)true;
 
+	// [NOTE] Clock of app is in user space, which window manager can't access, so only its kernel-owned copy is added.
 	case SYSCALL_ADDCLOCK:
-		k_addClock((Clock*)PARAM(0));
-		return (qword)true;
+		return (qword)k_addUserClock((Clock*)PARAM(0));
 
 	case SYSCALL_REMOVECLOCK:
-		return (qword)k_removeClock(PARAM(0));
+		return (qword)k_removeUserClock(PARAM(0));
 
 	/*** Syscall from kid.h ***/
 	case SYSCALL_ALLOCKID:
@@ -423,6 +470,10 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		k_confirm((ConfirmArg*)PARAM(0));
 		return (qword)true;
 
+	/*** Syscall from syscall.h ***/
+	case SYSCALL_ENTERSYSCALLRING:
+		return k_processSyscallRing((SyscallRing*)PARAM(0));
+
 	/*** Syscall - test ***/
 	case SYSCALL_TEST:
 		k_printf("syscall test...success\n");
@@ -433,3 +484,46 @@ qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable) {
 		return (qword)false;
 	}	
 }
+
+qword k_processSyscallRing(SyscallRing* ring) {
+	SyscallRingEntry* entry;
+	dword head;
+	dword tail;
+	qword processedCount = 0;
+
+	if (ring == null) {
+		return 0;
+	}
+
+	// read head and tail once, because application can change them while processing.
+	// If queued entry count is over ring size, ring is broken.
+	head = ring->head;
+	tail = ring->tail;
+	if ((dword)(tail - head) > SC_RINGMAXCOUNT) {
+		return 0;
+	}
+
+	// process queued entries in order by calling syscall handler directly,
+	// so that a batch enters and exits kernel only once.
+	// [NOTE] Only entries queued before entering kernel are processed (at most SC_RINGMAXCOUNT),
+	//        so other threads of application which keep queuing entries can't hold kernel in this loop.
+	//        Entries queued while processing are processed by the next call.
+	while (head != tail) {
+		entry = &(ring->entries[head % SC_RINGMAXCOUNT]);
+
+		// entering syscall ring recursively isn't allowed.
+		if (entry->syscallNumber == SYSCALL_ENTERSYSCALLRING) {
+			entry->result = 0;
+
+		} else {
+			entry->result = k_processSyscall(entry->syscallNumber, &(entry->paramTable));
+		}
+
+		head++;
+		ring->head = head;
+		processedCount++;
+	}
+
+	// return processed entry count.
+	return processedCount;
+}
@@ -5,6 +5,7 @@
 #include "syscall_numbers.h"
 
 #define SC_MAXPARAMCOUNT 10
+#define SC_RINGMAXCOUNT  256 // max entry count of syscall ring (power of 2)
 
 /* Macro Function */
 #define PARAM(x) (paramTable->values[(x)])
@@ -15,6 +16,25 @@ typedef struct k_ParamTable {
 	qword values[SC_MAXPARAMCOUNT];
 } ParamTable;
 
+typedef struct k_SyscallRingEntry {
+	qword syscallNumber;   // syscall number
+	ParamTable paramTable; // parameter table
+	qword result;          // result of syscall (written by kernel when the entry is processed)
+} SyscallRingEntry;
+
+/**
+  < Syscall Ring >
+  - A ring of syscall entries in application memory, shared by application and kernel (the same address space).
+  - application queues entries at tail, and enters kernel once by SYSCALL_ENTERSYSCALLRING.
+    kernel processes all entries from head to tail in order, writes results to entries, and moves head.
+  - head and tail are free-running indexes (entry index = index % SC_RINGMAXCOUNT), and queued entry count is tail - head.
+*/
+typedef struct k_SyscallRing {
+	volatile dword head;                      // head index: next entry to be processed (written by kernel)
+	volatile dword tail;                      // tail index: next entry to be queued (written by application)
+	SyscallRingEntry entries[SC_RINGMAXCOUNT]; // syscall entries
+} SyscallRing;
+
 #pragma pack(pop)
 
 /*** Functions defined in syscall_asm.asm ***/
@@ -24,5 +44,6 @@ void k_syscallTestTask(void);
 /*** Functions defined in syscall.c ***/
 void k_initSyscall(void);
 qword k_processSyscall(qword syscallNumber, const ParamTable* paramTable);
+qword k_processSyscallRing(SyscallRing* ring);
 
 #endif // __CORE_SYSCALL_H__
\ No newline at end of file
@@ -32,6 +32,7 @@
 #define SYSCALL_NOTIFYONEINJOINGROUP 316
 #define SYSCALL_NOTIFYALLINJOINGROUP 317
 #define SYSCALL_CREATETHREAD         318
+#define SYSCALL_CLONEPROCESS         319
 
 /*** Syscall from sync.h ***/
 #define SYSCALL_LOCK   400
@@ -57,6 +58,16 @@
 #define SYSCALL_REWINDDIR  708
 #define SYSCALL_CLOSEDIR   709
 #define SYSCALL_ISFOPEN    710
+#define SYSCALL_STAT       711
+#define SYSCALL_MKDIR      712
+#define SYSCALL_RMDIR      713
+#define SYSCALL_MAPFILE    714
+#define SYSCALL_UNMAPFILE  715
+#define SYSCALL_FSYNC      716
+#define SYSCALL_READV      717
+#define SYSCALL_WRITEV     718
+#define SYSCALL_PREAD      719
+#define SYSCALL_PWRITE     720
 
 /*** Syscall from serial_port.h ***/
 #define SYSCALL_SENDSERIALDATA  800
@@ -110,6 +121,7 @@
 #define SYSCALL_BITBLT                   1137
 #define SYSCALL_MOVEMOUSECURSOR          1138
 #define SYSCALL_GETMOUSECURSORPOS        1139
+#define SYSCALL_DRAWDISPLAYLIST          1140
 
 /*** Syscall from jpeg.h ***/
 #define SYSCALL_INITJPEG   1200
@@ -141,6 +153,9 @@
 #define SYSCALL_ALERT   1701
 #define SYSCALL_CONFIRM 1702
 
+/*** Syscall from syscall.h ***/
+#define SYSCALL_ENTERSYSCALLRING 1800
+
 /*** Syscall - test ***/
 #define SYSCALL_TEST 0xFFFFFFFFFFFFFFFF
 
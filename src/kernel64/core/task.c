@@ -8,29 +8,27 @@
 #include "mp_config_table.h"
 #include "window.h"
 #include "dynamic_mem.h"
+#include "acpi.h"
 #include "../utils/kid.h"
+#include "virtual_mem.h"
 
 static TaskPoolManager g_taskPoolManager;
 static Scheduler g_schedulers[MAXPROCESSORCOUNT];
 static CommonScheduler g_commonScheduler;
+static FpuManager g_fpuManager;
 
 static void k_initTaskPool(void) {
-	int i;
-	
 	// initialize task pool manager.
 	k_memset(&g_taskPoolManager, 0, sizeof(g_taskPoolManager));
 	
 	// initialize task pool.
+	// link free tasks through the low 32 bits of task ID, so allocated task count (high 32 bits) of free task ID remains 0.
 	g_taskPoolManager.startAddr = (Task*)TASK_TASKPOOLSTARTADDRESS;
 	k_memset((void*)TASK_TASKPOOLSTARTADDRESS, 0, sizeof(Task) * TASK_MAXCOUNT);
+	k_initPool(&(g_taskPoolManager.pool), g_taskPoolManager.startAddr, sizeof(Task), TASK_MAXCOUNT, offsetof(Task, link) + offsetof(ListLink, id), 
+	           g_taskPoolManager.usedIndexes, g_taskPoolManager.usedPositions);
 	
-	// set task ID (offset) to tasks in pool.
-	for(i = 0; i < TASK_MAXCOUNT; i++){
-		g_taskPoolManager.startAddr[i].link.id = i;
-	}
-	
-	// initialize max task count and allocated task count.
-	g_taskPoolManager.maxCount = TASK_MAXCOUNT;
+	// initialize allocated task count.
 	g_taskPoolManager.allocatedCount = 1;
 	
 	// initialize spinlock of task pool manager.
@@ -43,24 +41,19 @@ static Task* k_allocTask(void) {
 	
 	k_lockSpin(&(g_taskPoolManager.spinlock));
 	
-	if (g_taskPoolManager.usedCount >= g_taskPoolManager.maxCount) {
+	// pop free task from free list of task pool.
+	emptyTask = (Task*)k_allocPool(&(g_taskPoolManager.pool));
+	if (emptyTask == null) {
 		k_unlockSpin(&(g_taskPoolManager.spinlock));
 		return null;
 	}
-
-	for (i = 0; i < g_taskPoolManager.maxCount; i++) {
-		// If allocated task count (high 32 bits) of task ID == 0, it's not allocated.
-		if ((g_taskPoolManager.startAddr[i].link.id >> 32) == 0) {
-			emptyTask = &(g_taskPoolManager.startAddr[i]);
-			break;
-		}
-	}
+	
+	i = k_getPoolIndex(&(g_taskPoolManager.pool), emptyTask);
 	
 	// set not-0 to allocated task count (high 32 bits) of task ID in order to mark it allocated.
 	// task ID consists of allocated task count (high 32 bits) and task offset (low 32 bits).
 	emptyTask->link.id = (((qword)g_taskPoolManager.allocatedCount) << 32) | i;
-
-	g_taskPoolManager.usedCount++;
+	
 	g_taskPoolManager.allocatedCount++;
 	if (g_taskPoolManager.allocatedCount == 0) {
 		g_taskPoolManager.allocatedCount = 1;
@@ -83,10 +76,10 @@ static void k_freeTask(qword taskId) {
 	k_lockSpin(&(g_taskPoolManager.spinlock));
 	
 	// initialize task ID.
-	// set 0 to allocated task count (high 32 bits) of task ID in order to mark it free.
-	g_taskPoolManager.startAddr[i].link.id = i;
-	
-	g_taskPoolManager.usedCount--;
+	// set 0 to allocated task count (high 32 bits) of task ID in order to mark it free,
+	// and push task to free list of task pool (low 32 bits of task ID become the next free task offset).
+	g_taskPoolManager.startAddr[i].link.id = 0;
+	k_freePool(&(g_taskPoolManager.pool), &(g_taskPoolManager.startAddr[i]));
 	
 	k_unlockSpin(&(g_taskPoolManager.spinlock));
 }
@@ -112,9 +105,22 @@ static void k_freeTask(qword taskId) {
 */
 
 Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAddr, qword arg, byte affinity) {
+	return k_createTaskInAddressSpace(flags, null, memAddr, memSize, entryPointAddr, arg, 0, affinity);
+}
+
+/**
+  < Task in Address Space >
+  - If addressSpace is not null when creating process, the process runs in its own address space,
+    and its stack is reserved in user space (16 MB) instead of dynamic memory (64 KB), and is mapped lazily.
+  - If stackPointer is not 0, it's set to RSP/RBP instead of stack end. (Caller has already pushed data to stack.)
+  - Thread always runs in the address space of its parent process.
+*/
+Task* k_createTaskInAddressSpace(qword flags, struct k_AddressSpace* addressSpace, void* memAddr, qword memSize, qword entryPointAddr, qword arg, qword stackPointer, byte affinity) {
 	Task* task;    // task to create (task means process or thread)
 	Task* process; // process with running task in it (It means process which has created the task, or it means parent process.)
 	void* stackAddr;
+	qword stackSize;
+	bool userStack; // It indicates whether stack is in user space.
 	byte currentApicId;
 	
 	currentApicId = k_getApicId();
@@ -125,11 +131,19 @@ Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAd
 		return null;
 	}
 	
-	// allocate stack.
-	stackAddr = k_allocMem(TASK_STACKSIZE);
-	if (stackAddr == null) {
-		k_freeTask(task->link.id);
-		return null;
+	// allocate stack: Stack of process with address space is reserved in user space.
+	userStack = ((addressSpace != null) && ((flags & TASK_FLAGS_THREAD) == 0));
+	if (userStack == true) {
+		stackAddr = (void*)VMEM_USERSTACKSTARTADDRESS;
+		stackSize = VMEM_USERSTACKSIZE;
+		
+	} else {
+		stackAddr = k_allocMem(TASK_STACKSIZE);
+		stackSize = TASK_STACKSIZE;
+		if (stackAddr == null) {
+			k_freeTask(task->link.id);
+			return null;
+		}
 	}
 
 	k_lockSpin(&(g_schedulers[currentApicId].spinlock));
@@ -137,7 +151,10 @@ Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAd
 	// get process with running task in it.
 	process = k_getProcessByThread(k_getRunningTask(currentApicId));
 	if (process == null) {
-		k_freeMem(stackAddr);
+		if (userStack == false) {
+			k_freeMem(stackAddr);
+		}
+		
 		k_freeTask(task->link.id);
 		k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		return null;
@@ -151,6 +168,8 @@ Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAd
 		task->parentProcessId = process->link.id;
 		task->memAddr = process->memAddr;
 		task->memSize = process->memSize;
+		task->addressSpace = process->addressSpace;
+		task->memNode = process->memNode;
 		
 		// add the created thread to [parent process.child thread list].
 		k_addListToTail(&(process->childThreadList), &(task->threadLink));
@@ -162,6 +181,8 @@ Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAd
 		task->parentProcessId = process->link.id;
 		task->memAddr = memAddr;
 		task->memSize = memSize;
+		task->addressSpace = addressSpace;
+		task->memNode = (addressSpace != null) ? addressSpace->node : k_getCurrentNode();
 	}
 	
 	// set thread ID equaled to task ID.
@@ -170,13 +191,20 @@ Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAd
 	k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		
 	// set task.
-	k_setTask(task, flags, entryPointAddr, arg, stackAddr, TASK_STACKSIZE);
+	k_setTask(task, flags, entryPointAddr, arg, stackAddr, stackSize);
+	
+	if (stackPointer != 0) {
+		task->context.registers[TASK_INDEX_RSP] = stackPointer;
+		task->context.registers[TASK_INDEX_RBP] = stackPointer;
+	}
 	
 	// initialize child thread list.
 	k_initList(&(task->childThreadList));
 	
 	// initialize FPU used flag, APIC ID, and affinity.
 	task->fpuUsed = false;
+	task->fpuApicId = TASK_INVALIDAPICID;
+	task->fpuUseCount = 0;
 	task->apicId = currentApicId;
 	task->affinity = affinity;
 	task->waitGroupId = KID_INVALID;
@@ -200,7 +228,10 @@ static void k_setTask(Task* task, qword flags, qword entryPointAddr, qword arg,
 	
 	// push the address of k_exitTask function to the top (8 bytes) of stack as the return address,
 	// in order to move to k_exitTask function when entry point function of task returns.
-	*(qword*)((qword)stackAddr + stackSize - 8) = (qword)k_exitTask;
+	// (Stack in user space is not mapped in current address space, so skip it.)
+	if ((qword)stackAddr < VMEM_USERSPACESTARTADDRESS) {
+		*(qword*)((qword)stackAddr + stackSize - 8) = (qword)k_exitTask;
+	}
 	
 	// set segment selector.
 	if (flags & TASK_FLAGS_USER) {
@@ -276,6 +307,10 @@ void k_initScheduler(void) {
 	// They must not move to another core. Thus, their affinity is set to current APIC ID.
 	task->apicId = currentApicId;
 	task->affinity = currentApicId;
+	task->fpuUsed = false;
+	task->fpuApicId = TASK_INVALIDAPICID;
+	task->fpuUseCount = 0;
+	task->memNode = k_getCurrentNode();
 	task->waitGroupId = KID_INVALID;
 	task->joinGroupId = KID_INVALID;
 	task->joinCount = 0;
@@ -296,6 +331,7 @@ void k_initScheduler(void) {
 	task->memSize = 0x500000;
 	task->stackAddr = (void*)0x600000;
 	task->stackSize = 0x100000;
+	task->addressSpace = null;
 	
 	// initialize fields related with processor load.
 	g_schedulers[currentApicId].processorTimeInIdleTask = 0;
@@ -462,6 +498,7 @@ static byte k_findSchedulerByMinTaskCount(const Task* task) {
 	byte minCoreIndex;
 	int tempTaskCount;
 	int coreCount;
+	int imbalance;
 	
 	coreCount = k_getProcessorCount();
 	if (coreCount == 1) {
@@ -472,18 +509,39 @@ static byte k_findSchedulerByMinTaskCount(const Task* task) {
 	currentTaskCount = k_getListCount(&(g_schedulers[task->apicId].readyLists[priority]));
 	
 	/**
-	  find scheduler with minimum task count out of schedulers whose task count is '2 or more' less than current task count.
+	  find scheduler with minimum task count out of schedulers whose task count is less than current task count by imbalance.
 	  (task count is only from ready list with the same priority.)
+	  - cores on the NUMA node holding task memory are searched first with TASK_LOCALIMBALANCE.
+	    If task runs on a core of another node, it goes back to its node if there is a core which is not busier.
+	  - cores on the other nodes are searched only if no core is found above, with TASK_REMOTEIMBALANCE,
+	    because task accesses its memory with cross-node latency there.
 	*/
 	minTaskCount = TASK_MAXCOUNT;
 	minCoreIndex = task->apicId;
+	imbalance = (k_getNodeByApicId(task->apicId) == task->memNode) ? TASK_LOCALIMBALANCE : 0;
 	for (i = 0; i < coreCount; i++) {
-		if (i == task->apicId) {
+		if ((i == task->apicId) || (k_getNodeByApicId(i) != task->memNode)) {
 			continue;
 		}
 		
 		tempTaskCount = k_getListCount(&(g_schedulers[i].readyLists[priority]));
-		if ((tempTaskCount + 2 <= currentTaskCount) && (tempTaskCount < minTaskCount)) {
+		if ((tempTaskCount + imbalance <= currentTaskCount) && (tempTaskCount < minTaskCount)) {
+			minCoreIndex = i;
+			minTaskCount = tempTaskCount;
+		}
+	}
+	
+	if ((minCoreIndex != task->apicId) || (k_getNodeCount() == 1)) {
+		return minCoreIndex;
+	}
+	
+	for (i = 0; i < coreCount; i++) {
+		if ((i == task->apicId) || (k_getNodeByApicId(i) == task->memNode)) {
+			continue;
+		}
+		
+		tempTaskCount = k_getListCount(&(g_schedulers[i].readyLists[priority]));
+		if ((tempTaskCount + TASK_REMOTEIMBALANCE <= currentTaskCount) && (tempTaskCount < minTaskCount)) {
 			minCoreIndex = i;
 			minTaskCount = tempTaskCount;
 		}
@@ -509,19 +567,8 @@ static void k_addTaskToSchedulerWithLoadBalancing(Task* task) {
 		targetApicId = currentApicId;
 	}
 	
-	/* save FPU context if it requires */
-	k_lockSpin(&(g_schedulers[currentApicId].spinlock));
-	
-	// save FPU context to memory if task moves to another scheduler and it's the last FPU-used task.
-	if ((currentApicId != targetApicId) && (task->link.id == g_schedulers[currentApicId].lastFpuUsedTaskId)) {
-		// clear TS in order not to cause exception 7 (Device Not Available).
-		// Otherwise, exception 7 occurs when FPU operation or FPU command (fxsave) is being executed, with TS being set to 1.
-		k_clearTs();
-		k_saveFpuContext(task->fpuContext);
-		g_schedulers[currentApicId].lastFpuUsedTaskId = TASK_INVALIDID;
-	}
-	
-	k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
+	// [NOTE] FPU context of task which is not running has always been saved to memory when it was switched out (k_switchFpuContext),
+	//        so task can move to another scheduler without flushing FPU registers of the core which it ran on.
 	
 	/* add task to target scheduler */
 	k_lockSpin(&(g_schedulers[targetApicId].spinlock));
@@ -679,13 +726,8 @@ bool k_schedule(void) {
 		g_schedulers[currentApicId].processorTimeInIdleTask += (TASK_PROCESSORTIME - g_schedulers[currentApicId].processorTime);
 	}
 	
-	// If next task is not last FPU-used task, set CR0.TS=1.
-	if (g_schedulers[currentApicId].lastFpuUsedTaskId != nextTask->link.id) {
-		k_setTs();
-		
-	} else {
-		k_clearTs();
-	}
+	// save FPU context of running task, and restore FPU context of next task lazily or eagerly.
+	k_switchFpuContext(currentApicId, runningTask, nextTask);
 
 	/**
 	  < Context Switching in Task >
@@ -694,19 +736,21 @@ bool k_schedule(void) {
 	 */
 	
 	// If it's switched from wait task, move the task to wait list, and switch context.
+	// [NOTE] The task is moved to wait list before unlocking scheduler, so that notification always finds it
+	//        either as the running task or in wait list. (locking order: scheduler -> common scheduler)
 	if (runningTask->flags & TASK_FLAGS_WAIT) {
-		k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		k_addTaskToWaitList(runningTask);
+		k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		// save running task context from registers to task pool,
 		// and restore next task context from task pool to registers.
-		k_switchContext(&(runningTask->context), &(nextTask->context));
+		k_switchContext(&(runningTask->context), &(nextTask->context), k_getAddressSpaceCr3(nextTask->addressSpace));
 
 	// If it's switched from end task, move the task to end list, and switch context.
 	} else if (runningTask->flags & TASK_FLAGS_END) {
 		k_addListToTail(&(g_schedulers[currentApicId].endList), runningTask);
 		k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		// restore next task context from task pool to registers.
-		k_switchContext(null, &(nextTask->context));
+		k_switchContext(null, &(nextTask->context), k_getAddressSpaceCr3(nextTask->addressSpace));
 		
 	// If it's switched from normal task, move the task to ready list, and switch context.
 	} else {
@@ -714,7 +758,7 @@ bool k_schedule(void) {
 		k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 		// save running task context from registers to task pool,
 		// and restore next task context from task pool to registers.
-		k_switchContext(&(runningTask->context), &(nextTask->context));
+		k_switchContext(&(runningTask->context), &(nextTask->context), k_getAddressSpaceCr3(nextTask->addressSpace));
 	}
 	
 	// update processor time.
@@ -776,19 +820,17 @@ bool k_scheduleInInterrupt(void) {
 		k_memcpy(&(runningTask->context), contextAddr, sizeof(Context));
 	}
 	
-	// If next task is not last FPU-used task, set CR0.TS=1.
-	if (g_schedulers[currentApicId].lastFpuUsedTaskId != nextTask->link.id) {
-		k_setTs();
-		
-	} else {
-		k_clearTs();
-	}
+	// save FPU context of running task, and restore FPU context of next task lazily or eagerly.
+	k_switchFpuContext(currentApicId, runningTask, nextTask);
 	
 	k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
 	
 	// restore next task context from task pool to IST.
 	k_memcpy(contextAddr, &(nextTask->context), sizeof(Context));
 	
+	// switch address space: IST is in kernel space, so it's safe to switch it here.
+	k_switchAddressSpace(nextTask->addressSpace);
+	
 	if (((runningTask->flags & TASK_FLAGS_WAIT) != TASK_FLAGS_WAIT) && 
 		((runningTask->flags & TASK_FLAGS_END) != TASK_FLAGS_END)) {
 		k_addTaskToSchedulerWithLoadBalancing(runningTask);
@@ -804,6 +846,10 @@ void k_decreaseProcessorTime(byte apicId) {
 	g_schedulers[apicId].processorTime--;
 }
 
+void k_expireProcessorTime(byte apicId) {
+	g_schedulers[apicId].processorTime = 0;
+}
+
 bool k_isProcessorTimeExpired(byte apicId) {
 	if (g_schedulers[apicId].processorTime <= 0) {
 		return true;
@@ -1221,8 +1267,11 @@ void k_idleTask(void) {
 						
 					// If all child threads are completely ended, end process itself completely.
 					} else {
-						// free code/data area of user process.
-						if (task->flags & TASK_FLAGS_USER) {
+						// free address space (page tables, pages, app image) or code/data area of user process.
+						if (task->addressSpace != null) {
+							k_deleteAddressSpace(task->addressSpace);
+							
+						} else if (task->flags & TASK_FLAGS_USER) {
 							k_freeMem(task->memAddr);
 						}
 					}
@@ -1246,7 +1295,10 @@ void k_idleTask(void) {
 					k_deleteWindowsByTask(task->link.id);
 				}
 
-				k_freeMem(task->stackAddr);
+				// stack in user space has been freed with address space.
+				if ((qword)task->stackAddr < VMEM_USERSPACESTARTADDRESS) {
+					k_freeMem(task->stackAddr);
+				}
 
 				// free task of end task (If task is freed, then also stack is freed automatically.)
 				taskId = task->link.id;
@@ -1286,38 +1338,193 @@ void k_setLastFpuUsedTaskId(byte apicId, qword taskId) {
 	g_schedulers[apicId].lastFpuUsedTaskId = taskId;
 }
 
+/**
+  < FPU Context Switching >
+  - FPU context is restored lazily: CR0.TS is set when switching task, and #NM (exception 7) restores FPU context when task uses FPU first.
+  - FPU context is saved when task is switched out (write back), if task owns FPU registers of current core.
+    So, FPU context of task which is not running is always in memory, and task can move to another core safely.
+    FPU registers still hold it, so if task comes back to the same core and nobody has used FPU, it doesn't need to be restored.
+  - XSAVEOPT doesn't save state components which have not been modified since the last XRSTOR, so saving every switch is cheap.
+  - Eager FPU: If task uses FPU in TASK_FPUEAGERTHRESHOLD slices consecutively (or has TASK_FLAGS_FPUEAGER),
+    FPU context is restored when switching to task, in order to avoid #NM every slice.
+*/
+void k_initFpuSaveMode(void) {
+	dword eax, ebx, ecx, edx;
+	qword xsaveMask;
+
+	// check XSAVE (CPUID.01H:ECX.XSAVE[bit 26]).
+	k_readCpuid(0x01, 0, &eax, &ebx, &ecx, &edx);
+	if ((ecx & (1 << 26)) == 0) {
+		g_fpuManager.saveMode = TASK_FPUSAVEMODE_FXSAVE;
+		g_fpuManager.xsaveMask = 0;
+		g_fpuManager.contextSize = 512;
+		return;
+	}
+
+	// enable XSAVE and XCR0 (CR4.OSXSAVE[bit 18]).
+	k_writeCr4(k_readCr4() | (1 << 18));
+
+	// enable x87, SSE, and AVX (CPUID.01H:ECX.AVX[bit 28]) if supported.
+	xsaveMask = TASK_XSTATE_X87 | TASK_XSTATE_SSE;
+	if (ecx & (1 << 28)) {
+		xsaveMask |= TASK_XSTATE_AVX;
+	}
+
+	k_writeXcr0(xsaveMask);
+
+	// XSAVE area size of enabled state components (CPUID.(EAX=0DH,ECX=0):EBX) must fit in FPU context of task.
+	k_readCpuid(0x0D, 0, &eax, &ebx, &ecx, &edx);
+	if (ebx > TASK_FPUCONTEXTSIZE) {
+		xsaveMask = TASK_XSTATE_X87 | TASK_XSTATE_SSE;
+		k_writeXcr0(xsaveMask);
+		k_readCpuid(0x0D, 0, &eax, &ebx, &ecx, &edx);
+	}
+
+	g_fpuManager.xsaveMask = xsaveMask;
+	g_fpuManager.contextSize = ebx;
+
+	// check XSAVEOPT (CPUID.(EAX=0DH,ECX=1):EAX[bit 0]).
+	k_readCpuid(0x0D, 1, &eax, &ebx, &ecx, &edx);
+	if (eax & 0x01) {
+		g_fpuManager.saveMode = TASK_FPUSAVEMODE_XSAVEOPT;
+
+	} else {
+		g_fpuManager.saveMode = TASK_FPUSAVEMODE_XSAVE;
+	}
+}
+
+bool k_isFpuOwner(byte apicId, const Task* task) {
+	return ((g_schedulers[apicId].lastFpuUsedTaskId == task->link.id) && (task->fpuApicId == apicId));
+}
+
+void k_saveTaskFpuContext(Task* task) {
+	switch (g_fpuManager.saveMode) {
+	case TASK_FPUSAVEMODE_XSAVEOPT:
+		k_xsaveopt(task->fpuContext, g_fpuManager.xsaveMask);
+		break;
+
+	case TASK_FPUSAVEMODE_XSAVE:
+		k_xsave(task->fpuContext, g_fpuManager.xsaveMask);
+		break;
+
+	default:
+		k_saveFpuContext(task->fpuContext);
+		break;
+	}
+}
+
+void k_loadTaskFpuContext(Task* task) {
+
+	// If task has never used FPU, make initial FPU context, which resets x87 and SSE (and AVX) registers.
+	// [NOTE] It's restored by XRSTOR instead of FINIT, because XSAVEOPT is valid only after XRSTOR from the same FPU context.
+	if (task->fpuUsed == false) {
+		k_memset(task->fpuContext, 0, sizeof(task->fpuContext));
+		*(word*)((byte*)task->fpuContext + 0) = 0x037F;  // FCW: x87 default control word
+		*(dword*)((byte*)task->fpuContext + 24) = 0x1F80; // MXCSR: SSE default control/status (all exceptions masked)
+		task->fpuUsed = true;
+	}
+
+	if (g_fpuManager.saveMode == TASK_FPUSAVEMODE_FXSAVE) {
+		k_loadFpuContext(task->fpuContext);
+
+	} else {
+		k_xrstor(task->fpuContext, g_fpuManager.xsaveMask);
+	}
+}
+
+static void k_switchFpuContext(byte apicId, Task* runningTask, Task* nextTask) {
+
+	// save FPU context of running task if it owns FPU registers. (CR0.TS is 0 in this case.)
+	// If not, running task has not used FPU in this slice.
+	if (k_isFpuOwner(apicId, runningTask) == true) {
+		k_saveTaskFpuContext(runningTask);
+
+	} else if ((runningTask->flags & TASK_FLAGS_FPUEAGER) == 0) {
+		runningTask->fpuUseCount = 0;
+	}
+
+	// If FPU registers still hold FPU context of next task, use it as is.
+	if (k_isFpuOwner(apicId, nextTask) == true) {
+		k_clearTs();
+
+	// If next task uses FPU every slice, restore its FPU context eagerly.
+	} else if ((nextTask->fpuUsed == true) && ((nextTask->flags & TASK_FLAGS_FPUEAGER) || (nextTask->fpuUseCount >= TASK_FPUEAGERTHRESHOLD))) {
+		k_clearTs();
+		k_loadTaskFpuContext(nextTask);
+		g_schedulers[apicId].lastFpuUsedTaskId = nextTask->link.id;
+		nextTask->fpuApicId = apicId;
+		nextTask->fpuUseCount++;
+
+	// If not, set CR0.TS=1 in order to restore FPU context lazily when next task uses FPU.
+	} else {
+		k_setTs();
+	}
+}
+
 bool k_waitGroup(qword groupId, void* lock) {
 	Task* target;
-	bool result;
+	bool interruptFlag;
+	byte apicId;
+
+	//----------------------------------------------------------------------------------------------------
+	// set wait group ID and wait task flag before unlocking lock, so that notification which occurs
+	// between unlocking lock and switching task isn't lost. (It clears wait task flag of the running task.)
+	// [NOTE] interrupt is disabled until lock is unlocked, in order that the task isn't moved to wait list by timer while holding lock.
+	//        (If lock is spinlock, interrupt has been already disabled, and unlocking it restores interrupt flag.)
+	//----------------------------------------------------------------------------------------------------
+	interruptFlag = k_setInterruptFlag(false);
 
 	target = k_getRunningTask(k_getApicId());
+	if (k_findSchedulerByTaskWithLock(target->link.id, &apicId) == false) {
+		k_setInterruptFlag(interruptFlag);
+		return false;
+	}
+
 	target->waitGroupId = groupId;
+	target->flags |= TASK_FLAGS_WAIT;
+	k_unlockSpin(&(g_schedulers[apicId].spinlock));
 
 	if (lock != null) {
 		k_unlockAny(lock);
-	}		
+	}
+
+	// switch task. If there is no other task to run, it returns right away, so that caller checks its condition again.
+	k_schedule();
 
-	result = k_waitTask(target->link.id);
+	// clear wait task flag which remains if task has not been switched.
+	if (k_findSchedulerByTaskWithLock(target->link.id, &apicId) == true) {
+		target->flags &= ~TASK_FLAGS_WAIT;
+		target->waitGroupId = KID_INVALID;
+		k_unlockSpin(&(g_schedulers[apicId].spinlock));
+	}
 
-	target->waitGroupId = KID_INVALID;
+	if ((lock == null) || (*(byte*)lock != LOCK_TYPE_SPINLOCK)) {
+		k_setInterruptFlag(interruptFlag);
+	}
 
 	if (lock != null) {
 		k_lockAny(lock);
 	}
 
-	return result;
+	return true;
 }
 
 bool k_notifyOneInWaitGroup(qword groupId) {
 	Task* task;
-	bool result = false;
+	qword taskId = TASK_INVALIDID;
+
+	// notify the running task which is about to wait first, because it entered wait group before tasks in wait list can be woken.
+	if (k_notifyRunningTaskInWaitGroup(groupId, false) == true) {
+		return true;
+	}
 
+	// [NOTE] task is notified after unlocking common scheduler in order to keep locking order (scheduler -> common scheduler).
 	k_lockSpin(&g_commonScheduler.spinlock);
 
 	task = k_getHeadFromList(&g_commonScheduler.waitList);
 	while (task != null) {
 		if (task->waitGroupId == groupId) {
-			result = k_notifyTask(task->link.id);
+			taskId = task->link.id;
 			break;
 		}
 
@@ -1326,25 +1533,72 @@ bool k_notifyOneInWaitGroup(qword groupId) {
 
 	k_unlockSpin(&g_commonScheduler.spinlock);
 
-	return result;
+	if (taskId == TASK_INVALIDID) {
+		return false;
+	}
+
+	return k_notifyTask(taskId);
 }
 
 bool k_notifyAllInWaitGroup(qword groupId) {
+	Task* task;
+	qword taskId;
+	bool result;
+
+	// notify running tasks which are about to wait first, and then tasks in wait list.
+	// [NOTE] This order doesn't miss a task which moves from running to wait list while notifying.
+	result = k_notifyRunningTaskInWaitGroup(groupId, true);
+
+	// notify tasks in wait list one by one. A notified task is removed from wait list, so it isn't found again.
+	// [NOTE] task is notified after unlocking common scheduler in order to keep locking order (scheduler -> common scheduler).
+	while (true) {
+		taskId = TASK_INVALIDID;
+
+		k_lockSpin(&g_commonScheduler.spinlock);
+
+		task = k_getHeadFromList(&g_commonScheduler.waitList);
+		while (task != null) {
+			if (task->waitGroupId == groupId) {
+				taskId = task->link.id;
+				break;
+			}
+
+			task = k_getNextFromList(&g_commonScheduler.waitList, task);
+		}
+
+		k_unlockSpin(&g_commonScheduler.spinlock);
+
+		if ((taskId == TASK_INVALIDID) || (k_notifyTask(taskId) == false)) {
+			break;
+		}
+
+		result = true;
+	}
+
+	return result;
+}
+
+static bool k_notifyRunningTaskInWaitGroup(qword groupId, bool all) {
 	Task* task;
 	bool result = false;
+	int i;
 
-	k_lockSpin(&g_commonScheduler.spinlock);
+	// clear wait task flag of running tasks which have set it in wait group, but have not been switched yet.
+	for (i = 0; i < k_getProcessorCount(); i++) {
+		k_lockSpin(&(g_schedulers[i].spinlock));
 
-	task = k_getHeadFromList(&g_commonScheduler.waitList);
-	while (task != null) {
-		if (task->waitGroupId == groupId) {
-			result = k_notifyTask(task->link.id);
+		task = g_schedulers[i].runningTask;
+		if ((task != null) && (task->waitGroupId == groupId) && ((task->flags & TASK_FLAGS_WAIT) == TASK_FLAGS_WAIT)) {
+			task->flags &= ~TASK_FLAGS_WAIT;
+			result = true;
 		}
 
-		task = k_getNextFromList(&g_commonScheduler.waitList, task);
-	} 
+		k_unlockSpin(&(g_schedulers[i].spinlock));
 
-	k_unlockSpin(&g_commonScheduler.spinlock);
+		if ((result == true) && (all == false)) {
+			break;
+		}
+	}
 
 	return result;
 }
@@ -1445,3 +1699,49 @@ qword k_createThread(qword entryPointAddr, qword arg, byte affinity, qword exitF
 
 	return task->link.id;
 }
+
+/**
+  < Process Clone >
+  - It creates a process which shares the address space of running process as copy-on-write,
+    so spawning a worker from a warmed-up process costs only copying page tables, not loading and relocating app again.
+  - The cloned process starts from entry point with its own stack, which is the same stack area of the original but copied on write.
+  [NOTE] Only a process without threads can be cloned, because the clone has only one thread started from entry point,
+         while the other threads might be in the middle of updating shared data.
+*/
+qword k_cloneProcess(qword entryPointAddr, qword arg, byte affinity, qword exitFunc) {
+	Task* process;
+	AddressSpace* addressSpace;
+	Task* task;
+	qword stackPointer;
+	byte currentApicId;
+
+	currentApicId = k_getApicId();
+
+	k_lockSpin(&(g_schedulers[currentApicId].spinlock));
+	process = k_getProcessByThread(k_getRunningTask(currentApicId));
+	k_unlockSpin(&(g_schedulers[currentApicId].spinlock));
+
+	if ((process == null) || (process->addressSpace == null) || (k_getListCount(&(process->childThreadList)) > 0)) {
+		return TASK_INVALIDID;
+	}
+
+	addressSpace = k_cloneAddressSpace(process->addressSpace);
+	if (addressSpace == null) {
+		return TASK_INVALIDID;
+	}
+
+	// push exitFunc to the top of stack as the return address.
+	stackPointer = VMEM_USERSPACEENDADDRESS - 8;
+	if (k_copyToAddressSpace(addressSpace, stackPointer, &exitFunc, sizeof(qword)) == false) {
+		k_deleteAddressSpace(addressSpace);
+		return TASK_INVALIDID;
+	}
+
+	task = k_createTaskInAddressSpace(TASK_FLAGS_PROCESS | TASK_FLAGS_USER | GETTASKPRIORITY(process->flags), addressSpace, process->memAddr, process->memSize, entryPointAddr, arg, stackPointer, affinity);
+	if (task == null) {
+		k_deleteAddressSpace(addressSpace);
+		return TASK_INVALIDID;
+	}
+
+	return task->link.id;
+}
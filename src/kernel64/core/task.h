@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "../utils/list.h"
+#include "../utils/pool.h"
 #include "sync.h"
 
 /**
@@ -99,10 +100,30 @@
 #define TASK_FLAGS_GUI     0x0200000000000000
 #define TASK_FLAGS_USER    0x0100000000000000
 #define TASK_FLAGS_JOIN    0x0080000000000000
+#define TASK_FLAGS_FPUEAGER 0x0040000000000000
 
 // task affinity
 #define TASK_AFFINITY_LB 0xFF // load balancing (no affinity)
 
+// NUMA load balancing
+#define TASK_LOCALIMBALANCE  2 // task moves to another core on the same NUMA node, if task count differs by this much or more.
+#define TASK_REMOTEIMBALANCE 4 // task moves to another core on the other NUMA node, if task count differs by this much or more.
+
+// FPU context
+#define TASK_FPUCONTEXTSIZE    832 // FPU context size: XSAVE area of x87 and SSE (legacy area 512 bytes) + XSAVE header (64 bytes) + AVX (256 bytes)
+#define TASK_FPUEAGERTHRESHOLD 5   // If task uses FPU in this many slices consecutively, its FPU context is restored eagerly.
+#define TASK_INVALIDAPICID     0xFF
+
+// FPU save mode
+#define TASK_FPUSAVEMODE_FXSAVE   0 // FXSAVE/FXRSTOR: x87 and SSE only
+#define TASK_FPUSAVEMODE_XSAVE    1 // XSAVE/XRSTOR
+#define TASK_FPUSAVEMODE_XSAVEOPT 2 // XSAVEOPT/XRSTOR: Unmodified state components since the last XRSTOR are not saved.
+
+// XSAVE state components (XCR0)
+#define TASK_XSTATE_X87 0x01
+#define TASK_XSTATE_SSE 0x02
+#define TASK_XSTATE_AVX 0x04
+
 /* macro functions */
 #define GETTASKOFFSET(taskId)            ((taskId) & 0xFFFFFFFF)                                 // get task offset (low 32 bits) of task.link.id (64 bits).
 #define GETTASKPRIORITY(flags)           ((flags) & 0xFF)                                        // get task priority (low 8 bits) of task.flags(64 bits).
@@ -131,12 +152,12 @@ typedef struct k_Task {
 	//--------------------------------------------------
 	ListLink threadLink;     // child thread link: It consists of next child thread address (threadLink.next) and thread ID (threadLink.id).
 	qword parentProcessId;   // parent process ID
-	qword fpuContext[512/8]; // FPU context (512 bytes-fixed)
-	                         //     : [NOTE] The start address of FPU context must be the multiple of 16 bytes.
+	qword fpuContext[TASK_FPUCONTEXTSIZE/8]; // FPU context (832 bytes-fixed)
+	                         //     : [NOTE] The start address of FPU context must be the multiple of 64 bytes. (XSAVE area)
 	                         //       To guarantee it, the conditions below must be satisfied.
-	                         //       - Condition 1: The start address of task pool must be the multiple of 16 bytes. (currently, It's 0x800000 (8 MBytes).)
-	                         //       - Condition 2: The size of each task must be the multiple of 16 bytes. (currently, It's 816 bytes.)
-	                         //       - Condition 3: The FPU context offset of each task must be the multiple of 16 bytes. (currently, It's 64 bytes)
+	                         //       - Condition 1: The start address of task pool must be the multiple of 64 bytes. (currently, It's 0x800000 (8 MBytes).)
+	                         //       - Condition 2: The size of each task must be the multiple of 64 bytes. (currently, It's 1216 bytes.)
+	                         //       - Condition 3: The FPU context offset of each task must be the multiple of 64 bytes. (currently, It's 64 bytes)
 	                         //       Currently, the conditions above are satisfied. Thus, it's recommended to add fields below FPU context field.
 	List childThreadList;    // child thread list
 	
@@ -147,20 +168,25 @@ typedef struct k_Task {
 	void* stackAddr;         // start address of stack
 	qword stackSize;         // size of stack
 	bool fpuUsed;            // FPU used flag: It indicates whether the task has used FPU operation before.
+	byte fpuApicId;          // APIC ID of core whose FPU registers still hold FPU context of task (TASK_INVALIDAPICID if none)
+	byte fpuUseCount;        // count of consecutive slices using FPU: It wraps around to 0 in order to re-check if eager FPU is still needed.
 	byte apicId;             // APIC ID of core which task is running on
 	byte affinity;           // task-processor affinity: APIC ID of core which has affinity with task
+	byte memNode;            // NUMA node holding task memory: Load balancing prefers cores on this node.
 	qword waitGroupId;       // wait group ID
 	qword joinGroupId;       // join group ID
 	int joinCount;           // join count
-	char padding[5];         // padding bytes: According to Condition 2 of FPU context, align task size with the multiple of 16 bytes.
-} Task; // Task is ListItem, and current task size is 832 bytes.
+	struct k_AddressSpace* addressSpace; // address space: It's shared by process and its threads. (null if task uses kernel address space.)
+	char padding[58];        // padding bytes: According to Condition 2 of FPU context, align task size with the multiple of 64 bytes.
+} Task; // Task is ListItem, and current task size is 1216 bytes.
 
 typedef struct k_TaskPoolManager {
-	Spinlock spinlock;  // spinlock
-	Task* startAddr;    // start address of task pool: You can consider it as task array.
-	int maxCount;       // max task count
-	int usedCount;      // used task count: currently being-used task count.
-	int allocatedCount; // allocated task count: It only increases when allocating task. It's for task ID to be unique.
+	Spinlock spinlock;                 // spinlock
+	Task* startAddr;                   // start address of task pool: You can consider it as task array.
+	Pool pool;                         // task pool: free tasks are linked through the low 32 bits of task ID.
+	int allocatedCount;                // allocated task count: It only increases when allocating task. It's for task ID to be unique.
+	int usedIndexes[TASK_MAXCOUNT];    // used index array of task pool
+	int usedPositions[TASK_MAXCOUNT];  // used position array of task pool
 } TaskPoolManager;
 
 typedef struct k_Scheduler {
@@ -176,6 +202,12 @@ typedef struct k_Scheduler {
 	bool loadBalancing;                         // task load balancing flag
 } Scheduler;
 
+typedef struct k_FpuManager {
+	byte saveMode;     // FPU save mode
+	qword xsaveMask;   // state components saved and restored by XSAVE (XCR0)
+	dword contextSize; // FPU context size used by save mode
+} FpuManager;
+
 typedef struct k_CommonScheduler {
 	Spinlock spinlock; // spinlock
 	List waitList;     // wait list: Tasks which are waiting to be ready are in the list.
@@ -190,6 +222,7 @@ static void k_freeTask(qword taskId);
 
 /* Task Functions */
 Task* k_createTask(qword flags, void* memAddr, qword memSize, qword entryPointAddr, qword arg, byte affinity);
+Task* k_createTaskInAddressSpace(qword flags, struct k_AddressSpace* addressSpace, void* memAddr, qword memSize, qword entryPointAddr, qword arg, qword stackPointer, byte affinity);
 static void k_setTask(Task* task, qword flags, qword entryPointAddr, qword arg, void* stackAddr, qword stackSize);
 
 /* Scheduler Functions */
@@ -208,6 +241,7 @@ static Task* k_removeTaskFromWaitList(qword taskId);
 bool k_schedule(void); // task switching in task.
 bool k_scheduleInInterrupt(void); // task switching in interrupt handler.
 void k_decreaseProcessorTime(byte apicId);
+void k_expireProcessorTime(byte apicId); // make task switched at next timer interrupt.
 bool k_isProcessorTimeExpired(byte apicId);
 bool k_changeTaskPriority(qword taskId, byte priority);
 bool k_changeTaskAffinity(qword taskId, byte affinity);
@@ -228,18 +262,25 @@ void k_idleTask(void);
 void k_haltProcessorByLoad(byte apicId);
 
 /* FPU Functions */
+void k_initFpuSaveMode(void); // detect XSAVE/XSAVEOPT, and enable XSAVE state components in current core.
 qword k_getLastFpuUsedTaskId(byte apicId);
 void k_setLastFpuUsedTaskId(byte apicId, qword taskId);
+bool k_isFpuOwner(byte apicId, const Task* task); // check if FPU registers of core hold FPU context of task.
+void k_saveTaskFpuContext(Task* task);
+void k_loadTaskFpuContext(Task* task); // restore FPU context of task, or initialize it if task has never used FPU.
+static void k_switchFpuContext(byte apicId, Task* runningTask, Task* nextTask);
 
 /* Wait Group Functions */
 bool k_waitGroup(qword groupId, void* lock);
 bool k_notifyOneInWaitGroup(qword groupId);
 bool k_notifyAllInWaitGroup(qword groupId);
+static bool k_notifyRunningTaskInWaitGroup(qword groupId, bool all); // notify running tasks which are about to wait in wait group.
 bool k_joinGroup(qword* taskIds, int count);
 bool k_notifyOneInJoinGroup(qword groupId);
 bool k_notifyAllInJoinGroup(qword groupId);
 
 /* Application Functions */
 qword k_createThread(qword entryPointAddr, qword arg, byte affinity, qword exitFunc);
+qword k_cloneProcess(qword entryPointAddr, qword arg, byte affinity, qword exitFunc);
 
 #endif // __CORE_TASK_H__
\ No newline at end of file
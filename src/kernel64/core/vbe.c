@@ -1,7 +1,27 @@
 #include "vbe.h"
+#include "asm_util.h"
 
 static VbeModeInfoBlock* g_vbeModeInfoBlock = (VbeModeInfoBlock*)VBE_MODEINFOBLOCKADDRESS;
 
 inline VbeModeInfoBlock* k_getVbeModeInfoBlock(void) {
 	return g_vbeModeInfoBlock;
+}
+
+bool k_isVideoMemWriteCombining(void) {
+	qword high32bits, low32bits;
+	qword pat;
+
+	if (VBE_GRAPHICMODEFLAG != VBE_GRAPHICMODEFLAG_GRAPHICMODE) {
+		return false;
+	}
+
+	// [NOTE] All IA-32e mode processors support PAT, so IA32_PAT MSR is always readable here.
+	k_readMsr(VBE_MSR_PAT, &high32bits, &low32bits);
+	pat = (high32bits << 32) | (low32bits & 0xFFFFFFFF);
+
+	if (((pat >> (VBE_PATINDEX_VIDEOMEM * 8)) & 0x07) == VBE_PATTYPE_WC) {
+		return true;
+	}
+
+	return false;
 }
\ No newline at end of file
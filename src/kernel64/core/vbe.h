@@ -3,9 +3,14 @@
 
 #include "types.h"
 
-#define VBE_MODEINFOBLOCKADDRESS   0x7E00 // VBE mode info block address: It's right after boot-loader address <0x7C00>.
+#define VBE_MODEINFOBLOCKADDRESS   0x8000 // VBE mode info block address: It's right after boot-loader (2 sectors) address <0x7C00>.
 #define VBE_GRAPHICMODEFLAGADDRESS 0x7C0A // GRAPHIC_MODE_FLAG is defined in boot_loader.asm.
 
+// PAT-related macros: kernel32 maps video memory with PAT entry 4 (PA4), and changes it to write combining (WC).
+#define VBE_MSR_PAT           0x277
+#define VBE_PATTYPE_WC        0x01
+#define VBE_PATINDEX_VIDEOMEM 4
+
 // graphic mode flag
 #define VBE_GRAPHICMODEFLAG             *(byte*)VBE_GRAPHICMODEFLAGADDRESS // graphic mode flag (0: text mode, 1: graphic mode)
 #define VBE_GRAPHICMODEFLAG_TEXTMODE    0x00 // text mode
@@ -86,5 +91,6 @@ typedef struct k_VbeModeInfoBlock {
 #pragma pack(pop)
 
 VbeModeInfoBlock* k_getVbeModeInfoBlock(void);
+bool k_isVideoMemWriteCombining(void);
 
 #endif // __CORE_VBE_H__
\ No newline at end of file
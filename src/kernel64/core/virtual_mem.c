@@ -0,0 +1,737 @@
+#include "virtual_mem.h"
+#include "dynamic_mem.h"
+#include "frame_mem.h"
+#include "asm_util.h"
+#include "task.h"
+#include "multiprocessor.h"
+#include "local_apic.h"
+#include "mp_config_table.h"
+#include "file_system.h"
+#include "../utils/util.h"
+
+// spinlock for reference count of app image shared by cloned address spaces
+static Spinlock g_imageSpinlock;
+
+// TLB shootdown manager
+static TlbShootdownManager g_tlbShootdownManager;
+
+void k_initVirtualMem(void) {
+	k_initSpinlock(&g_imageSpinlock);
+	k_memset(&g_tlbShootdownManager, 0, sizeof(g_tlbShootdownManager));
+}
+
+static void* k_allocPage(byte node) {
+	void* page;
+
+	// pages and page tables are 4 KB frames of frame memory, which are mapped identically in kernel space.
+	page = k_allocFrameOnNode(node);
+	if (page == null) {
+		return null;
+	}
+
+	k_memset(page, 0, VMEM_PAGESIZE);
+
+	return page;
+}
+
+AddressSpace* k_createAddressSpace(void) {
+	AddressSpace* addressSpace;
+
+	addressSpace = (AddressSpace*)k_allocMem(sizeof(AddressSpace));
+	if (addressSpace == null) {
+		return null;
+	}
+
+	k_memset(addressSpace, 0, sizeof(AddressSpace));
+
+	// pages of address space are allocated from the NUMA node of current core, which loads app.
+	addressSpace->node = k_getCurrentNode();
+	addressSpace->pml4 = (qword*)k_allocPage(addressSpace->node);
+	if (addressSpace->pml4 == null) {
+		k_freeMem(addressSpace);
+		return null;
+	}
+
+	// share kernel space (PML4 entry 0) with kernel address space.
+	addressSpace->pml4[0] = ((qword*)VMEM_KERNELPML4ADDRESS)[0];
+
+	k_initSpinlock(&(addressSpace->spinlock));
+
+	return addressSpace;
+}
+
+void k_deleteAddressSpace(AddressSpace* addressSpace) {
+	qword* pdpt;
+	int i;
+
+	// free page tables and pages of user space. (kernel space is shared, so don't free it.)
+	if (addressSpace->pml4[VMEM_USERSPACEPML4INDEX] & VMEM_FLAGS_P) {
+		pdpt = (qword*)(addressSpace->pml4[VMEM_USERSPACEPML4INDEX] & VMEM_ADDRMASK);
+		k_freePageTable(pdpt, 3);
+	}
+
+	k_freeFrame(addressSpace->pml4);
+
+	// release file mappings of file views which haven't been unmapped. (their pages are freed by file mapping.)
+	for (i = 0; i < addressSpace->regionCount; i++) {
+		if (addressSpace->regions[i].mapping != null) {
+			k_releaseFileMapping(addressSpace->regions[i].mapping);
+		}
+	}
+
+	// free app image if it's not shared by another cloned address space anymore.
+	if (addressSpace->image != null) {
+		if (addressSpace->imageRefCount == null) {
+			k_freeMem(addressSpace->image);
+
+		} else {
+			k_lockSpin(&g_imageSpinlock);
+			(*addressSpace->imageRefCount)--;
+			if (*addressSpace->imageRefCount == 0) {
+				k_freeMem(addressSpace->image);
+				k_freeMem(addressSpace->imageRefCount);
+			}
+			k_unlockSpin(&g_imageSpinlock);
+		}
+	}
+
+	k_freeMem(addressSpace);
+}
+
+bool k_addVirtualRegion(AddressSpace* addressSpace, qword startAddr, qword size, const byte* fileData, qword fileSize) {
+	VirtualRegion* region;
+
+	if ((startAddr < VMEM_USERSPACESTARTADDRESS) || (size > (VMEM_USERSPACEENDADDRESS - startAddr)) || (fileSize > size)) {
+		return false;
+	}
+
+	k_lockSpin(&(addressSpace->spinlock));
+
+	if (addressSpace->regionCount >= VMEM_MAXREGIONCOUNT) {
+		k_unlockSpin(&(addressSpace->spinlock));
+		return false;
+	}
+
+	region = &(addressSpace->regions[addressSpace->regionCount]);
+	region->startAddr = startAddr;
+	region->size = size;
+	region->fileData = fileData;
+	region->fileSize = fileSize;
+	region->mapping = null;
+	addressSpace->regionCount++;
+
+	k_unlockSpin(&(addressSpace->spinlock));
+
+	return true;
+}
+
+qword k_getAddressSpaceCr3(const AddressSpace* addressSpace) {
+	if (addressSpace == null) {
+		return VMEM_KERNELPML4ADDRESS;
+	}
+
+	return (qword)addressSpace->pml4;
+}
+
+void k_switchAddressSpace(const AddressSpace* addressSpace) {
+	qword cr3;
+
+	// If it's same as current address space, don't switch it in order not to flush TLB.
+	cr3 = k_getAddressSpaceCr3(addressSpace);
+	if (k_readCr3() != cr3) {
+		k_writeCr3(cr3);
+	}
+}
+
+bool k_copyToAddressSpace(AddressSpace* addressSpace, qword destAddr, const void* src, qword size) {
+	byte* page;
+	byte* oldPage;
+	qword offset;
+	qword copyLen;
+
+	// copy data page by page through kernel address of pages, because address space might not be current one.
+	while (size > 0) {
+		offset = destAddr & (VMEM_PAGESIZE - 1);
+		copyLen = VMEM_PAGESIZE - offset;
+		if (copyLen > size) {
+			copyLen = size;
+		}
+
+		k_lockSpin(&(addressSpace->spinlock));
+		page = k_getWritablePage(addressSpace, destAddr, &oldPage);
+		if (page != null) {
+			k_memcpy(page + offset, src, copyLen);
+		}
+		k_unlockSpin(&(addressSpace->spinlock));
+
+		// free old page of COW break after the other cores stop using it.
+		if (oldPage != null) {
+			k_flushTlb(addressSpace, destAddr);
+			k_freeFrame(oldPage);
+		}
+
+		if (page == null) {
+			return false;
+		}
+
+		src = (const byte*)src + copyLen;
+		destAddr += copyLen;
+		size -= copyLen;
+	}
+
+	return true;
+}
+
+static qword* k_getPtEntry(AddressSpace* addressSpace, qword virtualAddr, bool create) {
+	qword* table;
+	qword* nextTable;
+	int indexes[3];
+	int i;
+
+	indexes[0] = VMEM_PML4INDEX(virtualAddr);
+	indexes[1] = VMEM_PDPTINDEX(virtualAddr);
+	indexes[2] = VMEM_PDINDEX(virtualAddr);
+
+	// walk PML4 table -> page directory pointer table -> page directory, and create tables on the way if needed.
+	table = addressSpace->pml4;
+	for (i = 0; i < 3; i++) {
+		if ((table[indexes[i]] & VMEM_FLAGS_P) == 0) {
+			if (create == false) {
+				return null;
+			}
+
+			nextTable = (qword*)k_allocPage(addressSpace->node);
+			if (nextTable == null) {
+				return null;
+			}
+
+			table[indexes[i]] = (qword)nextTable | VMEM_FLAGS_USERPAGE;
+		}
+
+		table = (qword*)(table[indexes[i]] & VMEM_ADDRMASK);
+	}
+
+	return &(table[VMEM_PTINDEX(virtualAddr)]);
+}
+
+static byte* k_populatePage(AddressSpace* addressSpace, qword virtualAddr) {
+	VirtualRegion* region;
+	qword pageAddr;
+	qword* entry;
+	byte* page;
+	qword copyStart, copyEnd;
+	bool inRegion;
+	int i;
+
+	pageAddr = virtualAddr & ~((qword)VMEM_PAGESIZE - 1);
+
+	// check if page is in virtual regions. (file view is populated by k_populateViewPage only.)
+	inRegion = false;
+	for (i = 0; i < addressSpace->regionCount; i++) {
+		region = &(addressSpace->regions[i]);
+		if ((region->mapping == null) && (pageAddr < (region->startAddr + region->size)) && ((pageAddr + VMEM_PAGESIZE) > region->startAddr)) {
+			inRegion = true;
+			break;
+		}
+	}
+
+	if (inRegion == false) {
+		return null;
+	}
+
+	entry = k_getPtEntry(addressSpace, pageAddr, true);
+	if (entry == null) {
+		return null;
+	}
+
+	// If page has already been mapped (by another thread), return it.
+	if (*entry & VMEM_FLAGS_P) {
+		return (byte*)(*entry & VMEM_ADDRMASK);
+	}
+
+	page = (byte*)k_allocPage(addressSpace->node);
+	if (page == null) {
+		return null;
+	}
+
+	// copy file data of all regions overlapped with page, because a page can be shared by the end of a section and the start of the next section.
+	// (The rest of page has already been zero-filled.)
+	for (i = 0; i < addressSpace->regionCount; i++) {
+		region = &(addressSpace->regions[i]);
+		if ((region->fileData == null) || (region->fileSize == 0)) {
+			continue;
+		}
+
+		copyStart = (pageAddr > region->startAddr) ? pageAddr : region->startAddr;
+		copyEnd = ((pageAddr + VMEM_PAGESIZE) < (region->startAddr + region->fileSize)) ? (pageAddr + VMEM_PAGESIZE) : (region->startAddr + region->fileSize);
+		if (copyStart < copyEnd) {
+			k_memcpy(page + (copyStart - pageAddr), region->fileData + (copyStart - region->startAddr), copyEnd - copyStart);
+		}
+	}
+
+	*entry = (qword)page | VMEM_FLAGS_USERPAGE;
+	addressSpace->mappedPageCount++;
+
+	return page;
+}
+
+static void k_freePageTable(qword* table, int level) {
+	qword* child;
+	int i;
+
+	// level 3: page directory pointer table, level 2: page directory, level 1: page table
+	for (i = 0; i < VMEM_MAXENTRYCOUNT; i++) {
+		if ((table[i] & VMEM_FLAGS_P) == 0) {
+			continue;
+		}
+
+		child = (qword*)(table[i] & VMEM_ADDRMASK);
+		if (level > 1) {
+			k_freePageTable(child, level - 1);
+
+		// page of file view is freed by file mapping.
+		} else if ((table[i] & VMEM_FLAGS_NOFREE) == 0) {
+			k_freeFrame(child);
+		}
+	}
+
+	k_freeFrame(table);
+}
+
+static VirtualRegion* k_findVirtualRegion(AddressSpace* addressSpace, qword virtualAddr) {
+	VirtualRegion* region;
+	int i;
+
+	for (i = 0; i < addressSpace->regionCount; i++) {
+		region = &(addressSpace->regions[i]);
+		if ((virtualAddr >= region->startAddr) && (virtualAddr < (region->startAddr + region->size))) {
+			return region;
+		}
+	}
+
+	return null;
+}
+
+bool k_handlePageFault(qword faultAddr, qword errorCode) {
+	Task* task;
+	AddressSpace* addressSpace;
+	VirtualRegion* region;
+	byte* page;
+	byte* oldPage = null;
+	bool result;
+
+	// Only not-present page or writing to read-only page (copy-on-write) in user space can be handled.
+	if ((errorCode & VMEM_PFERROR_RSVD) || (faultAddr < VMEM_USERSPACESTARTADDRESS) || (faultAddr >= VMEM_USERSPACEENDADDRESS)) {
+		return false;
+	}
+
+	if ((errorCode & VMEM_PFERROR_P) && ((errorCode & VMEM_PFERROR_WR) == 0)) {
+		return false;
+	}
+
+	task = k_getRunningTask(k_getApicId());
+	addressSpace = (AddressSpace*)task->addressSpace;
+	if (addressSpace == null) {
+		return false;
+	}
+
+	k_lockSpin(&(addressSpace->spinlock));
+
+	// file view is read-only, so only not-present page can be handled.
+	region = k_findVirtualRegion(addressSpace, faultAddr);
+	if ((region != null) && (region->mapping != null)) {
+		result = ((errorCode & VMEM_PFERROR_P) == 0) && (k_populateViewPage(addressSpace, region, faultAddr) == true);
+		k_unlockSpin(&(addressSpace->spinlock));
+		return result;
+	}
+
+	if (errorCode & VMEM_PFERROR_P) {
+		page = k_getWritablePage(addressSpace, faultAddr, &oldPage);
+
+	} else {
+		page = k_populatePage(addressSpace, faultAddr);
+	}
+	k_unlockSpin(&(addressSpace->spinlock));
+
+	// free old page of COW break after the other cores stop using it.
+	if (oldPage != null) {
+		k_flushTlb(addressSpace, faultAddr);
+		k_freeFrame(oldPage);
+	}
+
+	if (page == null) {
+		return false;
+	}
+
+	return true;
+}
+
+qword k_addFileViewRegion(AddressSpace* addressSpace, qword size, struct k_FileMapping* mapping) {
+	VirtualRegion* region;
+	qword startAddr;
+	bool overlapped;
+	int i;
+
+	size = (size + (VMEM_PAGESIZE - 1)) & ~((qword)VMEM_PAGESIZE - 1);
+	if ((size == 0) || (size > (VMEM_USERSTACKSTARTADDRESS - VMEM_FILEVIEWSTARTADDRESS))) {
+		return 0;
+	}
+
+	k_lockSpin(&(addressSpace->spinlock));
+
+	if (addressSpace->regionCount >= VMEM_MAXREGIONCOUNT) {
+		k_unlockSpin(&(addressSpace->spinlock));
+		return 0;
+	}
+
+	// search the lowest free range from file view start address (first fit).
+	// If range overlaps a region, move it to the end of the region, and check all regions again.
+	startAddr = VMEM_FILEVIEWSTARTADDRESS;
+	do {
+		overlapped = false;
+		for (i = 0; i < addressSpace->regionCount; i++) {
+			region = &(addressSpace->regions[i]);
+			if ((startAddr < (region->startAddr + region->size)) && ((startAddr + size) > region->startAddr)) {
+				startAddr = (region->startAddr + region->size + (VMEM_PAGESIZE - 1)) & ~((qword)VMEM_PAGESIZE - 1);
+				overlapped = true;
+			}
+		}
+	} while ((overlapped == true) && ((startAddr + size) <= VMEM_USERSTACKSTARTADDRESS));
+
+	if ((startAddr + size) > VMEM_USERSTACKSTARTADDRESS) {
+		k_unlockSpin(&(addressSpace->spinlock));
+		return 0;
+	}
+
+	region = &(addressSpace->regions[addressSpace->regionCount]);
+	region->startAddr = startAddr;
+	region->size = size;
+	region->fileData = null;
+	region->fileSize = 0;
+	region->mapping = mapping;
+	addressSpace->regionCount++;
+
+	k_unlockSpin(&(addressSpace->spinlock));
+
+	return startAddr;
+}
+
+struct k_FileMapping* k_removeFileViewRegion(AddressSpace* addressSpace, qword startAddr) {
+	VirtualRegion* region = null;
+	struct k_FileMapping* mapping;
+	qword* entry;
+	qword pageAddr;
+	int i;
+
+	k_lockSpin(&(addressSpace->spinlock));
+
+	for (i = 0; i < addressSpace->regionCount; i++) {
+		if ((addressSpace->regions[i].startAddr == startAddr) && (addressSpace->regions[i].mapping != null)) {
+			region = &(addressSpace->regions[i]);
+			break;
+		}
+	}
+
+	if (region == null) {
+		k_unlockSpin(&(addressSpace->spinlock));
+		return null;
+	}
+
+	// unmap pages of file view. (They're not freed, because file mapping owns them.)
+	for (pageAddr = region->startAddr; pageAddr < (region->startAddr + region->size); pageAddr += VMEM_PAGESIZE) {
+		entry = k_getPtEntry(addressSpace, pageAddr, false);
+		if ((entry != null) && (*entry & VMEM_FLAGS_P)) {
+			*entry = 0;
+			addressSpace->mappedPageCount--;
+		}
+	}
+
+	// remove region by moving the following regions forward.
+	mapping = region->mapping;
+	k_memcpy(region, region + 1, sizeof(VirtualRegion) * (addressSpace->regionCount - i - 1));
+	addressSpace->regionCount--;
+
+	k_unlockSpin(&(addressSpace->spinlock));
+
+	// flush TLB of all cores running address space, so that no core can access pages of file view after they're released.
+	k_flushTlb(addressSpace, VMEM_FLUSHALL);
+
+	return mapping;
+}
+
+static bool k_populateViewPage(AddressSpace* addressSpace, VirtualRegion* region, qword virtualAddr) {
+	qword pageAddr;
+	qword* entry;
+	byte* page;
+
+	pageAddr = virtualAddr & ~((qword)VMEM_PAGESIZE - 1);
+
+	entry = k_getPtEntry(addressSpace, pageAddr, true);
+	if (entry == null) {
+		return false;
+	}
+
+	// If page has already been mapped (by another thread), return.
+	if (*entry & VMEM_FLAGS_P) {
+		return true;
+	}
+
+	if (k_getFileMappingPage(region->mapping, pageAddr - region->startAddr, &page) == false) {
+		return false;
+	}
+
+	// If page is being read from hard disk, give up the rest of processor time, and fault again after that.
+	if (page == null) {
+		k_expireProcessorTime(k_getApicId());
+		return true;
+	}
+
+	// map page read-only.
+	*entry = (qword)page | VMEM_FLAGS_VIEWPAGE;
+	addressSpace->mappedPageCount++;
+
+	return true;
+}
+
+AddressSpace* k_cloneAddressSpace(AddressSpace* addressSpace) {
+	AddressSpace* clone;
+	qword* pdpt;
+	qword* srcPdpt;
+	int i;
+
+	clone = k_createAddressSpace();
+	if (clone == null) {
+		return null;
+	}
+
+	// clone shares pages with source, so it belongs to the NUMA node of source.
+	clone->node = addressSpace->node;
+
+	k_lockSpin(&(addressSpace->spinlock));
+
+	// share app image, because not-yet-mapped pages of clone are populated from it.
+	if (addressSpace->image != null) {
+		if (addressSpace->imageRefCount == null) {
+			addressSpace->imageRefCount = (qword*)k_allocMem(sizeof(qword));
+			if (addressSpace->imageRefCount == null) {
+				k_unlockSpin(&(addressSpace->spinlock));
+				k_deleteAddressSpace(clone);
+				return null;
+			}
+
+			*addressSpace->imageRefCount = 1;
+		}
+
+		k_lockSpin(&g_imageSpinlock);
+		(*addressSpace->imageRefCount)++;
+		k_unlockSpin(&g_imageSpinlock);
+
+		clone->image = addressSpace->image;
+		clone->imageRefCount = addressSpace->imageRefCount;
+	}
+
+	k_memcpy(clone->regions, addressSpace->regions, sizeof(VirtualRegion) * addressSpace->regionCount);
+	clone->regionCount = addressSpace->regionCount;
+
+	// share file mappings of file views, because they're released when clone is deleted.
+	for (i = 0; i < clone->regionCount; i++) {
+		if (clone->regions[i].mapping != null) {
+			k_shareFileMapping(clone->regions[i].mapping);
+		}
+	}
+
+	// copy page tables of user space, and share mapped pages as copy-on-write.
+	if (addressSpace->pml4[VMEM_USERSPACEPML4INDEX] & VMEM_FLAGS_P) {
+		pdpt = (qword*)k_allocPage(clone->node);
+		if (pdpt == null) {
+			k_unlockSpin(&(addressSpace->spinlock));
+			k_deleteAddressSpace(clone);
+			return null;
+		}
+
+		clone->pml4[VMEM_USERSPACEPML4INDEX] = (qword)pdpt | VMEM_FLAGS_USERPAGE;
+		srcPdpt = (qword*)(addressSpace->pml4[VMEM_USERSPACEPML4INDEX] & VMEM_ADDRMASK);
+
+		// [NOTE] If it fails in the middle, some pages of source remain copy-on-write, which is harmless.
+		if (k_clonePageTable(srcPdpt, pdpt, 3, clone->node) == false) {
+			k_unlockSpin(&(addressSpace->spinlock));
+			k_deleteAddressSpace(clone);
+			return null;
+		}
+	}
+
+	clone->mappedPageCount = addressSpace->mappedPageCount;
+
+	k_unlockSpin(&(addressSpace->spinlock));
+
+	// flush TLB of all cores running source, because writable pages of source have become read-only.
+	k_flushTlb(addressSpace, VMEM_FLUSHALL);
+
+	return clone;
+}
+
+static bool k_clonePageTable(qword* srcTable, qword* destTable, int level, byte node) {
+	qword* child;
+	int i;
+
+	// level 3: page directory pointer table, level 2: page directory, level 1: page table
+	for (i = 0; i < VMEM_MAXENTRYCOUNT; i++) {
+		if ((srcTable[i] & VMEM_FLAGS_P) == 0) {
+			continue;
+		}
+
+		if (level > 1) {
+			child = (qword*)k_allocPage(node);
+			if (child == null) {
+				return false;
+			}
+
+			destTable[i] = (qword)child | VMEM_FLAGS_USERPAGE;
+
+			if (k_clonePageTable((qword*)(srcTable[i] & VMEM_ADDRMASK), child, level - 1, node) == false) {
+				return false;
+			}
+
+		// page of file view is read-only and not owned, so share it as it is.
+		} else if (srcTable[i] & VMEM_FLAGS_NOFREE) {
+			destTable[i] = srcTable[i];
+
+		} else {
+			// If reference count of frame is full, fail cloning instead of overflowing it.
+			if (k_shareFrame((void*)(srcTable[i] & VMEM_ADDRMASK)) == false) {
+				return false;
+			}
+
+			srcTable[i] = (srcTable[i] & ~VMEM_FLAGS_RW) | VMEM_FLAGS_COW;
+			destTable[i] = srcTable[i];
+		}
+	}
+
+	return true;
+}
+
+static byte* k_getWritablePage(AddressSpace* addressSpace, qword virtualAddr, byte** oldPage) {
+	qword* entry;
+	byte* page;
+	byte* newPage;
+
+	// [NOTE] Old page of COW break is returned to caller instead of being freed here,
+	//        because it must be freed after TLB shootdown, which is requested after unlocking address space spinlock.
+	*oldPage = null;
+
+	page = k_populatePage(addressSpace, virtualAddr);
+	if (page == null) {
+		return null;
+	}
+
+	entry = k_getPtEntry(addressSpace, virtualAddr, false);
+	if ((*entry & VMEM_FLAGS_COW) == 0) {
+		return page;
+	}
+
+	// If page is still shared, copy it to a new page. If not, it can be written in place.
+	if (k_getFrameRefCount(page) > 1) {
+		newPage = (byte*)k_allocPage(addressSpace->node);
+		if (newPage == null) {
+			return null;
+		}
+
+		k_memcpy(newPage, page, VMEM_PAGESIZE);
+		*entry = (qword)newPage | VMEM_FLAGS_USERPAGE;
+		*oldPage = page;
+		page = newPage;
+
+	// [NOTE] Making page writable in place needs no shootdown, because stale read-only entries only cause page fault again.
+	} else {
+		*entry = (*entry & ~VMEM_FLAGS_COW) | VMEM_FLAGS_RW;
+	}
+
+	if (k_readCr3() == (qword)addressSpace->pml4) {
+		k_invalidatePage(virtualAddr);
+	}
+
+	return page;
+}
+
+void k_flushTlb(AddressSpace* addressSpace, qword virtualAddr) {
+	Task* runningTask;
+	bool interruptFlag;
+	byte currentApicId;
+	int i;
+
+	interruptFlag = k_setInterruptFlag(false);
+
+	currentApicId = k_getApicId();
+
+	// flush TLB of current core.
+	if (k_readCr3() == (qword)addressSpace->pml4) {
+		if (virtualAddr == VMEM_FLUSHALL) {
+			k_writeCr3((qword)addressSpace->pml4);
+
+		} else {
+			k_invalidatePage(virtualAddr);
+		}
+	}
+
+	if (k_getProcessorCount() <= 1) {
+		k_setInterruptFlag(interruptFlag);
+		return;
+	}
+
+	// lock shootdown manager, while processing shootdown request of another core.
+	while (k_testAndSet(&(g_tlbShootdownManager.lockFlag), 0, 1) == false) {
+		k_processTlbShootdown();
+		k_pause();
+	}
+
+	g_tlbShootdownManager.cr3 = (qword)addressSpace->pml4;
+	g_tlbShootdownManager.virtualAddr = virtualAddr;
+
+	// send IPI to the other cores running address space.
+	// [NOTE] Scheduler spinlock in k_getRunningTask orders page table change before reading running task.
+	for (i = 0; i < k_getProcessorCount(); i++) {
+		if (i == currentApicId) {
+			continue;
+		}
+
+		runningTask = k_getRunningTask(i);
+		if ((runningTask == null) || (runningTask->addressSpace != addressSpace)) {
+			continue;
+		}
+
+		g_tlbShootdownManager.pendings[i] = true;
+		k_sendIpiToLocalApic(i, LAPIC_VECTOR_TLBSHOOTDOWN);
+	}
+
+	// wait until all target cores flush TLB.
+	for (i = 0; i < k_getProcessorCount(); i++) {
+		while (g_tlbShootdownManager.pendings[i] == true) {
+			k_pause();
+		}
+	}
+
+	g_tlbShootdownManager.lockFlag = 0;
+
+	k_setInterruptFlag(interruptFlag);
+}
+
+void k_processTlbShootdown(void) {
+	byte apicId;
+
+	apicId = k_getApicId();
+	if (g_tlbShootdownManager.pendings[apicId] == false) {
+		return;
+	}
+
+	// If current core has switched to another address space already, TLB has been flushed by CR3.
+	if (k_readCr3() == g_tlbShootdownManager.cr3) {
+		if (g_tlbShootdownManager.virtualAddr == VMEM_FLUSHALL) {
+			k_writeCr3(g_tlbShootdownManager.cr3);
+
+		} else {
+			k_invalidatePage(g_tlbShootdownManager.virtualAddr);
+		}
+	}
+
+	g_tlbShootdownManager.pendings[apicId] = false;
+}
@@ -0,0 +1,165 @@
+#ifndef __CORE_VIRTUALMEM_H__
+#define __CORE_VIRTUALMEM_H__
+
+#include "types.h"
+#include "sync.h"
+#include "multiprocessor.h"
+
+/**
+  < Per-Process Address Space >
+  - Kernel address space is the PML4 table <0x100000> built by kernel32, which maps 0 ~ 64 GB identically with 2 MB pages.
+  - Address space of user process has its own PML4 table.
+    - PML4 entry 0 (0 ~ 512 GB)     : shared with kernel address space. (kernel, dynamic memory, frame memory, video memory)
+    - PML4 entry 1 (512 GB ~ 1 TB)  : user space which is private to process, and is mapped with 4 KB pages.
+  - User space consists of virtual regions, which are populated lazily by page fault handler.
+
+  < User Space Layout >
+    512 GB ------------------------------- 768 GB -------------------------------------------- 1 TB
+           | code/data (sections of app) | ... | file views | ... |          stack (16 MB) |
+           -------------------------------------------------------------------------------------
+             ^ file data + zero (BSS)            ^ pages of file mapping    ^ zero (grows down)
+
+  < Demand Paging >
+  1. app manager relocates app image in file buffer, and adds virtual regions of sections and stack to address space.
+  2. When app touches a page first, page fault (#14) occurs.
+  3. page fault handler allocates a page, fills it with file data (or zero), and maps it to the faulted address.
+  4. processor re-executes the faulted instruction.
+  [NOTE] Kernel also touches user space in system call, so page fault can occur in kernel mode (Ring 0) too.
+         But, interrupt handlers must not touch user space, because all exceptions and interrupts share IST.
+
+  < File View >
+  - A file view region is backed by pages of file mapping (file system), and mapped read-only without copy.
+  - Page fault handler gets a page from file mapping. If it's being read from hard disk, page fault handler can't sleep,
+    so it gives up the rest of processor time, and the faulted instruction faults again until the page is ready.
+  - Pages of file view aren't owned by address space (NOFREE), so they're neither shared nor freed with page tables.
+    They're freed by file mapping after all views are removed.
+*/
+
+/**
+  < Copy-on-Write Clone >
+  - Cloning an address space copies only its page tables, and mapped pages are shared by both address spaces.
+    - Shared pages are marked read-only and copy-on-write (COW), and their reference counts are increased.
+    - Not-yet-mapped pages are populated from the app image, which is also shared with reference count.
+  - When a process writes a COW page first, page fault (#14) occurs with P and W/R bits in error code.
+    - If the page is still shared, page fault handler copies it to a new page, and maps the new page writable.
+    - If the page is no longer shared (reference count 1), page fault handler just makes it writable.
+  [NOTE] CR0.WP is set by kernel32, so kernel writing COW pages in system call also causes page fault.
+*/
+
+/**
+  < TLB Shootdown >
+  - When a mapping loses permission (clone makes pages read-only) or is replaced (COW break maps a new page),
+    the other cores running the same address space might still have the old mapping in their TLB.
+  - So, the core which changed page table sends TLB shootdown IPI to those cores, and waits until all of them flush TLB.
+    - target cores: cores whose running task is in the address space. (A core switching to another address space flushes TLB by CR3 anyway.)
+    - The old page of COW break is freed after shootdown, so that no core can access it through stale TLB entry.
+  [NOTE] A core waiting for spinlock with interrupt disabled can't receive IPI, so it processes shootdown request while spinning.
+*/
+
+// page table entry flags (64 bits)
+#define VMEM_FLAGS_P        0x0000000000000001 // present
+#define VMEM_FLAGS_RW       0x0000000000000002 // read/write
+#define VMEM_FLAGS_US       0x0000000000000004 // user/supervisor
+#define VMEM_FLAGS_COW      0x0000000000000200 // copy-on-write (bit 9: available to software)
+#define VMEM_FLAGS_NOFREE   0x0000000000000400 // not owned page (bit 10: available to software): page of file view
+#define VMEM_FLAGS_USERPAGE (VMEM_FLAGS_P | VMEM_FLAGS_RW | VMEM_FLAGS_US)
+#define VMEM_FLAGS_VIEWPAGE (VMEM_FLAGS_P | VMEM_FLAGS_US | VMEM_FLAGS_NOFREE) // read-only page of file view
+#define VMEM_ADDRMASK       0x000FFFFFFFFFF000 // base address field (bit 12~51)
+
+// page fault error code
+#define VMEM_PFERROR_P    0x01 // present: 1: protection violation, 0: not-present page
+#define VMEM_PFERROR_WR   0x02 // write/read: 1: write, 0: read
+#define VMEM_PFERROR_US   0x04 // user/supervisor: 1: user mode, 0: kernel mode
+#define VMEM_PFERROR_RSVD 0x08 // reserved bit violation
+
+// page and page table
+#define VMEM_PAGESIZE        0x1000 // 4 KB
+#define VMEM_MAXENTRYCOUNT   512
+
+// kernel address space
+#define VMEM_KERNELPML4ADDRESS 0x100000 // 1 MB: PML4 table built by kernel32
+
+// user space
+#define VMEM_USERSPACEPML4INDEX    1
+#define VMEM_USERSPACESTARTADDRESS 0x0000008000000000 // 512 GB
+#define VMEM_USERSPACEENDADDRESS   0x0000010000000000 // 1 TB
+#define VMEM_USERSTACKSIZE         (16 * 1024 * 1024) // 16 MB: reserved, and mapped lazily.
+#define VMEM_USERSTACKSTARTADDRESS (VMEM_USERSPACEENDADDRESS - VMEM_USERSTACKSIZE)
+#define VMEM_FILEVIEWSTARTADDRESS  0x000000C000000000 // 768 GB: file views are mapped from here to user stack.
+
+// max virtual region count of address space
+#define VMEM_MAXREGIONCOUNT 32
+
+// virtual address which means flushing all TLB entries of address space
+#define VMEM_FLUSHALL 0xFFFFFFFFFFFFFFFF
+
+/* macro functions */
+#define VMEM_PML4INDEX(addr) (((addr) >> 39) & 0x1FF)
+#define VMEM_PDPTINDEX(addr) (((addr) >> 30) & 0x1FF)
+#define VMEM_PDINDEX(addr)   (((addr) >> 21) & 0x1FF)
+#define VMEM_PTINDEX(addr)   (((addr) >> 12) & 0x1FF)
+
+#pragma pack(push, 1)
+
+typedef struct k_VirtualRegion {
+	qword startAddr;               // start address (user virtual address)
+	qword size;                    // region size
+	const byte* fileData;          // file data: It's copied to page when page is touched first. (null if region is zero-filled, such as BSS and stack.)
+	qword fileSize;                // file data size: The rest of region after file data is zero-filled.
+	struct k_FileMapping* mapping; // file mapping which pages of region come from (null if region isn't file view)
+} VirtualRegion;
+
+typedef struct k_AddressSpace {
+	Spinlock spinlock;                          // spinlock
+	qword* pml4;                                // PML4 table: Physical address is same as kernel address, because it's allocated from frame memory.
+	byte* image;                                // app image which file data of regions points to: It's freed with the last address space sharing it.
+	qword* imageRefCount;                       // reference count of app image shared by cloned address spaces (null if not shared yet)
+	VirtualRegion regions[VMEM_MAXREGIONCOUNT]; // virtual regions
+	int regionCount;                            // virtual region count
+	qword mappedPageCount;                      // mapped page count (except page tables)
+	byte node;                                  // NUMA node which pages and page tables are allocated from
+} AddressSpace;
+
+typedef struct k_TlbShootdownManager {
+	volatile byte lockFlag;                     // lock flag: Spinlock can't be used, because waiting core must process shootdown request.
+	volatile qword cr3;                         // CR3 of address space to flush
+	volatile qword virtualAddr;                 // virtual address of page to flush (VMEM_FLUSHALL if all entries)
+	volatile bool pendings[MAXPROCESSORCOUNT];  // pending flags by core: Target core clears its own flag after flushing TLB.
+} TlbShootdownManager;
+
+#pragma pack(pop)
+
+/* Page Functions */
+void k_initVirtualMem(void);
+static void* k_allocPage(byte node); // allocate a zero-filled 4 KB frame from NUMA node.
+
+/* Address Space Functions */
+AddressSpace* k_createAddressSpace(void);
+void k_deleteAddressSpace(AddressSpace* addressSpace);
+bool k_addVirtualRegion(AddressSpace* addressSpace, qword startAddr, qword size, const byte* fileData, qword fileSize);
+qword k_getAddressSpaceCr3(const AddressSpace* addressSpace); // get CR3 value of address space: kernel address space if null.
+void k_switchAddressSpace(const AddressSpace* addressSpace);
+bool k_copyToAddressSpace(AddressSpace* addressSpace, qword destAddr, const void* src, qword size);
+static qword* k_getPtEntry(AddressSpace* addressSpace, qword virtualAddr, bool create);
+static byte* k_populatePage(AddressSpace* addressSpace, qword virtualAddr); // map page and return its kernel address.
+static void k_freePageTable(qword* table, int level);
+static VirtualRegion* k_findVirtualRegion(AddressSpace* addressSpace, qword virtualAddr);
+
+/* File View Functions */
+qword k_addFileViewRegion(AddressSpace* addressSpace, qword size, struct k_FileMapping* mapping); // return start address of view (0 if fails).
+struct k_FileMapping* k_removeFileViewRegion(AddressSpace* addressSpace, qword startAddr);     // return file mapping of removed view (null if fails).
+static bool k_populateViewPage(AddressSpace* addressSpace, VirtualRegion* region, qword virtualAddr);
+
+/* Copy-on-Write Functions */
+AddressSpace* k_cloneAddressSpace(AddressSpace* addressSpace);
+static bool k_clonePageTable(qword* srcTable, qword* destTable, int level, byte node);
+static byte* k_getWritablePage(AddressSpace* addressSpace, qword virtualAddr, byte** oldPage); // map page, break copy-on-write, and return its kernel address.
+
+/* TLB Shootdown Functions */
+void k_flushTlb(AddressSpace* addressSpace, qword virtualAddr); // flush TLB entries of address space on all cores running it.
+void k_processTlbShootdown(void); // process shootdown request to current core.
+
+/* Page Fault Functions */
+bool k_handlePageFault(qword faultAddr, qword errorCode);
+
+#endif // __CORE_VIRTUALMEM_H__
@@ -13,7 +13,6 @@ static WindowPoolManager g_windowPoolManager;
 static WindowManager g_windowManager;
 
 static void k_initWindowPool(void) {
-	int i;
 	void* windowPoolAddr;
 
 	// initialize window pool manager.
@@ -29,16 +28,13 @@ static void k_initWindowPool(void) {
 	}
 
 	// initialize window pool.
+	// link free windows through the low 32 bits of window ID, so allocated window count (high 32 bits) of free window ID remains 0.
 	g_windowPoolManager.startAddr = (Window*)windowPoolAddr;
 	k_memset(windowPoolAddr, 0, sizeof(Window) * WINDOW_MAXCOUNT);
+	k_initPool(&(g_windowPoolManager.pool), windowPoolAddr, sizeof(Window), WINDOW_MAXCOUNT, offsetof(Window, link) + offsetof(ListLink, id), 
+	           g_windowPoolManager.usedIndexes, g_windowPoolManager.usedPositions);
 
-	// set window ID (offset) to windows in pool.
-	for (i = 0; i < WINDOW_MAXCOUNT; i++) {
-		g_windowPoolManager.startAddr[i].link.id = i;
-	}
-
-	// initialize max window count and allocated window count.
-	g_windowPoolManager.maxCount = WINDOW_MAXCOUNT;
+	// initialize allocated window count.
 	g_windowPoolManager.allocatedCount = 1;
 
 	// initialize mutex of window pool manager.
@@ -51,24 +47,19 @@ static Window* k_allocWindow(void) {
 
 	k_lock(&g_windowPoolManager.mutex);
 
-	if (g_windowPoolManager.usedCount >= g_windowPoolManager.maxCount) {
+	// pop free window from free list of window pool.
+	emptyWindow = (Window*)k_allocPool(&(g_windowPoolManager.pool));
+	if (emptyWindow == null) {
 		k_unlock(&g_windowPoolManager.mutex);
 		return null;
 	}
 
-	for (i = 0; i < g_windowPoolManager.maxCount; i++) {
-		// If allocated window count (high 32 bits) of window ID == 0, it's not allocated.
-		if ((g_windowPoolManager.startAddr[i].link.id >> 32) == 0) {
-			emptyWindow = &(g_windowPoolManager.startAddr[i]);
-			break;
-		}
-	}
+	i = k_getPoolIndex(&(g_windowPoolManager.pool), emptyWindow);
 
 	// set not-0 to allocated window count (high 32 bits) of window ID in order to mark it allocated.
 	// window ID consists of allocated window count (high 32 bits) and window offset (low 32 bits).
 	emptyWindow->link.id = (((qword)g_windowPoolManager.allocatedCount) << 32) | i;
 
-	g_windowPoolManager.usedCount++;
 	g_windowPoolManager.allocatedCount++;
 	if (g_windowPoolManager.allocatedCount == 0) {
 		g_windowPoolManager.allocatedCount = 1;
@@ -91,13 +82,10 @@ static void k_freeWindow(qword windowId) {
 	k_lock(&g_windowPoolManager.mutex);
 
 	// initialize window.
+	// set 0 to allocated window count (high 32 bits) of window ID in order to mark it free,
+	// and push window to free list of window pool (low 32 bits of window ID become the next free window offset).
 	k_memset(&(g_windowPoolManager.startAddr[i]), 0, sizeof(Window));
-
-	// initialize window ID.
-	// set 0 to allocated window count (high 32 bits) of window ID in order to mark it free.
-	g_windowPoolManager.startAddr[i].link.id = i;
-
-	g_windowPoolManager.usedCount--;
+	k_freePool(&(g_windowPoolManager.pool), &(g_windowPoolManager.startAddr[i]));
 
 	k_unlock(&g_windowPoolManager.mutex);
 }
@@ -2184,6 +2172,204 @@ static void k_drawBackgroundImage(void) {
 	k_freeMem(jpeg);
 }
 
+void k_initDisplayList(DisplayList* list, DrawCommand* commands, int maxCount) {
+	list->commands = commands;
+	list->maxCount = maxCount;
+	k_clearDisplayList(list);
+}
+
+void k_clearDisplayList(DisplayList* list) {
+	list->count = 0;
+	k_setRect(&list->bound, 0, 0, 0, 0);
+}
+
+static DrawCommand* k_addDrawCommand(DisplayList* list, byte type, int x1, int y1, int x2, int y2) {
+	DrawCommand* command;
+
+	if (list->count >= list->maxCount) {
+		return null;
+	}
+
+	command = &list->commands[list->count];
+	command->type = type;
+	k_setRect(&command->bound, x1, y1, x2, y2);
+
+	// extend bounding area of display list to include the command.
+	if (list->count == 0) {
+		k_memcpy(&list->bound, &command->bound, sizeof(Rect));
+
+	} else {
+		list->bound.x1 = MIN(list->bound.x1, command->bound.x1);
+		list->bound.y1 = MIN(list->bound.y1, command->bound.y1);
+		list->bound.x2 = MAX(list->bound.x2, command->bound.x2);
+		list->bound.y2 = MAX(list->bound.y2, command->bound.y2);
+	}
+
+	list->count++;
+
+	return command;
+}
+
+bool k_recordPixel(DisplayList* list, int x, int y, Color color) {
+	DrawCommand* command;
+
+	command = k_addDrawCommand(list, DRAWCOMMAND_PIXEL, x, y, x, y);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = color;
+	command->x1 = x;
+	command->y1 = y;
+
+	return true;
+}
+
+bool k_recordLine(DisplayList* list, int x1, int y1, int x2, int y2, Color color) {
+	DrawCommand* command;
+
+	command = k_addDrawCommand(list, DRAWCOMMAND_LINE, x1, y1, x2, y2);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = color;
+	command->x1 = x1;
+	command->y1 = y1;
+	command->x2 = x2;
+	command->y2 = y2;
+
+	return true;
+}
+
+bool k_recordRect(DisplayList* list, int x1, int y1, int x2, int y2, Color color, bool fill) {
+	DrawCommand* command;
+
+	command = k_addDrawCommand(list, DRAWCOMMAND_RECT, x1, y1, x2, y2);
+	if (command == null) {
+		return false;
+	}
+
+	command->fill = fill;
+	command->color = color;
+	command->x1 = x1;
+	command->y1 = y1;
+	command->x2 = x2;
+	command->y2 = y2;
+
+	return true;
+}
+
+bool k_recordCircle(DisplayList* list, int x, int y, int radius, Color color, bool fill) {
+	DrawCommand* command;
+
+	command = k_addDrawCommand(list, DRAWCOMMAND_CIRCLE, x - radius, y - radius, x + radius, y + radius);
+	if (command == null) {
+		return false;
+	}
+
+	command->fill = fill;
+	command->color = color;
+	command->x1 = x;
+	command->y1 = y;
+	command->x2 = radius;
+
+	return true;
+}
+
+bool k_recordText(DisplayList* list, int x, int y, Color textColor, Color backgroundColor, const char* str, int len) {
+	DrawCommand* command;
+
+	if (len <= 0) {
+		return false;
+	}
+
+	command = k_addDrawCommand(list, DRAWCOMMAND_TEXT, x, y, x + (FONT_DEFAULT_WIDTH * len) - 1, y + FONT_DEFAULT_HEIGHT - 1);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = textColor;
+	command->backgroundColor = backgroundColor;
+	command->x1 = x;
+	command->y1 = y;
+	command->str = str;
+	command->len = len;
+
+	return true;
+}
+
+bool k_drawDisplayList(qword windowId, const DisplayList* list, const Rect* damageArea) {
+	Window* window;
+	Rect area;
+	Rect clipArea;
+	Rect overArea;
+	const DrawCommand* command;
+	int i;
+
+	window = k_getWindowWithLock(windowId);
+	if (window == null) {
+		return false;
+	}
+
+	// set clipping area on window coordinates.
+	k_setRect(&area, 0, 0, window->area.x2 - window->area.x1, window->area.y2 - window->area.y1);
+
+	// narrow clipping area down to damaged area and bounding area of display list.
+	k_memcpy(&clipArea, &area, sizeof(Rect));
+	if (((damageArea != null) && (k_getOverlappedRect(&clipArea, damageArea, &clipArea) == false)) ||
+	    (list->count == 0) || (k_getOverlappedRect(&clipArea, &list->bound, &clipArea) == false)) {
+		k_unlock(&window->mutex);
+		return true;
+	}
+
+	// draw all commands under a lock.
+	// [NOTE] Commands out of clipping area are skipped, and only filled rectangles are clipped exactly to clipping area.
+	//        Other commands overlapped with clipping area are drawn whole (clipped to window area),
+	//        because rasterizers use a single area as both buffer dimension and clipping area.
+	for (i = 0; i < list->count; i++) {
+		command = &list->commands[i];
+		if (k_isRectOverlapped(&clipArea, &command->bound) == false) {
+			continue;
+		}
+
+		switch (command->type) {
+		case DRAWCOMMAND_PIXEL:
+			__k_drawPixel(window->buffer, &area, command->x1, command->y1, command->color);
+			break;
+
+		case DRAWCOMMAND_LINE:
+			__k_drawLine(window->buffer, &area, command->x1, command->y1, command->x2, command->y2, command->color);
+			break;
+
+		case DRAWCOMMAND_RECT:
+			if (command->fill == true) {
+				k_getOverlappedRect(&clipArea, &command->bound, &overArea);
+				__k_drawRect(window->buffer, &area, overArea.x1, overArea.y1, overArea.x2, overArea.y2, command->color, true);
+
+			} else {
+				__k_drawRect(window->buffer, &area, command->x1, command->y1, command->x2, command->y2, command->color, false);
+			}
+			break;
+
+		case DRAWCOMMAND_CIRCLE:
+			__k_drawCircle(window->buffer, &area, command->x1, command->y1, command->x2, command->color, command->fill);
+			break;
+
+		case DRAWCOMMAND_TEXT:
+			__k_drawText(window->buffer, &area, command->x1, command->y1, command->color, command->backgroundColor, command->str, command->len);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	k_unlock(&window->mutex);
+
+	return true;
+}
+
 // mouse cursor bitmap (10 * 18 = 180 bytes)
 // - A byte in bitmap represents a color (16 bits) in video memory or a pixel (16 bits) in screen.
 static byte g_mouseCursorBitmap[MOUSE_CURSOR_WIDTH * MOUSE_CURSOR_HEIGHT] = {
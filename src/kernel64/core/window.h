@@ -6,6 +6,7 @@
 #include "sync.h"
 #include "../utils/list.h"
 #include "../utils/queue.h"
+#include "../utils/pool.h"
 #include "keyboard.h"
 #include "widgets.h"
 
@@ -242,11 +243,12 @@ typedef struct k_Window {
 } Window; // Window is ListItem.
 
 typedef struct k_WindowPoolManager {
-	Mutex mutex;        // mutex
-	Window* startAddr;  // start address of window pool: You can consider it as window array.
-	int maxCount;       // max window count
-	int usedCount;      // used window count: currently being-used window count.
-	int allocatedCount; // allocated window count: It only increases when allocating window. It's for window ID to be unique.
+	Mutex mutex;                        // mutex
+	Window* startAddr;                  // start address of window pool: You can consider it as window array.
+	Pool pool;                          // window pool: free windows are linked through the low 32 bits of window ID.
+	int allocatedCount;                 // allocated window count: It only increases when allocating window. It's for window ID to be unique.
+	int usedIndexes[WINDOW_MAXCOUNT];   // used index array of window pool
+	int usedPositions[WINDOW_MAXCOUNT]; // used position array of window pool
 } WindowPoolManager;
 
 typedef struct k_WindowManager {
@@ -360,6 +362,17 @@ bool k_drawText(qword windowId, int x, int y, Color textColor, Color backgroundC
 bool k_bitblt(qword windowId, int x, int y, const Color* buffer, int width, int height);
 static void k_drawBackgroundImage(void);
 
+/* Display List Functions: record objects to display list using window coordinates, and draw them at once */
+void k_initDisplayList(DisplayList* list, DrawCommand* commands, int maxCount);
+void k_clearDisplayList(DisplayList* list);
+static DrawCommand* k_addDrawCommand(DisplayList* list, byte type, int x1, int y1, int x2, int y2);
+bool k_recordPixel(DisplayList* list, int x, int y, Color color);
+bool k_recordLine(DisplayList* list, int x1, int y1, int x2, int y2, Color color);
+bool k_recordRect(DisplayList* list, int x1, int y1, int x2, int y2, Color color, bool fill);
+bool k_recordCircle(DisplayList* list, int x, int y, int radius, Color color, bool fill);
+bool k_recordText(DisplayList* list, int x, int y, Color textColor, Color backgroundColor, const char* str, int len);
+bool k_drawDisplayList(qword windowId, const DisplayList* list, const Rect* damageArea); // window coordinates
+
 /* Mouse Cursor Functions */
 static void k_drawMouseCursor(int x, int y); // draw mouse cursor in video memory using screen coordinates.  
 void k_moveMouseCursor(int x, int y); // screen coordinates
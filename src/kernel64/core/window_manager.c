@@ -6,6 +6,7 @@
 #include "task.h"
 #include "../gui_tasks/system_menu.h"
 #include "widgets.h"
+#include "boot_profile.h"
 
 /**
   < Screen Update Performance Test >
@@ -35,6 +36,7 @@ void k_windowManagerTask(void) {
 	bool keyResult;
 	bool windowManagerResult;
 	WindowManager* windowManager;
+	bool firstFrame;
 	#if __DEBUG__
 	/* Screen Update Performance Test */
 	qword lastTickCount;
@@ -44,6 +46,7 @@ void k_windowManagerTask(void) {
 	
 	// initialize GUI system.
 	k_initGuiSystem();
+	k_addBootPhase("initialize GUI system");
 	
 	// draw mouse cursor at current mouse position (center in screen).
 	k_getMouseCursorPos(&mouseX, &mouseY);
@@ -65,6 +68,8 @@ void k_windowManagerTask(void) {
 	prevLoopCount = 0;
 	#endif // __DEBUG__
 	
+	firstFrame = true;
+	
 	/* window manager task loop */
 	while (true) {
 		#if __DEBUG__
@@ -104,6 +109,12 @@ void k_windowManagerTask(void) {
 		// draw all clocks.
 		k_drawAllClocks();
 		
+		// record the end of boot after the first GUI frame has been drawn.
+		if (firstFrame == true) {
+			k_addBootPhase("draw the first GUI frame");
+			firstFrame = false;
+		}
+		
 		// If no data/events have been processed, switch task.
 		if ((mouseResult == false) && (keyResult == false) && (windowManagerResult == false)) {
 			k_sleep(0);
@@ -135,11 +135,8 @@ static void k_drawFileName(qword windowId, Rect* area, const char* fileName, int
 }
 
 static bool k_showImage(qword mainWindowId, const char* fileName) {
-	Dir* dir;
-	dirent* entry;
 	dword fileSize;
-	File* file = null;
-	byte* fileBuffer = null;
+	const byte* fileBuffer = null;
 	Jpeg* jpeg = null;
 	Color* imageBuffer = null;
 	Rect screenArea;
@@ -151,65 +148,25 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 	int imageWidth, imageHeight;
 	bool exit;
 	
-	/* search image file in root directory */
-	dir = opendir("/");
+	/* map image file and decode it: decode directly from the view without copying file to a private buffer */
 	fileSize = 0;
-
-	while (true) {
-		entry = readdir(dir);
-		if (entry == null) {
-			break;
-		}
-
-		if (k_equalStr(entry->d_name, fileName) == true) {
-			fileSize = entry->d_size;
-			break;
-		}
-	}
-
-	closedir(dir);
-
-	if (fileSize == 0) {
+	fileBuffer = (const byte*)k_mapFile(fileName, &fileSize);
+	if ((fileBuffer == null) || (fileSize == 0)) {
 		k_printf("[image viewer error] %s does not exist or is zero-sized.\n", fileName);
 		return false;
 	}
 
-	/* read image file and decode it */
-	file = fopen(fileName, "rb");
-	if (file == null) {
-		k_printf("[image viewer error] %s opening failure\n", fileName);
-		return false;
-	}
-
-	fileBuffer = (byte*)k_allocMem(fileSize);
-	if (fileBuffer == null) {
-		k_printf("[image viewer error] file buffer allocation failure\n");
-		fclose(file);
-		return false;
-	}
-
 	jpeg = (Jpeg*)k_allocMem(sizeof(Jpeg));
 	if (jpeg == null) {
 		k_printf("[image viewer error] JPEG allocation failure\n");
-		k_freeMem(fileBuffer);
-		fclose(file);
+		k_unmapFile(fileBuffer);
 		return false;
 	}
 
-	if (fread(fileBuffer, 1, fileSize, file) != fileSize) {
-		k_printf("[image viewer error] %s reading failure\n", fileName);
-		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
-		fclose(file);
-		return false;
-	}
-
-	fclose(file);
-
 	if (k_initJpeg(jpeg, fileBuffer, fileSize) == false) {
 		k_printf("[image viewer error] JPEG initialization failure\n");
 		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
+		k_unmapFile(fileBuffer);
 		return false;
 	}
 	
@@ -217,7 +174,7 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 	if (imageBuffer == null) {
 		k_printf("[image viewer error] image buffer allocation failure\n");
 		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
+		k_unmapFile(fileBuffer);
 		return false;
 	}
 
@@ -225,7 +182,7 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 		k_printf("[image viewer error] JPEG decoding failure\n");
 		k_freeMem(imageBuffer);
 		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
+		k_unmapFile(fileBuffer);
 		return false;
 	}
 
@@ -235,7 +192,7 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 		k_printf("[image viewer error] image viewer creation failure\n");
 		k_freeMem(imageBuffer);
 		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
+		k_unmapFile(fileBuffer);
 		return false;	
 	}	
 
@@ -245,7 +202,7 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 		k_deleteWindow(windowId);
 		k_freeMem(imageBuffer);
 		k_freeMem(jpeg);
-		k_freeMem(fileBuffer);
+		k_unmapFile(fileBuffer);
 		return false;		
 	}
 
@@ -260,7 +217,7 @@ static bool k_showImage(qword mainWindowId, const char* fileName) {
 	// Do not free image buffer here in order to reuse it when EVENT_WINDOW_RESIZE event receives.
 	//k_freeMem(imageBuffer);
 	k_freeMem(jpeg);
-	k_freeMem(fileBuffer);
+	k_unmapFile(fileBuffer);
 
 	k_showWindow(windowId, true);
 	k_showWindow(mainWindowId, false);
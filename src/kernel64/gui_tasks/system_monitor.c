@@ -5,6 +5,7 @@
 #include "../core/mp_config_table.h"
 #include "../core/task.h"
 #include "../core/dynamic_mem.h"
+#include "../core/frame_mem.h"
 #include "../fonts/fonts.h"
 
 void k_systemMonitorTask(void) {
@@ -16,6 +17,7 @@ void k_systemMonitorTask(void) {
 	qword lastTickCount;
 	qword lastDynamicMemUsedSize;
 	qword dynamicMemUsedSize;
+	qword frameMemUsedSize;
 	Event event;
 	bool changed;
 	int i;
@@ -108,6 +110,8 @@ void k_systemMonitorTask(void) {
 
 		/* print memory info */
 		k_getDynamicMemInfo(null, null, null, &dynamicMemUsedSize);
+		k_getFrameMemInfo(null, null, &frameMemUsedSize, null);
+		dynamicMemUsedSize += frameMemUsedSize;
 
 		if (dynamicMemUsedSize != lastDynamicMemUsedSize) {
 			lastDynamicMemUsedSize = dynamicMemUsedSize;
@@ -164,6 +168,7 @@ static void k_drawMemoryInfo(qword windowId, int y, int windowWidth) {
 	qword totalRamSize;        // total RAM size (MB)
 	qword dynamicMemStartAddr; // dynamic memory start address (kernel used size)
 	qword dynamicMemUsedSize;  // dynamic memory used size
+	qword frameMemUsedSize;    // frame memory used size
 	qword memoryUsage;         // memory usage (%)
 	qword usageBarWidth;
 	int middleX;
@@ -171,6 +176,8 @@ static void k_drawMemoryInfo(qword windowId, int y, int windowWidth) {
 
 	totalRamSize = k_getTotalRamSize();
 	k_getDynamicMemInfo(&dynamicMemStartAddr, null, null, &dynamicMemUsedSize);
+	k_getFrameMemInfo(null, null, &frameMemUsedSize, null);
+	dynamicMemUsedSize += frameMemUsedSize;
 
 	/* print total size and used size */
 	k_sprintf(buffer, "- total : %d MB", totalRamSize);
@@ -182,7 +189,7 @@ static void k_drawMemoryInfo(qword windowId, int y, int windowWidth) {
 	// draw bar border.
 	k_drawRect(windowId, SYSMTR_MEMORY_SIDEMARGIN, y + 40, windowWidth - SYSMTR_MEMORY_SIDEMARGIN, y + SYSMTR_MEMORY_HEIGHT - 32, RGB(0, 0, 0), false);
 
-	// memory usage (%) = (kernel used size + dynamic memory used size) * 100 / total RAM size
+	// memory usage (%) = (kernel used size + dynamic memory used size + frame memory used size) * 100 / total RAM size
 	memoryUsage = (dynamicMemStartAddr + dynamicMemUsedSize) * 100 / 1024 / 1024 / totalRamSize;
 	if (memoryUsage > 100) {
 		memoryUsage = 100;
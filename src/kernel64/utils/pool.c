@@ -0,0 +1,124 @@
+#include "pool.h"
+
+void k_initPool(Pool* pool, void* array, int dataSize, int maxDataCount, int linkOffset, int* usedIndexes, int* usedPositions) {
+	int i;
+	
+	pool->dataSize = dataSize;
+	pool->maxDataCount = maxDataCount;
+	pool->array = array;
+	pool->linkOffset = linkOffset;
+	pool->usedCount = 0;
+	pool->usedIndexes = usedIndexes;
+	pool->usedPositions = usedPositions;
+	
+	// link all objects to free list in index order, so objects are allocated from the start of pool at first.
+	for (i = 0; i < maxDataCount; i++) {
+		*k_getPoolLink(pool, i) = (i == (maxDataCount - 1)) ? POOL_INVALIDINDEX : (i + 1);
+		usedPositions[i] = POOL_INVALIDINDEX;
+	}
+	
+	pool->freeIndex = (maxDataCount > 0) ? 0 : POOL_INVALIDINDEX;
+}
+
+bool k_isPoolFull(const Pool* pool) {
+	if (pool->freeIndex == POOL_INVALIDINDEX) {
+		return true;
+	}
+	
+	return false;
+}
+
+void* k_allocPool(Pool* pool) {
+	int index;
+	
+	if (k_isPoolFull(pool) == true) {
+		return null;
+	}
+	
+	// pop object from the head of free list.
+	index = pool->freeIndex;
+	pool->freeIndex = *k_getPoolLink(pool, index);
+	
+	// append object to the end of used index array.
+	pool->usedIndexes[pool->usedCount] = index;
+	pool->usedPositions[index] = pool->usedCount;
+	pool->usedCount++;
+	
+	return k_getPoolData(pool, index);
+}
+
+bool k_freePool(Pool* pool, void* data) {
+	int index;
+	int position;
+	int lastIndex;
+	
+	index = k_getPoolIndex(pool, data);
+	if ((index == POOL_INVALIDINDEX) || (pool->usedPositions[index] == POOL_INVALIDINDEX)) {
+		return false;
+	}
+	
+	// remove object from used index array by moving the last used index to its position.
+	position = pool->usedPositions[index];
+	lastIndex = pool->usedIndexes[pool->usedCount - 1];
+	pool->usedIndexes[position] = lastIndex;
+	pool->usedPositions[lastIndex] = position;
+	pool->usedPositions[index] = POOL_INVALIDINDEX;
+	pool->usedCount--;
+	
+	// push object to the head of free list.
+	*k_getPoolLink(pool, index) = pool->freeIndex;
+	pool->freeIndex = index;
+	
+	return true;
+}
+
+int k_getPoolIndex(const Pool* pool, const void* data) {
+	qword offset;
+	
+	if (((qword)data < (qword)pool->array) || ((qword)data >= ((qword)pool->array + ((qword)pool->dataSize * pool->maxDataCount)))) {
+		return POOL_INVALIDINDEX;
+	}
+	
+	offset = (qword)data - (qword)pool->array;
+	if ((offset % pool->dataSize) != 0) {
+		return POOL_INVALIDINDEX;
+	}
+	
+	return (int)(offset / pool->dataSize);
+}
+
+void* k_getPoolData(const Pool* pool, int index) {
+	if ((index < 0) || (index >= pool->maxDataCount)) {
+		return null;
+	}
+	
+	return (void*)((qword)pool->array + ((qword)pool->dataSize * index));
+}
+
+bool k_isPoolDataUsed(const Pool* pool, int index) {
+	if ((index < 0) || (index >= pool->maxDataCount)) {
+		return false;
+	}
+	
+	if (pool->usedPositions[index] == POOL_INVALIDINDEX) {
+		return false;
+	}
+	
+	return true;
+}
+
+int k_getPoolUsedCount(const Pool* pool) {
+	return pool->usedCount;
+}
+
+void* k_getPoolUsedData(const Pool* pool, int position) {
+	if ((position < 0) || (position >= pool->usedCount)) {
+		return null;
+	}
+	
+	return k_getPoolData(pool, pool->usedIndexes[position]);
+}
+
+static int* k_getPoolLink(const Pool* pool, int index) {
+	return (int*)((qword)pool->array + ((qword)pool->dataSize * index) + pool->linkOffset);
+}
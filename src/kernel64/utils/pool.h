@@ -0,0 +1,48 @@
+#ifndef __UTILS_POOL_H__
+#define __UTILS_POOL_H__
+
+#include "../core/types.h"
+
+// etc macros
+#define POOL_INVALIDINDEX -1
+
+#pragma pack(push, 1)
+
+/**
+  < Pool Object Definition Example >
+      typedef struct k_PoolObject {
+          char data1;
+          int link; // [NOTE] Pool overwrites this field (4 bytes) while object is free.
+          int data2;
+      } PoolObject;
+      
+      k_initPool(&pool, array, sizeof(PoolObject), maxCount, offsetof(PoolObject, link), usedIndexes, usedPositions);
+*/
+
+// general fixed-capacity object pool: allocating, freeing and checking object are O(1).
+typedef struct k_Pool {
+	int dataSize;
+	int maxDataCount;
+	void* array;        // array (buffer) address: save address of array user declared in order to make pool general.
+	int linkOffset;     // link offset: offset of 4 bytes-sized field in object which links free objects (intrusive free list).
+	int freeIndex;      // head object index of free list (-1:pool is full)
+	int usedCount;      // used object count
+	int* usedIndexes;   // used index array: indexes of used objects packed from 0 to (usedCount - 1), so used objects are walked without scanning pool.
+	int* usedPositions; // used position array: position of each object in used index array (-1:free object)
+} Pool;
+
+#pragma pack(pop)
+
+/* Pool Functions */
+void k_initPool(Pool* pool, void* array, int dataSize, int maxDataCount, int linkOffset, int* usedIndexes, int* usedPositions);
+bool k_isPoolFull(const Pool* pool);
+void* k_allocPool(Pool* pool);
+bool k_freePool(Pool* pool, void* data);
+int k_getPoolIndex(const Pool* pool, const void* data);
+void* k_getPoolData(const Pool* pool, int index);
+bool k_isPoolDataUsed(const Pool* pool, int index);
+int k_getPoolUsedCount(const Pool* pool);
+void* k_getPoolUsedData(const Pool* pool, int position);
+static int* k_getPoolLink(const Pool* pool, int index);
+
+#endif // __UTILS_POOL_H__
@@ -503,6 +503,7 @@ int k_sprintf(char* str, const char* format, ...) {
   - %s         : string
   - %c         : char
   - %d, %i     : int (decimal, signed)
+  - %l         : long (decimal, signed)
   - %x, %X     : dword (hexadecimal, unsigned)
   - %q, %Q, %p : qword (hexadecimal, unsigned)
   - %f         : float (print down to the second position below decimal point by half-rounding up at the third position below decimal point.)
@@ -541,6 +542,10 @@ int k_vsprintf(char* str, const char* format, va_list ap) {
 				index += k_ltoa10(ivalue, str + index);
 				break;
 				
+			case 'l':
+				index += k_ltoa10((long)(va_arg(ap, long)), str + index);
+				break;
+				
 			case 'x':
 			case 'X':
 				qwvalue = (dword)(va_arg(ap, dword)) & 0xFFFFFFFF;
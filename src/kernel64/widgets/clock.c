@@ -3,12 +3,14 @@
 #include "../utils/util.h"
 #include "../core/rtc.h"
 #include "../utils/kid.h"
+#include "../core/dynamic_mem.h"
 
 static ClockManager g_clockManager;
 
 void k_initClockManager(void) {
 	k_initMutex(&g_clockManager.mutex);
 	k_initList(&g_clockManager.clockList);
+	k_initList(&g_clockManager.userClockList);
 	g_clockManager.prevHour = 0;
 	g_clockManager.prevMinute = 0;
 	g_clockManager.prevSecond = 0;
@@ -63,7 +65,11 @@ void k_setClock(Clock* clock, qword windowId, int x, int y, Color textColor, Col
 		k_setRect(&clockArea, x, y, x + FONT_DEFAULT_WIDTH * 11, y + FONT_DEFAULT_HEIGHT);
 		k_memcpy(&clock->area, &clockArea, sizeof(Rect));
 		break;
-	}	
+	}
+
+	// record clock text once, and draw it by display list whenever time changes.
+	k_initDisplayList(&clock->displayList, &clock->command, 1);
+	k_recordText(&clock->displayList, x, y, textColor, backgroundColor, clock->formatStr, k_strlen(clock->formatStr));
 }
 
 void k_addClock(Clock* clock) {
@@ -86,6 +92,51 @@ Clock* k_removeClock(qword clockId) {
 	return clock;
 }
 
+bool k_addUserClock(const Clock* clock) {
+	Clock* copy;
+
+	copy = (Clock*)k_allocMem(sizeof(Clock));
+	if (copy == null) {
+		return false;
+	}
+
+	// copy clock, and record display list again, because it points to command buffer and text of the original.
+	k_memcpy(copy, clock, sizeof(Clock));
+	k_setClock(copy, clock->windowId, clock->area.x1, clock->area.y1, clock->textColor, clock->backgroundColor, clock->format, false);
+
+	k_lock(&g_clockManager.mutex);
+
+	if (k_findListById(&g_clockManager.userClockList, copy->link.id) != null) {
+		k_unlock(&g_clockManager.mutex);
+		k_freeMem(copy);
+		return false;
+	}
+
+	k_addListToTail(&g_clockManager.userClockList, copy);
+
+	k_unlock(&g_clockManager.mutex);
+
+	return true;
+}
+
+bool k_removeUserClock(qword clockId) {
+	Clock* copy;
+
+	k_lock(&g_clockManager.mutex);
+
+	copy = k_removeListById(&g_clockManager.userClockList, clockId);
+
+	k_unlock(&g_clockManager.mutex);
+
+	if (copy == null) {
+		return false;
+	}
+
+	k_freeMem(copy);
+
+	return true;
+}
+
 void k_drawAllClocks() {
 	Clock* clock;
 
@@ -97,6 +148,12 @@ void k_drawAllClocks() {
 		clock = k_getNextFromList(&g_clockManager.clockList, clock);
 	}
 
+	clock = k_getHeadFromList(&g_clockManager.userClockList);
+	while (clock != null) {
+		k_drawClock(clock);
+		clock = k_getNextFromList(&g_clockManager.userClockList, clock);
+	}
+
 	k_unlock(&g_clockManager.mutex);
 }
 
@@ -175,6 +232,6 @@ static void k_drawClock(Clock* clock) {
 		break;
 	}
 
-	k_drawText(clock->windowId, clock->area.x1, clock->area.y1, clock->textColor, clock->backgroundColor, clock->formatStr, k_strlen(clock->formatStr));
+	k_drawDisplayList(clock->windowId, &clock->displayList, &clock->area);
 	k_updateScreenByWindowArea(clock->windowId, &clock->area);
 }
@@ -29,11 +29,14 @@ typedef struct k_Clock {
 	Color backgroundColor;
 	byte format;
 	char formatStr[12];
+	DisplayList displayList; // retained display list to draw clock
+	DrawCommand command;     // draw command buffer of display list
 } Clock;
 
 typedef struct k_ClockManager {
 	Mutex mutex;
 	List clockList;
+	List userClockList; // kernel-owned copies of clocks added by system call
 	byte prevHour;
 	byte prevMinute;
 	byte prevSecond;
@@ -45,6 +48,8 @@ void k_initClockManager(void);
 void k_setClock(Clock* clock, qword windowId, int x, int y, Color textColor, Color backgroundColor, byte format, bool reset);
 void k_addClock(Clock* clock);
 Clock* k_removeClock(qword clockId);
+bool k_addUserClock(const Clock* clock); // add kernel-owned copy of clock, because window manager draws clocks in kernel address space.
+bool k_removeUserClock(qword clockId);
 void k_drawAllClocks();
 static void k_drawClock(Clock* clock);
 
@@ -1,6 +1,7 @@
 #include "menu.h"
 #include "../core/window.h"
 #include "../utils/util.h"
+#include "../core/dynamic_mem.h"
 
 bool k_createMenu(Menu* menu, int x, int y, int itemHeight, Color* colors, qword parentId, Menu* top, dword flags) {
 	int i;
@@ -91,10 +92,10 @@ bool k_createMenu(Menu* menu, int x, int y, int itemHeight, Color* colors, qword
 		if ((flags & MENU_FLAGS_HORIZONTAL) != MENU_FLAGS_HORIZONTAL) {
 			k_setRect(&menu->table[i].area, offsetX, offsetY + itemHeight * i, offsetX + windowWidth - 1, offsetY + itemHeight * (i + 1) - 1);
 		}
-
-		k_drawMenuItem(menu, i, false, menu->textColor, menu->backgroundColor, menu->activeColor);
 	}
 
+	k_drawAllMenuItems(menu, menu->textColor, menu->backgroundColor, menu->activeColor);
+
 	if (flags & MENU_FLAGS_VISIBLE) {
 		k_moveWindowToTop(windowId);
 		k_showWindow(windowId, true);
@@ -329,11 +330,35 @@ bool k_drawMenuItem(const Menu* menu, int index, bool active, Color textColor, C
 }
 
 void k_drawAllMenuItems(const Menu* menu, Color textColor, Color backgroundColor, Color activeColor) {
+	DrawCommand* commands;
+	DisplayList list;
+	const Rect* itemArea;
 	int i;
 
+	// allocate 2 draw commands (rectangle, text) per a menu item.
+	commands = (DrawCommand*)k_allocMem(sizeof(DrawCommand) * menu->itemCount * 2);
+	if (commands == null) {
+		// draw menu items one by one if allocation fails.
+		for (i = 0; i < menu->itemCount; i++) {
+			k_drawMenuItem(menu, i, false, textColor, backgroundColor, activeColor);
+		}
+
+		return;
+	}
+
+	// record all menu items, and draw them under a lock and update screen once.
+	k_initDisplayList(&list, commands, menu->itemCount * 2);
 	for (i = 0; i < menu->itemCount; i++) {
-		k_drawMenuItem(menu, i, false, textColor, backgroundColor, activeColor);
+		itemArea = &menu->table[i].area;
+		k_recordRect(&list, itemArea->x1, itemArea->y1, itemArea->x2, itemArea->y2, backgroundColor, true);
+		k_recordText(&list, itemArea->x1 + MENU_ITEMWIDTHPADDING, itemArea->y1 + menu->itemHeightPadding, textColor, backgroundColor, menu->table[i].name, k_strlen(menu->table[i].name));
 	}
+
+	if ((list.count > 0) && (k_drawDisplayList(menu->id, &list, null) == true)) {
+		k_updateScreenByWindowArea(menu->id, &list.bound);
+	}
+
+	k_freeMem(commands);
 }
 
 void k_processTopMenuActivity(qword parentId, int mouseX, int mouseY) {
@@ -213,6 +213,17 @@ qword createThread(qword entryPointAddr, qword arg, byte affinity) {
 	return executeSyscall(SYSCALL_CREATETHREAD, &paramTable);
 }
 
+qword cloneProcess(qword entryPointAddr, qword arg, byte affinity) {
+	ParamTable paramTable;
+
+	PARAM(0) = entryPointAddr;
+	PARAM(1) = arg;
+	PARAM(2) = (qword)affinity;
+	PARAM(3) = (qword)exit;
+
+	return executeSyscall(SYSCALL_CLONEPROCESS, &paramTable);
+}
+
 void lock(Mutex* mutex) {
 	ParamTable paramTable;
 
@@ -245,7 +256,7 @@ bool free(void* addr) {
 	return (bool)executeSyscall(SYSCALL_FREE, &paramTable);
 }
 
-int readHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
+int readHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)primary;
@@ -257,7 +268,7 @@ int readHddSector(bool primary, bool master, dword lba, int sectorCount, char* b
 	return (int)executeSyscall(SYSCALL_READHDDSECTOR, &paramTable);
 }
 
-int writeHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer) {
+int writeHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)primary;
@@ -278,7 +289,7 @@ File* fopen(const char* fileName, const char* mode) {
 	return (File*)executeSyscall(SYSCALL_FOPEN, &paramTable);
 }
 
-dword fread(void* buffer, dword size, dword count, File* file) {
+qword fread(void* buffer, qword size, qword count, File* file) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)buffer;
@@ -286,10 +297,10 @@ dword fread(void* buffer, dword size, dword count, File* file) {
 	PARAM(2) = (qword)count;
 	PARAM(3) = (qword)file;
 
-	return (dword)executeSyscall(SYSCALL_FREAD, &paramTable);
+	return (qword)executeSyscall(SYSCALL_FREAD, &paramTable);
 }
 
-dword fwrite(const void* buffer, dword size, dword count, File* file) {
+qword fwrite(const void* buffer, qword size, qword count, File* file) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)buffer;
@@ -297,10 +308,10 @@ dword fwrite(const void* buffer, dword size, dword count, File* file) {
 	PARAM(2) = (qword)count;
 	PARAM(3) = (qword)file;
 
-	return (dword)executeSyscall(SYSCALL_FWRITE, &paramTable);
+	return (qword)executeSyscall(SYSCALL_FWRITE, &paramTable);
 }
 
-int fseek(File* file, int offset, int origin) {
+int fseek(File* file, long offset, int origin) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)file;
@@ -366,6 +377,98 @@ bool isfopen(const dirent* entry) {
 	return (bool)executeSyscall(SYSCALL_ISFOPEN, &paramTable);
 }
 
+int stat(const char* fileName, dirent* entry) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)fileName;
+	PARAM(1) = (qword)entry;
+
+	return (int)executeSyscall(SYSCALL_STAT, &paramTable);
+}
+
+int mkdir(const char* dirName) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)dirName;
+
+	return (int)executeSyscall(SYSCALL_MKDIR, &paramTable);
+}
+
+int rmdir(const char* dirName) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)dirName;
+
+	return (int)executeSyscall(SYSCALL_RMDIR, &paramTable);
+}
+
+const void* mapFile(const char* fileName, dword* size) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)fileName;
+	PARAM(1) = (qword)size;
+
+	return (const void*)executeSyscall(SYSCALL_MAPFILE, &paramTable);
+}
+
+int unmapFile(const void* addr) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)addr;
+
+	return (int)executeSyscall(SYSCALL_UNMAPFILE, &paramTable);
+}
+
+int fsync(File* file) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)file;
+
+	return (int)executeSyscall(SYSCALL_FSYNC, &paramTable);
+}
+
+qword readv(File* file, const iovec* vectors, int count) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)file;
+	PARAM(1) = (qword)vectors;
+	PARAM(2) = (qword)count;
+
+	return (qword)executeSyscall(SYSCALL_READV, &paramTable);
+}
+
+qword writev(File* file, const iovec* vectors, int count) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)file;
+	PARAM(1) = (qword)vectors;
+	PARAM(2) = (qword)count;
+
+	return (qword)executeSyscall(SYSCALL_WRITEV, &paramTable);
+}
+
+qword pread(File* file, void* buffer, qword size, qword offset) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)file;
+	PARAM(1) = (qword)buffer;
+	PARAM(2) = (qword)size;
+	PARAM(3) = (qword)offset;
+
+	return (qword)executeSyscall(SYSCALL_PREAD, &paramTable);
+}
+
+qword pwrite(File* file, const void* buffer, qword size, qword offset) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)file;
+	PARAM(1) = (qword)buffer;
+	PARAM(2) = (qword)size;
+	PARAM(3) = (qword)offset;
+
+	return (qword)executeSyscall(SYSCALL_PWRITE, &paramTable);
+}
+
 void sendSerialData(byte* buffer, int size) {
 	ParamTable paramTable;
 
@@ -776,6 +879,16 @@ void getMouseCursorPos(int* x, int* y) {
 	executeSyscall(SYSCALL_GETMOUSECURSORPOS, &paramTable);
 }
 
+bool drawDisplayList(qword windowId, const DisplayList* list, const Rect* damageArea) {
+	ParamTable paramTable;
+
+	PARAM(0) = windowId;
+	PARAM(1) = (qword)list;
+	PARAM(2) = (qword)damageArea;
+
+	return (bool)executeSyscall(SYSCALL_DRAWDISPLAYLIST, &paramTable);
+}
+
 
 bool initJpeg(Jpeg* jpeg, const byte* fileBuffer, dword fileSize) {
 	ParamTable paramTable;
@@ -891,20 +1004,20 @@ void setClock(Clock* clock, qword windowId, int x, int y, Color textColor, Color
 	executeSyscall(SYSCALL_SETCLOCK, &paramTable);
 }
 
-void addClock(Clock* clock) {
+bool addClock(const Clock* clock) {
 	ParamTable paramTable;
 
 	PARAM(0) = (qword)clock;
 
-	executeSyscall(SYSCALL_ADDCLOCK, &paramTable);
+	return (bool)executeSyscall(SYSCALL_ADDCLOCK, &paramTable);
 }
 
-Clock* removeClock(qword clockId) {
+bool removeClock(qword clockId) {
 	ParamTable paramTable;
 
 	PARAM(0) = clockId;
 
-	return (Clock*)executeSyscall(SYSCALL_REMOVECLOCK, &paramTable);
+	return (bool)executeSyscall(SYSCALL_REMOVECLOCK, &paramTable);
 }
 
 qword allocKid(void) {
@@ -934,3 +1047,11 @@ void confirm(const ConfirmArg* arg) {
 
 	executeSyscall(SYSCALL_CONFIRM, &paramTable);
 }
+
+qword enterSyscallRing(SyscallRing* ring) {
+	ParamTable paramTable;
+
+	PARAM(0) = (qword)ring;
+
+	return executeSyscall(SYSCALL_ENTERSYSCALLRING, &paramTable);
+}
@@ -2,8 +2,10 @@
 #define __SYSCALL_H__
 
 #include "types.h"
+#include "syscall_numbers.h"
 
 #define SC_MAXPARAMCOUNT 10
+#define SC_RINGMAXCOUNT  256 // max entry count of syscall ring (power of 2)
 
 /* Macro Function */
 #define PARAM(x) (paramTable.values[(x)])
@@ -14,6 +16,25 @@ typedef struct __ParamTable {
 	qword values[SC_MAXPARAMCOUNT];
 } ParamTable;
 
+typedef struct __SyscallRingEntry {
+	qword syscallNumber;   // syscall number
+	ParamTable paramTable; // parameter table
+	qword result;          // result of syscall (written by kernel when the entry is processed)
+} SyscallRingEntry;
+
+/**
+  < Syscall Ring >
+  - A ring of syscall entries in application memory, shared by application and kernel (the same address space).
+  - application queues entries at tail, and enters kernel once by SYSCALL_ENTERSYSCALLRING.
+    kernel processes all entries from head to tail in order, writes results to entries, and moves head.
+  - head and tail are free-running indexes (entry index = index % SC_RINGMAXCOUNT), and queued entry count is tail - head.
+*/
+typedef struct __SyscallRing {
+	volatile dword head;                      // head index: next entry to be processed (written by kernel)
+	volatile dword tail;                      // tail index: next entry to be queued (written by application)
+	SyscallRingEntry entries[SC_RINGMAXCOUNT]; // syscall entries
+} SyscallRing;
+
 #pragma pack(pop)
 
 /****** Functions defined in syscall_asm.asm ******/
@@ -51,6 +72,7 @@ bool joinGroup(qword* taskIds, int count);
 bool notifyOneInJoinGroup(qword groupId);
 bool notifyAllInJoinGroup(qword groupId);
 qword createThread(qword entryPointAddr, qword arg, byte affinity);
+qword cloneProcess(qword entryPointAddr, qword arg, byte affinity);
 
 /*** Syscall from sync.h ***/
 void lock(Mutex* mutex);
@@ -61,14 +83,14 @@ void* malloc(qword size);
 bool free(void* addr);
 
 /*** Syscall from hdd.h ***/
-int readHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
-int writeHddSector(bool primary, bool master, dword lba, int sectorCount, char* buffer);
+int readHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
+int writeHddSector(bool primary, bool master, qword lba, int sectorCount, char* buffer);
 
 /*** Syscall from file_system.h ***/
 File* fopen(const char* fileName, const char* mode);
-dword fread(void* buffer, dword size, dword count, File* file);
-dword fwrite(const void* buffer, dword size, dword count, File* file);
-int fseek(File* file, int offset, int origin);
+qword fread(void* buffer, qword size, qword count, File* file);
+qword fwrite(const void* buffer, qword size, qword count, File* file);
+int fseek(File* file, long offset, int origin);
 int fclose(File* file);
 int remove(const char* fileName);
 Dir* opendir(const char* dirName);
@@ -76,6 +98,16 @@ dirent* readdir(Dir* dir);
 void rewinddir(Dir* dir);
 int closedir(Dir* dir);
 bool isfopen(const dirent* entry);
+int stat(const char* fileName, dirent* entry);
+int mkdir(const char* dirName);
+int rmdir(const char* dirName);
+const void* mapFile(const char* fileName, dword* size);
+int unmapFile(const void* addr);
+int fsync(File* file);
+qword readv(File* file, const iovec* vectors, int count);
+qword writev(File* file, const iovec* vectors, int count);
+qword pread(File* file, void* buffer, qword size, qword offset);
+qword pwrite(File* file, const void* buffer, qword size, qword offset);
 
 /*** Syscall from serial_port.h ***/
 void sendSerialData(byte* buffer, int size);
@@ -129,6 +161,7 @@ bool drawText(qword windowId, int x, int y, Color textColor, Color backgroundCol
 bool bitblt(qword windowId, int x, int y, const Color* buffer, int width, int height);
 void moveMouseCursor(int x, int y);
 void getMouseCursorPos(int* x, int* y);
+bool drawDisplayList(qword windowId, const DisplayList* list, const Rect* damageArea);
 
 /*** Syscall from jpeg.h ***/
 bool initJpeg(Jpeg* jpeg, const byte* fileBuffer, dword fileSize);
@@ -149,8 +182,8 @@ bool processMenuEvent(Menu* menu);
 bool drawHosLogo(qword windowId, int x, int y, int width, int height, Color brightColor, Color darkColor);
 bool drawButton(qword windowId, const Rect* buttonArea, Color textColor, Color backgroundColor, const char* text, dword flags);
 void setClock(Clock* clock, qword windowId, int x, int y, Color textColor, Color backgroundColor, byte format, bool reset);
-void addClock(Clock* clock);
-Clock* removeClock(qword clockId);
+bool addClock(const Clock* clock);
+bool removeClock(qword clockId);
 
 /*** Syscall from kid.h ***/
 qword allocKid(void);
@@ -160,4 +193,7 @@ void freeKid(qword id);
 void alert(const char* msg);
 void confirm(const ConfirmArg* arg);
 
+/*** Syscall from syscall.h ***/
+qword enterSyscallRing(SyscallRing* ring);
+
 #endif // __SYSCALL_H__
\ No newline at end of file
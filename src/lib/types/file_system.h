@@ -4,7 +4,13 @@
 #include "types.h"
 
 // max file name length
-#define FS_MAXFILENAMELENGTH      24   // max file name length (include file extension and last null character)
+#define FS_MAXFILENAMELENGTH      23   // max file name length (include file extension and last null character)
+#define FS_MAXPATHLENGTH          256  // max path length (include directory names, path separators and last null character)
+#define FS_IOVEC_MAXCOUNT         1024 // max I/O vector count of readv/writev
+
+// file attribute
+#define FS_ATTRIBUTE_FILE      0x00 // file
+#define FS_ATTRIBUTE_DIRECTORY 0x01 // directory
 
 // SEEK option
 #define SEEK_SET 0 // start of file
@@ -12,35 +18,60 @@
 #define SEEK_END 2 // end of file
 
 // redefine hFS type names as C standard I/O type names.
-#define size_t dword
+#define size_t qword
 #define dirent DirEntry
 #define d_name fileName
 #define d_size fileSize
+#define d_attr attribute
+#define iovec IoVec
+#define iov_base base
+#define iov_len length
 
 #pragma pack(push, 1)
 
 typedef struct __DirEntry {
-	char fileName[FS_MAXFILENAMELENGTH]; // [byte 0~23]  : file name (include file extension and last null character)
-	dword fileSize;                      // [byte 24~27] : file size (byte-level)
-	dword startClusterIndex;             // [byte 28~31] : start cluster index (0x00:free directory entry)
-} DirEntry; // 32 bytes-sized
+	char fileName[FS_MAXFILENAMELENGTH]; // [byte 0~22]  : file name (include file extension and last null character)
+	byte attribute;                      // [byte 23]    : file attribute: [0x00:file], [0x01:directory]
+	qword fileSize;                      // [byte 24~31] : file size (byte-level, 0 for directory)
+	dword startClusterIndex;             // [byte 32~35] : start cluster index (0x00:free directory entry)
+	byte reserved[28];                   // [byte 36~63] : reserved
+} DirEntry; // 64 bytes-sized
+
+typedef struct __FileExtent {
+	dword clusterOffset; // cluster offset in file of the first cluster of extent
+	dword clusterIndex;  // cluster index of the first cluster of extent
+	dword clusterCount;  // contiguous cluster count of extent
+} FileExtent;
 
 typedef struct __FileHandle {
-	int dirEntryOffset;        // directory entry offset (directory entry index matching file name)
-	dword fileSize;            // file size (byte-level)
+	int dentryIndex;           // dentry index of file in dentry cache
+	qword fileSize;            // file size (byte-level)
 	dword startClusterIndex;   // start cluster index
 	dword currentClusterIndex; // current cluster index (cluster index which current I/O is working)
 	dword prevClusterIndex;    // previous cluster index
-	dword currentOffset;       // current file pointer offset (byte-level)
+	qword currentOffset;       // current file pointer offset (byte-level)
+	FileExtent* extentMap;     // extent map: cluster runs of file sorted by cluster offset (built lazily at first seek, null if not built)
+	dword extentCount;         // extent count of extent map
+	dword extentMaxCount;      // max extent count of extent map (allocated size)
+	dword mappedClusterCount;  // cluster count covered by extent map from the start of file
+	byte* clusterBuffer;       // scratch cluster buffer of handle (allocated at first use, null if disk hands out cluster pointers)
 } FileHandle;
 
 typedef struct __DirHandle {
-	DirEntry* dirBuffer; // root directory buffer
-	int currentOffset;   // current directory pointer offset
+	DirEntry* dirBuffer;       // directory cluster buffer
+	int currentOffset;         // current directory pointer offset (directory entry index in directory cluster)
+	dword startClusterIndex;   // start cluster index of directory
+	dword currentClusterIndex; // cluster index of directory cluster in directory cluster buffer
 } DirHandle;
 
+typedef struct __IoVec {
+	void* base;   // buffer address
+	qword length; // buffer size (byte-level)
+} IoVec;
+
 typedef struct __FileDirHandle {
 	byte type; // handle type: free handle, file handle, directory handle	
+	int next;  // next handle index: next open handle in open handle hash bucket chain if used, next free handle in handle pool if free (-1:end)
 	union {
 		FileHandle fileHandle; // file handle
 		DirHandle dirHandle;   // directory handle
@@ -21,6 +21,7 @@
 #define TASK_FLAGS_GUI     0x0200000000000000
 #define TASK_FLAGS_USER    0x0100000000000000
 #define TASK_FLAGS_JOIN    0x0080000000000000
+#define TASK_FLAGS_FPUEAGER 0x0040000000000000
 
 // task affinity
 #define TASK_AFFINITY_LB 0xFF // load balancing (no affinity)
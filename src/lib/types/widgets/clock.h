@@ -28,6 +28,8 @@ typedef struct __Clock {
 	Color backgroundColor;
 	byte format;
 	char formatStr[12];
+	DisplayList displayList; // retained display list to draw clock
+	DrawCommand command;     // draw command buffer of display list
 } Clock;
 
 #pragma pack(pop)
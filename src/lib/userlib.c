@@ -426,6 +426,7 @@ int sprintf(char* str, const char* format, ...) {
   - %s         : string
   - %c         : char
   - %d, %i     : int (decimal, signed)
+  - %l         : long (decimal, signed)
   - %x, %X     : dword (hexadecimal, unsigned)
   - %q, %Q, %p : qword (hexadecimal, unsigned)
   - %f         : float (print down to the second position below decimal point by half-rounding up at the third position below decimal point.)
@@ -464,6 +465,10 @@ int vsprintf(char* str, const char* format, va_list ap) {
 				index += ltoa10(ivalue, str + index);
 				break;
 				
+			case 'l':
+				index += ltoa10((long)(va_arg(ap, long)), str + index);
+				break;
+				
 			case 'x':
 			case 'X':
 				qwvalue = (dword)(va_arg(ap, dword)) & 0xFFFFFFFF;
@@ -566,6 +571,38 @@ qword rand(void) {
 	return g_randomValue;
 }
 
+void initSyscallRing(SyscallRing* ring) {
+	memset(ring, 0, sizeof(SyscallRing));
+}
+
+// queue a syscall entry to ring, and return its parameter table which the caller fills.
+// If ring is full, submit queued entries first.
+// [NOTE] entries are processed only when they are submitted, so filling parameters after queuing is safe.
+ParamTable* queueSyscall(SyscallRing* ring, qword syscallNumber) {
+	SyscallRingEntry* entry;
+
+	if ((dword)(ring->tail - ring->head) >= SC_RINGMAXCOUNT) {
+		submitSyscallRing(ring);
+	}
+
+	entry = &(ring->entries[ring->tail % SC_RINGMAXCOUNT]);
+	entry->syscallNumber = syscallNumber;
+	entry->result = 0;
+	ring->tail++;
+
+	return &(entry->paramTable);
+}
+
+// enter kernel once to process all queued entries, and return processed entry count.
+// result of each entry is written to result field of entry.
+qword submitSyscallRing(SyscallRing* ring) {
+	if (ring->tail == ring->head) {
+		return 0;
+	}
+
+	return enterSyscallRing(ring);
+}
+
 void printf(const char* format, ...) {
 	va_list ap;
 	char str[1024];
@@ -919,3 +956,130 @@ bool sendKeyEventToWindow(qword windowId, const Key* key) {
 
 	return sendEventToWindow(&event, windowId);
 }
+
+void initDisplayList(DisplayList* list, DrawCommand* commands, int maxCount) {
+	list->commands = commands;
+	list->maxCount = maxCount;
+	clearDisplayList(list);
+}
+
+void clearDisplayList(DisplayList* list) {
+	list->count = 0;
+	setRect(&list->bound, 0, 0, 0, 0);
+}
+
+static DrawCommand* addDrawCommand(DisplayList* list, byte type, int x1, int y1, int x2, int y2) {
+	DrawCommand* command;
+
+	if (list->count >= list->maxCount) {
+		return null;
+	}
+
+	command = &list->commands[list->count];
+	command->type = type;
+	setRect(&command->bound, x1, y1, x2, y2);
+
+	// extend bounding area of display list to include the command.
+	if (list->count == 0) {
+		memcpy(&list->bound, &command->bound, sizeof(Rect));
+
+	} else {
+		list->bound.x1 = MIN(list->bound.x1, command->bound.x1);
+		list->bound.y1 = MIN(list->bound.y1, command->bound.y1);
+		list->bound.x2 = MAX(list->bound.x2, command->bound.x2);
+		list->bound.y2 = MAX(list->bound.y2, command->bound.y2);
+	}
+
+	list->count++;
+
+	return command;
+}
+
+bool recordPixel(DisplayList* list, int x, int y, Color color) {
+	DrawCommand* command;
+
+	command = addDrawCommand(list, DRAWCOMMAND_PIXEL, x, y, x, y);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = color;
+	command->x1 = x;
+	command->y1 = y;
+
+	return true;
+}
+
+bool recordLine(DisplayList* list, int x1, int y1, int x2, int y2, Color color) {
+	DrawCommand* command;
+
+	command = addDrawCommand(list, DRAWCOMMAND_LINE, x1, y1, x2, y2);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = color;
+	command->x1 = x1;
+	command->y1 = y1;
+	command->x2 = x2;
+	command->y2 = y2;
+
+	return true;
+}
+
+bool recordRect(DisplayList* list, int x1, int y1, int x2, int y2, Color color, bool fill) {
+	DrawCommand* command;
+
+	command = addDrawCommand(list, DRAWCOMMAND_RECT, x1, y1, x2, y2);
+	if (command == null) {
+		return false;
+	}
+
+	command->fill = fill;
+	command->color = color;
+	command->x1 = x1;
+	command->y1 = y1;
+	command->x2 = x2;
+	command->y2 = y2;
+
+	return true;
+}
+
+bool recordCircle(DisplayList* list, int x, int y, int radius, Color color, bool fill) {
+	DrawCommand* command;
+
+	command = addDrawCommand(list, DRAWCOMMAND_CIRCLE, x - radius, y - radius, x + radius, y + radius);
+	if (command == null) {
+		return false;
+	}
+
+	command->fill = fill;
+	command->color = color;
+	command->x1 = x;
+	command->y1 = y;
+	command->x2 = radius;
+
+	return true;
+}
+
+bool recordText(DisplayList* list, int x, int y, Color textColor, Color backgroundColor, const char* str, int len) {
+	DrawCommand* command;
+
+	if (len <= 0) {
+		return false;
+	}
+
+	command = addDrawCommand(list, DRAWCOMMAND_TEXT, x, y, x + (FONT_DEFAULT_WIDTH * len) - 1, y + FONT_DEFAULT_HEIGHT - 1);
+	if (command == null) {
+		return false;
+	}
+
+	command->color = textColor;
+	command->backgroundColor = backgroundColor;
+	command->x1 = x;
+	command->y1 = y;
+	command->str = str;
+	command->len = len;
+
+	return true;
+}
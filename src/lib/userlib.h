@@ -3,6 +3,7 @@
 
 #include <stdarg.h>
 #include "types.h"
+#include "syscall.h"
 
 // argument-related macros
 #define ARG_MAXLENGTH              30 // It's including the last null character, so the max argument length user can input is 29.
@@ -51,6 +52,11 @@ bool addFileExtension(char* fileName, const char* extension);
 qword srand(qword seed);
 qword rand(void);
 
+/* Syscall Ring Functions */
+void initSyscallRing(SyscallRing* ring);
+ParamTable* queueSyscall(SyscallRing* ring, qword syscallNumber);
+qword submitSyscallRing(SyscallRing* ring);
+
 /* Console Functions */
 void printf(const char* format, ...);
 
@@ -81,4 +87,13 @@ bool sendMouseEventToWindow(qword windowId, qword eventType, int mouseX, int mou
 bool sendWindowEventToWindow(qword windowId, qword eventType);
 bool sendKeyEventToWindow(qword windowId, const Key* key);
 
+/* Display List Functions */
+void initDisplayList(DisplayList* list, DrawCommand* commands, int maxCount);
+void clearDisplayList(DisplayList* list);
+bool recordPixel(DisplayList* list, int x, int y, Color color);
+bool recordLine(DisplayList* list, int x1, int y1, int x2, int y2, Color color);
+bool recordRect(DisplayList* list, int x1, int y1, int x2, int y2, Color color, bool fill);
+bool recordCircle(DisplayList* list, int x, int y, int radius, Color color, bool fill);
+bool recordText(DisplayList* list, int x, int y, Color textColor, Color backgroundColor, const char* str, int len);
+
 #endif // __USERLIB_H__
\ No newline at end of file
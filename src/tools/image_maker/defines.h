@@ -9,4 +9,19 @@
 
 #define BYTES_OF_SECTOR 512
 
+// LZ4-compressed kernel64 header: kernel32 checks the signature, and decompresses kernel64 if it exists.
+#define KERNEL64_LZ4SIGNATURE  0x4B345A4C // "LZ4K"
+#define KERNEL64_LZ4HEADERSIZE 16         // signature (4 bytes), compressed size (4 bytes), original size (4 bytes), reserved (4 bytes)
+
+// LZ4 block format-related macros
+#define LZ4_MINMATCH      4     // min match length
+#define LZ4_LASTLITERALS  5     // The last 5 bytes are always literals.
+#define LZ4_MFLIMIT       12    // The last match must start at least 12 bytes before the end of block.
+#define LZ4_MAXOFFSET     65535 // max match offset
+#define LZ4_HASHBITS      12
+#define LZ4_HASHTABLESIZE (1 << LZ4_HASHBITS)
+#define LZ4_CHAINSIZE     (LZ4_MAXOFFSET + 1) // chain table size: It covers all positions in match window.
+#define LZ4_MAXCHAINDEPTH 64                  // max candidate count searched in a hash chain
+#define LZ4_MAXCOMPRESSEDSIZE(srcSize) ((srcSize) + ((srcSize) / 255) + 16)
+
 #endif // __DEFINES_H__
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #ifdef __APPLE__
 #include <sys/uio.h>
@@ -13,12 +14,19 @@
 #include "defines.h"
 
 // argument
-#define ARG_TARGET argv[1]
-#define ARG_SRC1   argv[2]
-#define ARG_SRC2   argv[3]
-#define ARG_SRC3   argv[4]
+#define ARG_OPTION "-c" // compress kernel64 (src3) with LZ4.
+#define ARG_TARGET argv[argIndex + 1]
+#define ARG_SRC1   argv[argIndex + 2]
+#define ARG_SRC2   argv[argIndex + 3]
+#define ARG_SRC3   argv[argIndex + 4]
 
 static int copyFile(int srcfd, int targetfd);
+static int copyCompressedFile(int srcfd, int targetfd);
+static int compressLz4(const unsigned char* src, int srcSize, unsigned char* dest);
+static void insertLz4HashChain(const unsigned char* src, int srcIndex, int* hashTable, int* chainTable);
+static int writeLz4Sequence(unsigned char* dest, int destIndex, const unsigned char* literals, int literalLen, int offset, int matchLen);
+static unsigned int readDword(const unsigned char* src);
+static void writeDword(unsigned char* dest, unsigned int value);
 static int adjustBySectorSize(int fd, int srcSize);
 static void writeKernelInfo(int targetfd, int totalSectorCount, int kernel32SectorCount);
 
@@ -29,10 +37,18 @@ int main(int argc, const char** argv) {
 	int kernel32SectorCount;
 	int kernel64SectorCount;
 	int srcSize;
+	int argIndex = 0;
+	int compress = 0;
+	
+	// check option.
+	if ((argc == 6) && (strcmp(argv[1], ARG_OPTION) == 0)) {
+		argIndex = 1;
+		compress = 1;
+	}
 	
 	// check parameter count.
-	if (argc != 5) {
-		fprintf(stderr, "[error] Usage) image-maker <target> <src1> <src2> <src3>\n");
+	if (argc != (5 + argIndex)) {
+		fprintf(stderr, "[error] Usage) image-maker [-c] <target> <src1> <src2> <src3>\n");
 		exit(8);
 	}
 		
@@ -75,7 +91,13 @@ int main(int argc, const char** argv) {
 		exit(8);
 	}
 	
-	srcSize = copyFile(srcfd, targetfd);
+	if (compress == 1) {
+		srcSize = copyCompressedFile(srcfd, targetfd);
+		
+	} else {
+		srcSize = copyFile(srcfd, targetfd);
+	}
+	
 	close(srcfd);
 	
 	kernel64SectorCount = adjustBySectorSize(targetfd, srcSize);
@@ -116,6 +138,201 @@ static int copyFile(int srcfd, int targetfd) {
 	return srcSize;
 }
 
+static int copyCompressedFile(int srcfd, int targetfd) {
+	struct stat srcStat;
+	unsigned char* src;
+	unsigned char* dest;
+	int srcSize;
+	int compressedSize;
+	int writeSize;
+	
+	if (fstat(srcfd, &srcStat) == -1) {
+		fprintf(stderr, "[error] file stat failure: errno: %d\n", errno);
+		exit(8);
+	}
+	
+	srcSize = (int)srcStat.st_size;
+	src = (unsigned char*)malloc(srcSize + 1);
+	dest = (unsigned char*)malloc(KERNEL64_LZ4HEADERSIZE + LZ4_MAXCOMPRESSEDSIZE(srcSize));
+	if ((src == NULL) || (dest == NULL)) {
+		fprintf(stderr, "[error] memory allocation failure\n");
+		exit(8);
+	}
+	
+	if (read(srcfd, src, srcSize) != srcSize) {
+		fprintf(stderr, "[error] read size != file size\n");
+		exit(8);
+	}
+	
+	compressedSize = compressLz4(src, srcSize, dest + KERNEL64_LZ4HEADERSIZE);
+	
+	// If compression does not reduce size, write the original file.
+	if ((KERNEL64_LZ4HEADERSIZE + compressedSize) >= srcSize) {
+		printf("[info] not compress file: compressed size (%d) is not smaller than file size (%d).\n", KERNEL64_LZ4HEADERSIZE + compressedSize, srcSize);
+		writeSize = write(targetfd, src, srcSize);
+		
+	} else {
+		printf("[info] compress file with LZ4: file size: %d, compressed size: %d\n", srcSize, KERNEL64_LZ4HEADERSIZE + compressedSize);
+		writeDword(dest, KERNEL64_LZ4SIGNATURE);
+		writeDword(dest + 4, (unsigned int)compressedSize);
+		writeDword(dest + 8, (unsigned int)srcSize);
+		writeDword(dest + 12, 0);
+		srcSize = KERNEL64_LZ4HEADERSIZE + compressedSize;
+		writeSize = write(targetfd, dest, srcSize);
+	}
+	
+	if (writeSize != srcSize) {
+		fprintf(stderr, "[error] write size != file size\n");
+		exit(8);
+	}
+	
+	free(src);
+	free(dest);
+	
+	return srcSize;
+}
+
+/**
+  < LZ4 Block Format >
+  - A block is composed of sequences, and a sequence is [token][literal length+][literals][offset][match length+].
+  - token (1 byte): high 4 bits are literal length, and low 4 bits are match length - 4.
+                    If a length is 15, the following bytes are added to it until a byte is not 255.
+  - offset (2 bytes, little endian): backward distance of match from the current position (1 ~ 65535).
+  - The last sequence has only literals.
+*/
+static int compressLz4(const unsigned char* src, int srcSize, unsigned char* dest) {
+	static int hashTable[LZ4_HASHTABLESIZE]; // the latest position of each hash
+	static int chainTable[LZ4_CHAINSIZE];    // the previous position with the same hash of each position in match window
+	unsigned int sequence;
+	int srcIndex = 0;
+	int anchor = 0;
+	int destIndex = 0;
+	int candidateIndex;
+	int candidateLen;
+	int matchIndex;
+	int matchLen;
+	int depth;
+	int i;
+	
+	for (i = 0; i < LZ4_HASHTABLESIZE; i++) {
+		hashTable[i] = -1;
+	}
+	
+	// find matches greedily using hash chains of 4-byte sequences: take the longest match among candidates in the chain.
+	// [NOTE] Different sequences can have the same hash, so candidates whose sequence differs (hash collision) are skipped.
+	while (srcIndex < (srcSize - LZ4_MFLIMIT)) {
+		sequence = readDword(src + srcIndex);
+		insertLz4HashChain(src, srcIndex, hashTable, chainTable);
+		
+		matchLen = 0;
+		matchIndex = -1;
+		candidateIndex = chainTable[srcIndex % LZ4_CHAINSIZE];
+		for (depth = 0; (depth < LZ4_MAXCHAINDEPTH) && (candidateIndex >= 0) && ((srcIndex - candidateIndex) <= LZ4_MAXOFFSET); depth++) {
+			if (readDword(src + candidateIndex) == sequence) {
+				candidateLen = LZ4_MINMATCH;
+				while (((srcIndex + candidateLen) < (srcSize - LZ4_LASTLITERALS)) && (src[candidateIndex + candidateLen] == src[srcIndex + candidateLen])) {
+					candidateLen++;
+				}
+				
+				if (candidateLen > matchLen) {
+					matchLen = candidateLen;
+					matchIndex = candidateIndex;
+				}
+			}
+			
+			candidateIndex = chainTable[candidateIndex % LZ4_CHAINSIZE];
+		}
+		
+		if (matchIndex < 0) {
+			srcIndex++;
+			continue;
+		}
+		
+		destIndex = writeLz4Sequence(dest, destIndex, src + anchor, srcIndex - anchor, srcIndex - matchIndex, matchLen);
+		
+		// insert positions inside match to hash chains, in order that the following data can match them.
+		for (i = srcIndex + 1; (i < (srcIndex + matchLen)) && (i < (srcSize - LZ4_MFLIMIT)); i++) {
+			insertLz4HashChain(src, i, hashTable, chainTable);
+		}
+		
+		srcIndex += matchLen;
+		anchor = srcIndex;
+	}
+	
+	// write the last literals.
+	destIndex = writeLz4Sequence(dest, destIndex, src + anchor, srcSize - anchor, 0, 0);
+	
+	return destIndex;
+}
+
+static void insertLz4HashChain(const unsigned char* src, int srcIndex, int* hashTable, int* chainTable) {
+	unsigned int hash;
+	
+	// link position to the previous position with the same hash, and make it the latest position of the hash.
+	// [NOTE] chain table is indexed by position modulo window size, so only chains inside match window are valid.
+	hash = (readDword(src + srcIndex) * 2654435761U) >> (32 - LZ4_HASHBITS);
+	chainTable[srcIndex % LZ4_CHAINSIZE] = hashTable[hash];
+	hashTable[hash] = srcIndex;
+}
+
+static int writeLz4Sequence(unsigned char* dest, int destIndex, const unsigned char* literals, int literalLen, int offset, int matchLen) {
+	unsigned char* token;
+	int len;
+	
+	token = dest + destIndex++;
+	
+	// write literal length and literals.
+	if (literalLen >= 15) {
+		*token = 15 << 4;
+		for (len = literalLen - 15; len >= 255; len -= 255) {
+			dest[destIndex++] = 255;
+		}
+		
+		dest[destIndex++] = (unsigned char)len;
+		
+	} else {
+		*token = (unsigned char)(literalLen << 4);
+	}
+	
+	memcpy(dest + destIndex, literals, literalLen);
+	destIndex += literalLen;
+	
+	// The last sequence has no match.
+	if (matchLen == 0) {
+		return destIndex;
+	}
+	
+	// write offset and match length.
+	dest[destIndex++] = (unsigned char)(offset & 0xFF);
+	dest[destIndex++] = (unsigned char)(offset >> 8);
+	
+	matchLen -= LZ4_MINMATCH;
+	if (matchLen >= 15) {
+		*token |= 15;
+		for (len = matchLen - 15; len >= 255; len -= 255) {
+			dest[destIndex++] = 255;
+		}
+		
+		dest[destIndex++] = (unsigned char)len;
+		
+	} else {
+		*token |= (unsigned char)matchLen;
+	}
+	
+	return destIndex;
+}
+
+static unsigned int readDword(const unsigned char* src) {
+	return src[0] | (src[1] << 8) | (src[2] << 16) | ((unsigned int)src[3] << 24);
+}
+
+static void writeDword(unsigned char* dest, unsigned int value) {
+	dest[0] = value & 0xFF;
+	dest[1] = (value >> 8) & 0xFF;
+	dest[2] = (value >> 16) & 0xFF;
+	dest[3] = (value >> 24) & 0xFF;
+}
+
 static int adjustBySectorSize(int fd, int srcSize) {
 	int i;
 	int ajustSize;